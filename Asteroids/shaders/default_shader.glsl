@@ -6,24 +6,45 @@ layout (location = 1) in vec4 color;
 layout(location = 2) in vec2 tex_coord;
 layout(location = 3, component = 0) in float tex_index;
 layout(location = 3, component = 1) in float material_id;
+layout(location = 4) in vec4 shape;
 
-layout(binding = 0) buffer GlobalMatrices 
+struct View
 {
     mat4 proj_view;
+    vec4 viewport;
+    vec4 depth_range;
+};
+
+/* One view per instance, see Ember::ShaderView. */
+layout(binding = 0) buffer GlobalMatrices 
+{
+    View views[];
 };
 
 out flat vec4 out_color;
 out vec2 out_tex_coord;
 out flat float out_tex_index;
 out vec4 out_pos;
+out flat vec4 out_shape;
 
 void main()
 {
-	gl_Position = proj_view * vec4(pos, 1.0);
+	View view = views[gl_InstanceID];
+	vec4 clip_pos = view.proj_view * vec4(pos, 1.0);
+
+	/* Clipped to the view's own volume, then moved into its rectangle and depth slice. */
+	gl_ClipDistance[0] = clip_pos.w + clip_pos.x;
+	gl_ClipDistance[1] = clip_pos.w - clip_pos.x;
+	gl_ClipDistance[2] = clip_pos.w + clip_pos.y;
+	gl_ClipDistance[3] = clip_pos.w - clip_pos.y;
+	clip_pos.xy = clip_pos.xy * view.viewport.zw + (2.0 * view.viewport.xy + view.viewport.zw - 1.0) * clip_pos.w;
+	clip_pos.z = clip_pos.z * (view.depth_range.y - view.depth_range.x) + (view.depth_range.x + view.depth_range.y - 1.0) * clip_pos.w;
+	gl_Position = clip_pos;
 	out_color = color;
 	out_tex_coord = tex_coord;
 	out_tex_index = tex_index;
 	out_pos = vec4(pos, 1.0);
+	out_shape = shape;
 }
 
 #shader fragment
@@ -35,11 +56,33 @@ in flat vec4 out_color;
 in vec2 out_tex_coord;
 in flat float out_tex_index;
 in vec4 out_pos;
+in flat vec4 out_shape;
 
 uniform sampler2D textures[32];
 
+/* Signed distance to a box with half size b and corners rounded by r, negative inside. */
+float RoundedBox(vec2 p, vec2 b, float r)
+{
+	vec2 q = abs(p) - b + r;
+	return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - r;
+}
+
 void main()
 {
+	/* Circles, rings, rounded rects and capsules, the quad's texture coordinates are the position in the shape. */
+	if(out_shape.x > 0.0){
+		float d = RoundedBox(out_tex_coord, out_shape.xy, min(out_shape.z, min(out_shape.x, out_shape.y)));
+		if(out_shape.w > 0.0)
+			d = abs(d + out_shape.w * 0.5) - out_shape.w * 0.5;
+
+		/* Faded over the pixel centered on the edge, the quad reaches a pixel past it. */
+		float coverage = clamp(0.5 - d / max(length(vec2(dFdx(d), dFdy(d))), 1e-6), 0.0, 1.0);
+		if(coverage <= 0.0)
+			discard;
+		frag_color = vec4(out_color.rgb, out_color.a * coverage);
+		return;
+	}
+
 	if(out_tex_index != -1.0){
 		if(out_color == vec4(-1, -1, -1, -1)){
 			frag_color = texture(textures[int(out_tex_index)], out_tex_coord);
@@ -7,9 +7,17 @@ layout(location = 2) in vec2 tex_coord;
 layout(location = 3, component = 0) in float tex_index;
 layout(location = 3, component = 1) in float material_id;
 
-layout(binding = 0) buffer GlobalMatrices 
+struct View
 {
     mat4 proj_view;
+    vec4 viewport;
+    vec4 depth_range;
+};
+
+/* One view per instance, see Ember::ShaderView. */
+layout(binding = 0) buffer GlobalMatrices 
+{
+    View views[];
 };
 
 out flat vec4 out_color;
@@ -19,7 +27,17 @@ out vec4 out_pos;
 
 void main()
 {
-	gl_Position = proj_view * vec4(pos, 1.0);
+	View view = views[gl_InstanceID];
+	vec4 clip_pos = view.proj_view * vec4(pos, 1.0);
+
+	/* Clipped to the view's own volume, then moved into its rectangle and depth slice. */
+	gl_ClipDistance[0] = clip_pos.w + clip_pos.x;
+	gl_ClipDistance[1] = clip_pos.w - clip_pos.x;
+	gl_ClipDistance[2] = clip_pos.w + clip_pos.y;
+	gl_ClipDistance[3] = clip_pos.w - clip_pos.y;
+	clip_pos.xy = clip_pos.xy * view.viewport.zw + (2.0 * view.viewport.xy + view.viewport.zw - 1.0) * clip_pos.w;
+	clip_pos.z = clip_pos.z * (view.depth_range.y - view.depth_range.x) + (view.depth_range.x + view.depth_range.y - 1.0) * clip_pos.w;
+	gl_Position = clip_pos;
 	out_color = color;
 	out_tex_coord = tex_coord;
 	out_tex_index = tex_index;
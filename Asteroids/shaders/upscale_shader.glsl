@@ -0,0 +1,42 @@
+#shader vertex
+#version 450 core
+
+out vec2 out_tex_coord;
+
+void main()
+{
+	vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	out_tex_coord = corner;
+	gl_Position = vec4(corner * 2.0 - 1.0, 0.999, 1.0);
+}
+
+#shader fragment
+#version 450 core
+
+out vec4 frag_color;
+
+in vec2 out_tex_coord;
+
+uniform sampler2D source;
+/* xy is the rendered part of the source, z the sharpening strength, 0 for plain bilinear. */
+uniform vec3 params;
+
+vec3 Sample(vec2 uv, vec2 texel)
+{
+	return texture(source, clamp(uv, texel * 0.5, params.xy - texel * 0.5)).rgb;
+}
+
+void main()
+{
+	vec2 texel = 1.0 / vec2(textureSize(source, 0));
+	vec2 uv = out_tex_coord * params.xy;
+	vec3 color = Sample(uv, texel);
+
+	if (params.z > 0.0) {
+		vec3 neighbours = Sample(uv + vec2(texel.x, 0.0), texel) + Sample(uv - vec2(texel.x, 0.0), texel) +
+			Sample(uv + vec2(0.0, texel.y), texel) + Sample(uv - vec2(0.0, texel.y), texel);
+		color = clamp(color + (color - neighbours * 0.25) * params.z, 0.0, 1.0);
+	}
+
+	frag_color = vec4(color, 1.0);
+}
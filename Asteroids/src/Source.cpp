@@ -9,12 +9,31 @@
 #include "TextureAtlas.h"
 #include "Font.h"
 #include "RandomNumberGenerator.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
+#include "FastMath.h"
+#include "Physics2D.h"
+#include "Collision2D.h"
+#include "AABBTree.h"
+#include "Snapshot.h"
+#include "NetSession.h"
+#include "Clock.h"
+#include "RenderCapture.h"
+#include "DynamicResolution.h"
 
 #define SCREEN_WIDTH 1280
 #define SCREEN_HEIGHT 720
 
+/* Top right corner of the screen, as fractions of it. */
+constexpr glm::vec4 MINIMAP_VIEWPORT = { 0.78f, 0.76f, 0.2f, 0.2f };
+/* Bullets are drawn as circles filling the 5x5 square their position is the corner of. */
+constexpr float BULLET_RADIUS = 2.5f;
+
 #define MAX_SPEED 10.0f
 #define MIN_ASTEROID_SIZE 20
+#define MAX_CLIENTS 64
+#define SHIP_NET_ID 0x10000
+#define BULLET_NET_ID 0x20000
 
 struct WorldObject {
 	float x = 0.0f, y = 0.0f;
@@ -22,6 +41,25 @@ struct WorldObject {
 	float size = 0.0f;
 	float angle = 0.0f;
 	bool alive = true;
+	Ember::BodyHandle body;
+	uint32_t proxy = Ember::AABB_TREE_NULL;
+};
+
+using ObjectList = std::vector<WorldObject, Ember::TrackedAllocator<WorldObject, Ember::MemoryTag::Game>>;
+
+enum class NetRole { Offline, Host, Client };
+enum class NetKind : uint8_t { Asteroid, Ship, Bullet };
+enum class GameMessage : uint8_t { Welcome, ShipState, Fire };
+
+/* Both ends run the same build, so messages go over the wire as raw structs. */
+struct ShipMessage {
+	GameMessage type;
+	float x, y, angle;
+};
+
+struct WelcomeMessage {
+	GameMessage type;
+	uint32_t slot;
 };
 
 class Sandbox : public Ember::Application {
@@ -30,6 +68,8 @@ public:
 		Ember::RendererCommand::Init();
 		Ember::Renderer::Init();
 		Ember::RendererCommand::SetViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+		dynamic_resolution.Init(SCREEN_WIDTH, SCREEN_HEIGHT);
+		dynamic_resolution.SetEnabled(use_dynamic_resolution);
 
 		cam = Ember::OrthoCamera(0, SCREEN_WIDTH, 0, SCREEN_HEIGHT);
 		cam.SetPosition({ 0, 0, 0 });
@@ -49,26 +89,138 @@ public:
 				noise * cosf(((float)i / (float)verts) * 6.28318f) });
 		}
 
+		/* Bodies rotate about their centroid, so the models are moved to match their collider. */
+		Ember::PolygonShape asteroid_shape = Ember::PolygonShape::FromPoints(asteroid_model.data(), (uint32_t)asteroid_model.size());
+		Ember::PolygonShape ship_shape = Ember::PolygonShape::FromPoints(ship_model.data(), (uint32_t)ship_model.size());
+		for (auto& point : asteroid_model)
+			point -= asteroid_shape.centroid;
+		for (auto& point : ship_model)
+			point -= ship_shape.centroid;
+
+		/* The game steps once per frame with velocities in pixels per frame, so the second based defaults are rescaled. */
+		Ember::PhysicsSettings settings;
+		settings.restitution_threshold = 0.02f;
+		settings.sleep_linear_velocity = 0.05f;
+		settings.sleep_angular_velocity = 0.001f;
+		settings.time_to_sleep = 30.0f;
+		physics.Init(settings);
+		asteroid_grid.Init(128.0f);
+
+		/* Everything update() reads or writes, so rewinding restores the exact simulation. */
+		history.Init();
+		physics.RegisterState(history);
+		history.RegisterVector(&asteroids, "Asteroids");
+		history.RegisterVector(&bullets, "Bullets");
+		history.Register(&player, "Player");
+		history.Register(&level, "Level");
+		history.Register(&tries, "Tries");
+		history.Register(&wave_spawned, "Wave spawned");
+		history.Register(&Ember::RandomGenerator::GetEngine(), "Random engine");
+		asteroid_shape_id = physics.AddShape(asteroid_shape);
+		ship_shape_id = physics.AddShape(ship_shape);
+
 		text_shader.Init("shaders/text_shader.glsl");
 		Ember::Renderer::InitRendererShader(&text_shader);
 		text.Init("font.ttf", 48);
 
-		reset();
+		if (net_role == NetRole::Host) {
+			if (!server.Init(net_port, MAX_CLIENTS, net_quantization()))
+				net_role = NetRole::Offline;
+			remote_ships.resize(MAX_CLIENTS);
+			for (auto& ship : remote_ships)
+				ship.alive = false;
+			net_grid.Init(128.0f);
+		}
+		else if (net_role == NetRole::Client) {
+			if (!client.Init(net_address, net_quantization(), Ember::Clock::Now()))
+				net_role = NetRole::Offline;
+		}
+
+		/* A client's world comes from the host, it only flies its own ship. */
+		if (net_role != NetRole::Client)
+			reset();
+	}
+
+	void SetDynamicResolution(bool enabled) {
+		use_dynamic_resolution = enabled;
+	}
+
+	void SetNetRole(NetRole role, const Ember::NetAddress& address, uint16_t port) {
+		net_role = role;
+		net_address = address;
+		net_port = port;
+	}
+
+	Ember::NetQuantization net_quantization() {
+		/* Wrapping lets objects hang over the screen edge by their size. */
+		Ember::NetQuantization quantization;
+		quantization.bounds = { -64.0f, -64.0f, SCREEN_WIDTH + 64.0f, SCREEN_HEIGHT + 64.0f };
+		quantization.max_radius = 64.0f;
+		return quantization;
 	}
 
 	void reset() {
+		for (auto& asteroid : asteroids)
+			destroy_asteroid(asteroid);
 		asteroids.clear();
 
-		for (int i = 0; i < level; i++) {
-			asteroids.push_back({ (float)Ember::RandomGenerator::GenRandom(0, SCREEN_WIDTH), (float)Ember::RandomGenerator::GenRandom(0, SCREEN_HEIGHT),
-				(float)Ember::RandomGenerator::GenRandom(-5.0f, 5.0f), (float)Ember::RandomGenerator::GenRandom(-5.0f, 5.0f), 50, 0 });
-		}
-
 		player.x = SCREEN_WIDTH / 2;
 		player.y = SCREEN_HEIGHT / 2;
+
+		if (!player.body.IsValid()) {
+			Ember::BodyDefinition definition;
+			definition.type = Ember::BodyType::Kinematic;
+			definition.shape = ship_shape_id;
+			definition.scale = player.size;
+			definition.sensor = true;
+			player.body = physics.CreateBody(definition);
+		}
+
+		wave_spawned = 0;
+		Ember::TaskScheduler::Start(spawn_wave(++wave));
+	}
+
+	/* Spawns the rest of the level's asteroids, until a newer wave task takes over. */
+	Ember::Task<> spawn_wave(uint32_t id) {
+		while (wave_spawned < level) {
+			if (wave_spawned > 0)
+				co_await Ember::WaitSeconds(0.3f);
+			if (id != wave)
+				co_return;
+
+			spawn_asteroid(asteroids, (float)Ember::RandomGenerator::GenRandom(0, SCREEN_WIDTH), (float)Ember::RandomGenerator::GenRandom(0, SCREEN_HEIGHT), 50);
+			wave_spawned++;
+		}
+	}
+
+	void spawn_asteroid(ObjectList& list, float x, float y, float size) {
+		WorldObject asteroid = { x, y, (float)Ember::RandomGenerator::GenRandom(-5.0f, 5.0f), (float)Ember::RandomGenerator::GenRandom(-5.0f, 5.0f), size, 0.0f };
+
+		Ember::BodyDefinition definition;
+		definition.shape = asteroid_shape_id;
+		definition.scale = size;
+		definition.position = { x, y };
+		definition.velocity = { asteroid.dx, asteroid.dy };
+		definition.angular_velocity = (float)Ember::RandomGenerator::GenRandom(-0.03f, 0.03f);
+		definition.friction = 0.0f;
+		definition.restitution = 1.0f;
+		asteroid.body = physics.CreateBody(definition);
+		asteroid.proxy = asteroid_tree.Insert({ x - size, y - size, x + size, y + size }, list.size());
+
+		list.push_back(asteroid);
+	}
+
+	void destroy_asteroid(WorldObject& asteroid) {
+		physics.DestroyBody(asteroid.body);
+		asteroid_tree.Remove(asteroid.proxy);
+		asteroid.proxy = Ember::AABB_TREE_NULL;
 	}
 
 	virtual ~Sandbox() {
+		server.Destroy();
+		client.Destroy();
+		physics.Destroy();
+		Ember::RenderCapture::End();
 		Ember::Renderer::Destroy();
 	}
 
@@ -82,22 +234,16 @@ public:
 		if (iy < 0) oy = SCREEN_HEIGHT - -(iy);
 	}
 
-	bool circle_collision(float cx, float cy, float radius, float x, float y) {
-		return sqrt((x - cx) * (x - cx) + (y - cy) * (y - cy)) < radius;
-	}
-
-	float to_rad(float angle) {
-		return (angle / 180) * 3.14159f;
-	}
-
-	void update() {
+	void update_player() {
 		if (Ember::KeyboardEvents::GetKeyboardState(Ember::EmberKeyCode::LeftArrow))
 			player.angle += 3.0f;
 		if (Ember::KeyboardEvents::GetKeyboardState(Ember::EmberKeyCode::RightArrow))
 			player.angle -= 3.0f;
 		if (Ember::KeyboardEvents::GetKeyboardState(Ember::EmberKeyCode::UpArrow)) {
-			player.dx += sinf((player.angle / 180.f) * 3.14159f);
-			player.dy += -cosf((player.angle / 180.f) * 3.14159f);
+			float sine, cosine;
+			Ember::FastMath::SinCosDegrees(player.angle, sine, cosine);
+			player.dx += sine;
+			player.dy += -cosine;
 
 			if (player.dx > MAX_SPEED)
 				player.dx = MAX_SPEED;
@@ -113,86 +259,318 @@ public:
 		player.y += player.dy;
 
 		wrap(player.x, player.y, player.x, player.y, player.size, player.size);
+	}
 
-		for (auto& asteroid : asteroids) {
-			asteroid.x += asteroid.dx;
-			asteroid.y += asteroid.dy;
+	void update() {
+		update_player();
+
+		Ember::RigidBody* ship = physics.GetBody(player.body);
+		ship->position = { player.x, player.y };
+		ship->angle = glm::radians(player.angle);
+
+		physics.Step(1.0f);
 
-			if (circle_collision(asteroid.x, asteroid.y, asteroid.size + player.size, player.x, player.y)) {
+		for (const Ember::ContactEvent& contact : physics.GetContactEvents()) {
+			if (contact.a.index == player.body.index || contact.b.index == player.body.index) {
 				reset();
 				tries++;
+				return;
 			}
-			wrap(asteroid.x, asteroid.y, asteroid.x, asteroid.y, asteroid.size, asteroid.size);
 		}
 
-		for (auto& bullet : bullets) {
-			bullet.x += bullet.dx * MAX_SPEED;
-			bullet.y += bullet.dy * MAX_SPEED;
+		for (auto& asteroid : asteroids) {
+			Ember::RigidBody* body = physics.GetBody(asteroid.body);
+			asteroid.dx = body->velocity.x;
+			asteroid.dy = body->velocity.y;
+			asteroid.angle = glm::degrees(body->angle);
+
+			wrap(body->position.x, body->position.y, asteroid.x, asteroid.y, asteroid.size, asteroid.size);
+			body->position = { asteroid.x, asteroid.y };
+		}
+
+		/* Bullets are swept over their whole move so they cannot skip past an asteroid, whatever their speed. */
+		Ember::ArenaVector<glm::vec3> circles(asteroids.size(), Ember::Memory::FrameAllocator<glm::vec3>());
+		asteroid_grid.Clear();
+		for (size_t i = 0; i < asteroids.size(); i++) {
+			const WorldObject& asteroid = asteroids[i];
+			circles[i] = { asteroid.x, asteroid.y, asteroid.size };
+			asteroid_grid.Insert((uint32_t)i, { asteroid.x - asteroid.size, asteroid.y - asteroid.size, asteroid.x + asteroid.size, asteroid.y + asteroid.size });
+		}
+		asteroid_grid.Build();
+
+		Ember::ArenaVector<Ember::SweepQuery> sweeps(bullets.size(), Ember::Memory::FrameAllocator<Ember::SweepQuery>());
+		Ember::ArenaVector<Ember::SweepHit> hits(bullets.size(), Ember::Memory::FrameAllocator<Ember::SweepHit>());
+		for (size_t i = 0; i < bullets.size(); i++) {
+			sweeps[i].start = { bullets[i].x, bullets[i].y };
+			sweeps[i].end = { bullets[i].x + bullets[i].dx * MAX_SPEED, bullets[i].y + bullets[i].dy * MAX_SPEED };
+		}
+		Ember::Collision2D::SweepCircles(sweeps.data(), (uint32_t)sweeps.size(), asteroid_grid, circles.data(), hits.data());
+
+		for (size_t i = 0; i < bullets.size(); i++) {
+			WorldObject& bullet = bullets[i];
+			bullet.x = sweeps[i].end.x;
+			bullet.y = sweeps[i].end.y;
 
 			if (bullet.x < 0 || bullet.y < 0 || bullet.x > SCREEN_WIDTH || bullet.y > SCREEN_HEIGHT)
 				bullet.alive = false;
 
-			for (auto& asteroid : asteroids) {
-				if (circle_collision(asteroid.x, asteroid.y, asteroid.size, bullet.x, bullet.y)) {
-					asteroid.alive = false;
-					bullet.alive = false;
-					if (asteroid.size > MIN_ASTEROID_SIZE) {
-						asteroids.push_back({ asteroid.x, asteroid.y, (float)Ember::RandomGenerator::GenRandom(-5.0f, 5.0f), (float)Ember::RandomGenerator::GenRandom(-5.0f, 5.0f),
-							(float)((int)asteroid.size >> 1), 0.0f });
-						asteroids.push_back({ asteroids.back().x, asteroids.back().y, (float)Ember::RandomGenerator::GenRandom(-5.0f, 5.0f), (float)Ember::RandomGenerator::GenRandom(-5.0f, 5.0f),
-							asteroids.back().size, 0.0f });
-					}
-				}
+			if (!hits[i].IsHit() || !asteroids[hits[i].id].alive)
+				continue;
+
+			WorldObject& asteroid = asteroids[hits[i].id];
+			asteroid.alive = false;
+			bullet.alive = false;
+			destroy_asteroid(asteroid);
+
+			/* Children go to a separate list, pushing into asteroids here would invalidate the loop. */
+			if (asteroid.size > MIN_ASTEROID_SIZE) {
+				float size = (float)((int)asteroid.size >> 1);
+				spawn_asteroid(fragments, asteroid.x - size, asteroid.y, size);
+				spawn_asteroid(fragments, asteroid.x + size, asteroid.y, size);
 			}
 		}
 
 		clean_up_objs(bullets);
 		clean_up_objs(asteroids);
+		asteroids.insert(asteroids.end(), fragments.begin(), fragments.end());
+		fragments.clear();
+
+		/* Tree leaves map back to asteroids by index, refreshed after the list was compacted. */
+		for (size_t i = 0; i < asteroids.size(); i++) {
+			const WorldObject& asteroid = asteroids[i];
+			asteroid_tree.Move(asteroid.proxy, { asteroid.x - asteroid.size, asteroid.y - asteroid.size, asteroid.x + asteroid.size, asteroid.y + asteroid.size }, { asteroid.dx, asteroid.dy });
+			asteroid_tree.SetUserData(asteroid.proxy, i);
+		}
 
-		if (asteroids.size() == 0) {
+		if (asteroids.size() == 0 && wave_spawned >= level) {
 			level++;
 			reset();
 		}
 	}
 
+	/*
+	* The host simulates for everyone: clients send their ship every frame and their shots reliably, and get back the
+	* objects around their ship. Remote ships only fly and shoot, collisions are checked for the host's ship alone.
+	*/
+	void host_network() {
+		uint64_t now = Ember::Clock::Now();
+		server.Receive(now);
+
+		for (uint32_t slot : server.GetConnected()) {
+			WelcomeMessage welcome = { GameMessage::Welcome, slot };
+			server.Send(slot, Ember::NetChannel::Reliable, &welcome, sizeof(welcome));
+			remote_ships[slot] = player;
+			remote_ships[slot].alive = true;
+		}
+		for (uint32_t slot : server.GetDisconnected())
+			remote_ships[slot].alive = false;
+
+		uint32_t slot;
+		while (server.PopMessage(slot, net_message)) {
+			if (net_message.size() != sizeof(ShipMessage))
+				continue;
+
+			ShipMessage ship;
+			memcpy(&ship, net_message.data(), sizeof(ship));
+			if (ship.type == GameMessage::ShipState) {
+				remote_ships[slot].x = ship.x;
+				remote_ships[slot].y = ship.y;
+				remote_ships[slot].angle = ship.angle;
+			}
+			else if (ship.type == GameMessage::Fire) {
+				float sine, cosine;
+				Ember::FastMath::SinCosDegrees(ship.angle, sine, cosine);
+				bullets.push_back({ ship.x, ship.y, sine, -cosine, 1, ship.angle });
+			}
+		}
+
+		/* Bullet ids are list positions, they shift as bullets die and only cost some delta compression. */
+		net_entities.clear();
+		for (const auto& asteroid : asteroids)
+			net_entities.push_back({ asteroid.body.index, { asteroid.x, asteroid.y }, glm::radians(asteroid.angle), asteroid.size, (uint8_t)NetKind::Asteroid });
+		net_entities.push_back({ SHIP_NET_ID + MAX_CLIENTS, { player.x, player.y }, glm::radians(player.angle), player.size, (uint8_t)NetKind::Ship });
+		for (uint32_t i = 0; i < MAX_CLIENTS; i++)
+			if (remote_ships[i].alive)
+				net_entities.push_back({ SHIP_NET_ID + i, { remote_ships[i].x, remote_ships[i].y }, glm::radians(remote_ships[i].angle), player.size, (uint8_t)NetKind::Ship });
+		for (uint32_t i = 0; i < (uint32_t)bullets.size(); i++)
+			net_entities.push_back({ BULLET_NET_ID + i, { bullets[i].x, bullets[i].y }, 0.0f, 1.0f, (uint8_t)NetKind::Bullet });
+
+		net_grid.Clear();
+		for (uint32_t i = 0; i < (uint32_t)net_entities.size(); i++) {
+			const Ember::NetEntityState& entity = net_entities[i];
+			net_grid.Insert(i, { entity.position.x - entity.radius, entity.position.y - entity.radius, entity.position.x + entity.radius, entity.position.y + entity.radius });
+		}
+		net_grid.Build();
+
+		/* Interest is a screen sized area around each ship; this world is no bigger than the screen, larger ones gain more. */
+		for (uint32_t i = 0; i < MAX_CLIENTS; i++)
+			if (remote_ships[i].alive)
+				server.SetInterest(i, { remote_ships[i].x - SCREEN_WIDTH / 2, remote_ships[i].y - SCREEN_HEIGHT / 2, remote_ships[i].x + SCREEN_WIDTH / 2, remote_ships[i].y + SCREEN_HEIGHT / 2 });
+
+		server.SendSnapshots(net_entities.data(), (uint32_t)net_entities.size(), net_grid);
+		server.Flush(now);
+	}
+
+	/* Clients fly their own ship and show the host's world as last received. */
+	void client_update() {
+		update_player();
+
+		uint64_t now = Ember::Clock::Now();
+		client.Receive(now);
+		while (client.PopMessage(net_message)) {
+			if (net_message.size() == sizeof(WelcomeMessage) && net_message[0] == (uint8_t)GameMessage::Welcome) {
+				WelcomeMessage welcome;
+				memcpy(&welcome, net_message.data(), sizeof(welcome));
+				net_slot = welcome.slot;
+			}
+		}
+
+		ShipMessage ship = { GameMessage::ShipState, player.x, player.y, player.angle };
+		client.Send(Ember::NetChannel::Unreliable, &ship, sizeof(ship));
+		client.Flush(now);
+	}
+
+	void render_remote() {
+		for (const Ember::NetEntityState& entity : client.GetEntities()) {
+			float sine, cosine;
+			Ember::FastMath::SinCos(entity.angle, sine, cosine);
+			if (entity.kind == (uint8_t)NetKind::Asteroid)
+				draw_wireframe(asteroid_model, entity.position.x, entity.position.y, sine, cosine, entity.radius, { 1, 1, 1, 1 }, 3);
+			else if (entity.kind == (uint8_t)NetKind::Ship && entity.id != SHIP_NET_ID + net_slot)
+				draw_wireframe(ship_model, entity.position.x, entity.position.y, sine, cosine, entity.radius, { 1, 0.6f, 0.2f, 1 });
+			else if (entity.kind == (uint8_t)NetKind::Bullet)
+				Ember::Renderer::DrawCircle({ entity.position.x + BULLET_RADIUS, entity.position.y + BULLET_RADIUS, 0 }, BULLET_RADIUS, { 1, 1, 1, 1 });
+		}
+	}
+
 	void render() {
+		dynamic_resolution.BeginScene();
 		Ember::RendererCommand::Clear();
 		Ember::RendererCommand::SetClearColor(0.129f, 0.309f, 0.431f, 1.0f);
 
-		Ember::Renderer::BeginScene(cam, Ember::RenderFlags::TopLeftCornerPos);
+		/* The field is the screen, the minimap sees all of it through a second view of the same batches. */
+		Ember::RenderView views[2];
+		views[0].camera = cam;
+		views[1].camera = cam;
+		views[1].viewport = MINIMAP_VIEWPORT;
+		Ember::Renderer::BeginScene(views, show_minimap ? 2 : 1, Ember::RenderFlags::TopLeftCornerPos);
 		Ember::Renderer::SetShaderToDefualt();
 
-		draw_wireframe(ship_model, player.x, player.y, player.angle, player.size, { 1, 1, 1, 1 });
+		float ship_sine, ship_cosine;
+		Ember::FastMath::SinCosDegrees(player.angle, ship_sine, ship_cosine);
+		draw_wireframe(ship_model, player.x, player.y, ship_sine, ship_cosine, player.size, { 1, 1, 1, 1 });
 
-		for (auto& asteroid : asteroids) 
-			draw_wireframe(asteroid_model, asteroid.x, asteroid.y, asteroid.angle, asteroid.size, { 1, 1, 1, 1 }, 3);
+		for (const auto& ship : remote_ships) {
+			if (!ship.alive)
+				continue;
+			Ember::FastMath::SinCosDegrees(ship.angle, ship_sine, ship_cosine);
+			draw_wireframe(ship_model, ship.x, ship.y, ship_sine, ship_cosine, player.size, { 1, 0.6f, 0.2f, 1 });
+		}
+
+		if (net_role == NetRole::Client)
+			render_remote();
+
+		/* The asteroid model's noise goes up to 1.2 times its size, plus the line width. */
+		Ember::ArenaVector<glm::vec4> bounds(asteroids.size(), Ember::Memory::FrameAllocator<glm::vec4>());
+		Ember::ArenaVector<uint32_t> visible(asteroids.size(), Ember::Memory::FrameAllocator<uint32_t>());
+		for (size_t i = 0; i < asteroids.size(); i++) {
+			float extent = asteroids[i].size * 1.2f + 3;
+			bounds[i] = { asteroids[i].x - extent, asteroids[i].y - extent, asteroids[i].x + extent, asteroids[i].y + extent };
+		}
+
+		uint32_t visible_count = Ember::Renderer::CullBounds(cam, bounds.data(), (uint32_t)bounds.size(), visible.data());
+
+		/* One batched sincos for every visible asteroid instead of libm calls per vertex. */
+		Ember::ArenaVector<float> angles(visible_count, Ember::Memory::FrameAllocator<float>());
+		Ember::ArenaVector<float> sines(visible_count, Ember::Memory::FrameAllocator<float>());
+		Ember::ArenaVector<float> cosines(visible_count, Ember::Memory::FrameAllocator<float>());
+		for (uint32_t i = 0; i < visible_count; i++)
+			angles[i] = asteroids[visible[i]].angle;
+		Ember::FastMath::SinCosDegrees(angles.data(), sines.data(), cosines.data(), visible_count);
+
+		for (uint32_t i = 0; i < visible_count; i++) {
+			const WorldObject& asteroid = asteroids[visible[i]];
+			draw_wireframe(asteroid_model, asteroid.x, asteroid.y, sines[i], cosines[i], asteroid.size, { 1, 1, 1, 1 }, 3);
+		}
 
 		for (auto& bullet : bullets) {
-			Ember::Renderer::DrawQuad({ bullet.x, bullet.y, 0 }, { 5, 5 }, { 1, 1, 1, 1 });
+			Ember::Renderer::DrawCircle({ bullet.x + BULLET_RADIUS, bullet.y + BULLET_RADIUS, 0 }, BULLET_RADIUS, { 1, 1, 1, 1 });
 		}
 
 		Ember::Renderer::EndScene();
+		dynamic_resolution.EndScene();
+
+		/* The HUD stays at native resolution. */
+		if (show_minimap) {
+			glm::vec2 min = { MINIMAP_VIEWPORT.x * SCREEN_WIDTH, MINIMAP_VIEWPORT.y * SCREEN_HEIGHT };
+			glm::vec2 max = min + glm::vec2(MINIMAP_VIEWPORT.z * SCREEN_WIDTH, MINIMAP_VIEWPORT.w * SCREEN_HEIGHT);
+			Ember::Renderer::BeginScene(cam, Ember::RenderFlags::TopLeftCornerPos);
+			Ember::Renderer::DrawLine(min, { max.x, min.y }, { 1, 1, 0, 1 });
+			Ember::Renderer::DrawLine({ max.x, min.y }, max, { 1, 1, 0, 1 });
+			Ember::Renderer::DrawLine(max, { min.x, max.y }, { 1, 1, 0, 1 });
+			Ember::Renderer::DrawLine({ min.x, max.y }, min, { 1, 1, 0, 1 });
+			Ember::Renderer::EndScene();
+		}
 
 		Ember::Renderer::BeginScene(cam, Ember::RenderFlags::TopLeftCornerPos);
 		Ember::Renderer::SetShader(&text_shader);
 		Ember::Renderer::RenderText(&text, std::to_string(level), { 0, 600 }, { 2, 2 }, { 1, 1, 1, 1 });
 		Ember::Renderer::RenderText(&text, std::to_string(tries), { 0, 400 }, { 2, 2 }, { 1, 1, 1, 1 });
+		if (show_profiler)
+			Ember::Profiler::DrawOverlay(&text, { 0, SCREEN_HEIGHT - 20 }, { 0.35f, 0.35f }, { 1, 1, 0, 1 });
 
 		Ember::Renderer::EndScene();
 	}
 
 	void OnUserUpdate(float delta) {
-		if (!paused) update();
+		if (net_role == NetRole::Client)
+			client_update();
+		else if (Ember::KeyboardEvents::GetKeyboardState(Ember::EmberKeyCode::Backspace) && net_role == NetRole::Offline)
+			rewind();
+		else if (!game_clock.IsPaused()) {
+			history.Capture(frame);
+			update();
+			frame++;
+		}
+
+		if (net_role == NetRole::Host)
+			host_network();
 
 		render();
 
 		window->Update();
 	}
 
-	void clean_up_objs(std::vector<WorldObject>& world_objs) {
-		for (int i = 0; i < world_objs.size(); i++)
-			if (!world_objs[i].alive)
-				world_objs.erase(world_objs.begin() + i);
+	/*
+	* Steps back one frame per call while history lasts. The wave task is not in the history: the running one is
+	* cancelled and, when the restored frame was mid wave, a new one spawns the rest.
+	*/
+	void rewind() {
+		if (frame == 0 || !history.Restore(frame - 1))
+			return;
+		frame--;
+
+		wave++;
+		if (wave_spawned < level)
+			Ember::TaskScheduler::Start(spawn_wave(wave));
+
+		Ember::ArenaVector<glm::vec4> bounds(asteroids.size(), Ember::Memory::FrameAllocator<glm::vec4>());
+		Ember::ArenaVector<uint64_t> indices(asteroids.size(), Ember::Memory::FrameAllocator<uint64_t>());
+		Ember::ArenaVector<uint32_t> proxies(asteroids.size(), Ember::Memory::FrameAllocator<uint32_t>());
+		for (size_t i = 0; i < asteroids.size(); i++) {
+			const WorldObject& asteroid = asteroids[i];
+			bounds[i] = { asteroid.x - asteroid.size, asteroid.y - asteroid.size, asteroid.x + asteroid.size, asteroid.y + asteroid.size };
+			indices[i] = i;
+		}
+
+		asteroid_tree.Clear();
+		asteroid_tree.InsertBatch(bounds.data(), indices.data(), (uint32_t)asteroids.size(), proxies.data());
+		for (size_t i = 0; i < asteroids.size(); i++)
+			asteroids[i].proxy = proxies[i];
+	}
+
+	void clean_up_objs(ObjectList& world_objs) {
+		world_objs.erase(std::remove_if(world_objs.begin(), world_objs.end(), [](const WorldObject& object) { return !object.alive; }), world_objs.end());
 	}
 
 	void keyboard_event(Ember::KeyboardEvents& keyboard) {
@@ -201,7 +579,15 @@ public:
 			player.y = Ember::RandomGenerator::GenRandom(0, SCREEN_HEIGHT);
 		}
 		else if (keyboard.scancode == Ember::EmberKeyCode::Space && keyboard.pressed) {
-			bullets.push_back({ player.x, player.y, sinf((player.angle / 180.f) * 3.14159f), -cosf((player.angle / 180.f) * 3.14159f), 1, player.angle });
+			if (net_role == NetRole::Client) {
+				ShipMessage fire = { GameMessage::Fire, player.x, player.y, player.angle };
+				client.Send(Ember::NetChannel::Reliable, &fire, sizeof(fire));
+				return;
+			}
+
+			float sine, cosine;
+			Ember::FastMath::SinCosDegrees(player.angle, sine, cosine);
+			bullets.push_back({ player.x, player.y, sine, -cosine, 1, player.angle });
 		}
 		else if (keyboard.scancode == Ember::EmberKeyCode::LeftAlt && keyboard.pressed) {
 			EMBER_LOG("-------------------new entry-------------------");
@@ -210,27 +596,66 @@ public:
 			}
 		}
 		else if (keyboard.scancode == Ember::EmberKeyCode::P && keyboard.pressed) {
-			paused = !paused;
+			game_clock.SetPaused(!game_clock.IsPaused());
+		}
+		else if (keyboard.scancode == Ember::EmberKeyCode::F1 && keyboard.pressed) {
+			show_profiler = !show_profiler;
+		}
+		else if (keyboard.scancode == Ember::EmberKeyCode::F2 && keyboard.pressed) {
+			Ember::MemoryTracker::DumpJson("memory.json");
+		}
+		else if (keyboard.scancode == Ember::EmberKeyCode::F3 && keyboard.pressed) {
+			Ember::WindowProperties* properties = window->Properties();
+			properties->swap_interval = (properties->swap_interval == Ember::SwapInterval::VSync) ? Ember::SwapInterval::Adaptive :
+				(properties->swap_interval == Ember::SwapInterval::Adaptive) ? Ember::SwapInterval::Off : Ember::SwapInterval::VSync;
+		}
+		else if (keyboard.scancode == Ember::EmberKeyCode::F4 && keyboard.pressed) {
+			window->Properties()->max_frame_rate = (window->Properties()->max_frame_rate > 0.0f) ? 0.0f : 60.0f;
+		}
+		else if (keyboard.scancode == Ember::EmberKeyCode::F5 && keyboard.pressed) {
+			/* Replay/Replay.exe asteroids.trace benchmarks the captured frames. */
+			capturing = !capturing;
+			if (capturing)
+				Ember::RenderCapture::Begin("asteroids.trace");
+			else
+				Ember::RenderCapture::End();
+		}
+		else if (keyboard.scancode == Ember::EmberKeyCode::F6 && keyboard.pressed) {
+			dynamic_resolution.SetEnabled(!dynamic_resolution.IsEnabled());
+		}
+		else if (keyboard.scancode == Ember::EmberKeyCode::F7 && keyboard.pressed) {
+			dynamic_resolution.SetFilter((dynamic_resolution.GetFilter() == Ember::UpscaleFilter::Bilinear) ? Ember::UpscaleFilter::Sharpen : Ember::UpscaleFilter::Bilinear);
+		}
+		else if (keyboard.scancode == Ember::EmberKeyCode::F8 && keyboard.pressed) {
+			show_minimap = !show_minimap;
 		}
 	}
 
-	void draw_wireframe(const std::vector<glm::vec2>& coords, float x, float y, float r, float scale, const glm::vec4& color, float width = 1.0f) {
-		std::vector<glm::vec2> transformed;
-		transformed.resize(coords.size());
+	void mouse_event(Ember::MouseButtonEvents& mouse) {
+		if (!mouse.down || mouse.button_id != Ember::ButtonIds::LeftMouseButton)
+			return;
 
-		for (int i = 0; i < (int) transformed.size(); i++) {
-			transformed[i].x = (coords[i].x * cosf(to_rad(r))) - (coords[i].y * sinf(to_rad(r)));
-			transformed[i].y = (coords[i].x * sinf(to_rad(r))) + (coords[i].y * cosf(to_rad(r)));
-		}
+		/* Window coordinates grow downwards, the camera's upwards. */
+		glm::ivec2 mouse_position = Ember::Events::MousePosition();
+		glm::vec2 position = { (float)mouse_position.x, (float)(SCREEN_HEIGHT - mouse_position.y) };
 
-		for (int i = 0; i < (int) transformed.size(); i++) {
-			transformed[i].x = transformed[i].x * scale;
-			transformed[i].y = transformed[i].y * scale;
+		uint32_t picked[16];
+		uint32_t count = std::min(asteroid_tree.QueryPoint(position, picked, 16), 16u);
+		for (uint32_t i = 0; i < count; i++) {
+			const WorldObject& asteroid = asteroids[asteroid_tree.GetUserData(picked[i])];
+			if (glm::distance(position, glm::vec2(asteroid.x, asteroid.y)) <= asteroid.size)
+				EMBER_LOG("picked asteroid at %f, %f, dir: %f, %f, size: %f", asteroid.x, asteroid.y, asteroid.dx, asteroid.dy, asteroid.size);
 		}
+	}
+
+	void draw_wireframe(const std::vector<glm::vec2>& coords, float x, float y, float sine, float cosine, float scale, const glm::vec4& color, float width = 1.0f) {
+		Ember::ArenaVector<glm::vec2> transformed(coords.size(), Ember::Memory::FrameAllocator<glm::vec2>());
 
+		float scaled_sine = sine * scale;
+		float scaled_cosine = cosine * scale;
 		for (int i = 0; i < (int) transformed.size(); i++) {
-			transformed[i].x += x;
-			transformed[i].y += y;
+			transformed[i].x = (coords[i].x * scaled_cosine) - (coords[i].y * scaled_sine) + x;
+			transformed[i].y = (coords[i].x * scaled_sine) + (coords[i].y * scaled_cosine) + y;
 		}
 
 		for (int i = 0; i < (int) transformed.size() + 1; i++) {
@@ -244,26 +669,81 @@ public:
 		Ember::EventDispatcher dispatch(&event);
 
 		dispatch.Dispatch<Ember::KeyboardEvents>(EMBER_BIND_FUNC(keyboard_event));
+		dispatch.Dispatch<Ember::MouseButtonEvents>(EMBER_BIND_FUNC(mouse_event));
 	}
 private:
 	Ember::OrthoCamera cam;
+	Ember::DynamicResolution dynamic_resolution;
+	bool use_dynamic_resolution = false;
+	bool show_minimap = false;
 
 	Ember::Font text;
 	Ember::Shader text_shader;
-	std::vector<WorldObject> asteroids;
-	std::vector<WorldObject> bullets;
+	ObjectList asteroids;
+	ObjectList bullets;
+	ObjectList fragments;
 	WorldObject player;
 	std::vector<glm::vec2> ship_model;
 	std::vector<glm::vec2> asteroid_model;
 
+	Ember::PhysicsWorld physics;
+	Ember::SpatialGrid asteroid_grid;
+	Ember::AABBTree asteroid_tree;
+	Ember::SnapshotHistory history;
+	uint64_t frame = 0;
+
+	NetRole net_role = NetRole::Offline;
+	Ember::NetAddress net_address;
+	uint16_t net_port = Ember::NET_DEFAULT_PORT;
+	Ember::NetServer server;
+	Ember::NetClient client;
+	Ember::SpatialGrid net_grid;
+	ObjectList remote_ships;
+	std::vector<Ember::NetEntityState> net_entities;
+	std::vector<uint8_t> net_message;
+	uint32_t net_slot = UINT32_MAX;
+	uint32_t asteroid_shape_id = 0;
+	uint32_t ship_shape_id = 0;
+
 	uint32_t level = 1;
 	uint32_t tries = 0;
-	bool paused = false;
+	/* Id of the newest wave task, older ones stop at their next spawn. */
+	uint32_t wave = 0;
+	/* Asteroids the current level's wave has spawned so far. */
+	uint32_t wave_spawned = 0;
+	bool show_profiler = false;
+	bool capturing = false;
 };
 
 int main(int argc, char** argv) {
+	Ember::AppFlags flags = Ember::AppFlags::NONE;
+	NetRole role = NetRole::Offline;
+	Ember::NetAddress address;
+	uint16_t port = Ember::NET_DEFAULT_PORT;
+	bool dynamic_resolution = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--render-thread") == 0)
+			flags = Ember::AppFlags::RENDER_THREAD;
+		else if (strcmp(argv[i], "--dynamic-resolution") == 0)
+			dynamic_resolution = true;
+		else if (strcmp(argv[i], "--host") == 0) {
+			role = NetRole::Host;
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				port = (uint16_t)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc) {
+			if (Ember::Network::Init()) {
+				if (Ember::NetAddress::Parse(argv[++i], Ember::NET_DEFAULT_PORT, address))
+					role = NetRole::Client;
+				Ember::Network::Destroy();
+			}
+		}
+	}
+
 	Sandbox sandbox;
-	sandbox.Initialize("Asteroids", SCREEN_WIDTH, SCREEN_HEIGHT);
+	sandbox.SetNetRole(role, address, port);
+	sandbox.SetDynamicResolution(dynamic_resolution);
+	sandbox.Initialize("Asteroids", SCREEN_WIDTH, SCREEN_HEIGHT, flags);
 
 	sandbox.Run();
 
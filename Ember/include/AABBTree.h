@@ -0,0 +1,108 @@
+#ifndef AABB_TREE_H
+#define AABB_TREE_H
+
+#include <glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Ember {
+	constexpr uint32_t AABB_TREE_NULL = UINT32_MAX;
+	/* Traversal depth the queries handle without allocating. */
+	constexpr uint32_t AABB_TREE_STACK_SIZE = 256;
+	constexpr float AABB_TREE_DEFAULT_MARGIN = 4.0f;
+
+	struct TreeRayHit {
+		uint32_t proxy;
+		/* Fraction along the ray where it enters the proxy's bounds. */
+		float fraction;
+	};
+
+	struct TreeNearest {
+		uint32_t proxy;
+		float distance_squared;
+	};
+
+	/*
+	* Dynamic bounding volume tree over axis aligned boxes packed as (min x, min y, max x, max y). Leaves store the
+	* given bounds grown by a margin, so objects that move a little are only refit (Move returns early) and are
+	* reinserted once they leave their grown box. Insertion picks the sibling with the cheapest perimeter increase and
+	* rotations keep the tree balanced by height.
+	* Proxies are node indices and stay valid until removed. The overlap queries write into caller buffers and return
+	* how many results were found, which may exceed the capacity given; only the first capacity are written.
+	*/
+	class AABBTree {
+	public:
+		void Init(float margin = AABB_TREE_DEFAULT_MARGIN);
+		void Clear();
+
+		uint32_t Insert(const glm::vec4& bounds, uint64_t user_data = 0);
+		void Remove(uint32_t proxy);
+		/* Returns true when the proxy had to be reinserted. displacement extends the grown box along the motion. */
+		bool Move(uint32_t proxy, const glm::vec4& bounds, const glm::vec2& displacement = { 0.0f, 0.0f });
+
+		/* Builds the new leaves into a balanced subtree first and links it in as one node. */
+		void InsertBatch(const glm::vec4* bounds, const uint64_t* user_data, uint32_t count, uint32_t* proxies);
+		void RemoveBatch(const uint32_t* proxies, uint32_t count);
+
+		uint32_t QueryPoint(const glm::vec2& point, uint32_t* results, uint32_t capacity) const;
+		uint32_t QueryBounds(const glm::vec4& bounds, uint32_t* results, uint32_t capacity) const;
+		uint32_t QueryCircle(const glm::vec2& center, float radius, uint32_t* results, uint32_t capacity) const;
+		/* The capacity closest proxies whose bounds the segment crosses, sorted by fraction; returns how many were written. */
+		uint32_t RayCast(const glm::vec2& start, const glm::vec2& end, TreeRayHit* results, uint32_t capacity) const;
+		/* Up to count proxies closest to point by distance to their bounds, closest first; returns how many were written. */
+		uint32_t QueryNearest(const glm::vec2& point, uint32_t count, TreeNearest* results) const;
+
+		uint64_t GetUserData(uint32_t proxy) const { return nodes[proxy].user_data; }
+		void SetUserData(uint32_t proxy, uint64_t user_data) { nodes[proxy].user_data = user_data; }
+		const glm::vec4& GetBounds(uint32_t proxy) const { return nodes[proxy].tight; }
+		const glm::vec4& GetFatBounds(uint32_t proxy) const { return nodes[proxy].bounds; }
+		uint32_t GetProxyCount() const { return proxy_count; }
+		uint32_t GetHeight() const { return (root == AABB_TREE_NULL) ? 0 : nodes[root].height; }
+	private:
+		struct Node {
+			glm::vec4 bounds;
+			/* Leaves only: the bounds as given, before the margin. */
+			glm::vec4 tight;
+			uint64_t user_data;
+			/* Next free node while on the free list. */
+			uint32_t parent;
+			uint32_t child1;
+			uint32_t child2;
+			int32_t height;
+
+			bool IsLeaf() const { return child1 == AABB_TREE_NULL; }
+		};
+
+		uint32_t AllocateNode();
+		void FreeNode(uint32_t node);
+
+		uint32_t CreateLeaf(const glm::vec4& bounds, uint64_t user_data);
+		uint32_t BuildSubtree(uint32_t* leaves, uint32_t count);
+		void InsertLeaf(uint32_t leaf);
+		void RemoveLeaf(uint32_t leaf);
+		void Refit(uint32_t node);
+		uint32_t Balance(uint32_t node);
+
+		template<typename Test>
+		uint32_t Query(Test&& test, uint32_t* results, uint32_t capacity) const;
+
+		static glm::vec4 Combine(const glm::vec4& a, const glm::vec4& b) {
+			return { glm::min(a.x, b.x), glm::min(a.y, b.y), glm::max(a.z, b.z), glm::max(a.w, b.w) };
+		}
+		static float Perimeter(const glm::vec4& bounds) { return 2.0f * ((bounds.z - bounds.x) + (bounds.w - bounds.y)); }
+		static bool Contains(const glm::vec4& outer, const glm::vec4& inner) {
+			return outer.x <= inner.x && outer.y <= inner.y && inner.z <= outer.z && inner.w <= outer.w;
+		}
+		static bool Overlaps(const glm::vec4& a, const glm::vec4& b) {
+			return a.x <= b.z && b.x <= a.z && a.y <= b.w && b.y <= a.w;
+		}
+
+		std::vector<Node> nodes;
+		uint32_t root = AABB_TREE_NULL;
+		uint32_t free_list = AABB_TREE_NULL;
+		uint32_t proxy_count = 0;
+		float margin = AABB_TREE_DEFAULT_MARGIN;
+	};
+}
+
+#endif // !AABB_TREE_H
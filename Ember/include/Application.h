@@ -7,12 +7,21 @@
 #include "EventHandler.h"
 #include "Window.h"
 #include "Logger.h"
+#include "Memory.h"
+#include "MemoryTracker.h"
+#include "RenderThread.h"
+#include "Clock.h"
+#include "TimerWheel.h"
+#include "JobSystem.h"
+#include "Coroutine.h"
+#include "Layer.h"
 
 namespace Ember {
 	enum AppFlags {
 		NONE = 0x01,
 		FULL_SCREEN = 0x02,
-		OPENGL_CUSTOM_VERSION = 0x04
+		OPENGL_CUSTOM_VERSION = 0x04,
+		RENDER_THREAD = 0x08
 	};
 
 	class Application {
@@ -28,13 +37,34 @@ namespace Ember {
 		virtual void OnCreate() { }
 
 		Window* GetWindow() { return window; }
+
+		/*
+		* Layers receive events from the top of the stack down until one marks the event inactive, and are updated
+		* bottom up before OnUserUpdate.
+		*/
+		void PushLayer(Layer* layer);
+		void PushOverlay(Layer* overlay);
+		void PopLayer(Layer* layer);
+		void PopOverlay(Layer* overlay);
+
+		/*
+		* Game time passed to OnUserUpdate. Pausing or scaling it also pauses or scales the timers.
+		*/
+		GameClock& GetGameClock() { return game_clock; }
+		TimerWheel& GetTimers() { return timers; }
 	protected:
 		Window* window = nullptr;
 		EventHandler* event_handler = nullptr;
 		WindowProperties* properties = nullptr;
+		LayerStack* layer_stack = nullptr;
 
 		uint32_t opengl_minor_version = 0;
 		uint32_t opengl_major_version = 0;
+
+		AppFlags app_flags = AppFlags::NONE;
+
+		GameClock game_clock;
+		TimerWheel timers;
 	private:
 		void OnClose(const QuitEvent& event);
 		void OnResize(const ResizeEvent& event);
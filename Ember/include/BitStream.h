@@ -0,0 +1,73 @@
+#ifndef BIT_STREAM_H
+#define BIT_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Ember {
+	/*
+	* Packs values into a byte buffer with bit granularity, least significant bit first. Floats are written quantized to
+	* a range and a bit count. Writes past the capacity are dropped and flag the stream as overflowed, so a packet is
+	* checked once at the end instead of after every value.
+	*/
+	class BitWriter {
+	public:
+		BitWriter(uint8_t* buffer, size_t capacity);
+
+		/* bits from 1 to 32. */
+		void WriteBits(uint32_t value, uint32_t bits);
+		void WriteBool(bool value) { WriteBits(value ? 1 : 0, 1); }
+		/* 7 bits per byte, small values take one byte. */
+		void WriteVarUint(uint32_t value);
+		void WriteBytes(const void* data, size_t size);
+		void WriteQuantized(float value, float min, float max, uint32_t bits) { WriteBits(Quantize(value, min, max, bits), bits); }
+		void WriteAngle(float radians, uint32_t bits) { WriteBits(QuantizeAngle(radians, bits), bits); }
+
+		/* Writes out the partial last byte and returns the bytes used. */
+		size_t Flush();
+
+		size_t GetBitsWritten() const { return bits_written; }
+		bool Overflowed() const { return overflow; }
+
+		static uint32_t Quantize(float value, float min, float max, uint32_t bits);
+		static uint32_t QuantizeAngle(float radians, uint32_t bits);
+	private:
+		uint8_t* buffer;
+		size_t capacity;
+		uint64_t scratch = 0;
+		uint32_t scratch_bits = 0;
+		size_t bytes = 0;
+		size_t bits_written = 0;
+		bool overflow = false;
+	};
+
+	class BitReader {
+	public:
+		BitReader(const uint8_t* buffer, size_t size);
+
+		uint32_t ReadBits(uint32_t bits);
+		bool ReadBool() { return ReadBits(1) != 0; }
+		uint32_t ReadVarUint();
+		void ReadBytes(void* data, size_t size);
+		float ReadQuantized(float min, float max, uint32_t bits) { return Dequantize(ReadBits(bits), min, max, bits); }
+		float ReadAngle(uint32_t bits) { return DequantizeAngle(ReadBits(bits), bits); }
+
+		size_t GetBitsRead() const { return bits_read; }
+		size_t GetBitsRemaining() const { return size * 8 - bits_read; }
+		/* Set once a read went past the end, everything read after that is zero. */
+		bool Overflowed() const { return overflow; }
+
+		static float Dequantize(uint32_t value, float min, float max, uint32_t bits);
+		static float DequantizeAngle(uint32_t value, uint32_t bits);
+	private:
+		const uint8_t* buffer;
+		size_t size;
+		uint64_t scratch = 0;
+		uint32_t scratch_bits = 0;
+		size_t bytes = 0;
+		size_t bits_read = 0;
+		bool overflow = false;
+	};
+}
+
+#endif // !BIT_STREAM_H
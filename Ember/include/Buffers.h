@@ -1,6 +1,8 @@
 #ifndef OPENGL_BUFFERS_H
 #define OPENGL_BUFFERS_H
 
+#include "GPUResources.h"
+
 #include <memory>
 #include <vector>
 #include <string>
@@ -79,13 +81,16 @@ namespace Ember {
 		void Bind();
 		void UnBind();
 		void SetData(void* data, uint32_t size, uint32_t offset = 0);
+		void Resize(uint32_t size);
 
-		uint32_t GetId() const { return vertex_buffer_id; }
+		uint32_t GetId() const { return vertex_buffer.id; }
 
 		void SetLayout(const VertexBufferLayout& lay) { layout = std::make_shared<VertexBufferLayout>(lay); }
 		std::shared_ptr<VertexBufferLayout> GetLayout() { return layout; }
+		uint32_t GetSize() const { return size_of_buffer; }
 	private:
-		uint32_t vertex_buffer_id;
+		GPUHandle vertex_buffer;
+		uint32_t size_of_buffer = 0;
 		std::shared_ptr<VertexBufferLayout> layout;
 	};
 
@@ -95,14 +100,17 @@ namespace Ember {
 		IndexBuffer(uint32_t size);
 		virtual ~IndexBuffer();
 		void SetData(uint32_t* data, uint32_t size);
+		void Resize(uint32_t size);
 
 		void Bind();
 		void UnBind();
-		uint32_t GetId() const { return index_buffer_id; }
+		uint32_t GetId() const { return index_buffer.id; }
 		uint32_t GetCount() const { return count; }
+		uint32_t GetSize() const { return size_of_buffer; }
 	private:
-		uint32_t index_buffer_id;
+		GPUHandle index_buffer;
 		uint32_t count = 0;
+		uint32_t size_of_buffer = 0;
 	};
 
 	class UniformBuffer {
@@ -120,9 +128,9 @@ namespace Ember {
 		uint32_t GetId() const;
 		void SetData(void* data, uint32_t size, uint32_t offset);
 	private:
-		uint32_t uniform_buffer_id;
+		GPUHandle uniform_buffer;
 		uint32_t uniform_buffer_point;
-		uint32_t size_of_buffer;
+		uint32_t size_of_buffer = 0;
 	};
 
 	class IndirectDrawBuffer {
@@ -133,11 +141,12 @@ namespace Ember {
 		void Bind();
 		void UnBind();
 		uint32_t GetId() const;
+		uint32_t GetSize() const { return size_of_buffer; }
 		void SetData(void* data, uint32_t size, uint32_t offset);
 		void AllocateData(uint32_t size, void* data);
 	private:
-		uint32_t indirect_buffer_id;
-		uint32_t size_of_buffer;
+		GPUHandle indirect_buffer;
+		uint32_t size_of_buffer = 0;
 	};
 
 	class ShaderStorageBuffer {
@@ -155,9 +164,9 @@ namespace Ember {
 		void SetData(void* data, uint32_t size, uint32_t offset);
 		void AllocateData(uint32_t size, void* data);
 	private:
-		uint32_t shader_storage_id;
+		GPUHandle shader_storage;
 		uint32_t binding_point;
-		uint32_t size_of_buffer;
+		uint32_t size_of_buffer = 0;
 	};
 }
 
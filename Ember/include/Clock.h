@@ -0,0 +1,52 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <cstdint>
+
+namespace Ember {
+	constexpr uint64_t NANOSECONDS_PER_SECOND = 1000000000ull;
+	constexpr uint64_t NANOSECONDS_PER_MILLISECOND = 1000000ull;
+
+	/*
+	* Monotonic clock in nanoseconds built on the performance counter.
+	*/
+	class Clock {
+	public:
+		static uint64_t Now();
+
+		static double ToSeconds(uint64_t nanoseconds) { return (double)nanoseconds / NANOSECONDS_PER_SECOND; }
+		static double ToMilliseconds(uint64_t nanoseconds) { return (double)nanoseconds / NANOSECONDS_PER_MILLISECOND; }
+		static uint64_t FromSeconds(double seconds) { return (seconds > 0.0) ? (uint64_t)(seconds * NANOSECONDS_PER_SECOND) : 0; }
+		static uint64_t FromMilliseconds(double milliseconds) { return (milliseconds > 0.0) ? (uint64_t)(milliseconds * NANOSECONDS_PER_MILLISECOND) : 0; }
+	};
+
+	/*
+	* Game time advanced by the frame loop. A clock can be scaled or paused, and child clocks (UI, cutscenes, slow
+	* motion) are advanced with the delta of their parent. Fractions of a nanosecond left by the scale are carried over
+	* so scaled time does not drift. Step advances even while paused, for single stepping.
+	*/
+	class GameClock {
+	public:
+		void Advance(uint64_t delta);
+		void Step(uint64_t delta);
+
+		void SetScale(double time_scale) { scale = (time_scale > 0.0) ? time_scale : 0.0; }
+		void SetPaused(bool pause) { paused = pause; }
+
+		double GetScale() const { return scale; }
+		bool IsPaused() const { return paused; }
+
+		uint64_t GetTime() const { return time; }
+		uint64_t GetDelta() const { return delta_time; }
+		float GetDeltaSeconds() const { return (float)Clock::ToSeconds(delta_time); }
+		float GetDeltaMilliseconds() const { return (float)Clock::ToMilliseconds(delta_time); }
+	private:
+		uint64_t time = 0;
+		uint64_t delta_time = 0;
+		double scale = 1.0;
+		double remainder = 0.0;
+		bool paused = false;
+	};
+}
+
+#endif // !CLOCK_H
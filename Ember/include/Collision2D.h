@@ -0,0 +1,44 @@
+#ifndef COLLISION_2D_H
+#define COLLISION_2D_H
+
+#include "SpatialGrid.h"
+
+#include <glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Ember {
+	/* A circle moving from start to end over one step, radius 0 makes it a ray. */
+	struct SweepQuery {
+		glm::vec2 start;
+		glm::vec2 end;
+		float radius = 0.0f;
+	};
+
+	struct SweepHit {
+		uint32_t id = UINT32_MAX;
+		/* Fraction of the move in [0, 1] at first contact. */
+		float time = 1.0f;
+		glm::vec2 point = { 0.0f, 0.0f };
+		glm::vec2 normal = { 0.0f, 0.0f };
+
+		bool IsHit() const { return id != UINT32_MAX; }
+	};
+
+	/*
+	* Continuous tests for fast movers: instead of testing where an object ends up, the whole move is tested and the
+	* earliest time of impact is returned, so nothing can be skipped over whatever the speed. Targets are circles
+	* packed as (x, y, radius) and indexed by the id they were inserted into the grid with. Circles already touching
+	* the start of a move are hit at time 0.
+	*/
+	class Collision2D {
+	public:
+		/* Earliest hit against the candidates in ids, 4 candidates at a time with SSE2. */
+		static SweepHit SweepCircle(const SweepQuery& query, const glm::vec3* circles, const uint32_t* ids, uint32_t count);
+
+		/* Earliest hit for each query, candidates come from walking the grid cells along each move. */
+		static void SweepCircles(const SweepQuery* queries, uint32_t query_count, const SpatialGrid& grid, const glm::vec3* circles, SweepHit* hits);
+	};
+}
+
+#endif // !COLLISION_2D_H
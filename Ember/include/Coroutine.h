@@ -0,0 +1,210 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include "JobSystem.h"
+#include "TimerWheel.h"
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace Ember {
+	/*
+	* Size class allocator for coroutine frames. Frames up to COROUTINE_POOL_MAX_FRAME bytes come from free lists that
+	* grow in chunks and are never returned to the heap, so starting and finishing tasks stays off the global heap.
+	*/
+	constexpr size_t COROUTINE_POOL_MIN_FRAME = 64;
+	constexpr size_t COROUTINE_POOL_MAX_FRAME = 4096;
+	constexpr size_t COROUTINE_POOL_FRAMES_PER_CHUNK = 32;
+
+	class CoroutineFramePool {
+	public:
+		static void* Allocate(size_t size);
+		static void Free(void* frame, size_t size);
+		static void Destroy();
+	};
+
+	struct TaskPromiseBase {
+		std::coroutine_handle<> continuation;
+
+		/* Tasks started through TaskScheduler are detached: nothing awaits them and they free themselves when done. */
+		bool detached = false;
+		TaskPromiseBase* previous = nullptr;
+		TaskPromiseBase* next = nullptr;
+
+		static void* operator new(size_t size) { return CoroutineFramePool::Allocate(size); }
+		static void operator delete(void* frame, size_t size) { CoroutineFramePool::Free(frame, size); }
+
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		void unhandled_exception() { std::terminate(); }
+
+		struct FinalAwaiter {
+			bool await_ready() noexcept { return false; }
+			template<typename Promise>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+				TaskPromiseBase& promise = handle.promise();
+				if (promise.continuation)
+					return promise.continuation;
+				if (promise.detached)
+					FinishDetached(handle, &promise);
+				return std::noop_coroutine();
+			}
+			void await_resume() noexcept { }
+		};
+
+		FinalAwaiter final_suspend() noexcept { return {}; }
+
+		static void FinishDetached(std::coroutine_handle<> handle, TaskPromiseBase* promise);
+	};
+
+	template<typename T>
+	class Task;
+
+	template<typename T>
+	struct TaskPromise : TaskPromiseBase {
+		std::optional<T> value;
+
+		Task<T> get_return_object();
+		template<typename U>
+		void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+		T TakeResult() { return std::move(*value); }
+	};
+
+	template<>
+	struct TaskPromise<void> : TaskPromiseBase {
+		Task<void> get_return_object();
+		void return_void() { }
+		void TakeResult() { }
+	};
+
+	/*
+	* Lazily started coroutine. Awaiting a task runs it and resumes the awaiting coroutine once it returns, without
+	* going through the scheduler. Top level tasks are handed to TaskScheduler::Start.
+	*/
+	template<typename T = void>
+	class Task {
+	public:
+		using promise_type = TaskPromise<T>;
+		using Handle = std::coroutine_handle<promise_type>;
+
+		Task() = default;
+		explicit Task(Handle handle) : handle(handle) { }
+		Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) { }
+		Task& operator=(Task&& other) noexcept {
+			if (this != &other) {
+				if (handle)
+					handle.destroy();
+				handle = std::exchange(other.handle, nullptr);
+			}
+			return *this;
+		}
+		~Task() {
+			if (handle)
+				handle.destroy();
+		}
+
+		Task(const Task&) = delete;
+		Task& operator=(const Task&) = delete;
+
+		bool IsValid() const { return (bool)handle; }
+		bool IsDone() const { return !handle || handle.done(); }
+		Handle Release() { return std::exchange(handle, nullptr); }
+
+		bool await_ready() const noexcept { return !handle || handle.done(); }
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+			handle.promise().continuation = awaiting;
+			return handle;
+		}
+		T await_resume() { return handle.promise().TakeResult(); }
+	private:
+		Handle handle = nullptr;
+	};
+
+	template<typename T>
+	Task<T> TaskPromise<T>::get_return_object() { return Task<T>(Task<T>::Handle::from_promise(*this)); }
+	inline Task<void> TaskPromise<void>::get_return_object() { return Task<void>(Task<void>::Handle::from_promise(*this)); }
+
+	/*
+	* Resumes suspended tasks from the frame loop, on the main thread. Waits on time use the application's timer wheel,
+	* so they follow the game clock and stop while it is paused.
+	*/
+	class TaskScheduler {
+	public:
+		static void Init(TimerWheel* timers);
+		/* Destroys the frames of the tasks still suspended. Jobs they wait on must have finished. */
+		static void Destroy();
+
+		static void Start(Task<void>&& task);
+		static void Update();
+
+		static void ResumeNextFrame(std::coroutine_handle<> handle);
+		static void ResumeAfter(std::coroutine_handle<> handle, uint64_t delay);
+		static void ResumeWhen(std::coroutine_handle<> handle, const std::function<bool()>& condition);
+
+		static uint32_t GetActiveCount();
+	};
+
+	struct NextFrame {
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) const { TaskScheduler::ResumeNextFrame(handle); }
+		void await_resume() const noexcept { }
+	};
+
+	struct WaitSeconds {
+		float seconds;
+
+		WaitSeconds(float seconds) : seconds(seconds) { }
+
+		bool await_ready() const noexcept { return seconds <= 0.0f; }
+		void await_suspend(std::coroutine_handle<> handle) const { TaskScheduler::ResumeAfter(handle, Clock::FromSeconds(seconds)); }
+		void await_resume() const noexcept { }
+	};
+
+	struct WaitUntil {
+		std::function<bool()> condition;
+
+		WaitUntil(const std::function<bool()>& condition) : condition(condition) { }
+
+		bool await_ready() const { return condition(); }
+		void await_suspend(std::coroutine_handle<> handle) const { TaskScheduler::ResumeWhen(handle, condition); }
+		void await_resume() const noexcept { }
+	};
+
+	struct WaitForJob {
+		JobCounter* counter;
+
+		WaitForJob(JobCounter& counter) : counter(&counter) { }
+
+		bool await_ready() const noexcept { return counter->IsComplete(); }
+		void await_suspend(std::coroutine_handle<> handle) const {
+			JobCounter* job_counter = counter;
+			TaskScheduler::ResumeWhen(handle, [job_counter]() { return job_counter->IsComplete(); });
+		}
+		void await_resume() const noexcept { }
+	};
+
+	/*
+	* Runs the function on a worker and resumes with its result on the main thread, e.g. decoding an asset before
+	* uploading it: SDL_Surface* surface = co_await LoadAsync<SDL_Surface*>([] { return TextureLoader::Load("a.png"); });
+	*/
+	template<typename T>
+	struct LoadAsync {
+		std::function<T()> load;
+		std::optional<T> result;
+		JobCounter counter;
+
+		LoadAsync(const std::function<T()>& load) : load(load) { }
+
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) {
+			JobSystem::Submit([this]() { result.emplace(load()); }, &counter);
+			JobCounter* job_counter = &counter;
+			TaskScheduler::ResumeWhen(handle, [job_counter]() { return job_counter->IsComplete(); });
+		}
+		T await_resume() { return std::move(*result); }
+	};
+}
+
+#endif // !COROUTINE_H
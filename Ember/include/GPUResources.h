@@ -0,0 +1,102 @@
+#ifndef GPU_RESOURCES_H
+#define GPU_RESOURCES_H
+
+#include "RendererAPI.h"
+
+#include <cstdint>
+
+namespace Ember {
+	/* Pooled objects nobody asked for in this many frames are deleted. */
+	constexpr uint32_t GPU_POOL_MAX_FRAMES = 300;
+	constexpr uint64_t GPU_POOL_MAX_BYTES = 64ull * 1024 * 1024;
+
+	enum class GPUResourceType : uint8_t {
+		Buffer, VertexArray, Program, Texture, FrameBuffer, TimerQuery
+	};
+
+	/*
+	* A pooled buffer or texture as its owner holds it, the backend id and the generation it was handed out with.
+	* Releasing bumps the generation kept for the id, so a copy kept past the release stops matching even after the
+	* pool hands the id to a new owner.
+	*/
+	struct GPUHandle {
+		uint32_t id = 0;
+		uint32_t generation = 0;
+
+		bool IsValid() const { return id != 0; }
+	};
+
+	struct GPUResourceStats {
+		/* Released since the last EndFrame. */
+		uint32_t pending = 0;
+		/* Frames whose fence the GPU has not passed yet, and the objects released in them. */
+		uint32_t retiring_frames = 0;
+		uint32_t retiring = 0;
+		uint32_t pooled_buffers = 0;
+		uint32_t pooled_textures = 0;
+		uint64_t pooled_bytes = 0;
+		/* Totals since the start. */
+		uint64_t reused = 0;
+		uint64_t deleted = 0;
+		/* Double releases and uses of released handles that were caught. */
+		uint64_t misuses = 0;
+	};
+
+	/*
+	* Deferred destruction of backend objects. The buffer classes, VertexArray, Shader, Texture, Font, FrameBuffer and
+	* DynamicResolution release their ids here instead of deleting them, from any thread. EndFrame, on the thread that owns the context,
+	* puts a fence after the frame and the objects released during it are only reclaimed once the GPU has passed that
+	* fence, at the earliest on the next EndFrame.
+	* Reclaimed buffers and textures go into pools keyed by their size (and format), and the next buffer or texture of
+	* the same size takes one from there instead of allocating. Everything else is deleted.
+	* Released on the game thread while the render thread records, a release is recorded too, so it happens after the
+	* commands recorded before it.
+	* Only Release and its variants may be called from any thread. The pools, the retiring frames and the totals are not
+	* locked, so Acquire, EndFrame, Flush and GetStats belong to the thread that owns the context.
+	* Pooled buffers and textures are held through GPUHandles. A second release of a handle is logged and dropped, so
+	* the object is never pooled twice, and debug builds also check each bind of a buffer or texture (including the
+	* Renderer's texture slots, which keep raw ids) against released ones. A misuse asserts unless SetAssertOnMisuse
+	* turned that off.
+	*/
+	class GPUResources {
+	public:
+		/* For objects that are never pooled. */
+		static void Release(GPUResourceType type, uint32_t id);
+		/* Resets handle. */
+		static void ReleaseBuffer(GPUHandle& handle, uint32_t size);
+		static void ReleaseTexture(GPUHandle& handle, uint32_t width, uint32_t height, TextureFormat format);
+
+		/*
+		* A pooled object of exactly this size, or a new one from the backend, pooled tells which. Only on the thread
+		* that owns the context.
+		*/
+		static GPUHandle CreateBuffer(uint32_t size, bool& pooled);
+		static GPUHandle CreateTexture(uint32_t width, uint32_t height, TextureFormat format, bool& pooled);
+
+		/* False once the handle was released. type is Buffer or Texture. */
+		static bool IsLive(GPUResourceType type, GPUHandle handle);
+		/* For raw ids: true when a handle for the id was released and the id has not been handed out or deleted since. */
+		static bool IsReleased(GPUResourceType type, uint32_t id);
+		/* Reports a misuse when the handle or id was released, use EMBER_CHECK_GPU_USE. */
+		static void CheckUse(GPUResourceType type, GPUHandle handle);
+		static void CheckUse(GPUResourceType type, uint32_t id);
+		/* On by default. Misuses are always logged and counted. */
+		static void SetAssertOnMisuse(bool enabled);
+
+		static void EndFrame();
+
+		/* Waits for the GPU and deletes everything released and pooled, before the context goes away. */
+		static void Flush();
+
+		/* Only on the thread that owns the context. */
+		static GPUResourceStats GetStats();
+	};
+}
+
+#ifdef EMBER_DEBUG
+	#define EMBER_CHECK_GPU_USE(type, handle) Ember::GPUResources::CheckUse(type, handle)
+#else
+	#define EMBER_CHECK_GPU_USE(type, handle)
+#endif
+
+#endif // !GPU_RESOURCES_H
@@ -0,0 +1,42 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace Ember {
+	/*
+	* Counts the jobs submitted against it that have not finished yet. Must outlive those jobs.
+	*/
+	struct JobCounter {
+		std::atomic<uint32_t> pending{ 0 };
+
+		bool IsComplete() const { return pending.load(std::memory_order_acquire) == 0; }
+	};
+
+	/*
+	* Fixed pool of worker threads pulling from a shared queue. Without workers (before Init, or with a thread count of
+	* zero) jobs run inline on the submitting thread.
+	*/
+	class JobSystem {
+	public:
+		using Job = std::function<void()>;
+		using RangeJob = std::function<void(uint32_t begin, uint32_t end)>;
+
+		static void Init(uint32_t thread_count = UINT32_MAX);
+		static void Destroy();
+
+		static void Submit(const Job& job, JobCounter* counter = nullptr);
+		static void ParallelFor(uint32_t count, uint32_t batch_size, const RangeJob& job, JobCounter* counter);
+
+		/*
+		* Runs queued jobs on the calling thread until the counter reaches zero.
+		*/
+		static void Wait(JobCounter& counter);
+
+		static uint32_t GetThreadCount();
+	};
+}
+
+#endif // !JOB_SYSTEM_H
@@ -5,10 +5,17 @@
 #include "Events.h"
 
 namespace Ember {
+	/*
+	* An independent layer declares that its OnUpdate touches no state shared with other layers and issues no render
+	* calls, Application then runs it on a worker thread alongside the rest of the stack. The frame arena is such
+	* shared state, it is not synchronised and Memory::FrameAllocator asserts off the main thread in debug builds.
+	* Nothing resets a worker's scratch stack at the frame boundary, so an independent layer allocates only inside a
+	* ScratchMarker scope, through the marker or an ArenaAllocator on its arena, and keeps nothing past the scope.
+	*/
 	class Layer {
 	public:
-		Layer(const std::string& name)
-			: name(name) { }
+		Layer(const std::string& name, bool independent = false)
+			: name(name), independent(independent) { }
 		virtual ~Layer() = default;
 
 		virtual void OnAttach() {}
@@ -18,8 +25,10 @@ namespace Ember {
 		virtual void UpdateGui() { }
 
 		inline std::string GetName() const { return name; }
+		inline bool IsIndependent() const { return independent; }
 	protected:
 		std::string name;
+		bool independent;
 	};
 
 	class LayerStack
@@ -33,6 +42,9 @@ namespace Ember {
 		void PopLayer(Layer* layer);
 		void PopOverlay(Layer* overlay);
 
+		/* Updates the layers bottom up, independent ones as jobs, and returns once all of them are done. */
+		void Update(float delta);
+
 		inline std::vector<Layer*>::iterator begin() { return layers.begin(); }
 		inline std::vector<Layer*>::iterator end() { return layers.end(); }
 		inline std::vector<Layer*>::reverse_iterator rbegin() { return layers.rbegin(); }
@@ -6,14 +6,19 @@
 #include <iostream>
 #include <vector>
 #include <cstdarg>
+#include <mutex>
+
+#include "Memory.h"
+#include "MemoryTracker.h"
 
 namespace Ember {
 	class LogCommand {
 	public:
 		LogCommand() : command_name("") { }
+		virtual ~LogCommand() = default;
 		virtual void RunCommand(va_list& args, const char* input) = 0;
 		virtual void ProcessArgs(va_list& args) = 0;
-		virtual void AddToOutput(std::string& output, std::vector<LogCommand*>& commands);
+		virtual void AddToOutput(ArenaString& output, std::vector<LogCommand*>& commands);
 
 		inline const std::string GetCommand() const { return command_name; }
 		inline const std::string GetCommandOutput() const { return command_output; }
@@ -24,11 +29,23 @@ namespace Ember {
 		inline void SetPosition(size_t position) { starting_position = position; }
 		inline void ResetPosition() { starting_position = reseting_position; }
 		inline void GetResetingPosition() { reseting_position = starting_position; }
+
+		inline size_t GetTrackedSize() const { return tracked_size; }
 	protected:
+		/* Reports the whole concrete command under the Logger tag, LogFormat::Destroy frees the same size. */
+		template<typename T>
+		static LogCommand* CreateTracked() {
+			LogCommand* command = new T();
+			command->tracked_size = sizeof(T);
+			EMBER_TRACK_ALLOC(MemoryTag::Logger, sizeof(T));
+			return command;
+		}
+
 		std::string command_name;
 		std::string command_output;
 		size_t starting_position = 0;
 		size_t reseting_position = 0;
+		size_t tracked_size = 0;
 	};
 
 	typedef LogCommand* (__stdcall* CreateLogCommandFn)(void);
@@ -38,7 +55,7 @@ namespace Ember {
 		TimestampLogCommand() { }
 		void RunCommand(va_list& args, const char* input) override;
 		void ProcessArgs(va_list& args) override;
-		static LogCommand* __stdcall Create() { return new TimestampLogCommand(); }
+		static LogCommand* __stdcall Create() { return CreateTracked<TimestampLogCommand>(); }
 	};
 
 	class UserDefinedStringCommand : public LogCommand {
@@ -46,7 +63,7 @@ namespace Ember {
 		UserDefinedStringCommand() { }
 		void RunCommand(va_list& args, const char* input) override;
 		void ProcessArgs(va_list& args) override;
-		static LogCommand* __stdcall Create() { return new UserDefinedStringCommand(); }
+		static LogCommand* __stdcall Create() { return CreateTracked<UserDefinedStringCommand>(); }
 	};
 
 	class UserLogCommand : public LogCommand {
@@ -54,7 +71,7 @@ namespace Ember {
 		UserLogCommand() { }
 		void RunCommand(va_list& args, const char* input) override;
 		void ProcessArgs(va_list& args) override;
-		static LogCommand* __stdcall Create() { return new UserLogCommand(); }
+		static LogCommand* __stdcall Create() { return CreateTracked<UserLogCommand>(); }
 	};
 
 	class NewLineLogCommand : public LogCommand {
@@ -62,7 +79,7 @@ namespace Ember {
 		NewLineLogCommand() { }
 		void RunCommand(va_list& args, const char* input) override;
 		void ProcessArgs(va_list& args) override;
-		static LogCommand* __stdcall Create() { return new NewLineLogCommand(); }
+		static LogCommand* __stdcall Create() { return CreateTracked<NewLineLogCommand>(); }
 	};
 
 	enum ColorCode {
@@ -83,6 +100,7 @@ namespace Ember {
 		ColorController() : code(FG_DEFAULT) { }
 
 		inline void SetColor(ColorCode code) { this->code = code; }
+		inline ColorCode GetColor() const { return code; }
 
 		friend std::ostream& operator<<(std::ostream& os, const ColorController& controller) {
 			return os << "\033[" << controller.code << "m";
@@ -96,7 +114,7 @@ namespace Ember {
 		ColorLogCommand() { }
 		void RunCommand(va_list& args, const char* input) override;
 		void ProcessArgs(va_list& args) override;
-		static LogCommand* __stdcall Create() { return new ColorLogCommand(); }
+		static LogCommand* __stdcall Create() { return CreateTracked<ColorLogCommand>(); }
 	private:
 		ColorController color_controller;
 	};
@@ -104,8 +122,9 @@ namespace Ember {
 	class LogFormat {
 	public:
 		void Init(const char* format, ...);
+		void Destroy();
 		std::vector<LogCommand*>& GetCommands() { return commands; }
-		std::string GetLeftOutput() { return output; }
+		const std::string& GetLeftOutput() const { return output; }
 	private:
 		std::vector<LogCommand*> commands;
 		std::string output;
@@ -117,6 +136,7 @@ namespace Ember {
 		void Log(const char* fmt, ...); 
 	private:
 		LogFormat* formatter;
+		std::mutex mutex;
 	};
 
 	void InitializeLoggingSystem();
@@ -124,6 +144,7 @@ namespace Ember {
 	class LogImpl {
 	public:
 		static void Init();
+		static void Destroy();
 
 		static Logger& GetLogError();
 		static Logger& GetLogWarning();
@@ -0,0 +1,133 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Ember {
+	constexpr size_t DEFAULT_FRAME_ARENA_SIZE = 1024 * 1024;
+	constexpr size_t DEFAULT_SCRATCH_STACK_SIZE = 64 * 1024;
+
+	struct ArenaMarker {
+		void* block = nullptr;
+		size_t offset = 0;
+	};
+
+	/*
+	* Bump allocator. Allocations are never freed individually, the arena is rewound to a marker or reset as a whole.
+	* When a block runs out the arena chains an overflow block from the heap. Rewinding to a marker only frees the blocks
+	* chained after it. Once a rewind or Reset empties the arena the first block grows to the observed peak, so steady
+	* state use stays off the global heap even on threads that never Reset. Reset invalidates every marker taken from
+	* the arena.
+	*/
+	class LinearArena {
+	public:
+		LinearArena() = default;
+		LinearArena(size_t capacity);
+		~LinearArena();
+
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		void Init(size_t capacity);
+		void Destroy();
+
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		template<typename T>
+		T* Allocate(size_t count = 1) { return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))); }
+
+		ArenaMarker GetMarker() const;
+		void Rewind(const ArenaMarker& marker);
+		void Reset();
+
+		size_t GetCapacity() const;
+		size_t GetUsed() const { return used; }
+		size_t GetPeak() const { return peak; }
+		uint32_t GetOverflowCount() const { return overflow_count; }
+	private:
+		struct Block {
+			Block* previous;
+			size_t capacity;
+			size_t offset;
+		};
+
+		Block* CreateBlock(size_t capacity, Block* previous);
+		void FreeBlocksAfter(Block* block);
+
+		Block* first = nullptr;
+		Block* current = nullptr;
+		size_t used = 0;
+		size_t peak = 0;
+		uint32_t overflow_count = 0;
+	};
+
+	/*
+	* Rewinds the calling thread's scratch stack when it goes out of scope, nested markers unwind in LIFO order.
+	*/
+	class ScratchMarker {
+	public:
+		ScratchMarker();
+		~ScratchMarker();
+
+		ScratchMarker(const ScratchMarker&) = delete;
+		ScratchMarker& operator=(const ScratchMarker&) = delete;
+
+		template<typename T>
+		T* Allocate(size_t count = 1) { return arena->Allocate<T>(count); }
+		LinearArena* GetArena() { return arena; }
+	private:
+		LinearArena* arena;
+		ArenaMarker marker;
+	};
+
+	template<typename T>
+	class ArenaAllocator {
+	public:
+		using value_type = T;
+
+		ArenaAllocator(LinearArena* arena) noexcept : arena(arena) { }
+
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.GetArena()) { }
+
+		T* allocate(size_t count) { return arena->Allocate<T>(count); }
+		void deallocate(T* pointer, size_t count) noexcept { }
+
+		LinearArena* GetArena() const { return arena; }
+
+		template<typename U>
+		bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.GetArena(); }
+		template<typename U>
+		bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.GetArena(); }
+	private:
+		LinearArena* arena;
+	};
+
+	template<typename T>
+	using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+	using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+	class Memory {
+	public:
+		static void Init(size_t frame_arena_size = DEFAULT_FRAME_ARENA_SIZE);
+		static void Destroy();
+
+		/* Resets the frame arena and the calling thread's scratch stack, no scratch marker may be alive on that thread. */
+		static void BeginFrame();
+
+		/* Not synchronised: only the thread that called Init may use it, debug builds assert on any other. */
+		static LinearArena& GetFrameArena();
+		/* Per thread, the one for jobs to allocate temporaries from. */
+		static LinearArena& GetScratchStack();
+
+		template<typename T>
+		static ArenaAllocator<T> FrameAllocator() { return ArenaAllocator<T>(&GetFrameArena()); }
+		template<typename T>
+		static ArenaAllocator<T> ScratchAllocator() { return ArenaAllocator<T>(&GetScratchStack()); }
+	};
+}
+
+#endif // !MEMORY_H
@@ -0,0 +1,90 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Ember {
+	enum class MemoryTag {
+		Renderer, Font, Texture, Audio, Logger, Game, Count
+	};
+
+	struct MemoryTagStats {
+		size_t cpu_current = 0;
+		size_t cpu_peak = 0;
+		size_t gpu_current = 0;
+		size_t gpu_peak = 0;
+		uint64_t allocations = 0;
+		uint64_t frees = 0;
+	};
+
+	class MemoryTracker {
+	public:
+		static void TrackAlloc(MemoryTag tag, size_t size);
+		static void TrackFree(MemoryTag tag, size_t size);
+		static void TrackGpuAlloc(MemoryTag tag, size_t size);
+		static void TrackGpuFree(MemoryTag tag, size_t size);
+
+		static MemoryTagStats GetStats(MemoryTag tag);
+		static const char* GetTagName(MemoryTag tag);
+
+		static size_t GetTotalCpu();
+		static size_t GetTotalGpu();
+
+		/*
+		* Runs after the logging system has shut down so the logger's own allocations can be checked, prints directly.
+		*/
+		static void ReportLeaks();
+		static bool DumpJson(const char* file_path);
+	};
+
+	/*
+	* STL allocator that reports its memory under a tag. Falls back to plain new/delete when tracking is compiled out.
+	*/
+	template<typename T, MemoryTag Tag>
+	class TrackedAllocator {
+	public:
+		using value_type = T;
+
+		template<typename U>
+		struct rebind { using other = TrackedAllocator<U, Tag>; };
+
+		TrackedAllocator() noexcept = default;
+		template<typename U>
+		TrackedAllocator(const TrackedAllocator<U, Tag>&) noexcept { }
+
+		T* allocate(size_t count) {
+#ifdef EMBER_MEMORY_TRACKING
+			MemoryTracker::TrackAlloc(Tag, count * sizeof(T));
+#endif
+			return std::allocator<T>().allocate(count);
+		}
+
+		void deallocate(T* pointer, size_t count) noexcept {
+#ifdef EMBER_MEMORY_TRACKING
+			MemoryTracker::TrackFree(Tag, count * sizeof(T));
+#endif
+			std::allocator<T>().deallocate(pointer, count);
+		}
+
+		template<typename U>
+		bool operator==(const TrackedAllocator<U, Tag>&) const noexcept { return true; }
+		template<typename U>
+		bool operator!=(const TrackedAllocator<U, Tag>&) const noexcept { return false; }
+	};
+}
+
+#ifdef EMBER_MEMORY_TRACKING
+	#define EMBER_TRACK_ALLOC(tag, size) Ember::MemoryTracker::TrackAlloc(tag, size)
+	#define EMBER_TRACK_FREE(tag, size) Ember::MemoryTracker::TrackFree(tag, size)
+	#define EMBER_TRACK_GPU_ALLOC(tag, size) Ember::MemoryTracker::TrackGpuAlloc(tag, size)
+	#define EMBER_TRACK_GPU_FREE(tag, size) Ember::MemoryTracker::TrackGpuFree(tag, size)
+#else
+	#define EMBER_TRACK_ALLOC(tag, size)
+	#define EMBER_TRACK_FREE(tag, size)
+	#define EMBER_TRACK_GPU_ALLOC(tag, size)
+	#define EMBER_TRACK_GPU_FREE(tag, size)
+#endif // EMBER_MEMORY_TRACKING
+
+#endif // !MEMORY_TRACKER_H
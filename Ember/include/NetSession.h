@@ -0,0 +1,120 @@
+#ifndef NET_SESSION_H
+#define NET_SESSION_H
+
+#include "Network.h"
+#include "NetSnapshot.h"
+
+#include <glm.hpp>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace Ember {
+	class SpatialGrid;
+
+	constexpr uint16_t NET_DEFAULT_PORT = 27015;
+	constexpr uint64_t NET_TIMEOUT = 5000000000ull;
+	/* Cap on entities per snapshot so a full one fits a packet, the ones nearest the client's interest centre win. */
+	constexpr uint32_t NET_MAX_SNAPSHOT_ENTITIES = 96;
+
+	/*
+	* Authoritative end of a game session. Clients connect by sending any valid packet and take a free slot, they are
+	* dropped after NET_TIMEOUT of silence. Each tick the game reads client messages, simulates, then SendSnapshots sends every
+	* client the entities inside its interest bounds (found through the spatial grid) delta compressed against the
+	* snapshot it last acknowledged, and Flush sends one packet per client.
+	*/
+	class NetServer {
+	public:
+		bool Init(uint16_t port, uint32_t max_clients, const NetQuantization& quantization);
+		void Destroy();
+
+		/* Reads every waiting packet and drops timed out clients. */
+		void Receive(uint64_t now);
+		/* Next message from any client, client is its slot. */
+		bool PopMessage(uint32_t& client, std::vector<uint8_t>& message);
+		bool Send(uint32_t client, NetChannel channel, const void* data, size_t size);
+		void Broadcast(NetChannel channel, const void* data, size_t size);
+
+		/* Area the client receives entities from, as (min x, min y, max x, max y). Starts as the quantization bounds. */
+		void SetInterest(uint32_t client, const glm::vec4& bounds);
+		/* The ids stored in grid index entities. */
+		void SendSnapshots(const NetEntityState* entities, uint32_t count, const SpatialGrid& grid);
+		void Flush(uint64_t now);
+
+		uint32_t GetMaxClients() const { return (uint32_t)clients.size(); }
+		bool IsConnected(uint32_t client) const { return clients[client].connected; }
+		/* Slots that connected or dropped since the last call to Receive. */
+		const std::vector<uint32_t>& GetConnected() const { return connected; }
+		const std::vector<uint32_t>& GetDisconnected() const { return disconnected; }
+		const NetStats& GetStats(uint32_t client) const { return clients[client].connection.GetStats(); }
+		uint16_t GetPort() const { return socket.GetPort(); }
+	private:
+		struct Client {
+			bool connected = false;
+			NetConnection connection;
+			NetSnapshotEncoder encoder;
+			glm::vec4 interest = { 0.0f, 0.0f, 0.0f, 0.0f };
+			/* Snapshot carried by each packet in the ack window, UINT32_MAX for none. */
+			std::vector<uint32_t> packet_snapshots;
+			/* Index of the snapshot waiting in the unreliable queue, UINT32_MAX when there is none. */
+			uint32_t pending_snapshot = UINT32_MAX;
+		};
+
+		struct Inbound {
+			uint32_t client;
+			std::vector<uint8_t> message;
+		};
+
+		UdpSocket socket;
+		NetQuantization quantization;
+		std::vector<Client> clients;
+		std::deque<Inbound> inbox;
+		/* Reads the first packet of an unknown sender before it gets a slot. */
+		NetConnection candidate;
+		std::vector<uint32_t> connected;
+		std::vector<uint32_t> disconnected;
+		uint16_t snapshot_id = 0;
+
+		std::vector<uint32_t> interest_ids;
+		std::vector<NetEntityState> interest_entities;
+		std::vector<uint16_t> acked;
+		std::vector<uint8_t> message;
+		uint8_t packet[NET_MAX_PACKET_SIZE];
+	};
+
+	/*
+	* Client end: sends its messages to the server and keeps the entity list of the newest snapshot received.
+	*/
+	class NetClient {
+	public:
+		bool Init(const NetAddress& server, const NetQuantization& quantization, uint64_t now);
+		void Destroy();
+
+		/* Reads every waiting packet, returns true when a newer snapshot arrived. */
+		bool Receive(uint64_t now);
+		bool PopMessage(std::vector<uint8_t>& message);
+		bool Send(NetChannel channel, const void* data, size_t size);
+		/* Sends one packet, also when there is nothing queued since it carries the acks the server deltas against. */
+		void Flush(uint64_t now);
+
+		/* Sorted by id. */
+		const std::vector<NetEntityState>& GetEntities() const { return entities; }
+		bool IsConnected(uint64_t now) const { return has_snapshot && now - connection.GetLastReceiveTime() < NET_TIMEOUT; }
+		const NetStats& GetStats() const { return connection.GetStats(); }
+	private:
+		UdpSocket socket;
+		NetConnection connection;
+		NetSnapshotDecoder decoder;
+		std::vector<NetEntityState> entities;
+		std::vector<NetEntityState> decoded;
+		uint16_t snapshot_id = 0;
+		bool has_snapshot = false;
+
+		std::deque<std::vector<uint8_t>> inbox;
+		std::vector<uint16_t> acked;
+		std::vector<uint8_t> message;
+		uint8_t packet[NET_MAX_PACKET_SIZE];
+	};
+}
+
+#endif // !NET_SESSION_H
@@ -0,0 +1,95 @@
+#ifndef NET_SNAPSHOT_H
+#define NET_SNAPSHOT_H
+
+#include <glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Ember {
+	class BitWriter;
+	class BitReader;
+
+	constexpr uint32_t NET_SNAPSHOT_HISTORY = 32;
+
+	/* Replicated state of one object. kind is game defined and sent in 4 bits. */
+	struct NetEntityState {
+		uint32_t id;
+		glm::vec2 position;
+		float angle;
+		float radius;
+		uint8_t kind;
+	};
+
+	/* How entity fields are quantized on the wire, both ends must agree. */
+	struct NetQuantization {
+		/* World area positions are quantized over, as (min x, min y, max x, max y). */
+		glm::vec4 bounds = { 0.0f, 0.0f, 1.0f, 1.0f };
+		uint32_t position_bits = 16;
+		/* Position changes within this many bits (signed) are sent as a delta from the baseline. */
+		uint32_t position_delta_bits = 10;
+		uint32_t angle_bits = 10;
+		float max_radius = 128.0f;
+		uint32_t radius_bits = 8;
+	};
+
+	/*
+	* Server side delta compression for one client. Each snapshot is encoded against the newest snapshot the client
+	* acknowledged (the baseline): entities are written sorted by id with the id as a difference from the one before,
+	* entities unchanged since the baseline cost those id bits and one more, changed ones send only the fields that
+	* differ after quantization, and entities missing from the snapshot are removed on the client. A full snapshot is
+	* sent while no baseline is acknowledged or the baseline has left the history.
+	*/
+	class NetSnapshotEncoder {
+	public:
+		void Init(const NetQuantization& quantization);
+
+		/* Writes entities (any order) as snapshot id, stopping early if writer runs out of room; returns how many were written. */
+		uint32_t Encode(uint16_t id, const NetEntityState* entities, uint32_t count, BitWriter& writer, uint32_t capacity_bits);
+		void Acknowledge(uint16_t id);
+
+		bool HasBaseline() const { return has_baseline; }
+	private:
+		friend class NetSnapshotDecoder;
+
+		struct Quantized {
+			uint32_t id;
+			uint32_t x;
+			uint32_t y;
+			uint32_t angle;
+			uint32_t radius;
+			uint32_t kind;
+		};
+
+		struct Record {
+			uint16_t id = 0;
+			bool valid = false;
+			std::vector<Quantized> entities;
+		};
+
+		static Quantized Quantize(const NetQuantization& quantization, const NetEntityState& entity);
+		static NetEntityState Dequantize(const NetQuantization& quantization, const Quantized& entity);
+
+		NetQuantization quantization;
+		std::vector<Record> history;
+		std::vector<Quantized> scratch;
+		uint16_t baseline = 0;
+		bool has_baseline = false;
+	};
+
+	/*
+	* Client side: rebuilds the entity list of each snapshot from the baseline it names. Every decoded snapshot is kept
+	* in the history, since the server may pick any acknowledged one as a later baseline.
+	*/
+	class NetSnapshotDecoder {
+	public:
+		void Init(const NetQuantization& quantization);
+
+		/* False when the snapshot is malformed or its baseline is unknown. entities receives the snapshot's entities sorted by id. */
+		bool Decode(BitReader& reader, uint16_t& id, std::vector<NetEntityState>& entities);
+	private:
+		NetQuantization quantization;
+		std::vector<NetSnapshotEncoder::Record> history;
+	};
+}
+
+#endif // !NET_SNAPSHOT_H
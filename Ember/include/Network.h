@@ -0,0 +1,159 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace Ember {
+	constexpr uint32_t NET_PROTOCOL_ID = 0x454D4252;
+	/* Stays under the common internet MTU once IP and UDP headers are added. */
+	constexpr size_t NET_MAX_PACKET_SIZE = 1200;
+	constexpr size_t NET_MAX_MESSAGE_SIZE = 1100;
+	constexpr uint32_t NET_PACKET_WINDOW = 256;
+	constexpr uint32_t NET_RELIABLE_WINDOW = 256;
+	constexpr uint64_t NET_RESEND_INTERVAL = 100000000ull;
+
+	/* True when sequence a is newer than b, allowing for wrap around. */
+	inline bool SequenceGreater(uint16_t a, uint16_t b) {
+		return (a > b && a - b <= 32768) || (a < b && b - a > 32768);
+	}
+
+	struct NetAddress {
+		/* IPv4, host byte order. */
+		uint32_t ip = 0;
+		uint16_t port = 0;
+
+		static NetAddress Loopback(uint16_t port) { return { 0x7F000001, port }; }
+		/* "host" or "host:port", the host as a dotted address or a name to resolve. */
+		static bool Parse(const char* text, uint16_t default_port, NetAddress& address);
+
+		bool operator==(const NetAddress& other) const { return ip == other.ip && port == other.port; }
+		bool operator!=(const NetAddress& other) const { return !(*this == other); }
+	};
+
+	class Network {
+	public:
+		/* Starts the platform socket library, calls are counted so every user can Init and Destroy. */
+		static bool Init();
+		static void Destroy();
+	};
+
+	/*
+	* Non blocking UDP socket bound to every interface.
+	*/
+	class UdpSocket {
+	public:
+		/* Port 0 lets the system pick one, GetPort returns it afterwards. */
+		bool Open(uint16_t port = 0);
+		void Close();
+
+		bool Send(const NetAddress& address, const void* data, size_t size);
+		/* Bytes read into buffer, 0 when nothing is waiting. */
+		size_t Receive(NetAddress& address, void* buffer, size_t capacity);
+
+		bool IsOpen() const { return handle != INVALID_HANDLE; }
+		uint16_t GetPort() const { return port; }
+	private:
+		static constexpr uintptr_t INVALID_HANDLE = ~(uintptr_t)0;
+
+		uintptr_t handle = INVALID_HANDLE;
+		uint16_t port = 0;
+	};
+
+	enum class NetChannel : uint8_t {
+		Unreliable = 0,
+		/* Resent until acknowledged and delivered in the order sent. */
+		Reliable = 1
+	};
+
+	struct NetStats {
+		uint64_t packets_sent = 0;
+		uint64_t packets_received = 0;
+		uint64_t packets_acked = 0;
+		uint64_t bytes_sent = 0;
+		uint64_t bytes_received = 0;
+		/* Smoothed round trip time in milliseconds. */
+		float round_trip_time = 0.0f;
+	};
+
+	/*
+	* One end of a connection over UDP, independent of the socket: WritePacket builds the next packet to send and
+	* ReadPacket takes what came from the other end. Every packet carries a sequence number and acknowledges the last
+	* 33 packets received (latest sequence plus a 32 bit field), so the sender learns which packets arrived without
+	* separate ack packets. Packets carry any number of messages on two channels: unreliable messages are written once
+	* and dropped if they do not fit; reliable messages are written again every NET_RESEND_INTERVAL until a packet
+	* holding them is acknowledged, and the receiver buffers them to deliver in order.
+	*/
+	class NetConnection {
+	public:
+		void Init(const NetAddress& address, uint64_t now);
+
+		bool Send(NetChannel channel, const void* data, size_t size);
+		bool Receive(std::vector<uint8_t>& message);
+
+		/* Returns the packet size, never 0: a packet with no messages still carries the acks. */
+		size_t WritePacket(uint8_t* buffer, size_t capacity, uint64_t now);
+		/* False when the packet is malformed, from another protocol or a duplicate. */
+		bool ReadPacket(const uint8_t* data, size_t size, uint64_t now);
+
+		/* Sequence of the packet last written. */
+		uint16_t GetLastSequence() const { return (uint16_t)(sequence - 1); }
+		/* Unreliable messages queued before the last WritePacket; the first GetUnreliableWritten of them went out. */
+		uint32_t GetUnreliableQueued() const { return (uint32_t)unreliable_out.size(); }
+		uint32_t GetUnreliableWritten() const { return unreliable_written; }
+		/* Moves the sequences of our packets acknowledged since the last call into acked. */
+		void PopAcked(std::vector<uint16_t>& acked);
+
+		const NetAddress& GetAddress() const { return address; }
+		uint64_t GetLastReceiveTime() const { return last_receive; }
+		const NetStats& GetStats() const { return stats; }
+	private:
+		struct SentPacket {
+			uint64_t time = 0;
+			uint16_t sequence = 0;
+			bool valid = false;
+			bool acked = false;
+			std::vector<uint16_t> messages;
+		};
+
+		struct OutgoingMessage {
+			uint16_t id;
+			bool acked;
+			uint64_t last_sent;
+			std::vector<uint8_t> data;
+		};
+
+		struct IncomingMessage {
+			uint16_t id = 0;
+			bool valid = false;
+			std::vector<uint8_t> data;
+		};
+
+		void Acknowledge(uint16_t acked_sequence, uint64_t now);
+
+		NetAddress address;
+		uint64_t last_receive = 0;
+		NetStats stats;
+
+		uint16_t sequence = 0;
+		std::vector<SentPacket> sent_packets;
+		std::vector<uint16_t> acked_packets;
+
+		uint16_t remote_sequence = 0;
+		uint32_t received_bits = 0;
+		bool received_any = false;
+
+		uint16_t next_reliable_id = 0;
+		std::deque<OutgoingMessage> reliable_out;
+		std::vector<std::vector<uint8_t>> unreliable_out;
+		uint32_t unreliable_written = 0;
+
+		uint16_t next_receive_id = 0;
+		std::vector<IncomingMessage> reliable_in;
+		std::deque<std::vector<uint8_t>> inbox;
+	};
+}
+
+#endif // !NETWORK_H
@@ -0,0 +1,212 @@
+#ifndef NULL_RENDERER_API_H
+#define NULL_RENDERER_API_H
+
+#include "RendererAPI.h"
+
+#include <initializer_list>
+
+namespace Ember {
+	struct RendererAPIStats {
+		uint32_t calls = 0;
+		uint32_t draw_calls = 0;
+		/* Bytes given to BufferData, BufferSubData and the texture uploads. */
+		uint64_t bytes_uploaded = 0;
+		uint32_t buffers = 0;
+		uint32_t vertex_arrays = 0;
+		uint32_t programs = 0;
+		uint32_t textures = 0;
+	};
+
+	/*
+	* Backend without a GPU: it hands out ids and counts calls, draws, uploaded bytes and live objects, so the
+	* Renderer can run and be timed with no context at all.
+	*/
+	class NullRendererAPI : public RendererAPI {
+	public:
+		const RendererAPIStats& GetStats() const { return stats; }
+		void ResetStats() { stats = RendererAPIStats(); }
+		/* While held, no fence counts as passed, like a GPU still working on the frames that inserted them. */
+		void HoldFences(bool hold) { fences_held = hold; }
+		/* Every timer query reads this many nanoseconds from now on, or is still running when not available. */
+		void SetTimerResult(uint64_t nanoseconds, bool available = true) { timer_result = nanoseconds; timer_available = available; }
+
+		void Init() override { stats.calls++; }
+		void SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h) override { stats.calls++; }
+		void Clear() override { stats.calls++; }
+		void SetClearColor(float r, float g, float b, float a) override { stats.calls++; }
+		void SetPolygonMode(uint32_t face, uint32_t mode) override { stats.calls++; }
+		void SetLineWidth(float width) override { stats.calls++; }
+		void SetClipDistances(uint32_t count) override { stats.calls++; }
+		void Finish() override { stats.calls++; }
+		/* Nothing runs later, every fence is already passed unless they are held. */
+		uint64_t InsertFence() override { stats.calls++; return next_id++; }
+		bool IsFenceSignaled(uint64_t fence) override { stats.calls++; return !fences_held; }
+		void DeleteFence(uint64_t fence) override { stats.calls++; }
+		void WaitFence(uint64_t fence) override { stats.calls++; }
+		/* Results are ready at once and take no time unless set otherwise. */
+		uint32_t CreateTimerQuery() override { stats.calls++; return next_id++; }
+		void DeleteTimerQuery(uint32_t id) override { stats.calls++; }
+		void BeginTimerQuery(uint32_t id) override { stats.calls++; }
+		void EndTimerQuery() override { stats.calls++; }
+		bool GetTimerQueryResult(uint32_t id, uint64_t& nanoseconds) override { stats.calls++; nanoseconds = timer_result; return timer_available; }
+
+		void DrawIndexed(uint32_t index_count) override;
+		void DrawArraysInstanced(uint32_t vertex_count, uint32_t instance_count) override;
+		void DrawMultiIndirect(const void* indirect, uint32_t count, uint32_t stride) override;
+
+		uint32_t CreateBuffer() override;
+		void DeleteBuffer(uint32_t id) override;
+		void BindBuffer(BufferTarget target, uint32_t id) override { stats.calls++; }
+		void BufferData(BufferTarget target, uint32_t size, const void* data, BufferUsage usage) override;
+		void BufferSubData(BufferTarget target, uint32_t offset, uint32_t size, const void* data) override;
+		/* There is no memory to map, callers upload through the regular calls instead. */
+		void* MapBufferStorage(BufferTarget target, uint32_t size) override { stats.calls++; return nullptr; }
+		void BindBufferBase(BufferTarget target, uint32_t binding, uint32_t id) override { stats.calls++; }
+		void BindBufferRange(BufferTarget target, uint32_t binding, uint32_t id, uint32_t offset, uint32_t size) override { stats.calls++; }
+		uint32_t GetBlockIndex(uint32_t program, const char* name) override { stats.calls++; return 0; }
+		void SetUniformBlockBinding(uint32_t program, uint32_t block, uint32_t binding) override { stats.calls++; }
+		void SetStorageBlockBinding(uint32_t program, uint32_t block, uint32_t binding) override { stats.calls++; }
+
+		uint32_t CreateVertexArray() override;
+		void DeleteVertexArray(uint32_t id) override;
+		void BindVertexArray(uint32_t id) override { stats.calls++; }
+		void SetVertexAttribute(uint32_t index, uint32_t size, VertexShaderType type, bool normalized, uint32_t stride, size_t offset) override { stats.calls++; }
+		void EnableVertexAttribute(uint32_t index) override { stats.calls++; }
+
+		uint32_t CreateProgram(const ShaderSources& sources) override;
+		void DeleteProgram(uint32_t program) override;
+		void UseProgram(uint32_t program) override { stats.calls++; }
+		int32_t GetUniformLocation(uint32_t program, const char* name) override { stats.calls++; return 0; }
+		void GetUniformNames(uint32_t program, std::vector<std::string>& names) override { stats.calls++; }
+		void SetUniformFloat(uint32_t program, int32_t location, float value) override { stats.calls++; }
+		void SetUniformVec3(uint32_t program, int32_t location, const float* vec3) override { stats.calls++; }
+		void SetUniformMat4(uint32_t program, int32_t location, const float* mat4) override { stats.calls++; }
+		void SetUniformIntArray(uint32_t program, int32_t location, const int* values, uint32_t count) override { stats.calls++; }
+
+		uint32_t CreateTexture(uint32_t width, uint32_t height, TextureFormat format) override;
+		void DeleteTexture(uint32_t id) override;
+		void SetTextureData(uint32_t id, uint32_t width, uint32_t height, TextureFormat format, const void* data) override;
+		void SetTextureSubData(uint32_t id, int32_t x, int32_t y, uint32_t w, uint32_t h, TextureFormat format, uint32_t row_length, const void* data) override;
+		void BindTextureUnit(uint32_t slot, uint32_t id) override { stats.calls++; }
+		void BindTexture(uint32_t id) override { stats.calls++; }
+		void SetBoundTextureData(int32_t x, int32_t y, int32_t w, int32_t h, TextureFormat format, const void* pixels) override;
+		void ReadPixels(int32_t x, int32_t y, int32_t w, int32_t h, void* pixels) override;
+		uint32_t CreateFrameBuffer(uint32_t width, uint32_t height, uint32_t& color_attachment, uint32_t& depth_stencil_attachment) override;
+		void DeleteFrameBuffer(uint32_t id) override { stats.calls++; }
+		void BindFrameBuffer(uint32_t id) override { stats.calls++; }
+	protected:
+		RendererAPIStats stats;
+		uint32_t next_id = 1;
+		bool fences_held = false;
+		uint64_t timer_result = 0;
+		bool timer_available = true;
+	};
+
+	enum class RendererAPICallType {
+		Init, SetViewport, Clear, SetClearColor, SetPolygonMode, SetLineWidth, SetClipDistances, Finish,
+		InsertFence, IsFenceSignaled, DeleteFence, WaitFence,
+		CreateTimerQuery, DeleteTimerQuery, BeginTimerQuery, EndTimerQuery, GetTimerQueryResult,
+		DrawIndexed, DrawArraysInstanced, DrawMultiIndirect,
+		CreateBuffer, DeleteBuffer, BindBuffer, BufferData, BufferSubData, MapBufferStorage, BindBufferBase, BindBufferRange,
+		GetBlockIndex, SetUniformBlockBinding, SetStorageBlockBinding,
+		CreateVertexArray, DeleteVertexArray, BindVertexArray, SetVertexAttribute, EnableVertexAttribute,
+		CreateProgram, DeleteProgram, UseProgram, GetUniformLocation, GetUniformNames,
+		SetUniformFloat, SetUniformVec3, SetUniformMat4, SetUniformIntArray,
+		CreateTexture, DeleteTexture, SetTextureData, SetTextureSubData, BindTextureUnit, BindTexture, SetBoundTextureData, ReadPixels,
+		CreateFrameBuffer, DeleteFrameBuffer, BindFrameBuffer
+	};
+
+	/*
+	* Integer arguments (ids, targets, sizes, offsets, counts) in call order, float arguments in values, and a copy of
+	* any data uploaded. Ids a call returned are its last argument.
+	*/
+	struct RendererAPICall {
+		RendererAPICallType type;
+		uint32_t args[6] = {};
+		float values[4] = {};
+		std::vector<uint8_t> data;
+	};
+
+	/*
+	* Null backend that also keeps every call, for checking what the Renderer sent: the vertices it uploaded, the
+	* draw commands it built and the textures it bound.
+	*/
+	class RecordingRendererAPI : public NullRendererAPI {
+	public:
+		const std::vector<RendererAPICall>& GetCalls() const { return calls; }
+		uint32_t CountCalls(RendererAPICallType type) const;
+		/* Most recent call of the type, nullptr when there is none. */
+		const RendererAPICall* FindLast(RendererAPICallType type) const;
+		void ClearCalls() { calls.clear(); }
+
+		void Init() override;
+		void SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h) override;
+		void Clear() override;
+		void SetClearColor(float r, float g, float b, float a) override;
+		void SetPolygonMode(uint32_t face, uint32_t mode) override;
+		void SetLineWidth(float width) override;
+		void SetClipDistances(uint32_t count) override;
+		void Finish() override;
+		uint64_t InsertFence() override;
+		bool IsFenceSignaled(uint64_t fence) override;
+		void DeleteFence(uint64_t fence) override;
+		void WaitFence(uint64_t fence) override;
+		uint32_t CreateTimerQuery() override;
+		void DeleteTimerQuery(uint32_t id) override;
+		void BeginTimerQuery(uint32_t id) override;
+		void EndTimerQuery() override;
+		bool GetTimerQueryResult(uint32_t id, uint64_t& nanoseconds) override;
+
+		void DrawIndexed(uint32_t index_count) override;
+		void DrawArraysInstanced(uint32_t vertex_count, uint32_t instance_count) override;
+		void DrawMultiIndirect(const void* indirect, uint32_t count, uint32_t stride) override;
+
+		uint32_t CreateBuffer() override;
+		void DeleteBuffer(uint32_t id) override;
+		void BindBuffer(BufferTarget target, uint32_t id) override;
+		void BufferData(BufferTarget target, uint32_t size, const void* data, BufferUsage usage) override;
+		void BufferSubData(BufferTarget target, uint32_t offset, uint32_t size, const void* data) override;
+		void* MapBufferStorage(BufferTarget target, uint32_t size) override;
+		void BindBufferBase(BufferTarget target, uint32_t binding, uint32_t id) override;
+		void BindBufferRange(BufferTarget target, uint32_t binding, uint32_t id, uint32_t offset, uint32_t size) override;
+		uint32_t GetBlockIndex(uint32_t program, const char* name) override;
+		void SetUniformBlockBinding(uint32_t program, uint32_t block, uint32_t binding) override;
+		void SetStorageBlockBinding(uint32_t program, uint32_t block, uint32_t binding) override;
+
+		uint32_t CreateVertexArray() override;
+		void DeleteVertexArray(uint32_t id) override;
+		void BindVertexArray(uint32_t id) override;
+		void SetVertexAttribute(uint32_t index, uint32_t size, VertexShaderType type, bool normalized, uint32_t stride, size_t offset) override;
+		void EnableVertexAttribute(uint32_t index) override;
+
+		uint32_t CreateProgram(const ShaderSources& sources) override;
+		void DeleteProgram(uint32_t program) override;
+		void UseProgram(uint32_t program) override;
+		int32_t GetUniformLocation(uint32_t program, const char* name) override;
+		void GetUniformNames(uint32_t program, std::vector<std::string>& names) override;
+		void SetUniformFloat(uint32_t program, int32_t location, float value) override;
+		void SetUniformVec3(uint32_t program, int32_t location, const float* vec3) override;
+		void SetUniformMat4(uint32_t program, int32_t location, const float* mat4) override;
+		void SetUniformIntArray(uint32_t program, int32_t location, const int* values, uint32_t count) override;
+
+		uint32_t CreateTexture(uint32_t width, uint32_t height, TextureFormat format) override;
+		void DeleteTexture(uint32_t id) override;
+		void SetTextureData(uint32_t id, uint32_t width, uint32_t height, TextureFormat format, const void* data) override;
+		void SetTextureSubData(uint32_t id, int32_t x, int32_t y, uint32_t w, uint32_t h, TextureFormat format, uint32_t row_length, const void* data) override;
+		void BindTextureUnit(uint32_t slot, uint32_t id) override;
+		void BindTexture(uint32_t id) override;
+		void SetBoundTextureData(int32_t x, int32_t y, int32_t w, int32_t h, TextureFormat format, const void* pixels) override;
+		void ReadPixels(int32_t x, int32_t y, int32_t w, int32_t h, void* pixels) override;
+		uint32_t CreateFrameBuffer(uint32_t width, uint32_t height, uint32_t& color_attachment, uint32_t& depth_stencil_attachment) override;
+		void DeleteFrameBuffer(uint32_t id) override;
+		void BindFrameBuffer(uint32_t id) override;
+	private:
+		RendererAPICall& Record(RendererAPICallType type, std::initializer_list<uint32_t> args, const void* data = nullptr, size_t size = 0);
+
+		std::vector<RendererAPICall> calls;
+		/* Texture uploads read an offset instead of memory while a PixelUnpack buffer is bound. */
+		uint32_t unpack_buffer = 0;
+	};
+}
+
+#endif // !NULL_RENDERER_API_H
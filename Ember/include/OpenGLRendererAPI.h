@@ -0,0 +1,75 @@
+#ifndef OPENGL_RENDERER_API_H
+#define OPENGL_RENDERER_API_H
+
+#include "RendererAPI.h"
+
+namespace Ember {
+	class OpenGLRendererAPI : public RendererAPI {
+	public:
+		void Init() override;
+		void SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h) override;
+		void Clear() override;
+		void SetClearColor(float r, float g, float b, float a) override;
+		void SetPolygonMode(uint32_t face, uint32_t mode) override;
+		void SetLineWidth(float width) override;
+		void SetClipDistances(uint32_t count) override;
+		void Finish() override;
+		uint64_t InsertFence() override;
+		bool IsFenceSignaled(uint64_t fence) override;
+		void DeleteFence(uint64_t fence) override;
+		void WaitFence(uint64_t fence) override;
+		uint32_t CreateTimerQuery() override;
+		void DeleteTimerQuery(uint32_t id) override;
+		void BeginTimerQuery(uint32_t id) override;
+		void EndTimerQuery() override;
+		bool GetTimerQueryResult(uint32_t id, uint64_t& nanoseconds) override;
+
+		void DrawIndexed(uint32_t index_count) override;
+		void DrawArraysInstanced(uint32_t vertex_count, uint32_t instance_count) override;
+		void DrawMultiIndirect(const void* indirect, uint32_t count, uint32_t stride) override;
+
+		uint32_t CreateBuffer() override;
+		void DeleteBuffer(uint32_t id) override;
+		void BindBuffer(BufferTarget target, uint32_t id) override;
+		void BufferData(BufferTarget target, uint32_t size, const void* data, BufferUsage usage) override;
+		void BufferSubData(BufferTarget target, uint32_t offset, uint32_t size, const void* data) override;
+		void* MapBufferStorage(BufferTarget target, uint32_t size) override;
+		void BindBufferBase(BufferTarget target, uint32_t binding, uint32_t id) override;
+		void BindBufferRange(BufferTarget target, uint32_t binding, uint32_t id, uint32_t offset, uint32_t size) override;
+		uint32_t GetBlockIndex(uint32_t program, const char* name) override;
+		void SetUniformBlockBinding(uint32_t program, uint32_t block, uint32_t binding) override;
+		void SetStorageBlockBinding(uint32_t program, uint32_t block, uint32_t binding) override;
+
+		uint32_t CreateVertexArray() override;
+		void DeleteVertexArray(uint32_t id) override;
+		void BindVertexArray(uint32_t id) override;
+		void SetVertexAttribute(uint32_t index, uint32_t size, VertexShaderType type, bool normalized, uint32_t stride, size_t offset) override;
+		void EnableVertexAttribute(uint32_t index) override;
+
+		uint32_t CreateProgram(const ShaderSources& sources) override;
+		void DeleteProgram(uint32_t program) override;
+		void UseProgram(uint32_t program) override;
+		int32_t GetUniformLocation(uint32_t program, const char* name) override;
+		void GetUniformNames(uint32_t program, std::vector<std::string>& names) override;
+		void SetUniformFloat(uint32_t program, int32_t location, float value) override;
+		void SetUniformVec3(uint32_t program, int32_t location, const float* vec3) override;
+		void SetUniformMat4(uint32_t program, int32_t location, const float* mat4) override;
+		void SetUniformIntArray(uint32_t program, int32_t location, const int* values, uint32_t count) override;
+
+		uint32_t CreateTexture(uint32_t width, uint32_t height, TextureFormat format) override;
+		void DeleteTexture(uint32_t id) override;
+		void SetTextureData(uint32_t id, uint32_t width, uint32_t height, TextureFormat format, const void* data) override;
+		void SetTextureSubData(uint32_t id, int32_t x, int32_t y, uint32_t w, uint32_t h, TextureFormat format, uint32_t row_length, const void* data) override;
+		void BindTextureUnit(uint32_t slot, uint32_t id) override;
+		void BindTexture(uint32_t id) override;
+		void SetBoundTextureData(int32_t x, int32_t y, int32_t w, int32_t h, TextureFormat format, const void* pixels) override;
+		void ReadPixels(int32_t x, int32_t y, int32_t w, int32_t h, void* pixels) override;
+		uint32_t CreateFrameBuffer(uint32_t width, uint32_t height, uint32_t& color_attachment, uint32_t& depth_stencil_attachment) override;
+		void DeleteFrameBuffer(uint32_t id) override;
+		void BindFrameBuffer(uint32_t id) override;
+	private:
+		uint32_t CompileShader(const std::string& source, uint32_t type);
+	};
+}
+
+#endif // !OPENGL_RENDERER_API_H
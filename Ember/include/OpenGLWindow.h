@@ -2,6 +2,7 @@
 #define OPENGL_WINDOW_H
 
 #include "SDLWindow.h"
+#include "FramePacer.h"
 
 #ifdef EMBER_OPENGL_ACTIVATED
 #include <glad/glad.h>
@@ -18,8 +19,17 @@ namespace Ember {
 		virtual ~OpenGLWindow();
 
 		virtual void Update() override;
+
+		const PresentStats& GetPresentStats() const { return pacer.GetStats(); }
 	private:
+		void ApplyPresentation(SwapInterval swap_interval, float max_frame_rate);
+		void Present();
+
 		SDL_GLContext glcontext;
+		FramePacer pacer;
+
+		SwapInterval applied_swap_interval = SwapInterval::VSync;
+		float applied_max_frame_rate = 0.0f;
 	};
 }
 
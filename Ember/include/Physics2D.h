@@ -0,0 +1,253 @@
+#ifndef PHYSICS_2D_H
+#define PHYSICS_2D_H
+
+#include "SpatialGrid.h"
+
+#include <glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Ember {
+	class SnapshotHistory;
+
+	constexpr uint32_t PHYSICS_MAX_POLYGON_VERTICES = 24;
+	constexpr uint32_t PHYSICS_MAX_MANIFOLD_POINTS = 2;
+
+	/*
+	* Convex polygon in counter clockwise order around its centroid, which is the body origin. FromPoints takes any
+	* point cloud (e.g. a model outline), keeps its convex hull and moves it so the centroid sits at the origin; the
+	* offset removed is kept in centroid.
+	*/
+	struct PolygonShape {
+		glm::vec2 vertices[PHYSICS_MAX_POLYGON_VERTICES];
+		glm::vec2 normals[PHYSICS_MAX_POLYGON_VERTICES];
+		uint32_t count = 0;
+
+		glm::vec2 centroid = { 0.0f, 0.0f };
+		float area = 0.0f;
+		/* Second moment of area about the centroid, multiply by density for the inertia. */
+		float inertia = 0.0f;
+		float radius = 0.0f;
+
+		static PolygonShape FromPoints(const glm::vec2* points, uint32_t count);
+	};
+
+	struct BodyHandle {
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0;
+
+		bool IsValid() const { return index != UINT32_MAX; }
+	};
+
+	/*
+	* Static bodies never move, kinematic bodies move with the velocity they are given and push dynamic bodies
+	* without being pushed back. Sensors collide with nothing but are reported in the contact events.
+	*/
+	enum class BodyType {
+		Static, Kinematic, Dynamic
+	};
+
+	struct BodyDefinition {
+		BodyType type = BodyType::Dynamic;
+		uint32_t shape = 0;
+		/* Uniform scale of the shape, lets one outline serve bodies of different sizes. */
+		float scale = 1.0f;
+
+		glm::vec2 position = { 0.0f, 0.0f };
+		float angle = 0.0f;
+		glm::vec2 velocity = { 0.0f, 0.0f };
+		float angular_velocity = 0.0f;
+
+		float density = 1.0f;
+		float friction = 0.4f;
+		float restitution = 0.0f;
+		bool sensor = false;
+
+		uint32_t category = 0x0001;
+		uint32_t mask = 0xFFFFFFFF;
+		uint64_t user_data = 0;
+	};
+
+	struct RigidBody {
+		glm::vec2 position = { 0.0f, 0.0f };
+		float angle = 0.0f;
+		glm::vec2 velocity = { 0.0f, 0.0f };
+		float angular_velocity = 0.0f;
+
+		float inv_mass = 0.0f;
+		float inv_inertia = 0.0f;
+		float friction = 0.0f;
+		float restitution = 0.0f;
+		float scale = 1.0f;
+		uint32_t shape = 0;
+
+		BodyType type = BodyType::Dynamic;
+		bool sensor = false;
+		bool awake = true;
+		float sleep_time = 0.0f;
+
+		uint32_t category = 0;
+		uint32_t mask = 0;
+		uint64_t user_data = 0;
+
+		glm::vec4 bounds = glm::vec4(0.0f);
+		uint32_t island = UINT32_MAX;
+		uint32_t generation = 0;
+		bool active = false;
+	};
+
+	struct ContactPoint {
+		glm::vec2 point;
+		float separation;
+		uint32_t feature;
+
+		float normal_impulse;
+		float tangent_impulse;
+
+		glm::vec2 offset_a;
+		glm::vec2 offset_b;
+		float normal_mass;
+		float tangent_mass;
+		float velocity_bias;
+	};
+
+	struct ContactManifold {
+		uint32_t body_a;
+		uint32_t body_b;
+		/* Points from body_a towards body_b. */
+		glm::vec2 normal;
+		uint32_t point_count;
+		ContactPoint points[PHYSICS_MAX_MANIFOLD_POINTS];
+		float friction;
+		float restitution;
+	};
+
+	struct ContactEvent {
+		BodyHandle a;
+		BodyHandle b;
+		glm::vec2 point;
+		glm::vec2 normal;
+	};
+
+	/*
+	* Velocities and times are in the units of the dt passed to Step, lengths in world units. The defaults suit a
+	* world measured in pixels stepped in seconds.
+	*/
+	struct PhysicsSettings {
+		glm::vec2 gravity = { 0.0f, 0.0f };
+		uint32_t velocity_iterations = 8;
+		float baumgarte = 0.2f;
+		float linear_slop = 0.5f;
+		float restitution_threshold = 1.0f;
+
+		bool allow_sleep = true;
+		float sleep_linear_velocity = 2.0f;
+		float sleep_angular_velocity = 0.05f;
+		float time_to_sleep = 0.5f;
+
+		float cell_size = 128.0f;
+		/* Pairs and islands handed to each job. */
+		uint32_t narrowphase_batch = 256;
+		uint32_t island_batch = 16;
+	};
+
+	struct PhysicsStats {
+		uint32_t bodies = 0;
+		uint32_t awake_bodies = 0;
+		uint32_t pairs = 0;
+		uint32_t contacts = 0;
+		uint32_t islands = 0;
+		float step_time = 0.0f;
+	};
+
+	/*
+	* 2D rigid body world: spatial grid broadphase, SAT narrowphase with clipped two point manifolds, and a sequential
+	* impulse solver with warm starting. Touching dynamic bodies are grouped into islands; islands are solved in
+	* parallel on the job system and fall asleep together once every body in them has been slow for time_to_sleep.
+	* Bodies can be moved directly through GetBody, WakeBody must be called when a sleeping body is changed.
+	*/
+	class PhysicsWorld {
+	public:
+		void Init(const PhysicsSettings& settings = PhysicsSettings());
+		void Destroy();
+
+		uint32_t AddShape(const PolygonShape& shape);
+		const PolygonShape& GetShape(uint32_t shape) const { return shapes[shape]; }
+
+		BodyHandle CreateBody(const BodyDefinition& definition);
+		void DestroyBody(BodyHandle& handle);
+		void Clear();
+
+		RigidBody* GetBody(BodyHandle handle);
+		BodyHandle GetHandle(uint32_t index) const { return { index, bodies[index].generation }; }
+		void WakeBody(BodyHandle handle);
+
+		void Step(float dt);
+
+		/* Pairs that started touching during the last step, sensors included. */
+		const std::vector<ContactEvent>& GetContactEvents() const { return contact_events; }
+		const std::vector<ContactManifold>& GetManifolds() const { return manifolds; }
+		const PhysicsStats& GetStats() const { return stats; }
+		PhysicsSettings& GetSettings() { return settings; }
+
+		/* Registers everything that carries over between steps, the rest is rebuilt by Step. Shapes are not included. */
+		void RegisterState(SnapshotHistory& history);
+	private:
+		struct BodyPair {
+			uint32_t a;
+			uint32_t b;
+		};
+
+		struct CachedPoint {
+			uint32_t feature;
+			float normal_impulse;
+			float tangent_impulse;
+		};
+
+		struct CachedManifold {
+			uint64_t key;
+			uint32_t point_count;
+			CachedPoint points[PHYSICS_MAX_MANIFOLD_POINTS];
+		};
+
+		static uint64_t PairKey(uint32_t a, uint32_t b) { return ((uint64_t)a << 32) | b; }
+		const CachedManifold* FindCached(uint64_t key) const;
+		static bool IsMoving(const RigidBody& body) { return (body.type == BodyType::Dynamic && body.awake) || body.type == BodyType::Kinematic; }
+
+		void UpdateBounds(RigidBody& body);
+		bool ShouldCollide(const RigidBody& a, const RigidBody& b) const;
+		void Collide(ContactManifold& manifold) const;
+
+		void BuildIslands();
+		void SolveIsland(uint32_t island, float dt);
+		void PrepareContacts(ContactManifold& manifold, float dt);
+		void SolveContacts(ContactManifold& manifold);
+
+		uint32_t FindRoot(uint32_t body);
+
+		PhysicsSettings settings;
+		std::vector<PolygonShape> shapes;
+		std::vector<RigidBody> bodies;
+		std::vector<uint32_t> free_bodies;
+		std::vector<uint32_t> released_bodies;
+		uint32_t body_count = 0;
+
+		SpatialGrid grid;
+		std::vector<BodyPair> pairs;
+		std::vector<ContactManifold> manifolds;
+		std::vector<ContactEvent> contact_events;
+		/* Sorted by key, plain vectors so the cache can be snapshotted. */
+		std::vector<CachedManifold> cache;
+		std::vector<CachedManifold> next_cache;
+
+		std::vector<uint32_t> island_parents;
+		std::vector<uint32_t> island_body_starts;
+		std::vector<uint32_t> island_bodies;
+		std::vector<uint32_t> island_contact_starts;
+		std::vector<uint32_t> island_contacts;
+
+		PhysicsStats stats;
+	};
+}
+
+#endif // !PHYSICS_2D_H
@@ -0,0 +1,49 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Font.h"
+#include <glm.hpp>
+#include <cstdint>
+
+namespace Ember {
+	constexpr size_t MAX_PROFILER_ENTRIES = 64;
+	constexpr size_t MAX_PROFILER_NAME_LENGTH = 48;
+
+	enum class ProfilerUnit {
+		Count, Milliseconds, Bytes
+	};
+
+	struct ProfilerEntry {
+		char name[MAX_PROFILER_NAME_LENGTH] = { };
+		double value = 0.0;
+		ProfilerUnit unit = ProfilerUnit::Count;
+	};
+
+	class Profiler {
+	public:
+		/*
+		* Names are copied, truncated to MAX_PROFILER_NAME_LENGTH - 1 characters.
+		*/
+		static void SetValue(const char* name, double value, ProfilerUnit unit = ProfilerUnit::Count);
+		static void AddValue(const char* name, double value, ProfilerUnit unit = ProfilerUnit::Count);
+		static double GetValue(const char* name);
+
+		static size_t GetEntries(ProfilerEntry* entries, size_t max_entries);
+
+		/*
+		* Draws every entry and the per-tag memory counters as text. Expects to be called inside a scene that uses a text shader.
+		*/
+		static void DrawOverlay(Font* font, const glm::vec2& position, const glm::vec2& scale, const glm::vec4& color);
+	};
+
+	class ProfileScope {
+	public:
+		ProfileScope(const char* name);
+		~ProfileScope();
+	private:
+		const char* name;
+		uint64_t start;
+	};
+}
+
+#endif // !PROFILER_H
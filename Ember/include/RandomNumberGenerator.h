@@ -2,12 +2,50 @@
 #define RANDOM_GENERATOR_H
 
 #include <random>
+#include <cstdint>
 
 namespace Ember {
+	/*
+	* PCG32: 16 bytes of state, so the shared generator can be saved and restored with a plain copy (see
+	* SnapshotHistory). Usable with the <random> distributions.
+	*/
+	class RandomEngine {
+	public:
+		using result_type = uint32_t;
+
+		RandomEngine(uint64_t seed = 0x853C49E6748FEA9Bull) { Seed(seed); }
+
+		void Seed(uint64_t seed) {
+			state = 0;
+			increment = 0xDA3E39CB94B95BDBull;
+			(*this)();
+			state += seed;
+			(*this)();
+		}
+
+		result_type operator()() {
+			uint64_t old_state = state;
+			state = old_state * 6364136223846793005ull + increment;
+			uint32_t shifted = (uint32_t)(((old_state >> 18u) ^ old_state) >> 27u);
+			uint32_t rotation = (uint32_t)(old_state >> 59u);
+			return (shifted >> rotation) | (shifted << ((0u - rotation) & 31u));
+		}
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return UINT32_MAX; }
+	private:
+		uint64_t state;
+		uint64_t increment;
+	};
+
 	class RandomGenerator {
 	public:
 		static int GenRandom(int min, int max);
 		static double GenRandom(double min, double max);
+
+		/* Seeded from std::random_device at startup; seed explicitly for reproducible runs. */
+		static void Seed(uint64_t seed);
+		static RandomEngine& GetEngine();
 	};
 }
 
@@ -0,0 +1,99 @@
+#ifndef RENDER_CAPTURE_H
+#define RENDER_CAPTURE_H
+
+#include "Camera.h"
+#include "Transform2D.h"
+
+#include <glm.hpp>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace Ember {
+	class Font;
+	class Shader;
+	class Texture;
+	struct RenderView;
+
+	constexpr uint32_t RENDER_TRACE_MAGIC = 0x54524D45;
+	/* Version 2 added BeginViews, version 3 Shape, older traces still load. */
+	constexpr uint16_t RENDER_TRACE_VERSION = 3;
+
+	enum class RenderTraceOp : uint8_t {
+		DefineShader, DefineFont, BeginScene, EndScene, SetShader, Quad, Line, Text, EndFrame, BeginViews, Shape
+	};
+
+	/*
+	* Records the Renderer calls of whole frames into a binary trace: scenes with their camera matrices, shader changes,
+	* 2D quads (every DrawQuad form that ends up as a 2D transform), lines, analytic shapes and text, and frame ends.
+	* Shaders and fonts are written once, the first time a frame uses them: shaders by the path they were loaded from,
+	* fonts with their glyph metrics so the trace replays without the font file. Cubes, triangles and quads given as a
+	* mat4 are not recorded.
+	* Recording happens where the Renderer executes, so with the render thread the trace is written there too.
+	*/
+	class RenderCapture {
+	public:
+		/* Captures until End, or until frame_count frames ended when it is not 0. */
+		static void Begin(const char* path, uint32_t frame_count = 0);
+		static void End();
+		static bool IsCapturing();
+
+		/* A single view over the whole viewport is written as a plain BeginScene. */
+		static void RecordBeginScene(const RenderView* views, uint32_t view_count, int flags);
+		static void RecordEndScene();
+		/* nullptr for the default shader. */
+		static void RecordShader(Shader* shader);
+		static void RecordQuad(const Transform2D& transform, float z, const glm::vec4& color, uint32_t texture, const glm::vec2 tex_coords[]);
+		static void RecordLine(const glm::vec2& p1, const glm::vec2& p2, const glm::vec4& color, float width);
+		static void RecordShape(const Transform2D& transform, float z, const glm::vec4& color, const glm::vec4& shape);
+		static void RecordText(Font* font, const char* text, const glm::vec2& pos, const glm::vec2& scale, const glm::vec4& color);
+		static void RecordEndFrame();
+	};
+
+	/*
+	* Plays a trace back through the Renderer. Shaders are loaded again from their recorded paths, relative to the
+	* working directory. Recorded texture ids only matter to batching, each distinct id is replayed as its own 1x1
+	* white texture so batches break exactly where they did in the game.
+	*/
+	class RenderReplay {
+	public:
+		~RenderReplay();
+
+		bool Load(const char* path);
+		void Destroy();
+
+		/* Runs the frame's scenes and calls Renderer::EndFrame. */
+		void ReplayFrame(uint32_t frame);
+
+		uint32_t GetFrameCount() const { return (uint32_t)frame_offsets.size(); }
+		uint32_t GetCommandCount() const { return command_count; }
+		size_t GetTraceBytes() const { return data.size(); }
+	private:
+		/* Past the end it returns zeros and leaves offset past the end, which Load reports as a truncated trace. */
+		template<typename T>
+		T Read(size_t& offset) const {
+			T value{};
+			if (offset + sizeof(T) <= data.size())
+				memcpy(&value, data.data() + offset, sizeof(T));
+			offset += sizeof(T);
+			return value;
+		}
+
+		/* nullptr, with offset past the end, when the string is cut off. */
+		const char* ReadString(size_t& offset) const;
+		uint32_t GetTexture(uint32_t recorded);
+
+		std::vector<uint8_t> data;
+		std::vector<size_t> frame_offsets;
+		uint32_t command_count = 0;
+
+		std::vector<std::unique_ptr<Shader>> shaders;
+		std::vector<std::unique_ptr<Font>> fonts;
+		std::vector<uint32_t> recorded_textures;
+		std::vector<std::unique_ptr<Texture>> textures;
+		Camera camera;
+	};
+}
+
+#endif // !RENDER_CAPTURE_H
@@ -0,0 +1,137 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include "Memory.h"
+#include "Window.h"
+
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Ember {
+	constexpr size_t DEFAULT_RENDER_QUEUE_SIZE = 256 * 1024;
+	constexpr uint32_t RENDER_THREAD_FRAME_COUNT = 2;
+
+	/*
+	* List of deferred calls recorded into a linear arena. Commands capture their arguments by value, anything that
+	* points at caller memory (strings, texture coordinate arrays) has to be copied into the queue first.
+	*/
+	class RenderCommandQueue {
+	public:
+		RenderCommandQueue() = default;
+		~RenderCommandQueue() { Destroy(); }
+
+		RenderCommandQueue(const RenderCommandQueue&) = delete;
+		RenderCommandQueue& operator=(const RenderCommandQueue&) = delete;
+
+		template<typename F>
+		void Submit(F&& func) {
+			using Command = typename std::decay<F>::type;
+
+			CommandHeader* header = arena.Allocate<CommandHeader>();
+			header->data = new (arena.Allocate<Command>()) Command(std::forward<F>(func));
+			header->invoke = [](void* data, bool execute) {
+				Command* command = static_cast<Command*>(data);
+				if (execute)
+					(*command)();
+				command->~Command();
+			};
+			header->next = nullptr;
+
+			if (tail)
+				tail->next = header;
+			else
+				head = header;
+			tail = header;
+			command_count++;
+		}
+
+		void Init(size_t capacity = DEFAULT_RENDER_QUEUE_SIZE);
+		void Destroy();
+
+		const char* CopyString(const char* text);
+
+		template<typename T>
+		const T* CopyArray(const T* data, size_t count) {
+			T* copy = arena.Allocate<T>(count);
+			memcpy(copy, data, sizeof(T) * count);
+			return copy;
+		}
+
+		/*
+		* Runs every command in submission order and empties the queue. Clear drops the commands without running them.
+		*/
+		void Execute();
+		void Clear();
+
+		uint32_t GetCommandCount() const { return command_count; }
+		size_t GetUsedBytes() const { return arena.GetUsed(); }
+	private:
+		struct CommandHeader {
+			void (*invoke)(void* data, bool execute);
+			void* data;
+			CommandHeader* next;
+		};
+
+		void Reset();
+
+		LinearArena arena;
+		CommandHeader* head = nullptr;
+		CommandHeader* tail = nullptr;
+		uint32_t command_count = 0;
+	};
+
+	/*
+	* Optional mode where a dedicated thread owns the GL context. While it runs, Renderer and RendererCommand calls made
+	* on the game thread are recorded instead of executed, EndFrame hands the frame over and the render thread replays
+	* it while the game simulates the next one. The game is never more than one frame ahead of the GPU submission.
+	*
+	* GL objects (textures, shaders, fonts) must be created before Start or after Stop, or through Submit. They can be
+	* destroyed anywhere, GPUResources defers the deletion to the render thread.
+	*/
+	class RenderThread {
+	public:
+		static void Start(Window* window);
+		static void Stop();
+
+		static bool IsActive();
+		static bool IsRecording();
+
+		/*
+		* Blocks until the frame slot the game is about to record into has been consumed by the render thread.
+		*/
+		static void BeginFrame();
+
+		/*
+		* The input timestamp is the Clock::Now() value taken when the frame's events were polled.
+		*/
+		static void EndFrame(uint64_t input_timestamp);
+
+		static RenderCommandQueue& GetRecordQueue();
+
+		template<typename F>
+		static void Submit(F&& func) { GetRecordQueue().Submit(std::forward<F>(func)); }
+
+		static const char* CopyString(const char* text) { return GetRecordQueue().CopyString(text); }
+		template<typename T>
+		static const T* CopyArray(const T* data, size_t count) { return GetRecordQueue().CopyArray(data, count); }
+
+		/*
+		* Time from the input poll of the last presented frame until its swap returned.
+		*/
+		static float GetInputLatency();
+
+		/*
+		* Publishers copy state the game thread reads back (like the Renderer's stats) once a frame has been replayed,
+		* on the render thread and under the frame mutex, and once on Start. The game thread reads the copies under
+		* LockPublished, so it never sees what the replay of the next frame is changing.
+		*/
+		static void AddPublisher(void (*publish)());
+		static void RemovePublisher(void (*publish)());
+		static std::unique_lock<std::mutex> LockPublished();
+	};
+}
+
+#endif // !RENDER_THREAD_H
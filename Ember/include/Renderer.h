@@ -7,6 +7,7 @@
 #include "Camera.h"
 #include "Material.h"
 #include "Font.h"
+#include "Transform2D.h"
 
 namespace Ember {
 	struct Vertex {
@@ -15,18 +16,25 @@ namespace Ember {
 		glm::vec2 texture_coordinates;
 		float texture_id;
 		float material_id;
+		/*
+		* Half width, half height, corner radius and outline width of an analytic shape in world units, zero for
+		* everything else. Shape vertices carry their position in the shape in texture_coordinates.
+		*/
+		glm::vec4 shape;
 	};
 
 	constexpr size_t MAX_QUAD_COUNT = 100000;
 	constexpr size_t QUAD_VERTEX_COUNT = 4;
 	constexpr size_t MAX_VERTEX_COUNT = MAX_QUAD_COUNT * QUAD_VERTEX_COUNT;
-	constexpr size_t MAX_INDEX_COUNT = MAX_QUAD_COUNT * 6;
+	constexpr size_t QUAD_INDEX_COUNT = 6;
+	constexpr size_t MAX_INDEX_COUNT = MAX_QUAD_COUNT * QUAD_INDEX_COUNT;
 	constexpr size_t CUBE_FACES = 6;
 	constexpr size_t MAX_TEXTURE_SLOTS = 32;
 	constexpr size_t MAX_DRAW_COMMANDS = 1000;
 	constexpr size_t MAX_INSTANCE_COUNT = 10000;
 	constexpr size_t MAX_MATERIAL_COUNT = 64;
 	constexpr size_t MAX_LIGHT_COUNT = 64;
+	constexpr size_t MAX_VIEW_COUNT = 4;
 	constexpr glm::vec2 TEX_COORDS[] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
 	constexpr glm::vec4 QUAD_POSITIONS[QUAD_VERTEX_COUNT] = {
 		{ -0.5f, -0.5f, 0.0f, 1.0f },
@@ -52,13 +60,72 @@ namespace Ember {
 		{ -0.5f, -0.5f, -1.0f }, { 0.5f, -0.5f, -1.0f }, { 0.5f,  -0.5f, 0.0f }, { -0.5f,  -0.5f, 0.0f }
 	};
 
+	/*
+	* Batch storage starts at the initial sizes and doubles whenever a scene outgrows it, up to max_quad_count quads
+	* per batch (beyond that the batch is flushed). After shrink_after_scenes scenes that used under a quarter of the
+	* storage it is halved again, never below the initial size.
+	*/
+	struct RendererCapacity {
+		size_t initial_quad_count = 1024;
+		size_t max_quad_count = MAX_QUAD_COUNT;
+		size_t initial_draw_commands = 16;
+		uint32_t shrink_after_scenes = 600;
+	};
+
+	struct RendererCapacityStats {
+		uint32_t vertex_capacity = 0;
+		uint32_t index_capacity = 0;
+		uint32_t draw_command_capacity = 0;
+		uint32_t gpu_vertex_bytes = 0;
+		uint32_t gpu_index_bytes = 0;
+	};
+
+	struct RendererStats {
+		uint32_t primitives = 0;
+		uint32_t culled_primitives = 0;
+		uint32_t batches = 0;
+		/* Nanoseconds spent uploading and drawing batches, the rest of a scene is building them. */
+		uint64_t submit_time = 0;
+	};
+
+	/*
+	* A camera of a multi view scene and the part of the viewport it draws into: x, y, width and height as fractions of
+	* the viewport from its bottom left corner. Later views are drawn in front of earlier ones.
+	*/
+	struct RenderView {
+		Camera camera;
+		glm::vec4 viewport = { 0.0f, 0.0f, 1.0f, 1.0f };
+	};
+
+	/* One entry of the view array in the GlobalMatrices shader storage buffer, see default_shader.glsl. */
+	struct ShaderView {
+		glm::mat4 proj_view;
+		glm::vec4 viewport;
+		/* Near and far end of the view's share of the depth range, from 0 to 1. x and y are used. */
+		glm::vec4 depth_range;
+	};
+
+	/*
+	* Scenes with an orthographic camera reject quads, lines, triangles and glyphs that fall outside the camera's
+	* visible rectangle before their vertices are written, unless NoCulling is set. Cubes and perspective scenes are
+	* never culled.
+	*/
 	enum RenderFlags {
-		None = 0x01, TopLeftCornerPos = 0x02, PolygonMode = 0x04
+		None = 0x01, TopLeftCornerPos = 0x02, PolygonMode = 0x04, NoCulling = 0x08
+	};
+
+	/*
+	* Compile time options of the templated DrawQuad. Each combination only computes the transform terms it needs:
+	* DrawTopLeft treats the position as the top left corner instead of the center, DrawRotated rotates around the
+	* center and DrawTextured samples the texture.
+	*/
+	enum DrawFlags {
+		DrawCentered = 0x00, DrawTopLeft = 0x01, DrawRotated = 0x02, DrawTextured = 0x04
 	};
 
 	class Renderer {
 	public:
-		static void Init();
+		static void Init(const RendererCapacity& capacity = RendererCapacity());
 		static void Destroy();
 
 		static void SetShaderToDefualt();
@@ -68,8 +135,41 @@ namespace Ember {
 		static void SetPolygonLineThickness(float thickness);
 
 		static uint32_t GetShaderId();
+		static RendererCapacityStats GetCapacityStats();
+
+		/*
+		* Counters of the last finished frame, EndFrame publishes them to the profiler and starts a new frame. With the
+		* render thread both stats are those of the last frame it replayed.
+		*/
+		static RendererStats GetStats();
+		static void EndFrame();
+
+		/*
+		* With submission disabled batches are built and counted but never uploaded or drawn, which leaves only the CPU
+		* side of the renderer to measure.
+		*/
+		static void SetSubmitEnabled(bool enabled);
+
+		/*
+		* World space rectangle (min x, min y, max x, max y) seen by an orthographic camera. Returns false for other
+		* projections.
+		*/
+		static bool GetViewBounds(const Camera& camera, glm::vec4& bounds);
+
+		/*
+		* Tests bounds packed as (min x, min y, max x, max y) against the camera's view four at a time and writes the
+		* indices of the visible ones in order. visible_indices must hold count entries. Returns the visible count.
+		*/
+		static uint32_t CullBounds(const Camera& camera, const glm::vec4* bounds, uint32_t count, uint32_t* visible_indices);
 
 		static void BeginScene(Camera& camera, int flags = RenderFlags::None);
+		/*
+		* Builds the batches once and draws every batch into all views, as instances of the same draw commands, so an
+		* extra view (a minimap, split screen) costs GPU time but no vertices. The shader picks the view by
+		* gl_InstanceID and writes four clip distances to keep it in its rectangle, like default_shader.glsl does.
+		* Culling keeps what any of the views can see. At most MAX_VIEW_COUNT views.
+		*/
+		static void BeginScene(const RenderView* views, uint32_t view_count, int flags = RenderFlags::None);
 		static void EndScene();
 		static void NewBatch();
 		 
@@ -91,18 +191,59 @@ namespace Ember {
 		static void DrawCube(const glm::mat4& translation, const glm::vec4& color, float texture_id, const glm::vec2 tex_coords[]);
 
 		static void DrawQuad(const glm::mat4& translation, const glm::vec4& color, float texture_id, const glm::vec2 tex_coords[]);
+		static void DrawQuad(const Transform2D& transform, float z, const glm::vec4& color, Texture* texture = nullptr, const glm::vec2 tex_coords[] = TEX_COORDS);
+
+		/*
+		* Ember::Renderer::DrawQuad<DrawTopLeft | DrawRotated>(position, size, angle, color);
+		* rotation is in degrees and ignored without DrawRotated, texture and tex_coords are ignored without DrawTextured.
+		*/
+		template<int Flags>
+		static void DrawQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color, Texture* texture = nullptr, const glm::vec2 tex_coords[] = TEX_COORDS);
 		static void DrawTriangle(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color);
 		static void DrawTriangle(const glm::vec3& position, float rotation, const glm::vec3& rotation_orientation, const glm::vec2& size, const glm::vec4& color);
 	
 		static void DrawLine(const glm::vec2& p1, const glm::vec2& p2, const glm::vec4& color, float width = 1.0f);
 
+		/*
+		* Analytic shapes: one quad each, in the same batches as everything else, whose fragments evaluate the signed
+		* distance to a rounded rectangle. Edges fade over the pixel centered on them at any zoom, the quad is a pixel
+		* larger than the shape for that (in orthographic scenes after a RendererCommand::SetViewport). Sizes are in
+		* world units, centers ignore TopLeftCornerPos.
+		*/
+		static void DrawCircle(const glm::vec3& center, float radius, const glm::vec4& color);
+		/* The ring is thickness wide, inside radius. */
+		static void DrawRing(const glm::vec3& center, float radius, float thickness, const glm::vec4& color);
+		/* Placed like DrawQuad, rotation in degrees. corner_radius is at most half the shorter side. */
+		static void DrawRoundedRect(const glm::vec3& position, const glm::vec2& size, float corner_radius, const glm::vec4& color, float rotation = 0.0f);
+		/* A line with round caps, radius is half its width. It is flat, at the depth halfway between the ends. */
+		static void DrawCapsule(const glm::vec3& p1, const glm::vec3& p2, float radius, const glm::vec4& color);
+
 		static void RenderText(Font* font, const std::string& text, const glm::vec2& pos, const glm::vec2& scale, const glm::vec4& color);
+		static void RenderText(Font* font, const char* text, const glm::vec2& pos, const glm::vec2& scale, const glm::vec4& color);
 
 		static void GoToNextDrawCommand();
 		static void MakeCommand();
 	private:
+		friend class RenderReplay;
+
 		static void StartBatch();
 		static void Render();
+		static void EnsureBatchCapacity(uint32_t vertex_count);
+		/* texture is a texture id, 0 for none. */
+		static void WriteQuad(const glm::vec4 positions[], const glm::vec4& color, uint32_t texture, const glm::vec2 tex_coords[], const glm::vec4& shape = glm::vec4(0.0f));
+		/* The batch must already have room, texture_id is a slot of the current batch or -1. */
+		static void WriteQuadVertices(const glm::vec4 positions[], const glm::vec4& color, float texture_id, const glm::vec2 tex_coords[], const glm::vec4& shape);
+		static void SubmitShape(const Transform2D& transform, float z, const glm::vec4& color, const glm::vec4& shape);
+		static void SubmitQuad(const Transform2D& transform, float z, const glm::vec4& color, uint32_t texture, const glm::vec2 tex_coords[]);
+		static void BuildQuad(const Transform2D& transform, float z, const glm::vec4& color, uint32_t texture, const glm::vec2 tex_coords[]);
+		static void BuildQuad(const glm::mat4& translation, const glm::vec4& color, uint32_t texture, const glm::vec2 tex_coords[]);
+		static void WriteTriangle(const Transform2D& transform, float z, const glm::vec4& color);
+		static void WriteTriangle(const glm::vec4 positions[], const glm::vec4& color);
+		static void DrawScaledRotatedQuad(const glm::vec3& position, float rotation, const glm::vec3& rotation_orientation, const glm::vec2& size, uint32_t texture, const glm::vec2 tex_coords[], const glm::vec4& color);
+		static void AddCulledPrimitives(uint32_t count);
+		static void UpdateCapacity();
+		static void PublishStats();
+		static RendererCapacityStats ReadCapacityStats();
 
 		static float CalculateTextureIndex(Texture* texture);
 		static float CalculateTextureIndex(uint32_t id);
@@ -111,6 +252,26 @@ namespace Ember {
 	};
 
 	glm::vec3 CalculateVertexNormals(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+
+	template<int Flags>
+	void Renderer::DrawQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color, Texture* texture, const glm::vec2 tex_coords[]) {
+		static_assert((Flags & ~(DrawTopLeft | DrawRotated | DrawTextured)) == 0, "Unknown DrawFlags.");
+
+		glm::vec2 center = { position.x, position.y };
+		if constexpr ((Flags & DrawTopLeft) != 0)
+			center += size * 0.5f;
+
+		Transform2D transform;
+		if constexpr ((Flags & DrawRotated) != 0)
+			transform = Transform2D::TranslateRotateScale(center, glm::radians(rotation), size);
+		else
+			transform = Transform2D::TranslateScale(center, size);
+
+		if constexpr ((Flags & DrawTextured) != 0)
+			SubmitQuad(transform, position.z, color, texture->GetTextureId(), tex_coords);
+		else
+			SubmitQuad(transform, position.z, color, 0, TEX_COORDS);
+	}
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,145 @@
+#ifndef RENDERER_API_H
+#define RENDERER_API_H
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Ember {
+	enum class VertexShaderType;
+
+	enum class BufferTarget {
+		Vertex, Index, Uniform, Indirect, ShaderStorage, PixelUnpack
+	};
+
+	enum class BufferUsage {
+		Static, Dynamic
+	};
+
+	enum class ShaderStage : uint32_t {
+		Vertex, Fragment, Geometry, TessControl, TessEval
+	};
+
+	/* R8 is a single channel, font atlases use it. */
+	enum class TextureFormat {
+		RGB8, RGBA8, R8
+	};
+
+	/* Source of each stage in a shader file, keyed by ShaderStage. */
+	using ShaderSources = std::unordered_map<uint32_t, std::stringstream>;
+
+	uint32_t GetBytesPerPixel(TextureFormat format);
+
+	/*
+	* Every call the engine makes into the graphics API. The buffer classes, VertexArray, Shader, Texture,
+	* RendererCommand, Font and the Renderer only talk to the current backend, so the Renderer's CPU side (batching,
+	* texture slots, draw commands) runs on any backend. OpenGL is the default. Config and RenderBuffer still call
+	* OpenGL directly.
+	* Switch backends before anything is created with the old one, objects keep the ids their backend gave them.
+	*
+	* Backends are OpenGLRendererAPI, SoftwareRendererAPI, and NullRendererAPI with RecordingRendererAPI (no GPU,
+	* for tests and CPU timing). There is no Vulkan backend. This interface follows OpenGL, with bound state, integer ids
+	* and one command stream, while Vulkan needs command buffers recorded per thread, descriptor sets and SPIR-V
+	* shaders. The tree also vendors no Vulkan loader or GLSL to SPIR-V compiler. Adding one means reworking this
+	* interface first, not just adding another implementation.
+	*/
+	class RendererAPI {
+	public:
+		virtual ~RendererAPI() = default;
+
+		/* nullptr goes back to OpenGL. */
+		static void Set(RendererAPI* api);
+		static RendererAPI* Get() { return current; }
+
+		virtual void Init() = 0;
+		virtual void SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h) = 0;
+		virtual void Clear() = 0;
+		virtual void SetClearColor(float r, float g, float b, float a) = 0;
+		/* face and mode take the OpenGL values. */
+		virtual void SetPolygonMode(uint32_t face, uint32_t mode) = 0;
+		virtual void SetLineWidth(float width) = 0;
+		/* Clips against the first count gl_ClipDistance values the vertex stage writes, 0 turns clipping off. */
+		virtual void SetClipDistances(uint32_t count) = 0;
+		virtual void Finish() = 0;
+		/* Marks the current point of the command stream, IsFenceSignaled is true once the GPU has passed it. */
+		virtual uint64_t InsertFence() = 0;
+		virtual bool IsFenceSignaled(uint64_t fence) = 0;
+		virtual void DeleteFence(uint64_t fence) = 0;
+		/* Blocks until the GPU has passed the fence. */
+		virtual void WaitFence(uint64_t fence) = 0;
+		/* GPU time of the commands between Begin and End. Queries do not nest, the result arrives a few frames later. */
+		virtual uint32_t CreateTimerQuery() = 0;
+		virtual void DeleteTimerQuery(uint32_t id) = 0;
+		virtual void BeginTimerQuery(uint32_t id) = 0;
+		virtual void EndTimerQuery() = 0;
+		/* False while the GPU has not finished the commands yet. */
+		virtual bool GetTimerQueryResult(uint32_t id, uint64_t& nanoseconds) = 0;
+
+		virtual void DrawIndexed(uint32_t index_count) = 0;
+		virtual void DrawArraysInstanced(uint32_t vertex_count, uint32_t instance_count) = 0;
+		virtual void DrawMultiIndirect(const void* indirect, uint32_t count, uint32_t stride) = 0;
+
+		virtual uint32_t CreateBuffer() = 0;
+		virtual void DeleteBuffer(uint32_t id) = 0;
+		virtual void BindBuffer(BufferTarget target, uint32_t id) = 0;
+		/* data may be nullptr to only allocate. */
+		virtual void BufferData(BufferTarget target, uint32_t size, const void* data, BufferUsage usage) = 0;
+		virtual void BufferSubData(BufferTarget target, uint32_t offset, uint32_t size, const void* data) = 0;
+		/*
+		* Gives the bound buffer immutable storage that stays mapped for writing until the buffer is deleted, writes are
+		* seen by commands issued after them. nullptr when the backend cannot map, the buffer is unusable then.
+		*/
+		virtual void* MapBufferStorage(BufferTarget target, uint32_t size) = 0;
+		virtual void BindBufferBase(BufferTarget target, uint32_t binding, uint32_t id) = 0;
+		virtual void BindBufferRange(BufferTarget target, uint32_t binding, uint32_t id, uint32_t offset, uint32_t size) = 0;
+		virtual uint32_t GetBlockIndex(uint32_t program, const char* name) = 0;
+		virtual void SetUniformBlockBinding(uint32_t program, uint32_t block, uint32_t binding) = 0;
+		virtual void SetStorageBlockBinding(uint32_t program, uint32_t block, uint32_t binding) = 0;
+
+		virtual uint32_t CreateVertexArray() = 0;
+		virtual void DeleteVertexArray(uint32_t id) = 0;
+		virtual void BindVertexArray(uint32_t id) = 0;
+		/* stride and offset in bytes. */
+		virtual void SetVertexAttribute(uint32_t index, uint32_t size, VertexShaderType type, bool normalized, uint32_t stride, size_t offset) = 0;
+		virtual void EnableVertexAttribute(uint32_t index) = 0;
+
+		/* Compiles and links every stage, compile errors are logged. */
+		virtual uint32_t CreateProgram(const ShaderSources& sources) = 0;
+		virtual void DeleteProgram(uint32_t program) = 0;
+		virtual void UseProgram(uint32_t program) = 0;
+		virtual int32_t GetUniformLocation(uint32_t program, const char* name) = 0;
+		virtual void GetUniformNames(uint32_t program, std::vector<std::string>& names) = 0;
+		virtual void SetUniformFloat(uint32_t program, int32_t location, float value) = 0;
+		virtual void SetUniformVec3(uint32_t program, int32_t location, const float* vec3) = 0;
+		virtual void SetUniformMat4(uint32_t program, int32_t location, const float* mat4) = 0;
+		virtual void SetUniformIntArray(uint32_t program, int32_t location, const int* values, uint32_t count) = 0;
+
+		virtual uint32_t CreateTexture(uint32_t width, uint32_t height, TextureFormat format) = 0;
+		virtual void DeleteTexture(uint32_t id) = 0;
+		virtual void SetTextureData(uint32_t id, uint32_t width, uint32_t height, TextureFormat format, const void* data) = 0;
+		/*
+		* A w by h rectangle at x, y, from rows row_length pixels apart. With a PixelUnpack buffer bound, data is the
+		* byte offset into it and the copy happens on the GPU.
+		*/
+		virtual void SetTextureSubData(uint32_t id, int32_t x, int32_t y, uint32_t w, uint32_t h, TextureFormat format, uint32_t row_length, const void* data) = 0;
+		virtual void BindTextureUnit(uint32_t slot, uint32_t id) = 0;
+		virtual void BindTexture(uint32_t id) = 0;
+		/* Pixels into the bound texture, and RGB pixels out of the framebuffer. */
+		virtual void SetBoundTextureData(int32_t x, int32_t y, int32_t w, int32_t h, TextureFormat format, const void* pixels) = 0;
+		virtual void ReadPixels(int32_t x, int32_t y, int32_t w, int32_t h, void* pixels) = 0;
+		/*
+		* A framebuffer with an RGBA8 color texture, sampled linearly and clamped to the edge, and a depth and stencil
+		* texture. Returns 0 when the backend cannot render to textures.
+		*/
+		virtual uint32_t CreateFrameBuffer(uint32_t width, uint32_t height, uint32_t& color_attachment, uint32_t& depth_stencil_attachment) = 0;
+		virtual void DeleteFrameBuffer(uint32_t id) = 0;
+		/* 0 is the window. */
+		virtual void BindFrameBuffer(uint32_t id) = 0;
+	private:
+		static RendererAPI* current;
+	};
+}
+
+#endif // !RENDERER_API_H
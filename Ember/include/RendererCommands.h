@@ -9,12 +9,16 @@ namespace Ember {
 		static void Init();
 
 		static void SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+		/* Width and height of the last viewport set, 0 before the first. */
+		static void GetViewportSize(uint32_t& width, uint32_t& height);
 		static void Clear();
 		static void SetClearColor(float r, float g, float b, float a);
 		static void DrawVertexArray(VertexArray* vertex_array); 
 		static void DrawVertexArrayInstanced(VertexArray* vertex_array, uint32_t instance_count);
 		static void DrawMultiIndirect(const void* indirect, uint32_t count, uint32_t stride);
 		static void PolygonMode(uint32_t face, uint32_t mode);
+		/* Blocks until the GPU has executed every submitted command. */
+		static void Finish();
 	};
 
 	struct DrawElementsCommand {
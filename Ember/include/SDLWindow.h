@@ -19,6 +19,8 @@ namespace Ember {
 		virtual inline void SetResizeable(bool resize) override { SDL_SetWindowResizable(native_window, ConvertToSDLBool(resize)); }
 		void AddWindowFlag(uint32_t flag) { window_flags |= flag; }
 		SDL_GLContext* Context() { return nullptr;  }
+
+		virtual void OnResized(int width, int height) override;
 	protected:
 		SDL_Window* native_window;
 
@@ -34,6 +36,7 @@ namespace Ember {
 		void UpdateWindowAttributes();
 	private:
 		uint32_t window_flags;
+		WindowProperties applied_properties;
 	};
 }
 
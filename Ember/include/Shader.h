@@ -1,14 +1,14 @@
 #ifndef OPENGL_SHADER_H
 #define OPENGL_SHADER_H
 
+#include "RendererAPI.h"
+
 #include <string>
 #include <memory>
 #include <glm.hpp>
 #include <unordered_map>
 
 namespace Ember {
-	using ShaderSources = std::unordered_map<uint32_t, std::stringstream>;
-
 	class Shader {
 	public:
 		Shader(const std::string& file_path);
@@ -20,6 +20,7 @@ namespace Ember {
 		void UnBind();
 
 		void Init(const std::string& file_path);
+		void Destroy();
 
 		/* Uniforms go here! */
 		void Set1f(const std::string& name, float value);
@@ -29,11 +30,11 @@ namespace Ember {
 
 		uint32_t GetUniformLocation(const std::string& name);
 		uint32_t GetId() const { return shader_id; }
+		const std::string& GetPath() const { return path; }
 	private:
-		uint32_t shader_id;
+		uint32_t shader_id = 0;
+		std::string path;
 		ShaderSources ParseShader(const std::string& file_path);
-		uint32_t CompileShader(const std::string& source, uint32_t type);
-		uint32_t CreateShader(const ShaderSources& shader_sources);
 	};
 }
 
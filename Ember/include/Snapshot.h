@@ -0,0 +1,113 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace Ember {
+	constexpr uint32_t SNAPSHOT_DEFAULT_FRAMES = 16;
+	constexpr size_t SNAPSHOT_DEFAULT_BUDGET = 4 * 1024 * 1024;
+	constexpr size_t SNAPSHOT_DEFAULT_PAGE_SIZE = 512;
+
+	struct SnapshotStats {
+		uint32_t frames = 0;
+		uint32_t pages_used = 0;
+		uint32_t page_capacity = 0;
+		size_t state_bytes = 0;
+		/* Pages the last capture had to copy, the rest were shared with the frame before. */
+		uint32_t last_new_pages = 0;
+		uint32_t last_shared_pages = 0;
+	};
+
+	/*
+	* Ring of whole simulation snapshots for rollback and rewind. State is registered as memory regions (plain values
+	* or vectors of trivially copyable types) and copied in fixed size pages; a page equal to the same page of the
+	* previous frame is shared instead of copied, so frames cost only the pages that changed. Pages come from a pool
+	* sized by the memory budget, the oldest frames are dropped when it runs out.
+	* Restore copies a frame back into the registered memory and drops every newer frame, so re-simulating from
+	* there captures fresh ones. Registering a region clears the history.
+	*/
+	class SnapshotHistory {
+	public:
+		void Init(uint32_t frame_count = SNAPSHOT_DEFAULT_FRAMES, size_t memory_budget = SNAPSHOT_DEFAULT_BUDGET, size_t page_size = SNAPSHOT_DEFAULT_PAGE_SIZE);
+		void Destroy();
+
+		void Register(void* data, size_t size, const char* name);
+
+		template<typename T>
+		void Register(T* value, const char* name) {
+			static_assert(std::is_trivially_copyable_v<T>, "Snapshot regions are copied as raw bytes.");
+			Register((void*)value, sizeof(T), name);
+		}
+
+		template<typename T, typename A>
+		void RegisterVector(std::vector<T, A>* vector, const char* name) {
+			static_assert(std::is_trivially_copyable_v<T>, "Snapshot regions are copied as raw bytes.");
+			AddRegion({ vector, 0, name, &VectorBytes<std::vector<T, A>>, &VectorData<std::vector<T, A>>, &VectorResize<std::vector<T, A>> });
+		}
+
+		bool Capture(uint64_t frame);
+		bool Restore(uint64_t frame);
+		void Clear();
+
+		bool HasFrame(uint64_t frame) const { return FindFrame(frame) != UINT32_MAX; }
+		/* Only meaningful while GetStats().frames > 0. */
+		uint64_t GetOldestFrame() const;
+		uint64_t GetLatestFrame() const;
+		const SnapshotStats& GetStats() const { return stats; }
+	private:
+		struct Region {
+			void* owner;
+			size_t size;
+			const char* name;
+
+			/* Set for vectors, whose size changes between frames. */
+			size_t (*bytes)(void* owner);
+			void* (*data)(void* owner);
+			void* (*resize)(void* owner, size_t bytes);
+		};
+
+		struct Frame {
+			uint64_t frame = 0;
+			bool valid = false;
+			std::vector<size_t> region_bytes;
+			std::vector<uint32_t> pages;
+		};
+
+		template<typename V>
+		static size_t VectorBytes(void* owner) { return ((V*)owner)->size() * sizeof(typename V::value_type); }
+		template<typename V>
+		static void* VectorData(void* owner) { return ((V*)owner)->data(); }
+		template<typename V>
+		static void* VectorResize(void* owner, size_t bytes) {
+			V* vector = (V*)owner;
+			vector->resize(bytes / sizeof(typename V::value_type));
+			return vector->data();
+		}
+
+		void AddRegion(const Region& region);
+		void ReleaseFrame(Frame& frame);
+		bool DropOldest();
+		uint32_t FindFrame(uint64_t frame) const;
+
+		uint8_t* GetPage(uint32_t page) { return page_data.data() + (size_t)page * page_size; }
+
+		std::vector<Region> regions;
+		std::vector<Frame> frames;
+		uint32_t latest = UINT32_MAX;
+
+		size_t page_size = SNAPSHOT_DEFAULT_PAGE_SIZE;
+		std::vector<uint8_t> page_data;
+		std::vector<uint32_t> page_references;
+		std::vector<uint32_t> free_pages;
+
+		/* Per capture scratch: the page chosen for each page of the state, UINT32_MAX where a copy is needed. */
+		std::vector<uint32_t> pending_pages;
+
+		SnapshotStats stats;
+	};
+}
+
+#endif // !SNAPSHOT_H
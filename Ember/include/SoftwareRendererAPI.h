@@ -0,0 +1,199 @@
+#ifndef SOFTWARE_RENDERER_API_H
+#define SOFTWARE_RENDERER_API_H
+
+#include "NullRendererAPI.h"
+
+#include <glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Ember {
+	constexpr uint32_t SOFTWARE_TILE_SIZE = 64;
+	constexpr uint32_t SOFTWARE_MAX_ATTRIBUTES = 8;
+	constexpr uint32_t SOFTWARE_TEXTURE_UNITS = 32;
+
+	struct SoftwareRasterStats {
+		/* Triangles that reached the tiles, after culling and clipping. */
+		uint32_t triangles = 0;
+		uint32_t clipped_triangles = 0;
+		/* Tiles that had at least one triangle binned to them. */
+		uint32_t tiles = 0;
+		uint64_t fragments = 0;
+	};
+
+	/*
+	* CPU backend for rendering without a GPU. It keeps what the Renderer uploads (buffers, the vertex layout and
+	* textures) and rasterizes its indexed draws into an RGBA8 color buffer with a depth buffer, in the state
+	* OpenGLRendererAPI::Init sets up: depth test with GL_LESS, and SRC_ALPHA, ONE_MINUS_SRC_ALPHA blending.
+	*
+	* Each draw transforms its vertices with the matrix in the shader storage buffer at binding 0, clips the triangles
+	* and bins them into SOFTWARE_TILE_SIZE tiles, which are rasterized in parallel on the JobSystem (inline without
+	* workers). Texture coordinates are perspective correct, color, texture index and shape are flat from the last
+	* vertex. Shapes get the default shader's edge coverage, with its derivatives taken once per triangle.
+	* Instance i of an indirect draw uses view i of the Renderer's ShaderView array instead, drawn into its part of the
+	* viewport, like the default shader's multi view path.
+	*
+	* Programs are not run. Every program is shaded like the default shader, except ones whose fragment stage only
+	* reads the red channel of its sample, like the text shader, which use it as coverage. Textures sample as
+	* OpenGLRendererAPI creates them. Polygon mode, line width and multisampling are ignored, triangles are filled.
+	* There are no framebuffers to render into besides its own color buffer.
+	*/
+	class SoftwareRendererAPI : public NullRendererAPI {
+	public:
+		SoftwareRendererAPI(uint32_t width, uint32_t height);
+
+		/* Clears the contents and resets the viewport to the whole buffer. */
+		void Resize(uint32_t width, uint32_t height);
+
+		/* RGBA8, bottom row first like glReadPixels. */
+		const uint8_t* GetColorBuffer() const { return color_buffer.data(); }
+		uint32_t GetWidth() const { return width; }
+		uint32_t GetHeight() const { return height; }
+		/* The texture's texels expanded to RGBA8, row 0 first, nullptr for an id that is not a texture. */
+		const uint8_t* GetTexels(uint32_t id) const;
+
+		const SoftwareRasterStats& GetRasterStats() const { return raster_stats; }
+		void ResetRasterStats() { raster_stats = SoftwareRasterStats(); }
+
+		void SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h) override;
+		void Clear() override;
+		void SetClearColor(float r, float g, float b, float a) override;
+
+		void DrawIndexed(uint32_t index_count) override;
+		void DrawArraysInstanced(uint32_t vertex_count, uint32_t instance_count) override;
+		void DrawMultiIndirect(const void* indirect, uint32_t count, uint32_t stride) override;
+
+		void DeleteBuffer(uint32_t id) override;
+		void BindBuffer(BufferTarget target, uint32_t id) override;
+		void BufferData(BufferTarget target, uint32_t size, const void* data, BufferUsage usage) override;
+		void BufferSubData(BufferTarget target, uint32_t offset, uint32_t size, const void* data) override;
+		void* MapBufferStorage(BufferTarget target, uint32_t size) override;
+		void BindBufferBase(BufferTarget target, uint32_t binding, uint32_t id) override;
+		void BindBufferRange(BufferTarget target, uint32_t binding, uint32_t id, uint32_t offset, uint32_t size) override;
+
+		void DeleteVertexArray(uint32_t id) override;
+		void BindVertexArray(uint32_t id) override;
+		void SetVertexAttribute(uint32_t index, uint32_t size, VertexShaderType type, bool normalized, uint32_t stride, size_t offset) override;
+		void EnableVertexAttribute(uint32_t index) override;
+
+		uint32_t CreateProgram(const ShaderSources& sources) override;
+		void DeleteProgram(uint32_t program) override;
+		void UseProgram(uint32_t program) override;
+
+		uint32_t CreateTexture(uint32_t width, uint32_t height, TextureFormat format) override;
+		void DeleteTexture(uint32_t id) override;
+		void SetTextureData(uint32_t id, uint32_t width, uint32_t height, TextureFormat format, const void* data) override;
+		void SetTextureSubData(uint32_t id, int32_t x, int32_t y, uint32_t w, uint32_t h, TextureFormat format, uint32_t row_length, const void* data) override;
+		void BindTextureUnit(uint32_t slot, uint32_t id) override;
+		void BindTexture(uint32_t id) override;
+		void SetBoundTextureData(int32_t x, int32_t y, int32_t w, int32_t h, TextureFormat format, const void* pixels) override;
+		void ReadPixels(int32_t x, int32_t y, int32_t w, int32_t h, void* pixels) override;
+		/* Everything is drawn into the one color buffer. */
+		uint32_t CreateFrameBuffer(uint32_t width, uint32_t height, uint32_t& color_attachment, uint32_t& depth_stencil_attachment) override;
+	private:
+		struct Attribute {
+			uint32_t buffer = 0;
+			uint32_t size = 0;
+			uint32_t stride = 0;
+			size_t offset = 0;
+			bool is_float = true;
+			bool enabled = false;
+		};
+
+		struct VertexArrayState {
+			Attribute attributes[SOFTWARE_MAX_ATTRIBUTES];
+			uint32_t index_buffer = 0;
+		};
+
+		/* Texels are expanded to RGBA8 on upload. */
+		struct TextureStorage {
+			uint32_t width = 0, height = 0;
+			TextureFormat format = TextureFormat::RGBA8;
+			std::vector<uint8_t> texels;
+		};
+
+		struct ClipVertex {
+			glm::vec4 position;
+			glm::vec2 tex_coord;
+		};
+
+		/*
+		* Edge i is A * x + B * y + C >= 0 inside, in subpixel units with the fill rule folded into C. The other
+		* values are planes over pixel coordinates: value + dx * x + dy * y, relative to the first vertex.
+		*/
+		struct Triangle {
+			int32_t a[3], b[3];
+			int64_t c[3];
+			int32_t min_x, min_y, max_x, max_y;
+			float origin_x, origin_y;
+			glm::vec3 depth;
+			glm::vec3 inv_w;
+			glm::vec3 u_w;
+			glm::vec3 v_w;
+			glm::vec4 color;
+			int32_t texture;
+			bool linear;
+			glm::vec4 shape;
+			/* Change of the position in the shape from one pixel to the next in x and y. */
+			glm::vec2 shape_dx, shape_dy;
+		};
+
+		struct DrawState {
+			const uint8_t* attribute_data[SOFTWARE_MAX_ATTRIBUTES];
+			size_t attribute_size[SOFTWARE_MAX_ATTRIBUTES];
+			const VertexArrayState* vertex_array;
+			const TextureStorage* units[SOFTWARE_TEXTURE_UNITS];
+			glm::mat4 proj_view;
+			bool coverage;
+		};
+
+		std::vector<uint8_t>* GetBound(BufferTarget target);
+		/* Expands rows row_length pixels apart to RGBA8, clipped to the texture. */
+		void CopyToTexture(TextureStorage& texture, int32_t x, int32_t y, uint32_t w, uint32_t h, TextureFormat format, uint32_t row_length, const uint8_t* source);
+		bool BeginDraw(DrawState& state);
+		/* Points the state and the viewport at one of the Renderer's views, when the buffer at binding 0 holds it. */
+		void SelectView(DrawState& state, uint32_t view, const int32_t scene_viewport[4]);
+		ClipVertex FetchVertex(const DrawState& state, uint32_t index, glm::vec4& color, float& texture, glm::vec4& shape) const;
+		/* Appends the triangles of one primitive, clipped when it crosses the near, far or guard band planes. */
+		void SetupPrimitive(const DrawState& state, const ClipVertex vertices[3], const glm::vec4& color, float texture, const glm::vec4& shape);
+		void SetupTriangle(const DrawState& state, const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2, const glm::vec4& color, int32_t texture, const glm::vec4& shape);
+		void SetupIndexed(const DrawState& state, const uint32_t* indices, uint32_t index_count, uint32_t base_vertex);
+		/* Bins the triangles set up since the last call and rasterizes the tiles they touch. */
+		void RasterizeTriangles(const DrawState& state);
+		uint64_t RasterizeTile(const DrawState& state, uint32_t tile);
+		void ShadeFragment(const DrawState& state, const Triangle& triangle, int32_t x, int32_t y, uint64_t& fragments);
+
+		uint32_t width = 0, height = 0;
+		std::vector<uint8_t> color_buffer;
+		std::vector<float> depth_buffer;
+		int32_t viewport[4] = {};
+		uint8_t clear_color[4] = {};
+
+		std::unordered_map<uint32_t, std::vector<uint8_t>> buffers;
+		uint32_t bound_buffers[6] = {};
+		uint32_t storage_bindings[8] = {};
+		uint32_t storage_offsets[8] = {};
+
+		std::unordered_map<uint32_t, VertexArrayState> vertex_arrays;
+		uint32_t bound_vertex_array = 0;
+
+		/* Programs that shade with the red channel as coverage. */
+		std::unordered_map<uint32_t, bool> programs;
+		uint32_t bound_program = 0;
+
+		std::unordered_map<uint32_t, TextureStorage> textures;
+		uint32_t units[SOFTWARE_TEXTURE_UNITS] = {};
+		uint32_t bound_texture = 0;
+
+		std::vector<Triangle> triangles;
+		uint32_t tiles_x = 0, tiles_y = 0;
+		std::vector<std::vector<uint32_t>> bins;
+		std::vector<uint32_t> active_tiles;
+		std::vector<uint64_t> tile_fragments;
+		std::vector<uint32_t> sequential_indices;
+		SoftwareRasterStats raster_stats;
+	};
+}
+
+#endif // !SOFTWARE_RENDERER_API_H
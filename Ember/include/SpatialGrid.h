@@ -0,0 +1,148 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <glm.hpp>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+namespace Ember {
+	constexpr uint32_t SPATIAL_GRID_DEFAULT_BUCKETS = 4096;
+
+	/*
+	* Uniform grid over unbounded 2D space, cells are hashed into a fixed number of buckets. Bounds are packed as
+	* (min x, min y, max x, max y) like Renderer::CullBounds. The grid is rebuilt rather than updated: Clear, Insert
+	* every object, then Build sorts the entries by bucket (counting sort, linear time) before any query.
+	* An object overlapping several cells is stored once per cell; queries and pairs report it once by only accepting
+	* a match in the cell holding the minimum corner of the overlap.
+	*/
+	class SpatialGrid {
+	public:
+		void Init(float cell_size, uint32_t bucket_count = SPATIAL_GRID_DEFAULT_BUCKETS);
+
+		void Clear();
+		void Insert(uint32_t id, const glm::vec4& bounds);
+		void Build();
+
+		/* Ids whose bounds overlap, appended to results. */
+		void QueryBounds(const glm::vec4& bounds, std::vector<uint32_t>& results) const;
+		/*
+		* Ids whose bounds grown by radius are crossed by the segment, appended to results once each. Walks only the
+		* cells along the segment (and radius around it), so the cost follows the segment length, not the grid size.
+		*/
+		void QuerySegment(const glm::vec2& start, const glm::vec2& end, float radius, std::vector<uint32_t>& results) const;
+		/*
+		* Same walk in order from start to end. For each cell crossed, step_ids is refilled with the ids found around
+		* that part of the segment (an id can come back in a later step) and callback(step_ids, t_exit) is called, where
+		* t_exit is the fraction of the segment walked so far. Anything first touched before t_exit has been reported,
+		* which lets earliest hit searches stop early by returning false.
+		*/
+		template<typename F>
+		void WalkSegment(const glm::vec2& start, const glm::vec2& end, float radius, std::vector<uint32_t>& step_ids, F&& callback) const;
+
+		/* Calls callback(id_a, id_b) once for each pair of overlapping bounds. */
+		template<typename F>
+		void ForEachPair(F&& callback) const;
+
+		float GetCellSize() const { return cell_size; }
+		uint32_t GetEntryCount() const { return (uint32_t)entries.size(); }
+	private:
+		struct Entry {
+			glm::vec4 bounds;
+			int32_t cell_x;
+			int32_t cell_y;
+			uint32_t id;
+		};
+
+		int32_t CellCoordinate(float value) const { return (int32_t)glm::floor(value * inverse_cell_size); }
+		uint32_t Bucket(int32_t cell_x, int32_t cell_y) const {
+			return ((uint32_t)cell_x * 73856093u ^ (uint32_t)cell_y * 19349663u) & (bucket_count - 1);
+		}
+
+		void QueryCell(int32_t cell_x, int32_t cell_y, const glm::vec2& start, const glm::vec2& inverse_direction, float radius, std::vector<uint32_t>& results) const;
+
+		static bool Overlaps(const glm::vec4& a, const glm::vec4& b) {
+			return a.x <= b.z && b.x <= a.z && a.y <= b.w && b.y <= a.w;
+		}
+
+		float cell_size = 1.0f;
+		float inverse_cell_size = 1.0f;
+		uint32_t bucket_count = 0;
+
+		std::vector<Entry> pending;
+		std::vector<Entry> entries;
+		std::vector<uint32_t> bucket_starts;
+		std::vector<uint32_t> bucket_cursors;
+	};
+
+	template<typename F>
+	void SpatialGrid::WalkSegment(const glm::vec2& start, const glm::vec2& end, float radius, std::vector<uint32_t>& step_ids, F&& callback) const {
+		if (entries.empty())
+			return;
+
+		glm::vec2 direction = end - start;
+		glm::vec2 inverse_direction = { (direction.x != 0.0f) ? 1.0f / direction.x : FLT_MAX, (direction.y != 0.0f) ? 1.0f / direction.y : FLT_MAX };
+
+		/* Cell walk along the segment (Amanatides and Woo), t runs from 0 at start to 1 at end. */
+		int32_t x = CellCoordinate(start.x);
+		int32_t y = CellCoordinate(start.y);
+		int32_t step_x = (direction.x > 0.0f) ? 1 : -1;
+		int32_t step_y = (direction.y > 0.0f) ? 1 : -1;
+		float delta_x = (direction.x != 0.0f) ? cell_size * glm::abs(inverse_direction.x) : FLT_MAX;
+		float delta_y = (direction.y != 0.0f) ? cell_size * glm::abs(inverse_direction.y) : FLT_MAX;
+		float next_x = (direction.x != 0.0f) ? ((x + (step_x > 0)) * cell_size - start.x) * inverse_direction.x : FLT_MAX;
+		float next_y = (direction.y != 0.0f) ? ((y + (step_y > 0)) * cell_size - start.y) * inverse_direction.y : FLT_MAX;
+
+		uint32_t steps = (uint32_t)(glm::abs(CellCoordinate(end.x) - x) + glm::abs(CellCoordinate(end.y) - y));
+		float t_enter = 0.0f;
+		for (uint32_t i = 0; i <= steps; i++) {
+			float t_exit = (i == steps) ? 1.0f : glm::min(glm::min(next_x, next_y), 1.0f);
+
+			/* Cells within radius of this piece of the segment, usually just the one being walked. */
+			glm::vec2 a = start + t_enter * direction;
+			glm::vec2 b = start + t_exit * direction;
+			int32_t min_x = CellCoordinate(glm::min(a.x, b.x) - radius), max_x = CellCoordinate(glm::max(a.x, b.x) + radius);
+			int32_t min_y = CellCoordinate(glm::min(a.y, b.y) - radius), max_y = CellCoordinate(glm::max(a.y, b.y) + radius);
+
+			step_ids.clear();
+			for (int32_t cell_y = min_y; cell_y <= max_y; cell_y++)
+				for (int32_t cell_x = min_x; cell_x <= max_x; cell_x++)
+					QueryCell(cell_x, cell_y, start, inverse_direction, radius, step_ids);
+
+			if (!callback(step_ids, t_exit))
+				return;
+
+			t_enter = t_exit;
+			if (next_x < next_y) {
+				x += step_x;
+				next_x += delta_x;
+			}
+			else {
+				y += step_y;
+				next_y += delta_y;
+			}
+		}
+	}
+
+	template<typename F>
+	void SpatialGrid::ForEachPair(F&& callback) const {
+		for (uint32_t bucket = 0; bucket < bucket_count; bucket++) {
+			uint32_t end = bucket_starts[bucket + 1];
+			for (uint32_t i = bucket_starts[bucket]; i < end; i++) {
+				const Entry& a = entries[i];
+				for (uint32_t j = i + 1; j < end; j++) {
+					const Entry& b = entries[j];
+					if (a.cell_x != b.cell_x || a.cell_y != b.cell_y || !Overlaps(a.bounds, b.bounds))
+						continue;
+
+					if (CellCoordinate(glm::max(a.bounds.x, b.bounds.x)) != a.cell_x || CellCoordinate(glm::max(a.bounds.y, b.bounds.y)) != a.cell_y)
+						continue;
+
+					callback(a.id, b.id);
+				}
+			}
+		}
+	}
+}
+
+#endif // !SPATIAL_GRID_H
@@ -0,0 +1,64 @@
+#ifndef STREAMING_TEXTURE_H
+#define STREAMING_TEXTURE_H
+
+#include "Texture.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Ember {
+	/* Upload buffers in the ring, a slice is written again once the GPU has read it STREAMING_TEXTURE_SLICES uploads ago. */
+	constexpr uint32_t STREAMING_TEXTURE_SLICES = 3;
+
+	struct StreamingTextureStats {
+		uint32_t uploads = 0;
+		uint64_t bytes = 0;
+		/* Uploads that had to wait for the GPU to finish reading their slice. */
+		uint32_t stalls = 0;
+	};
+
+	struct StreamingTextureRing;
+
+	/*
+	* Texture for contents that change every frame (video, minimaps, procedural effects). Update writes into a copy on
+	* the CPU and grows the dirty rectangle, Flush sends only that rectangle, once per frame, before the texture is
+	* drawn. The upload goes through a ring of persistently mapped pixel unpack buffers, the driver copies from the
+	* buffer on the GPU timeline instead of stalling the CPU, and each slice is fenced so it is never overwritten while
+	* the GPU may still read it. Backends that cannot map upload straight from the copy.
+	*
+	* Like Texture it must be created before RenderThread::Start or through Submit. Update and Flush can be called on
+	* the game thread while the render thread records, Flush then records a copy of the dirty rows.
+	*/
+	class StreamingTexture : public Texture {
+	public:
+		StreamingTexture(uint32_t width, uint32_t height, TextureFormat format = TextureFormat::RGBA8);
+		StreamingTexture() = default;
+		~StreamingTexture() override;
+
+		StreamingTexture(const StreamingTexture&) = delete;
+		StreamingTexture& operator=(const StreamingTexture&) = delete;
+
+		void Init(uint32_t width, uint32_t height, TextureFormat format = TextureFormat::RGBA8);
+
+		/* Pixels in the texture's format with tightly packed rows, clipped to the texture. */
+		void Update(int32_t x, int32_t y, uint32_t w, uint32_t h, const void* pixels);
+		void Update(const void* pixels);
+
+		/* Uploads the dirty rectangle, nothing when no Update happened since the last Flush. */
+		void Flush();
+
+		bool IsDirty() const { return dirty_max_x > dirty_min_x; }
+		const uint8_t* GetPixels() const { return pixels.data(); }
+		StreamingTextureStats GetStats() const;
+	private:
+		std::vector<uint8_t> pixels;
+		int32_t dirty_min_x = 0, dirty_min_y = 0;
+		int32_t dirty_max_x = 0, dirty_max_y = 0;
+
+		StreamingTextureRing* ring = nullptr;
+		uint32_t uploads = 0;
+		uint64_t bytes = 0;
+	};
+}
+
+#endif // !STREAMING_TEXTURE_H
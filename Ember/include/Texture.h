@@ -1,6 +1,8 @@
 #ifndef OPENGL_TEXTURE_H
 #define OPENGL_TEXTURE_H
 
+#include "GPUResources.h"
+
 #include <memory>
 #include <string>
 #include <glm.hpp>
@@ -9,11 +11,11 @@ namespace Ember {
 	class Texture {
 	public:
 		Texture(const char* file_path, bool flip = true);
-		Texture(uint32_t width, uint32_t height);
+		Texture(uint32_t width, uint32_t height, TextureFormat format = TextureFormat::RGBA8);
 		Texture() = default;
 
 		void Init(const char* file_path, bool flip = true);
-		void Init(uint32_t width, uint32_t height);
+		void Init(uint32_t width, uint32_t height, TextureFormat format = TextureFormat::RGBA8);
 
 		virtual ~Texture();
 
@@ -24,13 +26,15 @@ namespace Ember {
 
 		uint32_t GetWidth() const { return width; }
 		uint32_t GetHeight() const { return height; }
-		uint32_t GetTextureId() const { return texture_id; }
+		uint32_t GetTextureId() const { return texture.id; }
+		TextureFormat GetFormat() const { return format; }
+		uint32_t GetSizeInBytes() const;
 	private:
-		uint32_t texture_id;
+		GPUHandle texture;
 
 		uint32_t width = 0;
 		uint32_t height = 0;
-		uint32_t internal_format = 0, data_format = 0;
+		TextureFormat format = TextureFormat::RGBA8;
 		std::string path;
 	};
 
@@ -41,7 +45,8 @@ namespace Ember {
 	};
 
 	void BindTexture(uint32_t id);
-	void SetPixels(const glm::ivec2& position, void* pixels, const glm::ivec2& size = { 1, 1 });
+	/* Into the bound texture, pixels in the given format with tightly packed rows. */
+	void SetPixels(const glm::ivec2& position, void* pixels, const glm::ivec2& size = { 1, 1 }, TextureFormat format = TextureFormat::RGB8);
 	void GetPixels(const glm::ivec2& position, void* pixels, const glm::ivec2& size = { 1, 1 });
 }
 
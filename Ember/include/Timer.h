@@ -1,9 +1,13 @@
 #ifndef TIMER_H
 #define TIMER_H
 
-#include <SDL.h>
+#include "Clock.h"
 
 namespace Ember {
+	/*
+	* Stopwatch over the monotonic clock. FetchAt reports whether the given second was reached during the last Update,
+	* so it triggers once even when a long frame skips past it.
+	*/
 	class Timer {
 	public:
 		Timer();
@@ -16,10 +20,13 @@ namespace Ember {
 
 		bool FetchAt(int timer_spot);
 		inline int GetSeconds() const { return seconds; }
+		inline uint64_t GetElapsed() const { return elapsed; }
 	private:
-		unsigned int last_time = 0, current_time = 0;
+		uint64_t last_time = 0;
+		uint64_t elapsed = 0;
 		bool on = true;
 		int seconds = 0;
+		int previous_seconds = 0;
 	};
 }
 
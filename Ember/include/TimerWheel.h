@@ -0,0 +1,86 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "Clock.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Ember {
+	constexpr uint32_t TIMER_WHEEL_LEVELS = 4;
+	constexpr uint32_t TIMER_WHEEL_SLOT_BITS = 8;
+	constexpr uint32_t TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_SLOT_BITS;
+	constexpr uint64_t TIMER_WHEEL_DEFAULT_TICK = NANOSECONDS_PER_MILLISECOND;
+
+	struct TimerHandle {
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0;
+
+		bool IsValid() const { return index != UINT32_MAX; }
+	};
+
+	/*
+	* Hierarchical timer wheel: four levels of 256 slots, each level covering 256 times the range of the one below. A
+	* timer is placed in the lowest level whose range covers its expiry and moves down when the level above cascades,
+	* so scheduling, cancelling and firing are O(1) amortized and nothing is visited per timer per frame.
+	* Timers fire in tick order with tick resolution (1 ms of game time by default). Delays beyond the top level are
+	* clamped to it.
+	*/
+	class TimerWheel {
+	public:
+		using Callback = std::function<void()>;
+
+		TimerWheel(uint64_t tick = TIMER_WHEEL_DEFAULT_TICK);
+
+		/*
+		* A non zero period makes the timer repeat until it is cancelled. Callbacks may schedule and cancel timers,
+		* including their own.
+		*/
+		TimerHandle Schedule(uint64_t delay, const Callback& callback, uint64_t period = 0);
+		bool Cancel(TimerHandle& handle);
+		void Clear();
+
+		bool IsPending(TimerHandle handle) const;
+		uint64_t GetRemaining(TimerHandle handle) const;
+
+		void Advance(uint64_t delta);
+
+		uint64_t GetTime() const { return current_tick * tick_length; }
+		uint32_t GetTimerCount() const { return timer_count; }
+	private:
+		struct TimerNode {
+			Callback callback;
+			uint64_t expires = 0;
+			uint64_t period = 0;
+			uint32_t generation = 0;
+			uint32_t previous = UINT32_MAX;
+			uint32_t next = UINT32_MAX;
+			uint32_t slot = UINT32_MAX;
+			bool active = false;
+		};
+
+		uint64_t ToTicks(uint64_t time) const;
+
+		void Insert(uint32_t index);
+		void Unlink(uint32_t index);
+		void Release(uint32_t index);
+		void Cascade(uint32_t level);
+		void Tick();
+
+		const TimerNode* Find(TimerHandle handle) const;
+
+		uint64_t tick_length;
+		uint64_t current_tick = 0;
+		uint64_t pending_time = 0;
+
+		std::vector<TimerNode> nodes;
+		uint32_t free_list = UINT32_MAX;
+		uint32_t timer_count = 0;
+		uint32_t firing = UINT32_MAX;
+
+		uint32_t slots[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+	};
+}
+
+#endif // !TIMER_WHEEL_H
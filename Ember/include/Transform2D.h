@@ -0,0 +1,62 @@
+#ifndef TRANSFORM_2D_H
+#define TRANSFORM_2D_H
+
+#include "FastMath.h"
+
+#include <glm.hpp>
+
+namespace Ember {
+	/*
+	* 2D affine transform stored as the images of the x and y axes plus a translation, the 2x3 part of a 2D model
+	* matrix. Building one costs a few multiplies and applying it to a point four multiply-adds, where the mat4
+	* equivalents are full 4x4 products.
+	*/
+	struct Transform2D {
+		glm::vec2 x_axis = { 1.0f, 0.0f };
+		glm::vec2 y_axis = { 0.0f, 1.0f };
+		glm::vec2 translation = { 0.0f, 0.0f };
+
+		glm::vec2 Apply(const glm::vec2& point) const { return translation + x_axis * point.x + y_axis * point.y; }
+		glm::vec2 ApplyVector(const glm::vec2& vector) const { return x_axis * vector.x + y_axis * vector.y; }
+
+		Transform2D operator*(const Transform2D& other) const {
+			return { ApplyVector(other.x_axis), ApplyVector(other.y_axis), Apply(other.translation) };
+		}
+
+		glm::mat4 ToMat4(float z = 0.0f) const {
+			glm::mat4 model(1.0f);
+			model[0] = { x_axis, 0.0f, 0.0f };
+			model[1] = { y_axis, 0.0f, 0.0f };
+			model[3] = { translation, z, 1.0f };
+			return model;
+		}
+
+		static Transform2D TranslateScale(const glm::vec2& translation, const glm::vec2& scale) {
+			return { { scale.x, 0.0f }, { 0.0f, scale.y }, translation };
+		}
+
+		/* translate * rotate * scale */
+		static Transform2D TranslateRotateScale(const glm::vec2& translation, float radians, const glm::vec2& scale) {
+			float s, c;
+			FastMath::SinCos(radians, s, c);
+			return { { c * scale.x, s * scale.x }, { -s * scale.y, c * scale.y }, translation };
+		}
+
+		/* translate * scale * rotate, the rotation happens before the scale. */
+		static Transform2D TranslateScaleRotate(const glm::vec2& translation, const glm::vec2& scale, float radians) {
+			float s, c;
+			FastMath::SinCos(radians, s, c);
+			return { { scale.x * c, scale.y * s }, { -scale.x * s, scale.y * c }, translation };
+		}
+
+		/* Unit quad stretched from p1 to p2 with the given thickness, the direction needs no trigonometry or division. */
+		static Transform2D Line(const glm::vec2& p1, const glm::vec2& p2, float width) {
+			glm::vec2 direction = p2 - p1;
+			float length_squared = glm::dot(direction, direction);
+			glm::vec2 normal = (length_squared > 0.0f) ? glm::vec2(-direction.y, direction.x) * FastMath::InvSqrt(length_squared) : glm::vec2(0.0f, 1.0f);
+			return { direction, normal * width, (p1 + p2) * 0.5f };
+		}
+	};
+}
+
+#endif // !TRANSFORM_2D_H
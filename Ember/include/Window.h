@@ -5,12 +5,18 @@
 #include "SDL_syswm.h"
 
 namespace Ember {
+	enum class SwapInterval {
+		Adaptive = -1, Off = 0, VSync = 1
+	};
+
 	struct WindowProperties {
 		std::string name;
 		int width;
 		int height;
 		bool full_screen;
 		glm::ivec2 position;
+		SwapInterval swap_interval = SwapInterval::VSync;
+		float max_frame_rate = 0.0f;
 		WindowProperties()
 			: name(), width(0), height(0), position(-1, -1), full_screen(false) { }
 		WindowProperties(const std::string& name, int width, int height)
@@ -30,6 +36,11 @@ namespace Ember {
 		virtual inline void SetResizeable(bool resize) = 0;
 		virtual SDL_GLContext* Context() = 0;
 
+		/*
+		* Records a size change that already happened on the native window, so it is not sent back to the window manager.
+		*/
+		virtual void OnResized(int width, int height) { properties->width = width; properties->height = height; }
+
 		bool IsRunning() const { return is_running; }
 		inline void Quit() { is_running = false; }
 
@@ -0,0 +1,537 @@
+#include "AABBTree.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace Ember {
+	void AABBTree::Init(float tree_margin) {
+		margin = tree_margin;
+		Clear();
+	}
+
+	void AABBTree::Clear() {
+		nodes.clear();
+		root = AABB_TREE_NULL;
+		free_list = AABB_TREE_NULL;
+		proxy_count = 0;
+	}
+
+	uint32_t AABBTree::AllocateNode() {
+		uint32_t node;
+		if (free_list != AABB_TREE_NULL) {
+			node = free_list;
+			free_list = nodes[node].parent;
+		}
+		else {
+			node = (uint32_t)nodes.size();
+			nodes.emplace_back();
+		}
+
+		Node& allocated = nodes[node];
+		allocated.parent = AABB_TREE_NULL;
+		allocated.child1 = AABB_TREE_NULL;
+		allocated.child2 = AABB_TREE_NULL;
+		allocated.height = 0;
+		allocated.user_data = 0;
+		return node;
+	}
+
+	void AABBTree::FreeNode(uint32_t node) {
+		nodes[node].parent = free_list;
+		nodes[node].height = -1;
+		free_list = node;
+	}
+
+	uint32_t AABBTree::CreateLeaf(const glm::vec4& bounds, uint64_t user_data) {
+		uint32_t leaf = AllocateNode();
+		Node& node = nodes[leaf];
+		node.bounds = { bounds.x - margin, bounds.y - margin, bounds.z + margin, bounds.w + margin };
+		node.tight = bounds;
+		node.user_data = user_data;
+		proxy_count++;
+		return leaf;
+	}
+
+	uint32_t AABBTree::Insert(const glm::vec4& bounds, uint64_t user_data) {
+		uint32_t leaf = CreateLeaf(bounds, user_data);
+		InsertLeaf(leaf);
+		return leaf;
+	}
+
+	void AABBTree::Remove(uint32_t proxy) {
+		if (proxy >= nodes.size() || !nodes[proxy].IsLeaf() || nodes[proxy].height < 0) {
+			EMBER_LOG_ERROR("AABBTree::Remove got an invalid proxy %u.", proxy);
+			return;
+		}
+
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		proxy_count--;
+	}
+
+	bool AABBTree::Move(uint32_t proxy, const glm::vec4& bounds, const glm::vec2& displacement) {
+		Node& node = nodes[proxy];
+		node.tight = bounds;
+		if (Contains(node.bounds, bounds))
+			return false;
+
+		RemoveLeaf(proxy);
+
+		/* Grow ahead of the motion so steady movers are reinserted less often. */
+		glm::vec4 grown = { bounds.x - margin, bounds.y - margin, bounds.z + margin, bounds.w + margin };
+		glm::vec2 ahead = 2.0f * displacement;
+		if (ahead.x < 0.0f) grown.x += ahead.x; else grown.z += ahead.x;
+		if (ahead.y < 0.0f) grown.y += ahead.y; else grown.w += ahead.y;
+
+		nodes[proxy].bounds = grown;
+		InsertLeaf(proxy);
+		return true;
+	}
+
+	void AABBTree::InsertBatch(const glm::vec4* bounds, const uint64_t* user_data, uint32_t count, uint32_t* proxies) {
+		if (count == 0)
+			return;
+
+		for (uint32_t i = 0; i < count; i++)
+			proxies[i] = CreateLeaf(bounds[i], user_data ? user_data[i] : 0);
+
+		/* A batch larger than the tree it joins is better served by rebuilding everything in one go. */
+		if (proxy_count - count < count) {
+			std::vector<uint32_t> leaves;
+			leaves.reserve(proxy_count);
+			for (uint32_t i = 0; i < (uint32_t)nodes.size(); i++) {
+				if (nodes[i].height == 0)
+					leaves.push_back(i);
+				else if (nodes[i].height > 0)
+					FreeNode(i);
+			}
+
+			root = BuildSubtree(leaves.data(), (uint32_t)leaves.size());
+			nodes[root].parent = AABB_TREE_NULL;
+			return;
+		}
+
+		std::vector<uint32_t> leaves(proxies, proxies + count);
+		InsertLeaf(BuildSubtree(leaves.data(), count));
+	}
+
+	void AABBTree::RemoveBatch(const uint32_t* proxies, uint32_t count) {
+		for (uint32_t i = 0; i < count; i++)
+			Remove(proxies[i]);
+	}
+
+	/* Top down median split along the longest axis of the leaf centers. */
+	uint32_t AABBTree::BuildSubtree(uint32_t* leaves, uint32_t count) {
+		if (count == 1)
+			return leaves[0];
+
+		glm::vec2 min_center = { FLT_MAX, FLT_MAX }, max_center = { -FLT_MAX, -FLT_MAX };
+		for (uint32_t i = 0; i < count; i++) {
+			const glm::vec4& bounds = nodes[leaves[i]].bounds;
+			glm::vec2 center = { bounds.x + bounds.z, bounds.y + bounds.w };
+			min_center = glm::min(min_center, center);
+			max_center = glm::max(max_center, center);
+		}
+
+		int axis = (max_center.x - min_center.x >= max_center.y - min_center.y) ? 0 : 1;
+		uint32_t half = count / 2;
+		std::nth_element(leaves, leaves + half, leaves + count, [this, axis](uint32_t a, uint32_t b) {
+			return nodes[a].bounds[axis] + nodes[a].bounds[axis + 2] < nodes[b].bounds[axis] + nodes[b].bounds[axis + 2];
+		});
+
+		uint32_t child1 = BuildSubtree(leaves, half);
+		uint32_t child2 = BuildSubtree(leaves + half, count - half);
+
+		uint32_t parent = AllocateNode();
+		Node& node = nodes[parent];
+		node.child1 = child1;
+		node.child2 = child2;
+		node.bounds = Combine(nodes[child1].bounds, nodes[child2].bounds);
+		node.height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+		nodes[child1].parent = parent;
+		nodes[child2].parent = parent;
+		return parent;
+	}
+
+	void AABBTree::InsertLeaf(uint32_t leaf) {
+		if (root == AABB_TREE_NULL) {
+			root = leaf;
+			nodes[leaf].parent = AABB_TREE_NULL;
+			return;
+		}
+
+		/* Walk down to the sibling whose bounds grow the least, counting what every ancestor grows by too. */
+		glm::vec4 leaf_bounds = nodes[leaf].bounds;
+		uint32_t index = root;
+		while (!nodes[index].IsLeaf()) {
+			const Node& node = nodes[index];
+			float area = Perimeter(node.bounds);
+			float combined = Perimeter(Combine(node.bounds, leaf_bounds));
+			float cost = 2.0f * combined;
+			float inheritance = 2.0f * (combined - area);
+
+			auto descend_cost = [&](uint32_t child) {
+				const glm::vec4& bounds = nodes[child].bounds;
+				float grown = Perimeter(Combine(bounds, leaf_bounds));
+				return (nodes[child].IsLeaf() ? grown : grown - Perimeter(bounds)) + inheritance;
+			};
+			float cost1 = descend_cost(node.child1);
+			float cost2 = descend_cost(node.child2);
+
+			if (cost < cost1 && cost < cost2)
+				break;
+			index = (cost1 < cost2) ? node.child1 : node.child2;
+		}
+
+		uint32_t sibling = index;
+		uint32_t old_parent = nodes[sibling].parent;
+		uint32_t new_parent = AllocateNode();
+		Node& parent = nodes[new_parent];
+		parent.parent = old_parent;
+		parent.bounds = Combine(leaf_bounds, nodes[sibling].bounds);
+		parent.height = 1 + std::max(nodes[sibling].height, nodes[leaf].height);
+		parent.child1 = sibling;
+		parent.child2 = leaf;
+
+		if (old_parent != AABB_TREE_NULL) {
+			if (nodes[old_parent].child1 == sibling)
+				nodes[old_parent].child1 = new_parent;
+			else
+				nodes[old_parent].child2 = new_parent;
+		}
+		else {
+			root = new_parent;
+		}
+		nodes[sibling].parent = new_parent;
+		nodes[leaf].parent = new_parent;
+
+		Refit(nodes[leaf].parent);
+	}
+
+	void AABBTree::RemoveLeaf(uint32_t leaf) {
+		if (leaf == root) {
+			root = AABB_TREE_NULL;
+			return;
+		}
+
+		uint32_t parent = nodes[leaf].parent;
+		uint32_t grand_parent = nodes[parent].parent;
+		uint32_t sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+		if (grand_parent != AABB_TREE_NULL) {
+			if (nodes[grand_parent].child1 == parent)
+				nodes[grand_parent].child1 = sibling;
+			else
+				nodes[grand_parent].child2 = sibling;
+			nodes[sibling].parent = grand_parent;
+			FreeNode(parent);
+			Refit(grand_parent);
+		}
+		else {
+			root = sibling;
+			nodes[sibling].parent = AABB_TREE_NULL;
+			FreeNode(parent);
+		}
+	}
+
+	/* Rebalances and refits every node from index up to the root. */
+	void AABBTree::Refit(uint32_t index) {
+		while (index != AABB_TREE_NULL) {
+			index = Balance(index);
+
+			Node& node = nodes[index];
+			node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+			node.bounds = Combine(nodes[node.child1].bounds, nodes[node.child2].bounds);
+			index = node.parent;
+		}
+	}
+
+	/* Rotates the taller grandchild up when a's children differ in height by more than one, returns the new subtree root. */
+	uint32_t AABBTree::Balance(uint32_t index_a) {
+		Node& a = nodes[index_a];
+		if (a.IsLeaf() || a.height < 2)
+			return index_a;
+
+		uint32_t index_b = a.child1;
+		uint32_t index_c = a.child2;
+		Node& b = nodes[index_b];
+		Node& c = nodes[index_c];
+		int32_t balance = c.height - b.height;
+
+		if (balance > 1) {
+			uint32_t index_f = c.child1;
+			uint32_t index_g = c.child2;
+			Node& f = nodes[index_f];
+			Node& g = nodes[index_g];
+
+			c.child1 = index_a;
+			c.parent = a.parent;
+			a.parent = index_c;
+			if (c.parent != AABB_TREE_NULL) {
+				if (nodes[c.parent].child1 == index_a)
+					nodes[c.parent].child1 = index_c;
+				else
+					nodes[c.parent].child2 = index_c;
+			}
+			else {
+				root = index_c;
+			}
+
+			if (f.height > g.height) {
+				c.child2 = index_f;
+				a.child2 = index_g;
+				g.parent = index_a;
+				a.bounds = Combine(b.bounds, g.bounds);
+				c.bounds = Combine(a.bounds, f.bounds);
+				a.height = 1 + std::max(b.height, g.height);
+				c.height = 1 + std::max(a.height, f.height);
+			}
+			else {
+				c.child2 = index_g;
+				a.child2 = index_f;
+				f.parent = index_a;
+				a.bounds = Combine(b.bounds, f.bounds);
+				c.bounds = Combine(a.bounds, g.bounds);
+				a.height = 1 + std::max(b.height, f.height);
+				c.height = 1 + std::max(a.height, g.height);
+			}
+			return index_c;
+		}
+
+		if (balance < -1) {
+			uint32_t index_d = b.child1;
+			uint32_t index_e = b.child2;
+			Node& d = nodes[index_d];
+			Node& e = nodes[index_e];
+
+			b.child1 = index_a;
+			b.parent = a.parent;
+			a.parent = index_b;
+			if (b.parent != AABB_TREE_NULL) {
+				if (nodes[b.parent].child1 == index_a)
+					nodes[b.parent].child1 = index_b;
+				else
+					nodes[b.parent].child2 = index_b;
+			}
+			else {
+				root = index_b;
+			}
+
+			if (d.height > e.height) {
+				b.child2 = index_d;
+				a.child1 = index_e;
+				e.parent = index_a;
+				a.bounds = Combine(c.bounds, e.bounds);
+				b.bounds = Combine(a.bounds, d.bounds);
+				a.height = 1 + std::max(c.height, e.height);
+				b.height = 1 + std::max(a.height, d.height);
+			}
+			else {
+				b.child2 = index_e;
+				a.child1 = index_d;
+				d.parent = index_a;
+				a.bounds = Combine(c.bounds, d.bounds);
+				b.bounds = Combine(a.bounds, e.bounds);
+				a.height = 1 + std::max(c.height, d.height);
+				b.height = 1 + std::max(a.height, e.height);
+			}
+			return index_b;
+		}
+
+		return index_a;
+	}
+
+	/* Traversal stack in place, spilling to the heap only when a degenerate tree is deeper than AABB_TREE_STACK_SIZE. */
+	class NodeStack {
+	public:
+		void Push(uint32_t node) {
+			if (size < AABB_TREE_STACK_SIZE)
+				fixed[size] = node;
+			else
+				overflow.push_back(node);
+			size++;
+		}
+
+		uint32_t Pop() {
+			size--;
+			if (size < AABB_TREE_STACK_SIZE)
+				return fixed[size];
+			uint32_t node = overflow.back();
+			overflow.pop_back();
+			return node;
+		}
+
+		bool IsEmpty() const { return size == 0; }
+	private:
+		uint32_t fixed[AABB_TREE_STACK_SIZE];
+		uint32_t size = 0;
+		std::vector<uint32_t> overflow;
+	};
+
+	/* Depth first walk shared by the overlap queries, test decides both which nodes to enter and which leaves match. */
+	template<typename Test>
+	uint32_t AABBTree::Query(Test&& test, uint32_t* results, uint32_t capacity) const {
+		if (root == AABB_TREE_NULL)
+			return 0;
+
+		NodeStack stack;
+		uint32_t found = 0;
+		stack.Push(root);
+
+		while (!stack.IsEmpty()) {
+			uint32_t index = stack.Pop();
+			const Node& node = nodes[index];
+			if (!test(node.bounds))
+				continue;
+
+			if (node.IsLeaf()) {
+				if (test(node.tight)) {
+					if (found < capacity)
+						results[found] = index;
+					found++;
+				}
+				continue;
+			}
+
+			stack.Push(node.child1);
+			stack.Push(node.child2);
+		}
+		return found;
+	}
+
+	uint32_t AABBTree::QueryPoint(const glm::vec2& point, uint32_t* results, uint32_t capacity) const {
+		auto test = [&point](const glm::vec4& bounds) { return point.x >= bounds.x && point.x <= bounds.z && point.y >= bounds.y && point.y <= bounds.w; };
+		return Query(test, results, capacity);
+	}
+
+	uint32_t AABBTree::QueryBounds(const glm::vec4& query, uint32_t* results, uint32_t capacity) const {
+		auto test = [&query](const glm::vec4& bounds) { return Overlaps(bounds, query); };
+		return Query(test, results, capacity);
+	}
+
+	uint32_t AABBTree::QueryCircle(const glm::vec2& center, float radius, uint32_t* results, uint32_t capacity) const {
+		auto test = [&center, radius](const glm::vec4& bounds) {
+			glm::vec2 closest = glm::clamp(center, glm::vec2(bounds.x, bounds.y), glm::vec2(bounds.z, bounds.w));
+			glm::vec2 offset = closest - center;
+			return glm::dot(offset, offset) <= radius * radius;
+		};
+		return Query(test, results, capacity);
+	}
+
+	/* Entry fraction of the segment into bounds, or a value above max_fraction when it misses. */
+	static float SegmentEntry(const glm::vec2& start, const glm::vec2& inverse_direction, const glm::vec2& direction, const glm::vec4& bounds, float max_fraction) {
+		float t_min = 0.0f, t_max = max_fraction;
+		for (int axis = 0; axis < 2; axis++) {
+			if (direction[axis] == 0.0f) {
+				if (start[axis] < bounds[axis] || start[axis] > bounds[axis + 2])
+					return FLT_MAX;
+				continue;
+			}
+
+			float t0 = (bounds[axis] - start[axis]) * inverse_direction[axis];
+			float t1 = (bounds[axis + 2] - start[axis]) * inverse_direction[axis];
+			t_min = std::max(t_min, std::min(t0, t1));
+			t_max = std::min(t_max, std::max(t0, t1));
+		}
+		return (t_min <= t_max) ? t_min : FLT_MAX;
+	}
+
+	uint32_t AABBTree::RayCast(const glm::vec2& start, const glm::vec2& end, TreeRayHit* results, uint32_t capacity) const {
+		if (root == AABB_TREE_NULL || capacity == 0)
+			return 0;
+
+		glm::vec2 direction = end - start;
+		glm::vec2 inverse_direction = { (direction.x != 0.0f) ? 1.0f / direction.x : 0.0f, (direction.y != 0.0f) ? 1.0f / direction.y : 0.0f };
+
+		/* Results stay sorted; once the buffer is full, nodes entered beyond the farthest kept hit are skipped. */
+		NodeStack stack;
+		uint32_t found = 0;
+		float max_fraction = 1.0f;
+		stack.Push(root);
+
+		while (!stack.IsEmpty()) {
+			uint32_t index = stack.Pop();
+			const Node& node = nodes[index];
+			if (SegmentEntry(start, inverse_direction, direction, node.bounds, max_fraction) > max_fraction)
+				continue;
+
+			if (!node.IsLeaf()) {
+				/* Nearer child on top so the buffer fills with close hits early and prunes the rest. */
+				float entry1 = SegmentEntry(start, inverse_direction, direction, nodes[node.child1].bounds, max_fraction);
+				float entry2 = SegmentEntry(start, inverse_direction, direction, nodes[node.child2].bounds, max_fraction);
+				uint32_t near_child = (entry1 <= entry2) ? node.child1 : node.child2;
+				uint32_t far_child = (entry1 <= entry2) ? node.child2 : node.child1;
+				if (std::max(entry1, entry2) <= max_fraction)
+					stack.Push(far_child);
+				if (std::min(entry1, entry2) <= max_fraction)
+					stack.Push(near_child);
+				continue;
+			}
+
+			float fraction = SegmentEntry(start, inverse_direction, direction, node.tight, max_fraction);
+			if (fraction > max_fraction)
+				continue;
+
+			uint32_t slot = std::min(found, capacity - 1);
+			while (slot > 0 && results[slot - 1].fraction > fraction) {
+				results[slot] = results[slot - 1];
+				slot--;
+			}
+			results[slot] = { index, fraction };
+			found = std::min(found + 1, capacity);
+			if (found == capacity)
+				max_fraction = results[capacity - 1].fraction;
+		}
+		return found;
+	}
+
+	uint32_t AABBTree::QueryNearest(const glm::vec2& point, uint32_t count, TreeNearest* results) const {
+		if (root == AABB_TREE_NULL || count == 0)
+			return 0;
+
+		auto distance_squared = [&point](const glm::vec4& bounds) {
+			glm::vec2 closest = glm::clamp(point, glm::vec2(bounds.x, bounds.y), glm::vec2(bounds.z, bounds.w));
+			glm::vec2 offset = closest - point;
+			return glm::dot(offset, offset);
+		};
+
+		/* Best first: always open the closest node left, stop once it is farther than the worst of the count kept. */
+		auto closer = [](const TreeNearest& a, const TreeNearest& b) { return a.distance_squared > b.distance_squared; };
+		std::vector<TreeNearest> open;
+		open.reserve(64);
+		open.push_back({ root, distance_squared(nodes[root].bounds) });
+
+		uint32_t found = 0;
+		while (!open.empty()) {
+			std::pop_heap(open.begin(), open.end(), closer);
+			TreeNearest next = open.back();
+			open.pop_back();
+
+			if (found == count && next.distance_squared >= results[count - 1].distance_squared)
+				break;
+
+			const Node& node = nodes[next.proxy];
+			if (!node.IsLeaf()) {
+				open.push_back({ node.child1, distance_squared(nodes[node.child1].bounds) });
+				std::push_heap(open.begin(), open.end(), closer);
+				open.push_back({ node.child2, distance_squared(nodes[node.child2].bounds) });
+				std::push_heap(open.begin(), open.end(), closer);
+				continue;
+			}
+
+			float distance = distance_squared(node.tight);
+			if (found == count && distance >= results[count - 1].distance_squared)
+				continue;
+
+			uint32_t slot = std::min(found, count - 1);
+			while (slot > 0 && results[slot - 1].distance_squared > distance) {
+				results[slot] = results[slot - 1];
+				slot--;
+			}
+			results[slot] = { next.proxy, distance };
+			found = std::min(found + 1, count);
+		}
+		return found;
+	}
+}
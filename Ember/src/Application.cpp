@@ -1,13 +1,21 @@
 #include "Application.h"
+#include "Profiler.h"
+#include "Renderer.h"
+#include "GPUResources.h"
 
 namespace Ember {
 	void Application::Initialize(const std::string& name, uint32_t width, uint32_t height, AppFlags flags) {
 		Ember::LogImpl::Init();
+		Memory::Init();
+		JobSystem::Init();
+		TaskScheduler::Init(&timers);
 		properties = new WindowProperties(name, width, height);
+		app_flags = flags;
 
 		properties->full_screen = (flags & AppFlags::FULL_SCREEN) ? true : false;
 		window = Window::CreateOpenGLWindow(properties, (flags & OPENGL_CUSTOM_VERSION) ? opengl_major_version : 0, (flags & OPENGL_CUSTOM_VERSION) ? opengl_minor_version : 0);
 
+		layer_stack = new LayerStack();
 		event_handler = new EventHandler(window);
 		event_handler->SetEventCallback(EMBER_BIND_FUNC(OnEvent));
 
@@ -15,25 +23,57 @@ namespace Ember {
 	}
 
 	Application::~Application() {
+		delete layer_stack;
+		GPUResources::Flush();
 		delete properties;
 		delete window;
 		delete event_handler;
+
+		JobSystem::Destroy();
+		TaskScheduler::Destroy();
+		CoroutineFramePool::Destroy();
+		Memory::Destroy();
+
+		LogImpl::Destroy();
+#ifdef EMBER_MEMORY_TRACKING
+		MemoryTracker::ReportLeaks();
+#endif
 	}
 
 	void Application::Run() {
-		uint64_t now = SDL_GetPerformanceCounter();
+		uint64_t now = Clock::Now();
 		uint64_t last = 0;
 		float delta = 0;
 
+		if (app_flags & AppFlags::RENDER_THREAD)
+			RenderThread::Start(window);
+		bool render_thread = RenderThread::IsActive();
+
 		while (window->IsRunning()) {
+			Memory::BeginFrame();
+			if (render_thread)
+				RenderThread::BeginFrame();
 			event_handler->Update();
 
 			last = now;
-			now = SDL_GetPerformanceCounter();
+			now = Clock::Now();
+
+			game_clock.Advance(now - last);
+			timers.Advance(game_clock.GetDelta());
+			TaskScheduler::Update();
 
-			delta = (float)((now - last) * 1000 / (float)SDL_GetPerformanceFrequency());
+			delta = game_clock.GetDeltaMilliseconds();
+			layer_stack->Update(delta);
 			OnUserUpdate(delta);
+			Renderer::EndFrame();
+
+			if (render_thread)
+				RenderThread::EndFrame(now);
+			else
+				Profiler::SetValue("Input latency", Clock::ToMilliseconds(Clock::Now() - now), ProfilerUnit::Milliseconds);
 		}
+
+		RenderThread::Stop();
 	}
 
 	void Application::OnEvent(Event& event) {
@@ -42,6 +82,27 @@ namespace Ember {
 		UserDefEvent(event);
 		dispatcher.Dispatch<QuitEvent>(EMBER_BIND_FUNC(OnClose));
 		dispatcher.Dispatch<ResizeEvent>(EMBER_BIND_FUNC(OnResize));
+
+		for (auto it = layer_stack->rbegin(); it != layer_stack->rend() && event.ActivityCheck(); it++)
+			(*it)->UserDefEvent(event);
+	}
+
+	void Application::PushLayer(Layer* layer) {
+		layer_stack->PushLayer(layer);
+		layer->OnAttach();
+	}
+
+	void Application::PushOverlay(Layer* overlay) {
+		layer_stack->PushOverlay(overlay);
+		overlay->OnAttach();
+	}
+
+	void Application::PopLayer(Layer* layer) {
+		layer_stack->PopLayer(layer);
+	}
+
+	void Application::PopOverlay(Layer* overlay) {
+		layer_stack->PopOverlay(overlay);
 	}
 
 	void Application::OnClose(const QuitEvent& event) {
@@ -49,7 +110,6 @@ namespace Ember {
 	}
 
 	void Application::OnResize(const ResizeEvent& event) {
-		window->Properties()->width = event.w;
-		window->Properties()->height = event.h;
+		window->OnResized(event.w, event.h);
 	}
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Audio.h"
+#include "MemoryTracker.h"
 
 namespace Ember {
 	AudioChunk::AudioChunk(const std::string& file_path) {
@@ -8,6 +9,8 @@ namespace Ember {
 	void AudioChunk::Initialize(const std::string& file_path) {
 		chunk = Mix_LoadWAV(file_path.c_str());
 		volume = 0;
+		if (chunk)
+			EMBER_TRACK_ALLOC(MemoryTag::Audio, chunk->alen);
 	}
 
 	void AudioChunk::Play() {
@@ -32,6 +35,8 @@ namespace Ember {
 	}
 
 	AudioChunk::~AudioChunk() {
+		if (chunk)
+			EMBER_TRACK_FREE(MemoryTag::Audio, chunk->alen);
 		Mix_FreeChunk(chunk);
 	}
 
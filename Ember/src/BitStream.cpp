@@ -0,0 +1,107 @@
+#include "BitStream.h"
+
+#include <glm.hpp>
+#include <gtc/constants.hpp>
+
+namespace Ember {
+	static uint32_t MaxValue(uint32_t bits) {
+		return (bits >= 32) ? UINT32_MAX : (1u << bits) - 1;
+	}
+
+	BitWriter::BitWriter(uint8_t* buffer, size_t capacity) : buffer(buffer), capacity(capacity) { }
+
+	void BitWriter::WriteBits(uint32_t value, uint32_t bits) {
+		if (overflow || bits_written + bits > capacity * 8) {
+			overflow = true;
+			return;
+		}
+
+		scratch |= (uint64_t)(value & MaxValue(bits)) << scratch_bits;
+		scratch_bits += bits;
+		bits_written += bits;
+		while (scratch_bits >= 8) {
+			buffer[bytes++] = (uint8_t)scratch;
+			scratch >>= 8;
+			scratch_bits -= 8;
+		}
+	}
+
+	void BitWriter::WriteVarUint(uint32_t value) {
+		while (value >= 0x80) {
+			WriteBits((value & 0x7F) | 0x80, 8);
+			value >>= 7;
+		}
+		WriteBits(value, 8);
+	}
+
+	void BitWriter::WriteBytes(const void* data, size_t size) {
+		const uint8_t* source = (const uint8_t*)data;
+		for (size_t i = 0; i < size; i++)
+			WriteBits(source[i], 8);
+	}
+
+	size_t BitWriter::Flush() {
+		if (scratch_bits > 0 && !overflow) {
+			buffer[bytes++] = (uint8_t)scratch;
+			scratch = 0;
+			scratch_bits = 0;
+		}
+		return bytes;
+	}
+
+	uint32_t BitWriter::Quantize(float value, float min, float max, uint32_t bits) {
+		float normalized = glm::clamp((value - min) / (max - min), 0.0f, 1.0f);
+		return (uint32_t)(normalized * (float)MaxValue(bits) + 0.5f);
+	}
+
+	uint32_t BitWriter::QuantizeAngle(float radians, uint32_t bits) {
+		float turns = radians / glm::two_pi<float>();
+		turns -= glm::floor(turns);
+		return (uint32_t)(turns * (float)(1ull << bits) + 0.5f) & MaxValue(bits);
+	}
+
+	BitReader::BitReader(const uint8_t* buffer, size_t size) : buffer(buffer), size(size) { }
+
+	uint32_t BitReader::ReadBits(uint32_t bits) {
+		if (overflow || bits_read + bits > size * 8) {
+			overflow = true;
+			return 0;
+		}
+
+		while (scratch_bits < bits) {
+			scratch |= (uint64_t)buffer[bytes++] << scratch_bits;
+			scratch_bits += 8;
+		}
+
+		uint32_t value = (uint32_t)scratch & MaxValue(bits);
+		scratch >>= bits;
+		scratch_bits -= bits;
+		bits_read += bits;
+		return value;
+	}
+
+	uint32_t BitReader::ReadVarUint() {
+		uint32_t value = 0;
+		for (uint32_t shift = 0; shift < 35; shift += 7) {
+			uint32_t byte = ReadBits(8);
+			value |= (byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+				break;
+		}
+		return value;
+	}
+
+	void BitReader::ReadBytes(void* data, size_t size) {
+		uint8_t* destination = (uint8_t*)data;
+		for (size_t i = 0; i < size; i++)
+			destination[i] = (uint8_t)ReadBits(8);
+	}
+
+	float BitReader::Dequantize(uint32_t value, float min, float max, uint32_t bits) {
+		return min + (max - min) * ((float)value / (float)MaxValue(bits));
+	}
+
+	float BitReader::DequantizeAngle(uint32_t value, uint32_t bits) {
+		return (float)value / (float)(1ull << bits) * glm::two_pi<float>();
+	}
+}
@@ -1,211 +1,280 @@
 #include "Buffers.h"
-#include <glad/glad.h>
+#include "MemoryTracker.h"
+#include "RendererAPI.h"
+#include "GPUResources.h"
 
 namespace Ember {
 	static uint32_t current_index_buffer_id = 0;
 	static uint32_t current_vertex_buffer_id = 0;
 	static uint32_t current_uniform_buffer_id = 0;
 
+	/* A pooled buffer already has its storage, it only needs the data. */
+	static void FillBuffer(BufferTarget target, bool pooled, uint32_t size, const void* data, BufferUsage usage) {
+		if (!pooled)
+			RendererAPI::Get()->BufferData(target, size, data, usage);
+		else if (data)
+			RendererAPI::Get()->BufferSubData(target, 0, size, data);
+	}
+
 	VertexBuffer::VertexBuffer(float* vertices, uint32_t size) {
-		glGenBuffers(1, &vertex_buffer_id);
+		bool pooled;
+		vertex_buffer = GPUResources::CreateBuffer(size, pooled);
 		Bind();
-		glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+		FillBuffer(BufferTarget::Vertex, pooled, size, vertices, BufferUsage::Static);
+		size_of_buffer = size;
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Renderer, size);
 	}
 
 	VertexBuffer::VertexBuffer(uint32_t size) {
-		glGenBuffers(1, &vertex_buffer_id);
+		bool pooled;
+		vertex_buffer = GPUResources::CreateBuffer(size, pooled);
 		Bind();
-		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+		FillBuffer(BufferTarget::Vertex, pooled, size, nullptr, BufferUsage::Dynamic);
+		size_of_buffer = size;
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Renderer, size);
 	}
 
 	VertexBuffer::~VertexBuffer() {
-		glDeleteBuffers(1, &vertex_buffer_id);
+		GPUResources::ReleaseBuffer(vertex_buffer, size_of_buffer);
+		EMBER_TRACK_GPU_FREE(MemoryTag::Renderer, size_of_buffer);
 	}
 
 	void VertexBuffer::Bind() {
-		if (current_vertex_buffer_id != vertex_buffer_id) {
-			glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_id);
-			current_index_buffer_id = vertex_buffer_id;
+		EMBER_CHECK_GPU_USE(GPUResourceType::Buffer, vertex_buffer);
+		if (current_vertex_buffer_id != vertex_buffer.id) {
+			RendererAPI::Get()->BindBuffer(BufferTarget::Vertex, vertex_buffer.id);
+			current_index_buffer_id = vertex_buffer.id;
 		}
 	}
 
 	void VertexBuffer::UnBind() {
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		RendererAPI::Get()->BindBuffer(BufferTarget::Vertex, 0);
 		current_index_buffer_id = 0;
 	}
 
 	void VertexBuffer::SetData(void* data, uint32_t size, uint32_t offset) {
 		Bind();
-		glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+		RendererAPI::Get()->BufferSubData(BufferTarget::Vertex, offset, size, data);
+	}
+
+	void VertexBuffer::Resize(uint32_t size) {
+		Bind();
+		RendererAPI::Get()->BufferData(BufferTarget::Vertex, size, nullptr, BufferUsage::Dynamic);
+		EMBER_TRACK_GPU_FREE(MemoryTag::Renderer, size_of_buffer);
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Renderer, size);
+		size_of_buffer = size;
 	}
 
 	IndexBuffer::IndexBuffer(uint32_t* indices, uint32_t size) {
-		glGenBuffers(1, &index_buffer_id);
+		bool pooled;
+		index_buffer = GPUResources::CreateBuffer(size, pooled);
 		Bind();
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices, GL_STATIC_DRAW);
+		FillBuffer(BufferTarget::Index, pooled, size, indices, BufferUsage::Static);
 		count = size / sizeof(*indices);
+		size_of_buffer = size;
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Renderer, size);
 	}
 
 	IndexBuffer::IndexBuffer(uint32_t size) {
-		glGenBuffers(1, &index_buffer_id);
+		bool pooled;
+		index_buffer = GPUResources::CreateBuffer(size, pooled);
 		Bind();
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+		FillBuffer(BufferTarget::Index, pooled, size, nullptr, BufferUsage::Dynamic);
 		count = 0;
+		size_of_buffer = size;
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Renderer, size);
 	}
 
 	void IndexBuffer::SetData(uint32_t* data, uint32_t size) {
 		Bind();
-		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, size, data);
+		RendererAPI::Get()->BufferSubData(BufferTarget::Index, 0, size, data);
 		count = size / sizeof(*data);
 	}
 
+	void IndexBuffer::Resize(uint32_t size) {
+		Bind();
+		RendererAPI::Get()->BufferData(BufferTarget::Index, size, nullptr, BufferUsage::Dynamic);
+		EMBER_TRACK_GPU_FREE(MemoryTag::Renderer, size_of_buffer);
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Renderer, size);
+		size_of_buffer = size;
+		count = 0;
+	}
+
 	IndexBuffer::~IndexBuffer() {
-		glDeleteBuffers(1, &index_buffer_id);
+		if (current_index_buffer_id == index_buffer.id)
+			current_index_buffer_id = 0;
+		GPUResources::ReleaseBuffer(index_buffer, size_of_buffer);
+		EMBER_TRACK_GPU_FREE(MemoryTag::Renderer, size_of_buffer);
 	}
 
 	void IndexBuffer::Bind() {
-		if (current_index_buffer_id != index_buffer_id) {
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id);
-			current_index_buffer_id = index_buffer_id;
+		EMBER_CHECK_GPU_USE(GPUResourceType::Buffer, index_buffer);
+		if (current_index_buffer_id != index_buffer.id) {
+			RendererAPI::Get()->BindBuffer(BufferTarget::Index, index_buffer.id);
+			current_index_buffer_id = index_buffer.id;
 		}
 	}
 
 	void IndexBuffer::UnBind() {
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		RendererAPI::Get()->BindBuffer(BufferTarget::Index, 0);
 		current_index_buffer_id = 0;
 	}
 
 	UniformBuffer::UniformBuffer(uint32_t size, uint32_t bindpoint) {
-		glGenBuffers(1, &uniform_buffer_id);
+		bool pooled;
+		uniform_buffer = GPUResources::CreateBuffer(size, pooled);
 		uniform_buffer_point = bindpoint;
 		Bind();
 		AllocateData(size);
-		size_of_buffer = size;
 	}
 
 	UniformBuffer::~UniformBuffer() {
-		glDeleteBuffers(1, &uniform_buffer_id);
+		if (current_uniform_buffer_id == uniform_buffer.id)
+			current_uniform_buffer_id = 0;
+		GPUResources::ReleaseBuffer(uniform_buffer, size_of_buffer);
+		EMBER_TRACK_GPU_FREE(MemoryTag::Renderer, size_of_buffer);
 	}
 
 	void UniformBuffer::Bind() {
-		if (current_uniform_buffer_id != uniform_buffer_id) {
-			glBindBuffer(GL_UNIFORM_BUFFER, uniform_buffer_id);
-			current_uniform_buffer_id = uniform_buffer_id;
+		EMBER_CHECK_GPU_USE(GPUResourceType::Buffer, uniform_buffer);
+		if (current_uniform_buffer_id != uniform_buffer.id) {
+			RendererAPI::Get()->BindBuffer(BufferTarget::Uniform, uniform_buffer.id);
+			current_uniform_buffer_id = uniform_buffer.id;
 		}
 	}
 
 	void UniformBuffer::UnBind() {
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		RendererAPI::Get()->BindBuffer(BufferTarget::Uniform, 0);
+		current_uniform_buffer_id = 0;
 	}
 
 	uint32_t UniformBuffer::GetId() const {
-		return uniform_buffer_id;
+		return uniform_buffer.id;
 	}
 
 	void UniformBuffer::SetData(void* data, uint32_t size, uint32_t offset) {
 		Bind();
-		glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+		RendererAPI::Get()->BufferSubData(BufferTarget::Uniform, offset, size, data);
 	}
 
 	uint32_t UniformBuffer::GetUniformBlockId(uint32_t shader_id, const std::string& block_name) {
-		return glGetUniformBlockIndex(shader_id, block_name.c_str());
+		return RendererAPI::Get()->GetBlockIndex(shader_id, block_name.c_str());
 	}
 
 	void UniformBuffer::BindToShader(uint32_t shader_id, const std::string& block_name) {
-		glUniformBlockBinding(shader_id, GetUniformBlockId(shader_id, block_name), uniform_buffer_point);
+		RendererAPI::Get()->SetUniformBlockBinding(shader_id, GetUniformBlockId(shader_id, block_name), uniform_buffer_point);
 		BindToBindPoint();
 	}
 
 	void UniformBuffer::BindToBindPoint() {
-		glBindBufferRange(GL_UNIFORM_BUFFER, uniform_buffer_point, uniform_buffer_id, 0, size_of_buffer);
+		RendererAPI::Get()->BindBufferRange(BufferTarget::Uniform, uniform_buffer_point, uniform_buffer.id, 0, size_of_buffer);
 	}
 
 	void UniformBuffer::AllocateData(uint32_t size) {
-		glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+		RendererAPI::Get()->BufferData(BufferTarget::Uniform, size, nullptr, BufferUsage::Dynamic);
+		EMBER_TRACK_GPU_FREE(MemoryTag::Renderer, size_of_buffer);
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Renderer, size);
+		size_of_buffer = size;
 	}
 
 	static uint32_t current_indirect_draw_buffer = 0;
 	IndirectDrawBuffer::IndirectDrawBuffer(uint32_t size) {
-		glGenBuffers(1, &indirect_buffer_id);
+		bool pooled;
+		indirect_buffer = GPUResources::CreateBuffer(size, pooled);
 		Bind();
 		AllocateData(size, nullptr);
-		size_of_buffer = size;
 	}
 
 	IndirectDrawBuffer::~IndirectDrawBuffer() {
-		glDeleteBuffers(1, &indirect_buffer_id);
+		if (current_indirect_draw_buffer == indirect_buffer.id)
+			current_indirect_draw_buffer = 0;
+		GPUResources::ReleaseBuffer(indirect_buffer, size_of_buffer);
+		EMBER_TRACK_GPU_FREE(MemoryTag::Renderer, size_of_buffer);
 	}
 
 	void IndirectDrawBuffer::Bind() {
-		if (current_indirect_draw_buffer != indirect_buffer_id) {
-			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer_id);
-			current_indirect_draw_buffer = indirect_buffer_id;
+		EMBER_CHECK_GPU_USE(GPUResourceType::Buffer, indirect_buffer);
+		if (current_indirect_draw_buffer != indirect_buffer.id) {
+			RendererAPI::Get()->BindBuffer(BufferTarget::Indirect, indirect_buffer.id);
+			current_indirect_draw_buffer = indirect_buffer.id;
 		}
 	}
 
 	void IndirectDrawBuffer::UnBind() {
-		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		RendererAPI::Get()->BindBuffer(BufferTarget::Indirect, 0);
+		current_indirect_draw_buffer = 0;
 	}
 
 	uint32_t IndirectDrawBuffer::GetId() const {
-		return indirect_buffer_id;
+		return indirect_buffer.id;
 	}
 
 	void IndirectDrawBuffer::SetData(void* data, uint32_t size, uint32_t offset) {
 		Bind();
-		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, offset, size, data);
+		RendererAPI::Get()->BufferSubData(BufferTarget::Indirect, offset, size, data);
 	}
 
 	void IndirectDrawBuffer::AllocateData(uint32_t size, void* data) {
-		glBufferData(GL_DRAW_INDIRECT_BUFFER, size, data, GL_DYNAMIC_DRAW);
+		RendererAPI::Get()->BufferData(BufferTarget::Indirect, size, data, BufferUsage::Dynamic);
+		EMBER_TRACK_GPU_FREE(MemoryTag::Renderer, size_of_buffer);
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Renderer, size);
+		size_of_buffer = size;
 	}
 
 	static uint32_t current_shader_storage_id = 0;
 	ShaderStorageBuffer::ShaderStorageBuffer(uint32_t size, uint32_t bindpoint) {
-		glGenBuffers(1, &shader_storage_id);
+		bool pooled;
+		shader_storage = GPUResources::CreateBuffer(size, pooled);
 		Bind();
 		AllocateData(size, nullptr);
-		size_of_buffer = size;
 		binding_point = bindpoint;
 	}
 
 	ShaderStorageBuffer::~ShaderStorageBuffer() {
-		glDeleteBuffers(1, &shader_storage_id);
+		if (current_shader_storage_id == shader_storage.id)
+			current_shader_storage_id = 0;
+		GPUResources::ReleaseBuffer(shader_storage, size_of_buffer);
+		EMBER_TRACK_GPU_FREE(MemoryTag::Renderer, size_of_buffer);
 	}
 
 	void ShaderStorageBuffer::Bind() {
-		if (current_shader_storage_id != shader_storage_id) {
-			glBindBuffer(GL_SHADER_STORAGE_BUFFER, shader_storage_id);
-			current_shader_storage_id = shader_storage_id;
+		EMBER_CHECK_GPU_USE(GPUResourceType::Buffer, shader_storage);
+		if (current_shader_storage_id != shader_storage.id) {
+			RendererAPI::Get()->BindBuffer(BufferTarget::ShaderStorage, shader_storage.id);
+			current_shader_storage_id = shader_storage.id;
 		}
 	}
 
 	void ShaderStorageBuffer::UnBind() {
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		RendererAPI::Get()->BindBuffer(BufferTarget::ShaderStorage, 0);
+		current_shader_storage_id = 0;
 	}
 
 	uint32_t ShaderStorageBuffer::GetId() const {
-		return shader_storage_id;
+		return shader_storage.id;
 	}
 
 	void ShaderStorageBuffer::SetData(void* data, uint32_t size, uint32_t offset) {
-		glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data);
+		RendererAPI::Get()->BufferSubData(BufferTarget::ShaderStorage, offset, size, data);
 	}
 
 	void ShaderStorageBuffer::AllocateData(uint32_t size, void* data) {
-		glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW); 
+		RendererAPI::Get()->BufferData(BufferTarget::ShaderStorage, size, nullptr, BufferUsage::Dynamic); 
+		EMBER_TRACK_GPU_FREE(MemoryTag::Renderer, size_of_buffer);
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Renderer, size);
+		size_of_buffer = size;
 	}
 
 	uint32_t ShaderStorageBuffer::GetUniformBlockId(uint32_t shader_id, const std::string& block_name) {
-		return glGetUniformBlockIndex(shader_id, block_name.c_str());
+		return RendererAPI::Get()->GetBlockIndex(shader_id, block_name.c_str());
 	}
 
 	void ShaderStorageBuffer::BindToShader(uint32_t shader_id, const std::string& block_name) {
-		glShaderStorageBlockBinding(shader_id, GetUniformBlockId(shader_id, block_name), binding_point);
+		RendererAPI::Get()->SetStorageBlockBinding(shader_id, GetUniformBlockId(shader_id, block_name), binding_point);
 		BindToBindPoint();
 	}
 
 	void ShaderStorageBuffer::BindToBindPoint() {
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_point, shader_storage_id);
+		RendererAPI::Get()->BindBufferBase(BufferTarget::ShaderStorage, binding_point, shader_storage.id);
 	}
 }
\ No newline at end of file
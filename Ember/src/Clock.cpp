@@ -0,0 +1,29 @@
+#include "Clock.h"
+
+#include <SDL.h>
+
+namespace Ember {
+	uint64_t Clock::Now() {
+		static const uint64_t frequency = SDL_GetPerformanceFrequency();
+		uint64_t counter = SDL_GetPerformanceCounter();
+
+		/* Split to keep counter * 1e9 from overflowing on counters with a high frequency. */
+		return (counter / frequency) * NANOSECONDS_PER_SECOND + ((counter % frequency) * NANOSECONDS_PER_SECOND) / frequency;
+	}
+
+	void GameClock::Advance(uint64_t delta) {
+		if (paused) {
+			delta_time = 0;
+			return;
+		}
+
+		Step(delta);
+	}
+
+	void GameClock::Step(uint64_t delta) {
+		double scaled = delta * scale + remainder;
+		delta_time = (uint64_t)scaled;
+		remainder = scaled - (double)delta_time;
+		time += delta_time;
+	}
+}
@@ -0,0 +1,133 @@
+#include "Collision2D.h"
+#include "FastMath.h"
+
+#include <cfloat>
+
+namespace Ember {
+	/*
+	* 2 when the move misses, so any hit in [0, 1] compares lower. The offset is split along and across the move
+	* rather than solving a*t^2 + 2*b*t + c directly, whose b*b - a*c cancels catastrophically once the move is long.
+	*/
+	static float TimeOfImpact(const SweepQuery& query, const glm::vec2& direction, float inverse_length, const glm::vec3& circle) {
+		glm::vec2 offset = query.start - glm::vec2(circle.x, circle.y);
+		float radius = circle.z + query.radius;
+		if (glm::dot(offset, offset) <= radius * radius)
+			return 0.0f;
+
+		float along = glm::dot(offset, direction) * inverse_length;
+		float across = (offset.x * direction.y - offset.y * direction.x) * inverse_length;
+		float discriminant = radius * radius - across * across;
+		if (along >= 0.0f || discriminant < 0.0f)
+			return 2.0f;
+
+		float time = (-along - std::sqrt(discriminant)) * inverse_length;
+		return (time <= 1.0f) ? time : 2.0f;
+	}
+
+	SweepHit Collision2D::SweepCircle(const SweepQuery& query, const glm::vec3* circles, const uint32_t* ids, uint32_t count) {
+		glm::vec2 direction = query.end - query.start;
+		float direction_squared = glm::dot(direction, direction);
+		/* 0 for a move of no length, which then only hits what it starts in. */
+		float inverse_length = (direction_squared > 0.0f) ? 1.0f / std::sqrt(direction_squared) : 0.0f;
+
+		float best_time = 2.0f;
+		uint32_t best = UINT32_MAX;
+		uint32_t i = 0;
+
+#ifdef EMBER_SIMD_SSE2
+		const __m128 start_x = _mm_set1_ps(query.start.x);
+		const __m128 start_y = _mm_set1_ps(query.start.y);
+		const __m128 direction_x = _mm_set1_ps(direction.x);
+		const __m128 direction_y = _mm_set1_ps(direction.y);
+		const __m128 inverse = _mm_set1_ps(inverse_length);
+		const __m128 query_radius = _mm_set1_ps(query.radius);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 miss = _mm_set1_ps(2.0f);
+
+		__m128 lane_time = miss;
+		__m128i lane_index = _mm_set1_epi32(-1);
+		__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+		const __m128i four = _mm_set1_epi32(4);
+
+		for (; i + 4 <= count; i += 4) {
+			const glm::vec3& c0 = circles[ids[i]];
+			const glm::vec3& c1 = circles[ids[i + 1]];
+			const glm::vec3& c2 = circles[ids[i + 2]];
+			const glm::vec3& c3 = circles[ids[i + 3]];
+
+			__m128 offset_x = _mm_sub_ps(start_x, _mm_setr_ps(c0.x, c1.x, c2.x, c3.x));
+			__m128 offset_y = _mm_sub_ps(start_y, _mm_setr_ps(c0.y, c1.y, c2.y, c3.y));
+			__m128 radius = _mm_add_ps(_mm_setr_ps(c0.z, c1.z, c2.z, c3.z), query_radius);
+
+			__m128 radius_squared = _mm_mul_ps(radius, radius);
+			__m128 inside = _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(offset_x, offset_x), _mm_mul_ps(offset_y, offset_y)), radius_squared);
+			__m128 along = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(offset_x, direction_x), _mm_mul_ps(offset_y, direction_y)), inverse);
+			__m128 across = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(offset_x, direction_y), _mm_mul_ps(offset_y, direction_x)), inverse);
+			__m128 discriminant = _mm_sub_ps(radius_squared, _mm_mul_ps(across, across));
+
+			/* Lanes that miss may take the root of a negative, they are masked out below. */
+			__m128 time = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(zero, along), _mm_sqrt_ps(_mm_max_ps(discriminant, zero))), inverse);
+			__m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(along, zero), _mm_cmpge_ps(discriminant, zero)), _mm_cmple_ps(time, one));
+			time = _mm_or_ps(_mm_and_ps(hit, time), _mm_andnot_ps(hit, miss));
+			time = _mm_andnot_ps(inside, time);
+
+			__m128 better = _mm_cmplt_ps(time, lane_time);
+			lane_time = _mm_or_ps(_mm_and_ps(better, time), _mm_andnot_ps(better, lane_time));
+			__m128i better_mask = _mm_castps_si128(better);
+			lane_index = _mm_or_si128(_mm_and_si128(better_mask, index), _mm_andnot_si128(better_mask, lane_index));
+			index = _mm_add_epi32(index, four);
+		}
+
+		alignas(16) float times[4];
+		alignas(16) int32_t indices[4];
+		_mm_store_ps(times, lane_time);
+		_mm_store_si128((__m128i*)indices, lane_index);
+		for (uint32_t lane = 0; lane < 4; lane++) {
+			if (times[lane] < best_time || (times[lane] == best_time && indices[lane] >= 0 && (uint32_t)indices[lane] < best)) {
+				best_time = times[lane];
+				best = (uint32_t)indices[lane];
+			}
+		}
+#endif
+
+		for (; i < count; i++) {
+			float time = TimeOfImpact(query, direction, inverse_length, circles[ids[i]]);
+			if (time < best_time) {
+				best_time = time;
+				best = i;
+			}
+		}
+
+		SweepHit hit;
+		if (best_time > 1.0f)
+			return hit;
+
+		const glm::vec3& circle = circles[ids[best]];
+		hit.id = ids[best];
+		hit.time = best_time;
+		glm::vec2 center = { circle.x, circle.y };
+		glm::vec2 position = query.start + best_time * direction;
+		glm::vec2 offset = position - center;
+		float length_squared = glm::dot(offset, offset);
+		hit.normal = (length_squared > 0.0f) ? offset * FastMath::InvSqrt(length_squared) : glm::vec2(0.0f, 0.0f);
+		hit.point = center + hit.normal * circle.z;
+		return hit;
+	}
+
+	void Collision2D::SweepCircles(const SweepQuery* queries, uint32_t query_count, const SpatialGrid& grid, const glm::vec3* circles, SweepHit* hits) {
+		std::vector<uint32_t> candidates;
+		for (uint32_t i = 0; i < query_count; i++) {
+			SweepHit& best = hits[i];
+			best = SweepHit();
+
+			/* Cells are walked in order, once a hit lies inside the part already walked nothing later can beat it. */
+			grid.WalkSegment(queries[i].start, queries[i].end, queries[i].radius, candidates, [&](const std::vector<uint32_t>& ids, float t_exit) {
+				SweepHit hit = SweepCircle(queries[i], circles, ids.data(), (uint32_t)ids.size());
+				if (hit.IsHit() && (hit.time < best.time || !best.IsHit()))
+					best = hit;
+				return !best.IsHit() || best.time > t_exit;
+			});
+		}
+	}
+}
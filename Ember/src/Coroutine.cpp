@@ -0,0 +1,208 @@
+#include "Coroutine.h"
+#include "Logger.h"
+#include "MemoryTracker.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace Ember {
+	constexpr size_t COROUTINE_POOL_CLASS_COUNT = 7;
+
+	struct FreeFrame {
+		FreeFrame* next;
+	};
+
+	struct CoroutinePoolData {
+		std::mutex mutex;
+		FreeFrame* free_lists[COROUTINE_POOL_CLASS_COUNT] = { };
+		std::vector<std::pair<void*, size_t>> chunks;
+	};
+
+	static CoroutinePoolData pool_data;
+
+	static size_t SizeClass(size_t size) {
+		size_t class_index = 0;
+		size_t class_size = COROUTINE_POOL_MIN_FRAME;
+		while (class_size < size) {
+			class_size <<= 1;
+			class_index++;
+		}
+		return class_index;
+	}
+
+	void* CoroutineFramePool::Allocate(size_t size) {
+		if (size > COROUTINE_POOL_MAX_FRAME)
+			return malloc(size);
+
+		size_t class_index = SizeClass(size);
+		std::lock_guard<std::mutex> lock(pool_data.mutex);
+
+		if (!pool_data.free_lists[class_index]) {
+			size_t frame_size = COROUTINE_POOL_MIN_FRAME << class_index;
+			uint8_t* chunk = static_cast<uint8_t*>(malloc(frame_size * COROUTINE_POOL_FRAMES_PER_CHUNK));
+			EMBER_TRACK_ALLOC(MemoryTag::Game, frame_size * COROUTINE_POOL_FRAMES_PER_CHUNK);
+			pool_data.chunks.push_back({ chunk, frame_size * COROUTINE_POOL_FRAMES_PER_CHUNK });
+
+			for (size_t i = 0; i < COROUTINE_POOL_FRAMES_PER_CHUNK; i++) {
+				FreeFrame* frame = reinterpret_cast<FreeFrame*>(chunk + i * frame_size);
+				frame->next = pool_data.free_lists[class_index];
+				pool_data.free_lists[class_index] = frame;
+			}
+		}
+
+		FreeFrame* frame = pool_data.free_lists[class_index];
+		pool_data.free_lists[class_index] = frame->next;
+		return frame;
+	}
+
+	void CoroutineFramePool::Free(void* frame, size_t size) {
+		if (size > COROUTINE_POOL_MAX_FRAME) {
+			free(frame);
+			return;
+		}
+
+		size_t class_index = SizeClass(size);
+		std::lock_guard<std::mutex> lock(pool_data.mutex);
+
+		FreeFrame* free_frame = static_cast<FreeFrame*>(frame);
+		free_frame->next = pool_data.free_lists[class_index];
+		pool_data.free_lists[class_index] = free_frame;
+	}
+
+	void CoroutineFramePool::Destroy() {
+		std::lock_guard<std::mutex> lock(pool_data.mutex);
+		for (size_t i = 0; i < COROUTINE_POOL_CLASS_COUNT; i++)
+			pool_data.free_lists[i] = nullptr;
+
+		for (auto& chunk : pool_data.chunks) {
+			free(chunk.first);
+			EMBER_TRACK_FREE(MemoryTag::Game, chunk.second);
+		}
+		pool_data.chunks.clear();
+	}
+
+	struct PendingResume {
+		std::coroutine_handle<> handle;
+		std::function<bool()> condition;
+	};
+
+	struct TaskSchedulerData {
+		TimerWheel* timers = nullptr;
+
+		std::vector<std::coroutine_handle<>> next_frame;
+		std::vector<std::coroutine_handle<>> timer_ready;
+		std::vector<PendingResume> waiting;
+		std::vector<std::coroutine_handle<>> resuming;
+
+		TaskPromiseBase* roots = nullptr;
+		uint32_t active_count = 0;
+		/* Bumped by Destroy, so waits still on the timer wheel from before it do not resume freed frames. */
+		uint32_t generation = 0;
+	};
+
+	static TaskSchedulerData scheduler_data;
+
+	void TaskPromiseBase::FinishDetached(std::coroutine_handle<> handle, TaskPromiseBase* promise) {
+		if (promise->previous)
+			promise->previous->next = promise->next;
+		else
+			scheduler_data.roots = promise->next;
+		if (promise->next)
+			promise->next->previous = promise->previous;
+
+		scheduler_data.active_count--;
+		handle.destroy();
+	}
+
+	void TaskScheduler::Init(TimerWheel* timers) {
+		scheduler_data.timers = timers;
+	}
+
+	void TaskScheduler::Destroy() {
+		scheduler_data.next_frame.clear();
+		scheduler_data.timer_ready.clear();
+		scheduler_data.waiting.clear();
+
+		TaskPromiseBase* it = scheduler_data.roots;
+		while (it) {
+			TaskPromiseBase* next = it->next;
+			Task<void>::Handle::from_promise(static_cast<TaskPromise<void>&>(*it)).destroy();
+			it = next;
+		}
+
+		scheduler_data.roots = nullptr;
+		scheduler_data.active_count = 0;
+		scheduler_data.timers = nullptr;
+		scheduler_data.generation++;
+	}
+
+	void TaskScheduler::Start(Task<void>&& task) {
+		Task<void>::Handle handle = task.Release();
+		if (!handle)
+			return;
+
+		TaskPromiseBase& promise = handle.promise();
+		promise.detached = true;
+		promise.previous = nullptr;
+		promise.next = scheduler_data.roots;
+		if (scheduler_data.roots)
+			scheduler_data.roots->previous = &promise;
+		scheduler_data.roots = &promise;
+		scheduler_data.active_count++;
+
+		handle.resume();
+	}
+
+	void TaskScheduler::Update() {
+		std::vector<std::coroutine_handle<>>& resuming = scheduler_data.resuming;
+		resuming.clear();
+		resuming.swap(scheduler_data.next_frame);
+		resuming.insert(resuming.end(), scheduler_data.timer_ready.begin(), scheduler_data.timer_ready.end());
+		scheduler_data.timer_ready.clear();
+
+		/* Satisfied waits are collected first, resuming can register new waits. */
+		size_t kept = 0;
+		for (size_t i = 0; i < scheduler_data.waiting.size(); i++) {
+			PendingResume& pending = scheduler_data.waiting[i];
+			if (pending.condition())
+				resuming.push_back(pending.handle);
+			else {
+				if (kept != i)
+					scheduler_data.waiting[kept] = std::move(pending);
+				kept++;
+			}
+		}
+		scheduler_data.waiting.resize(kept);
+
+		for (size_t i = 0; i < resuming.size(); i++)
+			resuming[i].resume();
+		resuming.clear();
+	}
+
+	void TaskScheduler::ResumeNextFrame(std::coroutine_handle<> handle) {
+		scheduler_data.next_frame.push_back(handle);
+	}
+
+	void TaskScheduler::ResumeAfter(std::coroutine_handle<> handle, uint64_t delay) {
+		if (!scheduler_data.timers) {
+			EMBER_LOG_ERROR("TaskScheduler has no timer wheel, resuming the next frame.");
+			ResumeNextFrame(handle);
+			return;
+		}
+
+		uint32_t generation = scheduler_data.generation;
+		scheduler_data.timers->Schedule(delay, [handle, generation]() {
+			if (generation == scheduler_data.generation)
+				scheduler_data.timer_ready.push_back(handle);
+		});
+	}
+
+	void TaskScheduler::ResumeWhen(std::coroutine_handle<> handle, const std::function<bool()>& condition) {
+		scheduler_data.waiting.push_back({ handle, condition });
+	}
+
+	uint32_t TaskScheduler::GetActiveCount() {
+		return scheduler_data.active_count;
+	}
+}
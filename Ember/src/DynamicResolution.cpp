@@ -0,0 +1,170 @@
+#include "DynamicResolution.h"
+#include "GPUResources.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "RendererAPI.h"
+#include "RendererCommands.h"
+#include "RenderThread.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Ember {
+	/* Weight of the newest result in the smoothed scene time. */
+	constexpr float SCENE_TIME_SMOOTHING = 0.25f;
+	/* Smaller changes are not worth throwing away the results still in flight. */
+	constexpr float MIN_SCALE_CHANGE = 0.02f;
+	/* Longer results are a stall or a driver hiccup, like the first query of a context on some drivers, not the scene. */
+	constexpr float MAX_SCENE_TIME = 250.0f;
+
+	DynamicResolution::~DynamicResolution() {
+		for (TimerQuery& query : queries)
+			GPUResources::Release(GPUResourceType::TimerQuery, query.id);
+		delete empty_vertex_array;
+	}
+
+	void DynamicResolution::Init(uint32_t width, uint32_t height, const DynamicResolutionSettings& settings, const std::string& shader_path) {
+		this->width = width;
+		this->height = height;
+		this->settings = settings;
+		scale = settings.max_scale;
+		stats.scale = scale;
+
+		target.Init(width, height);
+		if (!target.IsValid()) {
+			EMBER_LOG_WARNING("Dynamic resolution needs render to texture, the scene is drawn at native resolution.");
+			return;
+		}
+
+		upscale_shader.Init(shader_path);
+		empty_vertex_array = new VertexArray();
+		for (TimerQuery& query : queries)
+			query.id = RendererAPI::Get()->CreateTimerQuery();
+		enabled = true;
+	}
+
+	void DynamicResolution::SetEnabled(bool enabled) {
+		this->enabled = enabled && target.IsValid();
+	}
+
+	void DynamicResolution::SetFilter(UpscaleFilter filter) {
+		settings.filter = filter;
+	}
+
+	void DynamicResolution::GetScaledSize(uint32_t& scaled_width, uint32_t& scaled_height) const {
+		scaled_width = std::max((uint32_t)(width * scale + 0.5f), 1u);
+		scaled_height = std::max((uint32_t)(height * scale + 0.5f), 1u);
+	}
+
+	/* Oldest first, results arrive in submission order. */
+	void DynamicResolution::ReadQueries() {
+		RendererAPI* api = RendererAPI::Get();
+		for (uint32_t i = 0; i < DYNAMIC_RESOLUTION_QUERIES; i++) {
+			TimerQuery& query = queries[(next_query + i) % DYNAMIC_RESOLUTION_QUERIES];
+			if (!query.pending)
+				continue;
+
+			uint64_t nanoseconds = 0;
+			if (!api->GetTimerQueryResult(query.id, nanoseconds))
+				break;
+
+			query.pending = false;
+			float scene_time = nanoseconds / 1000000.0f;
+			if (query.frame >= changed_frame && scene_time <= MAX_SCENE_TIME)
+				Adjust(scene_time);
+		}
+	}
+
+	/* The cost is taken to grow with the pixel count, the square of the scale. */
+	void DynamicResolution::Adjust(float scene_time) {
+		stats.scene_time = (stats.scene_time == 0.0f) ? scene_time : stats.scene_time + (scene_time - stats.scene_time) * SCENE_TIME_SMOOTHING;
+
+		float new_scale = scale;
+		if (scene_time > settings.target_time)
+			new_scale = scale * std::sqrt(settings.target_time / scene_time);
+		else if (stats.scene_time < settings.target_time * settings.headroom) {
+			new_scale = scale + settings.increase_step;
+			if (stats.scene_time > 0.0f)
+				new_scale = std::min(new_scale, scale * std::sqrt(settings.target_time * settings.headroom / stats.scene_time));
+		}
+
+		new_scale = std::clamp(new_scale, settings.min_scale, settings.max_scale);
+		bool at_limit = new_scale == settings.min_scale || new_scale == settings.max_scale;
+		if (new_scale == scale || (std::abs(new_scale - scale) < MIN_SCALE_CHANGE && !at_limit))
+			return;
+
+		scale = new_scale;
+		changed_frame = frame;
+		stats.scene_time = 0.0f;
+		stats.adjustments++;
+	}
+
+	void DynamicResolution::BeginScene() {
+		bool enabled = this->enabled;
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([this, enabled]() { Begin(enabled); });
+		Begin(enabled);
+	}
+
+	void DynamicResolution::EndScene() {
+		float sharpness = (settings.filter == UpscaleFilter::Sharpen) ? settings.sharpness : 0.0f;
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([this, sharpness]() { End(sharpness); });
+		End(sharpness);
+	}
+
+	void DynamicResolution::Begin(bool enabled) {
+		frame++;
+		in_scene = enabled;
+		if (!in_scene) {
+			stats.scale = 1.0f;
+			return;
+		}
+
+		ReadQueries();
+		stats.scale = scale;
+		Profiler::SetValue("Render scale (%)", scale * 100.0);
+		Profiler::SetValue("Scene GPU time", stats.scene_time, ProfilerUnit::Milliseconds);
+
+		uint32_t scaled_width, scaled_height;
+		GetScaledSize(scaled_width, scaled_height);
+		target.Bind();
+		RendererCommand::SetViewport(0, 0, scaled_width, scaled_height);
+
+		/* Every query still in flight means the GPU is far behind, this scene goes untimed. */
+		TimerQuery& query = queries[next_query];
+		if (query.pending)
+			return;
+
+		RendererAPI::Get()->BeginTimerQuery(query.id);
+		query.frame = frame;
+		query.pending = true;
+		active_query = &query;
+		next_query = (next_query + 1) % DYNAMIC_RESOLUTION_QUERIES;
+	}
+
+	/* One triangle over the whole window near the far plane, so whatever is drawn after it lands in front. */
+	void DynamicResolution::End(float sharpness) {
+		if (!in_scene)
+			return;
+		in_scene = false;
+
+		RendererAPI* api = RendererAPI::Get();
+		if (active_query) {
+			api->EndTimerQuery();
+			active_query = nullptr;
+		}
+
+		uint32_t scaled_width, scaled_height;
+		GetScaledSize(scaled_width, scaled_height);
+		target.UnBind();
+		RendererCommand::SetViewport(0, 0, width, height);
+		RendererCommand::Clear();
+
+		upscale_shader.Bind();
+		upscale_shader.SetVec3f("params", { (float)scaled_width / width, (float)scaled_height / height, sharpness });
+		api->BindTextureUnit(0, target.GetColorAttachment());
+		empty_vertex_array->Bind();
+		api->DrawArraysInstanced(3, 1);
+	}
+}
@@ -88,8 +88,7 @@ namespace Ember {
 		if (native_event_handler.type == SDL_WINDOWEVENT) {
 			if (native_event_handler.window.event == SDL_WINDOWEVENT_RESIZED) {
 				ResizeEvent resize(native_event_handler.window.data1, native_event_handler.window.data2);
-				window->Properties()->width = resize.w;
-				window->Properties()->height = resize.h;
+				window->OnResized(resize.w, resize.h);
 				callback(resize);
 			}
 		}
@@ -0,0 +1,108 @@
+#include "FastMath.h"
+
+namespace Ember {
+#ifdef EMBER_SIMD_AVX2
+	static void Quadrant8(__m256i quadrant, __m256 r, float* sines, float* cosines) {
+		__m256 r2 = _mm256_mul_ps(r, r);
+		__m256 sin_poly = _mm256_add_ps(_mm256_set1_ps(FAST_MATH_SIN_2), _mm256_mul_ps(r2, _mm256_set1_ps(FAST_MATH_SIN_3)));
+		sin_poly = _mm256_add_ps(_mm256_set1_ps(FAST_MATH_SIN_1), _mm256_mul_ps(r2, sin_poly));
+		__m256 sin_r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), sin_poly));
+
+		__m256 cos_poly = _mm256_add_ps(_mm256_set1_ps(FAST_MATH_COS_2), _mm256_mul_ps(r2, _mm256_set1_ps(FAST_MATH_COS_3)));
+		cos_poly = _mm256_add_ps(_mm256_set1_ps(FAST_MATH_COS_1), _mm256_mul_ps(r2, cos_poly));
+		__m256 cos_r = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(_mm256_set1_ps(0.5f), r2)),
+			_mm256_mul_ps(_mm256_mul_ps(r2, r2), cos_poly));
+
+		__m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+		__m256 sine = _mm256_blendv_ps(sin_r, cos_r, swap);
+		__m256 cosine = _mm256_blendv_ps(cos_r, sin_r, swap);
+
+		__m256 sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+		__m256 cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+		_mm256_storeu_ps(sines, _mm256_xor_ps(sine, sin_sign));
+		_mm256_storeu_ps(cosines, _mm256_xor_ps(cosine, cos_sign));
+	}
+
+	/* Round half away from zero, matching the scalar reduction. */
+	static __m256 Round8(__m256 x) {
+		__m256 half = _mm256_or_ps(_mm256_set1_ps(0.5f), _mm256_and_ps(x, _mm256_set1_ps(-0.0f)));
+		return _mm256_round_ps(_mm256_add_ps(x, half), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+	}
+#endif
+
+#ifdef EMBER_SIMD_SSE2
+	static void Quadrant4(__m128i quadrant, __m128 r, float* sines, float* cosines) {
+		__m128 r2 = _mm_mul_ps(r, r);
+		__m128 sin_poly = _mm_add_ps(_mm_set1_ps(FAST_MATH_SIN_2), _mm_mul_ps(r2, _mm_set1_ps(FAST_MATH_SIN_3)));
+		sin_poly = _mm_add_ps(_mm_set1_ps(FAST_MATH_SIN_1), _mm_mul_ps(r2, sin_poly));
+		__m128 sin_r = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), sin_poly));
+
+		__m128 cos_poly = _mm_add_ps(_mm_set1_ps(FAST_MATH_COS_2), _mm_mul_ps(r2, _mm_set1_ps(FAST_MATH_COS_3)));
+		cos_poly = _mm_add_ps(_mm_set1_ps(FAST_MATH_COS_1), _mm_mul_ps(r2, cos_poly));
+		__m128 cos_r = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_mul_ps(_mm_mul_ps(r2, r2), cos_poly));
+
+		/* SSE2 has no blend, select with and/andnot. */
+		__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+		__m128 sine = _mm_or_ps(_mm_and_ps(swap, cos_r), _mm_andnot_ps(swap, sin_r));
+		__m128 cosine = _mm_or_ps(_mm_and_ps(swap, sin_r), _mm_andnot_ps(swap, cos_r));
+
+		__m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+		__m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+		_mm_storeu_ps(sines, _mm_xor_ps(sine, sin_sign));
+		_mm_storeu_ps(cosines, _mm_xor_ps(cosine, cos_sign));
+	}
+
+	static __m128 Round4(__m128 x) {
+		__m128 half = _mm_or_ps(_mm_set1_ps(0.5f), _mm_and_ps(x, _mm_set1_ps(-0.0f)));
+		return _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_add_ps(x, half)));
+	}
+#endif
+
+	void FastMath::SinCos(const float* radians, float* sines, float* cosines, size_t count) {
+		size_t i = 0;
+#ifdef EMBER_SIMD_AVX2
+		for (; i + 8 <= count; i += 8) {
+			__m256 x = _mm256_loadu_ps(radians + i);
+			__m256 k = Round8(_mm256_mul_ps(x, _mm256_set1_ps(FAST_MATH_TWO_OVER_PI)));
+			__m256 r = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(FAST_MATH_REDUCE_1)));
+			r = _mm256_sub_ps(r, _mm256_mul_ps(k, _mm256_set1_ps(FAST_MATH_REDUCE_2)));
+			r = _mm256_sub_ps(r, _mm256_mul_ps(k, _mm256_set1_ps(FAST_MATH_REDUCE_3)));
+			Quadrant8(_mm256_cvttps_epi32(k), r, sines + i, cosines + i);
+		}
+#endif
+#ifdef EMBER_SIMD_SSE2
+		for (; i + 4 <= count; i += 4) {
+			__m128 x = _mm_loadu_ps(radians + i);
+			__m128 k = Round4(_mm_mul_ps(x, _mm_set1_ps(FAST_MATH_TWO_OVER_PI)));
+			__m128 r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(FAST_MATH_REDUCE_1)));
+			r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(FAST_MATH_REDUCE_2)));
+			r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(FAST_MATH_REDUCE_3)));
+			Quadrant4(_mm_cvttps_epi32(k), r, sines + i, cosines + i);
+		}
+#endif
+		for (; i < count; i++)
+			SinCos(radians[i], sines[i], cosines[i]);
+	}
+
+	void FastMath::SinCosDegrees(const float* degrees, float* sines, float* cosines, size_t count) {
+		size_t i = 0;
+#ifdef EMBER_SIMD_AVX2
+		for (; i + 8 <= count; i += 8) {
+			__m256 x = _mm256_loadu_ps(degrees + i);
+			__m256 k = Round8(_mm256_mul_ps(x, _mm256_set1_ps(1.0f / 90.0f)));
+			__m256 r = _mm256_mul_ps(_mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(90.0f))), _mm256_set1_ps(FAST_MATH_DEGREES_TO_RADIANS));
+			Quadrant8(_mm256_cvttps_epi32(k), r, sines + i, cosines + i);
+		}
+#endif
+#ifdef EMBER_SIMD_SSE2
+		for (; i + 4 <= count; i += 4) {
+			__m128 x = _mm_loadu_ps(degrees + i);
+			__m128 k = Round4(_mm_mul_ps(x, _mm_set1_ps(1.0f / 90.0f)));
+			__m128 r = _mm_mul_ps(_mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(90.0f))), _mm_set1_ps(FAST_MATH_DEGREES_TO_RADIANS));
+			Quadrant4(_mm_cvttps_epi32(k), r, sines + i, cosines + i);
+		}
+#endif
+		for (; i < count; i++)
+			SinCosDegrees(degrees[i], sines[i], cosines[i]);
+	}
+}
@@ -1,9 +1,13 @@
 #include "Font.h"
 #include "Assets.h"
 #include "Logger.h"
+#include "MemoryTracker.h"
 #include "TextureAtlas.h"
-#include <glad/glad.h>
+#include "RendererAPI.h"
+#include "GPUResources.h"
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 #define ASCII_SIZE 128
 
@@ -21,7 +25,6 @@ namespace Ember {
         this->size = size;
         FT_Set_Pixel_Sizes(face, 0, size);
 
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  
         uint32_t w = 0, h = 0;
         for (unsigned char c = 0; c < ASCII_SIZE; c++) {
             if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
@@ -35,24 +38,8 @@ namespace Ember {
             w += face->glyph->bitmap.width;
         }
 
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            w,
-            h,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            nullptr
-        );
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        /* Glyphs are laid out left to right on the CPU and the atlas is uploaded once. */
+        std::vector<uint8_t> atlas((size_t)w * h, 0);
 
         uint32_t ox = 0;
         for (unsigned char c = 0; c < ASCII_SIZE; c++) {
@@ -71,27 +58,36 @@ namespace Ember {
             glyph.offset = TextureAtlas::CalculateSpriteCoordinate({ ox, 0 }, w, h).x;
             glyphs.insert(std::pair<char, Glyph>(c, glyph));
             
-            glTexSubImage2D(GL_TEXTURE_2D, 0, ox, 0, face->glyph->bitmap.width, face->glyph->bitmap.rows, GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
-            ox += face->glyph->bitmap.width;
+            const FT_Bitmap& bitmap = face->glyph->bitmap;
+            for (uint32_t row = 0; row < bitmap.rows; row++)
+                memcpy(&atlas[(size_t)row * w + ox], bitmap.buffer + (size_t)row * bitmap.pitch, bitmap.width);
+            ox += bitmap.width;
         }
 
         width = w;
         height = h;
+        bool pooled;
+        atlas_texture = GPUResources::CreateTexture(w, h, TextureFormat::R8, pooled);
+        texture = atlas_texture.id;
+        RendererAPI::Get()->SetTextureData(texture, w, h, TextureFormat::R8, atlas.data());
+        EMBER_TRACK_GPU_ALLOC(MemoryTag::Font, width * height);
+        EMBER_TRACK_ALLOC(MemoryTag::Font, glyphs.size() * sizeof(std::pair<const char, Glyph>));
 
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
         FT_Done_Face(face);
 	}
 
     Font::~Font() {
-        glDeleteTextures(1, &texture);
+        GPUResources::ReleaseTexture(atlas_texture, width, height, TextureFormat::R8);
+        EMBER_TRACK_GPU_FREE(MemoryTag::Font, width * height);
+        EMBER_TRACK_FREE(MemoryTag::Font, glyphs.size() * sizeof(std::pair<const char, Glyph>));
     }
 
     uint32_t Font::GetSizeOfText(const std::string& text) {
         uint32_t w = 0;
         for (auto& c : text) {
-            Glyph character = glyphs[c];
-
-            w += character.size.x;
+            auto glyph = glyphs.find(c);
+            if (glyph != glyphs.end())
+                w += glyph->second.size.x;
         }
 
         return w;
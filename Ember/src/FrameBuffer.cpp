@@ -1,5 +1,8 @@
 #include "FrameBuffer.h"
 #include "Logger.h"
+#include "MemoryTracker.h"
+#include "GPUResources.h"
+#include "RendererAPI.h"
 
 #include <iostream>
 #include <glad/glad.h>
@@ -10,51 +13,32 @@ namespace Ember {
 	}
 
 	void FrameBuffer::Init(uint32_t width, uint32_t height) {
-		glGenFramebuffers(1, &frame_buffer_id);
-		Bind();
+		this->width = width;
+		this->height = height;
+		frame_buffer_id = RendererAPI::Get()->CreateFrameBuffer(width, height, color_attachment, depth_stencil_attachment);
+		if (!frame_buffer_id)
+			return;
 
-		glCreateTextures(GL_TEXTURE_2D, 1, &color_attachment);
-		glBindTexture(GL_TEXTURE_2D, color_attachment);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color_attachment, 0);
-
-		glCreateTextures(GL_TEXTURE_2D, 1, &depth_stencil_attachment);
-		glBindTexture(GL_TEXTURE_2D, depth_stencil_attachment);
-
-		glTexImage2D(
-			GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0,
-			GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL
-		);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth_stencil_attachment, 0);
-
-		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-			EMBER_LOG_ERROR("Failed to load framebuffer.");
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-		UnBind();
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Texture, width * height * 8);
 	}
 
 	FrameBuffer::~FrameBuffer() {
-		glDeleteFramebuffers(1, &frame_buffer_id);
-		glDeleteTextures(1, &color_attachment);
-		glDeleteTextures(1, &depth_stencil_attachment);
+		if (!frame_buffer_id)
+			return;
+
+		/* The attachments have their own filtering and a depth format, so they are deleted rather than pooled. */
+		GPUResources::Release(GPUResourceType::FrameBuffer, frame_buffer_id);
+		GPUResources::Release(GPUResourceType::Texture, color_attachment);
+		GPUResources::Release(GPUResourceType::Texture, depth_stencil_attachment);
+		EMBER_TRACK_GPU_FREE(MemoryTag::Texture, width * height * 8);
 	}
 
 	void FrameBuffer::Bind() {
-		glBindFramebuffer(GL_FRAMEBUFFER, frame_buffer_id);
+		RendererAPI::Get()->BindFrameBuffer(frame_buffer_id);
 	}
 
 	void FrameBuffer::UnBind() {
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		RendererAPI::Get()->BindFrameBuffer(0);
 		/*
 		glBindTexture(GL_TEXTURE_2D, color_attachment);
 		char unsigned pixels[20][20][3];
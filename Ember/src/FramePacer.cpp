@@ -0,0 +1,62 @@
+#include "FramePacer.h"
+#include "Profiler.h"
+
+#include <SDL.h>
+
+namespace Ember {
+	void FramePacer::SetTargetFrameRate(float frame_rate) {
+		target_frame_rate = (frame_rate > 0.0f) ? frame_rate : 0.0f;
+		frame_ticks = (target_frame_rate > 0.0f) ? (uint64_t)(SDL_GetPerformanceFrequency() / target_frame_rate) : 0;
+		next_deadline = 0;
+	}
+
+	void FramePacer::Wait() {
+		if (!frame_ticks)
+			return;
+
+		uint64_t frequency = SDL_GetPerformanceFrequency();
+		uint64_t now = SDL_GetPerformanceCounter();
+
+		/* Restart the schedule after a long stall instead of trying to catch up with a burst of frames. */
+		if (next_deadline == 0 || now > next_deadline + frame_ticks) {
+			next_deadline = now + frame_ticks;
+			return;
+		}
+
+		uint64_t spin_ticks = (uint64_t)(frequency * (FRAME_PACER_SPIN_MS / 1000.0f));
+		if (next_deadline > now + spin_ticks)
+			SDL_Delay((uint32_t)((next_deadline - now - spin_ticks) * 1000 / frequency));
+
+		while (SDL_GetPerformanceCounter() < next_deadline) { }
+
+		next_deadline += frame_ticks;
+	}
+
+	void FramePacer::OnPresent() {
+		uint64_t now = SDL_GetPerformanceCounter();
+		if (last_present == 0) {
+			last_present = now;
+			return;
+		}
+
+		float frame_time = (float)((now - last_present) * 1000 / (double)SDL_GetPerformanceFrequency());
+		last_present = now;
+
+		if (stats.presented_frames == 0)
+			stats.average_frame_time = frame_time;
+
+		float deviation = frame_time - stats.average_frame_time;
+		stats.average_frame_time += deviation * 0.05f;
+		stats.jitter += (((deviation < 0.0f) ? -deviation : deviation) - stats.jitter) * 0.05f;
+		stats.frame_time = frame_time;
+		stats.presented_frames++;
+
+		float expected = (target_frame_rate > 0.0f) ? 1000.0f / target_frame_rate : expected_frame_time;
+		if (expected > 0.0f && frame_time > expected * FRAME_PACER_MISS_FACTOR)
+			stats.missed_frames++;
+
+		Profiler::SetValue("Frame time", stats.average_frame_time, ProfilerUnit::Milliseconds);
+		Profiler::SetValue("Frame jitter", stats.jitter, ProfilerUnit::Milliseconds);
+		Profiler::SetValue("Missed frames", (double)stats.missed_frames);
+	}
+}
@@ -0,0 +1,332 @@
+#include "GPUResources.h"
+#include "RenderThread.h"
+#include "Profiler.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Ember {
+	struct GPUResource {
+		GPUResourceType type;
+		uint32_t id;
+		/* Size in bytes for buffers. */
+		uint32_t width = 0;
+		uint32_t height = 0;
+		TextureFormat format = TextureFormat::RGBA8;
+		bool poolable = false;
+	};
+
+	struct RetiringFrame {
+		uint64_t fence;
+		std::vector<GPUResource> resources;
+	};
+
+	struct PooledResource {
+		GPUResource resource;
+		uint64_t frame;
+	};
+
+	enum class HandleState : uint8_t {
+		Live, Released, Deleted
+	};
+
+	/* Kept after the object is deleted, so the generation keeps counting if the backend gives the id out again. */
+	struct HandleSlot {
+		uint32_t generation = 0;
+		HandleState state = HandleState::Deleted;
+	};
+
+	struct GPUResourcesData {
+		std::mutex mutex;
+		std::vector<GPUResource> pending;
+		/* Pooled types by id, under the mutex since releases come from any thread. */
+		std::unordered_map<uint32_t, HandleSlot> buffer_slots;
+		std::unordered_map<uint32_t, HandleSlot> texture_slots;
+		uint64_t misuses = 0;
+		bool assert_on_misuse = true;
+
+		std::deque<RetiringFrame> retiring;
+		std::vector<PooledResource> pool;
+		uint64_t pooled_bytes = 0;
+		uint64_t frame = 0;
+		GPUResourceStats stats;
+	};
+
+	static GPUResourcesData resources_data;
+
+	static uint64_t GetSizeInBytes(const GPUResource& resource) {
+		if (resource.type == GPUResourceType::Buffer)
+			return resource.width;
+		return (uint64_t)resource.width * resource.height * GetBytesPerPixel(resource.format);
+	}
+
+	static std::unordered_map<uint32_t, HandleSlot>* GetSlots(GPUResourceType type) {
+		if (type == GPUResourceType::Buffer)
+			return &resources_data.buffer_slots;
+		if (type == GPUResourceType::Texture)
+			return &resources_data.texture_slots;
+		return nullptr;
+	}
+
+	/* Under the mutex. */
+	static void ReportMisuse(GPUResourceType type, uint32_t id, const char* what) {
+		resources_data.misuses++;
+		EMBER_LOG_ERROR("GPU %s %u %s.", type == GPUResourceType::Buffer ? "buffer" : "texture", id, what);
+		if (resources_data.assert_on_misuse)
+			assert(!"GPU resource misuse");
+	}
+
+	/* Marks the id handed out to a new owner and returns its handle. */
+	static GPUHandle HandOut(GPUResourceType type, uint32_t id) {
+		std::lock_guard<std::mutex> lock(resources_data.mutex);
+		HandleSlot& slot = (*GetSlots(type))[id];
+		slot.state = HandleState::Live;
+		return { id, slot.generation };
+	}
+
+	/* False, after reporting it, when the handle is not the live one for its id. */
+	static bool Retire(GPUResourceType type, const GPUHandle& handle) {
+		std::lock_guard<std::mutex> lock(resources_data.mutex);
+		auto& slots = *GetSlots(type);
+		auto slot = slots.find(handle.id);
+		if (slot == slots.end() || slot->second.state != HandleState::Live || slot->second.generation != handle.generation) {
+			ReportMisuse(type, handle.id, "released twice");
+			return false;
+		}
+
+		slot->second.state = HandleState::Released;
+		slot->second.generation++;
+		return true;
+	}
+
+	static void Delete(const GPUResource& resource) {
+		if (auto* slots = GetSlots(resource.type)) {
+			std::lock_guard<std::mutex> lock(resources_data.mutex);
+			auto slot = slots->find(resource.id);
+			if (slot != slots->end())
+				slot->second.state = HandleState::Deleted;
+		}
+
+		RendererAPI* api = RendererAPI::Get();
+		switch (resource.type) {
+		case GPUResourceType::Buffer: api->DeleteBuffer(resource.id); break;
+		case GPUResourceType::VertexArray: api->DeleteVertexArray(resource.id); break;
+		case GPUResourceType::Program: api->DeleteProgram(resource.id); break;
+		case GPUResourceType::Texture: api->DeleteTexture(resource.id); break;
+		case GPUResourceType::FrameBuffer: api->DeleteFrameBuffer(resource.id); break;
+		case GPUResourceType::TimerQuery: api->DeleteTimerQuery(resource.id); break;
+		}
+		resources_data.stats.deleted++;
+	}
+
+	static void Reclaim(const GPUResource& resource) {
+		uint64_t bytes = GetSizeInBytes(resource);
+		if (!resource.poolable || resources_data.pooled_bytes + bytes > GPU_POOL_MAX_BYTES)
+			return Delete(resource);
+
+		resources_data.pool.push_back({ resource, resources_data.frame });
+		resources_data.pooled_bytes += bytes;
+	}
+
+	static void Enqueue(const GPUResource& resource) {
+		std::lock_guard<std::mutex> lock(resources_data.mutex);
+		resources_data.pending.push_back(resource);
+	}
+
+	/* The most recently pooled match, so the rest of the pool can age out. */
+	static uint32_t Acquire(GPUResourceType type, uint32_t width, uint32_t height, TextureFormat format) {
+		auto& pool = resources_data.pool;
+		for (size_t i = pool.size(); i-- > 0;) {
+			const GPUResource& resource = pool[i].resource;
+			if (resource.type != type || resource.width != width || resource.height != height || resource.format != format)
+				continue;
+
+			uint32_t id = resource.id;
+			resources_data.pooled_bytes -= GetSizeInBytes(resource);
+			pool.erase(pool.begin() + i);
+			resources_data.stats.reused++;
+			return id;
+		}
+		return 0;
+	}
+
+	void GPUResources::Release(GPUResourceType type, uint32_t id) {
+		if (!id)
+			return;
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { Release(type, id); });
+
+		GPUResource resource;
+		resource.type = type;
+		resource.id = id;
+		Enqueue(resource);
+	}
+
+	void GPUResources::ReleaseBuffer(GPUHandle& handle, uint32_t size) {
+		GPUHandle released = handle;
+		handle = GPUHandle();
+		if (!released.IsValid())
+			return;
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() mutable { ReleaseBuffer(released, size); });
+		if (!Retire(GPUResourceType::Buffer, released))
+			return;
+
+		GPUResource resource;
+		resource.type = GPUResourceType::Buffer;
+		resource.id = released.id;
+		resource.width = size;
+		resource.poolable = size > 0;
+		Enqueue(resource);
+	}
+
+	void GPUResources::ReleaseTexture(GPUHandle& handle, uint32_t width, uint32_t height, TextureFormat format) {
+		GPUHandle released = handle;
+		handle = GPUHandle();
+		if (!released.IsValid())
+			return;
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() mutable { ReleaseTexture(released, width, height, format); });
+		if (!Retire(GPUResourceType::Texture, released))
+			return;
+
+		GPUResource resource;
+		resource.type = GPUResourceType::Texture;
+		resource.id = released.id;
+		resource.width = width;
+		resource.height = height;
+		resource.format = format;
+		resource.poolable = width > 0 && height > 0;
+		Enqueue(resource);
+	}
+
+	GPUHandle GPUResources::CreateBuffer(uint32_t size, bool& pooled) {
+		uint32_t id = Acquire(GPUResourceType::Buffer, size, 0, TextureFormat::RGBA8);
+		pooled = id != 0;
+		return HandOut(GPUResourceType::Buffer, pooled ? id : RendererAPI::Get()->CreateBuffer());
+	}
+
+	GPUHandle GPUResources::CreateTexture(uint32_t width, uint32_t height, TextureFormat format, bool& pooled) {
+		uint32_t id = Acquire(GPUResourceType::Texture, width, height, format);
+		pooled = id != 0;
+		return HandOut(GPUResourceType::Texture, pooled ? id : RendererAPI::Get()->CreateTexture(width, height, format));
+	}
+
+	bool GPUResources::IsLive(GPUResourceType type, GPUHandle handle) {
+		std::lock_guard<std::mutex> lock(resources_data.mutex);
+		auto& slots = *GetSlots(type);
+		auto slot = slots.find(handle.id);
+		return slot != slots.end() && slot->second.state == HandleState::Live && slot->second.generation == handle.generation;
+	}
+
+	bool GPUResources::IsReleased(GPUResourceType type, uint32_t id) {
+		std::lock_guard<std::mutex> lock(resources_data.mutex);
+		auto& slots = *GetSlots(type);
+		auto slot = slots.find(id);
+		return slot != slots.end() && slot->second.state == HandleState::Released;
+	}
+
+	void GPUResources::CheckUse(GPUResourceType type, GPUHandle handle) {
+		if (handle.IsValid() && !IsLive(type, handle)) {
+			std::lock_guard<std::mutex> lock(resources_data.mutex);
+			ReportMisuse(type, handle.id, "used after its release");
+		}
+	}
+
+	void GPUResources::CheckUse(GPUResourceType type, uint32_t id) {
+		if (id && IsReleased(type, id)) {
+			std::lock_guard<std::mutex> lock(resources_data.mutex);
+			ReportMisuse(type, id, "used after its release");
+		}
+	}
+
+	void GPUResources::SetAssertOnMisuse(bool enabled) {
+		resources_data.assert_on_misuse = enabled;
+	}
+
+	void GPUResources::EndFrame() {
+		RendererAPI* api = RendererAPI::Get();
+		resources_data.frame++;
+
+		auto& retiring = resources_data.retiring;
+		while (!retiring.empty() && api->IsFenceSignaled(retiring.front().fence)) {
+			for (const GPUResource& resource : retiring.front().resources)
+				Reclaim(resource);
+			api->DeleteFence(retiring.front().fence);
+			retiring.pop_front();
+		}
+
+		auto& pool = resources_data.pool;
+		auto expired = std::remove_if(pool.begin(), pool.end(), [](const PooledResource& pooled) {
+			if (resources_data.frame - pooled.frame <= GPU_POOL_MAX_FRAMES)
+				return false;
+
+			resources_data.pooled_bytes -= GetSizeInBytes(pooled.resource);
+			Delete(pooled.resource);
+			return true;
+		});
+		pool.erase(expired, pool.end());
+
+		std::vector<GPUResource> released;
+		{
+			std::lock_guard<std::mutex> lock(resources_data.mutex);
+			released.swap(resources_data.pending);
+		}
+		if (!released.empty())
+			retiring.push_back({ api->InsertFence(), std::move(released) });
+
+		Profiler::SetValue("GPU objects retiring", GetStats().retiring);
+		Profiler::SetValue("GPU pool", (double)resources_data.pooled_bytes, ProfilerUnit::Bytes);
+	}
+
+	void GPUResources::Flush() {
+		RendererAPI* api = RendererAPI::Get();
+		api->Finish();
+
+		std::vector<GPUResource> released;
+		{
+			std::lock_guard<std::mutex> lock(resources_data.mutex);
+			released.swap(resources_data.pending);
+		}
+
+		for (RetiringFrame& frame : resources_data.retiring) {
+			for (const GPUResource& resource : frame.resources)
+				Delete(resource);
+			api->DeleteFence(frame.fence);
+		}
+		for (const GPUResource& resource : released)
+			Delete(resource);
+		for (const PooledResource& pooled : resources_data.pool)
+			Delete(pooled.resource);
+
+		resources_data.retiring.clear();
+		resources_data.pool.clear();
+		resources_data.pooled_bytes = 0;
+	}
+
+	GPUResourceStats GPUResources::GetStats() {
+		GPUResourceStats stats = resources_data.stats;
+		{
+			std::lock_guard<std::mutex> lock(resources_data.mutex);
+			stats.pending = (uint32_t)resources_data.pending.size();
+			stats.misuses = resources_data.misuses;
+		}
+
+		stats.retiring_frames = (uint32_t)resources_data.retiring.size();
+		for (const RetiringFrame& frame : resources_data.retiring)
+			stats.retiring += (uint32_t)frame.resources.size();
+		for (const PooledResource& pooled : resources_data.pool) {
+			if (pooled.resource.type == GPUResourceType::Buffer)
+				stats.pooled_buffers++;
+			else
+				stats.pooled_textures++;
+		}
+		stats.pooled_bytes = resources_data.pooled_bytes;
+		return stats;
+	}
+}
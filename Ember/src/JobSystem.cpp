@@ -0,0 +1,125 @@
+#include "JobSystem.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Ember {
+	struct QueuedJob {
+		JobSystem::Job job;
+		JobCounter* counter;
+	};
+
+	struct JobSystemData {
+		std::vector<std::thread> workers;
+		std::deque<QueuedJob> queue;
+		std::mutex mutex;
+		std::condition_variable job_available;
+		bool stop = false;
+	};
+
+	static JobSystemData job_data;
+
+	static void RunJob(QueuedJob& queued) {
+		queued.job();
+		if (queued.counter)
+			queued.counter->pending.fetch_sub(1, std::memory_order_release);
+	}
+
+	static bool TryRunJob() {
+		QueuedJob queued;
+		{
+			std::lock_guard<std::mutex> lock(job_data.mutex);
+			if (job_data.queue.empty())
+				return false;
+			queued = std::move(job_data.queue.front());
+			job_data.queue.pop_front();
+		}
+
+		RunJob(queued);
+		return true;
+	}
+
+	static void WorkerLoop() {
+		while (true) {
+			QueuedJob queued;
+			{
+				std::unique_lock<std::mutex> lock(job_data.mutex);
+				job_data.job_available.wait(lock, [] { return job_data.stop || !job_data.queue.empty(); });
+				if (job_data.queue.empty())
+					return;
+
+				queued = std::move(job_data.queue.front());
+				job_data.queue.pop_front();
+			}
+
+			RunJob(queued);
+		}
+	}
+
+	void JobSystem::Init(uint32_t thread_count) {
+		if (!job_data.workers.empty())
+			return;
+
+		if (thread_count == UINT32_MAX) {
+			uint32_t hardware_threads = std::thread::hardware_concurrency();
+			thread_count = (hardware_threads > 1) ? hardware_threads - 1 : 1;
+		}
+
+		job_data.stop = false;
+		for (uint32_t i = 0; i < thread_count; i++)
+			job_data.workers.emplace_back(WorkerLoop);
+	}
+
+	void JobSystem::Destroy() {
+		{
+			std::lock_guard<std::mutex> lock(job_data.mutex);
+			job_data.stop = true;
+		}
+		job_data.job_available.notify_all();
+
+		for (auto& worker : job_data.workers)
+			worker.join();
+		job_data.workers.clear();
+	}
+
+	void JobSystem::Submit(const Job& job, JobCounter* counter) {
+		if (counter)
+			counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+		if (job_data.workers.empty()) {
+			QueuedJob queued = { job, counter };
+			RunJob(queued);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(job_data.mutex);
+			job_data.queue.push_back({ job, counter });
+		}
+		job_data.job_available.notify_one();
+	}
+
+	void JobSystem::ParallelFor(uint32_t count, uint32_t batch_size, const RangeJob& job, JobCounter* counter) {
+		if (batch_size == 0)
+			batch_size = 1;
+
+		for (uint32_t begin = 0; begin < count; begin += batch_size) {
+			uint32_t end = (begin + batch_size < count) ? begin + batch_size : count;
+			Submit([job, begin, end]() { job(begin, end); }, counter);
+		}
+	}
+
+	void JobSystem::Wait(JobCounter& counter) {
+		while (!counter.IsComplete()) {
+			if (!TryRunJob())
+				std::this_thread::yield();
+		}
+	}
+
+	uint32_t JobSystem::GetThreadCount() {
+		return (uint32_t)job_data.workers.size();
+	}
+}
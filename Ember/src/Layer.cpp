@@ -1,4 +1,9 @@
 #include "Layer.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "Clock.h"
+
+#include <algorithm>
 
 namespace Ember {
 	LayerStack::~LayerStack() {
@@ -33,4 +38,23 @@ namespace Ember {
 			layers.erase(it);
 		}
 	}
-}
\ No newline at end of file
+
+	static void UpdateLayer(Layer* layer, float delta) {
+		uint64_t start = Clock::Now();
+		layer->OnUpdate(delta);
+		Profiler::SetValue(layer->GetName().c_str(), Clock::ToMilliseconds(Clock::Now() - start), ProfilerUnit::Milliseconds);
+	}
+
+	void LayerStack::Update(float delta) {
+		JobCounter counter;
+		for (Layer* layer : layers)
+			if (layer->IsIndependent())
+				JobSystem::Submit([layer, delta]() { UpdateLayer(layer, delta); }, &counter);
+
+		for (Layer* layer : layers)
+			if (!layer->IsIndependent())
+				UpdateLayer(layer, delta);
+
+		JobSystem::Wait(counter);
+	}
+}
@@ -1,4 +1,5 @@
 #include "Logger.h"
+#include "MemoryTracker.h"
 #include <cstdarg>
 #include <ctime>
 #include <sstream>
@@ -11,15 +12,17 @@ namespace Ember {
         const std::time_t now = std::time(nullptr); 
         const std::tm calendar_time = *std::localtime(std::addressof(now));
 
-        command_output = std::to_string(calendar_time.tm_hour) + ":" + std::to_string(calendar_time.tm_min) + ":" + std::to_string(calendar_time.tm_sec);
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%d:%d:%d", calendar_time.tm_hour, calendar_time.tm_min, calendar_time.tm_sec);
+        command_output = buffer;
     }
 
     void TimestampLogCommand::ProcessArgs(va_list& args) { }
 
-    void LogCommand::AddToOutput(std::string& output, std::vector<LogCommand*>& commands) {
+    void LogCommand::AddToOutput(ArenaString& output, std::vector<LogCommand*>& commands) {
         size_t pos = GetPosition();
-        size_t size = GetCommandOutput().size();
-        output.insert(GetPosition(), GetCommandOutput());
+        size_t size = command_output.size();
+        output.insert(GetPosition(), command_output.c_str(), size);
         for (auto& command : commands)
             if (pos < command->GetPosition())
                 command->SetPosition(command->GetPosition() + size);
@@ -36,7 +39,7 @@ namespace Ember {
         vsnprintf(buffer, MAX_INPUT_SIZE, input, args);
         va_end(args);
 
-        SetCommandOutput(buffer);
+        command_output = buffer;
     }
 
     void UserLogCommand::ProcessArgs(va_list& args) { }
@@ -63,9 +66,9 @@ namespace Ember {
             }
         }
 
-        std::stringstream ss;
-        ss << color_controller;
-        command_output = ss.str();
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "\033[%dm", (int)color_controller.GetColor());
+        command_output = buffer;
     }
 
     void ColorLogCommand::ProcessArgs(va_list& args) { }
@@ -129,6 +132,14 @@ namespace Ember {
         va_end(args);
 	}
 
+    void LogFormat::Destroy() {
+        for (auto& command : commands) {
+            EMBER_TRACK_FREE(MemoryTag::Logger, command->GetTrackedSize());
+            delete command;
+        }
+        commands.clear();
+    }
+
     void Logger::SetLogFormat(LogFormat* log_format) {
         formatter = log_format;
     }
@@ -137,7 +148,12 @@ namespace Ember {
         if (formatter) {
             va_list args;
             va_start(args, fmt);
-            std::string output = formatter->GetLeftOutput();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            ScratchMarker scratch;
+            const std::string& format = formatter->GetLeftOutput();
+            ArenaString output(format.c_str(), format.size(), ArenaAllocator<char>(scratch.GetArena()));
+            output.reserve(format.size() + MAX_INPUT_SIZE);
 
             for (auto& command : formatter->GetCommands())
                 command->ResetPosition();
@@ -180,6 +196,13 @@ namespace Ember {
         def_log_good.SetLogFormat(&def_format_good);
     }
 
+    void LogImpl::Destroy() {
+        error_format.Destroy();
+        warning_format.Destroy();
+        def_format.Destroy();
+        def_format_good.Destroy();
+    }
+
     Logger& LogImpl::GetLogError() { return error_log; }
 
     Logger& LogImpl::GetLogWarning() { return warning_log; }
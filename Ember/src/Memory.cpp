@@ -0,0 +1,163 @@
+#include "Memory.h"
+#include "Logger.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <thread>
+
+namespace Ember {
+	static size_t AlignForward(size_t offset, size_t alignment) {
+		return (offset + (alignment - 1)) & ~(alignment - 1);
+	}
+
+	LinearArena::LinearArena(size_t capacity) {
+		Init(capacity);
+	}
+
+	LinearArena::~LinearArena() {
+		Destroy();
+	}
+
+	void LinearArena::Init(size_t capacity) {
+		Destroy();
+		first = CreateBlock(capacity, nullptr);
+		current = first;
+	}
+
+	void LinearArena::Destroy() {
+		FreeBlocksAfter(nullptr);
+		first = nullptr;
+		current = nullptr;
+		used = 0;
+	}
+
+	LinearArena::Block* LinearArena::CreateBlock(size_t capacity, Block* previous) {
+		Block* block = static_cast<Block*>(malloc(sizeof(Block) + capacity));
+		block->previous = previous;
+		block->capacity = capacity;
+		block->offset = 0;
+		return block;
+	}
+
+	void LinearArena::FreeBlocksAfter(Block* block) {
+		while (current && current != block) {
+			Block* previous = current->previous;
+			free(current);
+			current = previous;
+		}
+	}
+
+	void* LinearArena::Allocate(size_t size, size_t alignment) {
+		if (!first)
+			Init(DEFAULT_FRAME_ARENA_SIZE);
+
+		uint8_t* data = reinterpret_cast<uint8_t*>(current + 1);
+		size_t start = AlignForward(reinterpret_cast<size_t>(data + current->offset), alignment) - reinterpret_cast<size_t>(data);
+
+		if (start + size > current->capacity) {
+			size_t capacity = (size + alignment > first->capacity) ? size + alignment : first->capacity;
+			current = CreateBlock(capacity, current);
+			overflow_count++;
+
+			data = reinterpret_cast<uint8_t*>(current + 1);
+			start = AlignForward(reinterpret_cast<size_t>(data), alignment) - reinterpret_cast<size_t>(data);
+		}
+
+		used += (start - current->offset) + size;
+		current->offset = start + size;
+		if (used > peak)
+			peak = used;
+
+		return data + start;
+	}
+
+	ArenaMarker LinearArena::GetMarker() const {
+		/* A marker at the start names no block, so the first block can be replaced while it is alive. */
+		ArenaMarker marker;
+		if (used == 0)
+			return marker;
+		marker.block = current;
+		marker.offset = current->offset;
+		return marker;
+	}
+
+	void LinearArena::Rewind(const ArenaMarker& marker) {
+		if (!first)
+			return;
+
+		FreeBlocksAfter((marker.block) ? static_cast<Block*>(marker.block) : first);
+		current->offset = (marker.block) ? marker.offset : 0;
+
+		used = 0;
+		for (Block* it = current; it; it = it->previous)
+			used += it->offset;
+
+		/* Empty, so no marker names the first block and it can grow to the peak. */
+		if (used == 0 && first->capacity < peak) {
+			size_t capacity = peak + (peak >> 1);
+			EMBER_LOG_WARNING("Linear arena overflowed, growing from %zu to %zu bytes.", first->capacity, capacity);
+			free(first);
+			first = CreateBlock(capacity, nullptr);
+			current = first;
+		}
+	}
+
+	void LinearArena::Reset() {
+		Rewind(ArenaMarker());
+	}
+
+	size_t LinearArena::GetCapacity() const {
+		size_t capacity = 0;
+		for (Block* it = current; it; it = it->previous)
+			capacity += it->capacity;
+		return capacity;
+	}
+
+	static LinearArena& ThreadScratchStack() {
+		thread_local LinearArena scratch(DEFAULT_SCRATCH_STACK_SIZE);
+		return scratch;
+	}
+
+	ScratchMarker::ScratchMarker()
+		: arena(&ThreadScratchStack()), marker(arena->GetMarker()) { }
+
+	ScratchMarker::~ScratchMarker() {
+		arena->Rewind(marker);
+	}
+
+	static LinearArena frame_arena;
+	/* The thread that called Init, the only one allowed to touch the unsynchronised frame arena. */
+	static std::thread::id frame_arena_thread;
+
+	static void CheckFrameArenaThread() {
+#ifdef EMBER_DEBUG
+		assert((frame_arena_thread == std::thread::id() || frame_arena_thread == std::this_thread::get_id())
+			&& "The frame arena belongs to the main thread, jobs allocate from their own scratch stack.");
+#endif
+	}
+
+	void Memory::Init(size_t frame_arena_size) {
+		frame_arena.Init(frame_arena_size);
+		frame_arena_thread = std::this_thread::get_id();
+	}
+
+	void Memory::Destroy() {
+		frame_arena.Destroy();
+		frame_arena_thread = std::thread::id();
+	}
+
+	void Memory::BeginFrame() {
+		CheckFrameArenaThread();
+		frame_arena.Reset();
+		ThreadScratchStack().Reset();
+	}
+
+	LinearArena& Memory::GetFrameArena() {
+		CheckFrameArenaThread();
+		return frame_arena;
+	}
+
+	LinearArena& Memory::GetScratchStack() {
+		return ThreadScratchStack();
+	}
+}
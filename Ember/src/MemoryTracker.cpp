@@ -0,0 +1,108 @@
+#include "MemoryTracker.h"
+#include "Logger.h"
+
+#include <atomic>
+#include <cstdio>
+
+namespace Ember {
+	struct AtomicTagStats {
+		std::atomic<size_t> cpu_current{ 0 };
+		std::atomic<size_t> cpu_peak{ 0 };
+		std::atomic<size_t> gpu_current{ 0 };
+		std::atomic<size_t> gpu_peak{ 0 };
+		std::atomic<uint64_t> allocations{ 0 };
+		std::atomic<uint64_t> frees{ 0 };
+	};
+
+	static AtomicTagStats tag_stats[(size_t)MemoryTag::Count];
+
+	static const char* TAG_NAMES[(size_t)MemoryTag::Count] = {
+		"Renderer", "Font", "Texture", "Audio", "Logger", "Game"
+	};
+
+	static void RaisePeak(std::atomic<size_t>& peak, size_t value) {
+		size_t current = peak.load(std::memory_order_relaxed);
+		while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) { }
+	}
+
+	void MemoryTracker::TrackAlloc(MemoryTag tag, size_t size) {
+		AtomicTagStats& stats = tag_stats[(size_t)tag];
+		RaisePeak(stats.cpu_peak, stats.cpu_current.fetch_add(size, std::memory_order_relaxed) + size);
+		stats.allocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void MemoryTracker::TrackFree(MemoryTag tag, size_t size) {
+		AtomicTagStats& stats = tag_stats[(size_t)tag];
+		stats.cpu_current.fetch_sub(size, std::memory_order_relaxed);
+		stats.frees.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void MemoryTracker::TrackGpuAlloc(MemoryTag tag, size_t size) {
+		AtomicTagStats& stats = tag_stats[(size_t)tag];
+		RaisePeak(stats.gpu_peak, stats.gpu_current.fetch_add(size, std::memory_order_relaxed) + size);
+	}
+
+	void MemoryTracker::TrackGpuFree(MemoryTag tag, size_t size) {
+		tag_stats[(size_t)tag].gpu_current.fetch_sub(size, std::memory_order_relaxed);
+	}
+
+	MemoryTagStats MemoryTracker::GetStats(MemoryTag tag) {
+		AtomicTagStats& stats = tag_stats[(size_t)tag];
+
+		MemoryTagStats out;
+		out.cpu_current = stats.cpu_current.load(std::memory_order_relaxed);
+		out.cpu_peak = stats.cpu_peak.load(std::memory_order_relaxed);
+		out.gpu_current = stats.gpu_current.load(std::memory_order_relaxed);
+		out.gpu_peak = stats.gpu_peak.load(std::memory_order_relaxed);
+		out.allocations = stats.allocations.load(std::memory_order_relaxed);
+		out.frees = stats.frees.load(std::memory_order_relaxed);
+		return out;
+	}
+
+	const char* MemoryTracker::GetTagName(MemoryTag tag) {
+		return TAG_NAMES[(size_t)tag];
+	}
+
+	size_t MemoryTracker::GetTotalCpu() {
+		size_t total = 0;
+		for (auto& stats : tag_stats)
+			total += stats.cpu_current.load(std::memory_order_relaxed);
+		return total;
+	}
+
+	size_t MemoryTracker::GetTotalGpu() {
+		size_t total = 0;
+		for (auto& stats : tag_stats)
+			total += stats.gpu_current.load(std::memory_order_relaxed);
+		return total;
+	}
+
+	void MemoryTracker::ReportLeaks() {
+		for (size_t i = 0; i < (size_t)MemoryTag::Count; i++) {
+			MemoryTagStats stats = GetStats((MemoryTag)i);
+			if (stats.cpu_current != 0 || stats.gpu_current != 0)
+				printf("\033[%dmMemory leak in '%s': %zu bytes CPU, %zu bytes GPU still allocated (%llu allocations, %llu frees).\033[%dm\n", FG_YELLOW,
+					TAG_NAMES[i], stats.cpu_current, stats.gpu_current, (unsigned long long)stats.allocations, (unsigned long long)stats.frees, FG_DEFAULT);
+		}
+	}
+
+	bool MemoryTracker::DumpJson(const char* file_path) {
+		FILE* file = fopen(file_path, "w");
+		if (!file) {
+			EMBER_LOG_ERROR("Failed to open memory dump '%s'.", file_path);
+			return false;
+		}
+
+		fprintf(file, "{\n\t\"total_cpu\": %zu,\n\t\"total_gpu\": %zu,\n\t\"tags\": {\n", GetTotalCpu(), GetTotalGpu());
+		for (size_t i = 0; i < (size_t)MemoryTag::Count; i++) {
+			MemoryTagStats stats = GetStats((MemoryTag)i);
+			fprintf(file, "\t\t\"%s\": { \"cpu_current\": %zu, \"cpu_peak\": %zu, \"gpu_current\": %zu, \"gpu_peak\": %zu, \"allocations\": %llu, \"frees\": %llu }%s\n",
+				TAG_NAMES[i], stats.cpu_current, stats.cpu_peak, stats.gpu_current, stats.gpu_peak,
+				(unsigned long long)stats.allocations, (unsigned long long)stats.frees, (i + 1 < (size_t)MemoryTag::Count) ? "," : "");
+		}
+		fprintf(file, "\t}\n}\n");
+
+		fclose(file);
+		return true;
+	}
+}
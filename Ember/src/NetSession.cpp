@@ -0,0 +1,258 @@
+#include "NetSession.h"
+#include "BitStream.h"
+#include "Logger.h"
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Ember {
+	/* First byte of every message tells snapshots from the game's own messages. */
+	static constexpr uint8_t MESSAGE_SNAPSHOT = 0;
+	static constexpr uint8_t MESSAGE_USER = 1;
+
+	static bool SendUser(NetConnection& connection, std::vector<uint8_t>& message, NetChannel channel, const void* data, size_t size) {
+		message.resize(size + 1);
+		message[0] = MESSAGE_USER;
+		std::copy((const uint8_t*)data, (const uint8_t*)data + size, message.begin() + 1);
+		return connection.Send(channel, message.data(), message.size());
+	}
+
+	bool NetServer::Init(uint16_t port, uint32_t max_clients, const NetQuantization& settings) {
+		if (!Network::Init())
+			return false;
+
+		if (!socket.Open(port)) {
+			Network::Destroy();
+			return false;
+		}
+
+		quantization = settings;
+		clients.clear();
+		clients.resize(max_clients);
+		inbox.clear();
+		snapshot_id = 0;
+		return true;
+	}
+
+	void NetServer::Destroy() {
+		if (!socket.IsOpen())
+			return;
+
+		socket.Close();
+		clients.clear();
+		inbox.clear();
+		Network::Destroy();
+	}
+
+	void NetServer::Receive(uint64_t now) {
+		connected.clear();
+		disconnected.clear();
+
+		NetAddress from;
+		while (size_t size = socket.Receive(from, packet, sizeof(packet))) {
+			uint32_t slot = UINT32_MAX;
+			for (uint32_t i = 0; i < (uint32_t)clients.size() && slot == UINT32_MAX; i++)
+				if (clients[i].connected && clients[i].connection.GetAddress() == from)
+					slot = i;
+
+			if (slot == UINT32_MAX) {
+				for (uint32_t i = 0; i < (uint32_t)clients.size() && slot == UINT32_MAX; i++)
+					if (!clients[i].connected)
+						slot = i;
+
+				if (slot == UINT32_MAX)
+					continue;
+
+				/* A stranger takes the slot only once its packet reads as ours, stray datagrams never become clients. */
+				candidate.Init(from, now);
+				if (!candidate.ReadPacket(packet, size, now))
+					continue;
+
+				Client& client = clients[slot];
+				client.connected = true;
+				std::swap(client.connection, candidate);
+				client.encoder.Init(quantization);
+				client.interest = quantization.bounds;
+				client.packet_snapshots.assign(NET_PACKET_WINDOW, UINT32_MAX);
+				client.pending_snapshot = UINT32_MAX;
+				connected.push_back(slot);
+			}
+			else if (!clients[slot].connection.ReadPacket(packet, size, now)) {
+				continue;
+			}
+
+			Client& client = clients[slot];
+
+			client.connection.PopAcked(acked);
+			for (uint16_t sequence : acked) {
+				uint32_t snapshot = client.packet_snapshots[sequence % NET_PACKET_WINDOW];
+				if (snapshot != UINT32_MAX)
+					client.encoder.Acknowledge((uint16_t)snapshot);
+			}
+
+			while (client.connection.Receive(message))
+				if (!message.empty() && message[0] == MESSAGE_USER)
+					inbox.push_back({ slot, std::vector<uint8_t>(message.begin() + 1, message.end()) });
+		}
+
+		for (uint32_t i = 0; i < (uint32_t)clients.size(); i++) {
+			if (clients[i].connected && now - clients[i].connection.GetLastReceiveTime() > NET_TIMEOUT) {
+				clients[i].connected = false;
+				disconnected.push_back(i);
+			}
+		}
+	}
+
+	bool NetServer::PopMessage(uint32_t& client, std::vector<uint8_t>& data) {
+		if (inbox.empty())
+			return false;
+
+		client = inbox.front().client;
+		data.swap(inbox.front().message);
+		inbox.pop_front();
+		return true;
+	}
+
+	bool NetServer::Send(uint32_t client, NetChannel channel, const void* data, size_t size) {
+		if (!clients[client].connected)
+			return false;
+		return SendUser(clients[client].connection, message, channel, data, size);
+	}
+
+	void NetServer::Broadcast(NetChannel channel, const void* data, size_t size) {
+		for (uint32_t i = 0; i < (uint32_t)clients.size(); i++)
+			Send(i, channel, data, size);
+	}
+
+	void NetServer::SetInterest(uint32_t client, const glm::vec4& bounds) {
+		clients[client].interest = bounds;
+	}
+
+	void NetServer::SendSnapshots(const NetEntityState* entities, uint32_t count, const SpatialGrid& grid) {
+		snapshot_id++;
+		for (Client& client : clients) {
+			if (!client.connected)
+				continue;
+
+			interest_ids.clear();
+			grid.QueryBounds(client.interest, interest_ids);
+			if (interest_ids.size() > NET_MAX_SNAPSHOT_ENTITIES) {
+				glm::vec2 center = { (client.interest.x + client.interest.z) * 0.5f, (client.interest.y + client.interest.w) * 0.5f };
+				auto distance = [&](uint32_t id) { glm::vec2 offset = entities[id].position - center; return glm::dot(offset, offset); };
+				std::nth_element(interest_ids.begin(), interest_ids.begin() + NET_MAX_SNAPSHOT_ENTITIES, interest_ids.end(),
+					[&](uint32_t a, uint32_t b) { return distance(a) < distance(b); });
+				interest_ids.resize(NET_MAX_SNAPSHOT_ENTITIES);
+			}
+
+			interest_entities.clear();
+			for (uint32_t id : interest_ids)
+				if (id < count)
+					interest_entities.push_back(entities[id]);
+
+			BitWriter writer(packet, NET_MAX_MESSAGE_SIZE);
+			writer.WriteBits(MESSAGE_SNAPSHOT, 8);
+			client.encoder.Encode(snapshot_id, interest_entities.data(), (uint32_t)interest_entities.size(), writer, NET_MAX_MESSAGE_SIZE * 8);
+			size_t size = writer.Flush();
+
+			client.pending_snapshot = client.connection.GetUnreliableQueued();
+			client.connection.Send(NetChannel::Unreliable, packet, size);
+		}
+	}
+
+	void NetServer::Flush(uint64_t now) {
+		for (Client& client : clients) {
+			if (!client.connected)
+				continue;
+
+			size_t size = client.connection.WritePacket(packet, sizeof(packet), now);
+			uint16_t sequence = client.connection.GetLastSequence();
+			bool has_snapshot = client.pending_snapshot != UINT32_MAX && client.pending_snapshot < client.connection.GetUnreliableWritten();
+			client.packet_snapshots[sequence % NET_PACKET_WINDOW] = has_snapshot ? snapshot_id : UINT32_MAX;
+			client.pending_snapshot = UINT32_MAX;
+
+			socket.Send(client.connection.GetAddress(), packet, size);
+		}
+	}
+
+	bool NetClient::Init(const NetAddress& server, const NetQuantization& quantization, uint64_t now) {
+		if (!Network::Init())
+			return false;
+
+		if (!socket.Open()) {
+			Network::Destroy();
+			return false;
+		}
+
+		connection.Init(server, now);
+		decoder.Init(quantization);
+		entities.clear();
+		inbox.clear();
+		snapshot_id = 0;
+		has_snapshot = false;
+		return true;
+	}
+
+	void NetClient::Destroy() {
+		if (!socket.IsOpen())
+			return;
+
+		socket.Close();
+		entities.clear();
+		inbox.clear();
+		Network::Destroy();
+	}
+
+	bool NetClient::Receive(uint64_t now) {
+		bool updated = false;
+		NetAddress from;
+		while (size_t size = socket.Receive(from, packet, sizeof(packet))) {
+			if (from != connection.GetAddress() || !connection.ReadPacket(packet, size, now))
+				continue;
+
+			/* Acks only matter to the server, the client just keeps the list from growing. */
+			connection.PopAcked(acked);
+
+			while (connection.Receive(message)) {
+				if (message.empty())
+					continue;
+
+				if (message[0] == MESSAGE_USER) {
+					inbox.emplace_back(message.begin() + 1, message.end());
+					continue;
+				}
+
+				uint16_t id;
+				BitReader reader(message.data() + 1, message.size() - 1);
+				if (!decoder.Decode(reader, id, decoded))
+					continue;
+
+				if (!has_snapshot || SequenceGreater(id, snapshot_id)) {
+					entities.swap(decoded);
+					snapshot_id = id;
+					has_snapshot = true;
+					updated = true;
+				}
+			}
+		}
+		return updated;
+	}
+
+	bool NetClient::PopMessage(std::vector<uint8_t>& data) {
+		if (inbox.empty())
+			return false;
+
+		data.swap(inbox.front());
+		inbox.pop_front();
+		return true;
+	}
+
+	bool NetClient::Send(NetChannel channel, const void* data, size_t size) {
+		return SendUser(connection, message, channel, data, size);
+	}
+
+	void NetClient::Flush(uint64_t now) {
+		size_t size = connection.WritePacket(packet, sizeof(packet), now);
+		socket.Send(connection.GetAddress(), packet, size);
+	}
+}
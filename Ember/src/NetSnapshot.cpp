@@ -0,0 +1,226 @@
+#include "NetSnapshot.h"
+#include "BitStream.h"
+#include "Network.h"
+
+#include <algorithm>
+
+namespace Ember {
+	/* Worst case for one entity: more flag, a 5 byte id, flags and every field in full. */
+	static uint32_t MaxEntityBits(const NetQuantization& quantization) {
+		return 1 + 40 + 4 + 2 * quantization.position_bits + quantization.angle_bits + quantization.radius_bits + 4;
+	}
+
+	static int32_t ToSigned(uint32_t value, uint32_t bits) {
+		return (value & (1u << (bits - 1))) ? (int32_t)(value | ~((1u << bits) - 1)) : (int32_t)value;
+	}
+
+	NetSnapshotEncoder::Quantized NetSnapshotEncoder::Quantize(const NetQuantization& quantization, const NetEntityState& entity) {
+		return {
+			entity.id,
+			BitWriter::Quantize(entity.position.x, quantization.bounds.x, quantization.bounds.z, quantization.position_bits),
+			BitWriter::Quantize(entity.position.y, quantization.bounds.y, quantization.bounds.w, quantization.position_bits),
+			BitWriter::QuantizeAngle(entity.angle, quantization.angle_bits),
+			BitWriter::Quantize(entity.radius, 0.0f, quantization.max_radius, quantization.radius_bits),
+			(uint32_t)entity.kind & 0xF
+		};
+	}
+
+	NetEntityState NetSnapshotEncoder::Dequantize(const NetQuantization& quantization, const Quantized& entity) {
+		return {
+			entity.id,
+			{ BitReader::Dequantize(entity.x, quantization.bounds.x, quantization.bounds.z, quantization.position_bits),
+			  BitReader::Dequantize(entity.y, quantization.bounds.y, quantization.bounds.w, quantization.position_bits) },
+			BitReader::DequantizeAngle(entity.angle, quantization.angle_bits),
+			BitReader::Dequantize(entity.radius, 0.0f, quantization.max_radius, quantization.radius_bits),
+			(uint8_t)entity.kind
+		};
+	}
+
+	void NetSnapshotEncoder::Init(const NetQuantization& settings) {
+		quantization = settings;
+		history.clear();
+		history.resize(NET_SNAPSHOT_HISTORY);
+		scratch.clear();
+		baseline = 0;
+		has_baseline = false;
+	}
+
+	void NetSnapshotEncoder::Acknowledge(uint16_t id) {
+		const Record& record = history[id % NET_SNAPSHOT_HISTORY];
+		if (!record.valid || record.id != id)
+			return;
+
+		if (!has_baseline || SequenceGreater(id, baseline)) {
+			baseline = id;
+			has_baseline = true;
+		}
+	}
+
+	uint32_t NetSnapshotEncoder::Encode(uint16_t id, const NetEntityState* entities, uint32_t count, BitWriter& writer, uint32_t capacity_bits) {
+		scratch.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+			scratch[i] = Quantize(quantization, entities[i]);
+		std::sort(scratch.begin(), scratch.end(), [](const Quantized& a, const Quantized& b) { return a.id < b.id; });
+
+		/* The baseline slot is about to be reused once the client falls a whole history behind. */
+		const Record* base = nullptr;
+		if (has_baseline && (uint16_t)(id - baseline) < NET_SNAPSHOT_HISTORY) {
+			const Record& record = history[baseline % NET_SNAPSHOT_HISTORY];
+			if (record.valid && record.id == baseline)
+				base = &record;
+		}
+
+		Record& record = history[id % NET_SNAPSHOT_HISTORY];
+		record.id = id;
+		record.valid = true;
+		record.entities.clear();
+
+		writer.WriteBits(id, 16);
+		writer.WriteBool(base != nullptr);
+		if (base)
+			writer.WriteBits(baseline, 16);
+
+		uint32_t entity_bits = MaxEntityBits(quantization);
+		uint32_t delta_bits = quantization.position_delta_bits;
+		int32_t delta_limit = (int32_t)(1u << (delta_bits - 1));
+		size_t base_index = 0;
+		uint32_t previous_id = 0;
+		uint32_t written = 0;
+		for (const Quantized& entity : scratch) {
+			if (writer.GetBitsWritten() + entity_bits + 1 > capacity_bits)
+				break;
+
+			writer.WriteBool(true);
+			writer.WriteVarUint(entity.id - previous_id);
+			previous_id = entity.id;
+
+			while (base && base_index < base->entities.size() && base->entities[base_index].id < entity.id)
+				base_index++;
+
+			if (!base || base_index == base->entities.size() || base->entities[base_index].id != entity.id) {
+				writer.WriteBits(entity.x, quantization.position_bits);
+				writer.WriteBits(entity.y, quantization.position_bits);
+				writer.WriteBits(entity.angle, quantization.angle_bits);
+				writer.WriteBits(entity.radius, quantization.radius_bits);
+				writer.WriteBits(entity.kind, 4);
+			}
+			else {
+				const Quantized& previous = base->entities[base_index];
+				bool moved = entity.x != previous.x || entity.y != previous.y;
+				bool turned = entity.angle != previous.angle;
+				bool reshaped = entity.radius != previous.radius || entity.kind != previous.kind;
+
+				writer.WriteBool(moved || turned || reshaped);
+				if (moved || turned || reshaped) {
+					writer.WriteBool(moved);
+					if (moved) {
+						int32_t dx = (int32_t)entity.x - (int32_t)previous.x;
+						int32_t dy = (int32_t)entity.y - (int32_t)previous.y;
+						bool small = dx >= -delta_limit && dx < delta_limit && dy >= -delta_limit && dy < delta_limit;
+						writer.WriteBool(small);
+						if (small) {
+							writer.WriteBits((uint32_t)dx, delta_bits);
+							writer.WriteBits((uint32_t)dy, delta_bits);
+						}
+						else {
+							writer.WriteBits(entity.x, quantization.position_bits);
+							writer.WriteBits(entity.y, quantization.position_bits);
+						}
+					}
+
+					writer.WriteBool(turned);
+					if (turned)
+						writer.WriteBits(entity.angle, quantization.angle_bits);
+
+					writer.WriteBool(reshaped);
+					if (reshaped) {
+						writer.WriteBits(entity.radius, quantization.radius_bits);
+						writer.WriteBits(entity.kind, 4);
+					}
+				}
+			}
+
+			record.entities.push_back(entity);
+			written++;
+		}
+		writer.WriteBool(false);
+		return written;
+	}
+
+	void NetSnapshotDecoder::Init(const NetQuantization& settings) {
+		quantization = settings;
+		history.clear();
+		history.resize(NET_SNAPSHOT_HISTORY);
+	}
+
+	bool NetSnapshotDecoder::Decode(BitReader& reader, uint16_t& id, std::vector<NetEntityState>& entities) {
+		id = (uint16_t)reader.ReadBits(16);
+		const NetSnapshotEncoder::Record* base = nullptr;
+		if (reader.ReadBool()) {
+			uint16_t baseline = (uint16_t)reader.ReadBits(16);
+			const NetSnapshotEncoder::Record& record = history[baseline % NET_SNAPSHOT_HISTORY];
+			if (!record.valid || record.id != baseline)
+				return false;
+			base = &record;
+		}
+
+		/* The baseline can share the slot being decoded into, so decode aside first. */
+		std::vector<NetSnapshotEncoder::Quantized> decoded;
+		uint32_t delta_bits = quantization.position_delta_bits;
+		size_t base_index = 0;
+		uint32_t previous_id = 0;
+		while (reader.ReadBool() && !reader.Overflowed()) {
+			NetSnapshotEncoder::Quantized entity;
+			entity.id = previous_id + reader.ReadVarUint();
+			previous_id = entity.id;
+
+			while (base && base_index < base->entities.size() && base->entities[base_index].id < entity.id)
+				base_index++;
+
+			if (!base || base_index == base->entities.size() || base->entities[base_index].id != entity.id) {
+				entity.x = reader.ReadBits(quantization.position_bits);
+				entity.y = reader.ReadBits(quantization.position_bits);
+				entity.angle = reader.ReadBits(quantization.angle_bits);
+				entity.radius = reader.ReadBits(quantization.radius_bits);
+				entity.kind = reader.ReadBits(4);
+			}
+			else {
+				entity = base->entities[base_index];
+				if (reader.ReadBool()) {
+					if (reader.ReadBool()) {
+						if (reader.ReadBool()) {
+							entity.x = (uint32_t)((int32_t)entity.x + ToSigned(reader.ReadBits(delta_bits), delta_bits));
+							entity.y = (uint32_t)((int32_t)entity.y + ToSigned(reader.ReadBits(delta_bits), delta_bits));
+						}
+						else {
+							entity.x = reader.ReadBits(quantization.position_bits);
+							entity.y = reader.ReadBits(quantization.position_bits);
+						}
+					}
+
+					if (reader.ReadBool())
+						entity.angle = reader.ReadBits(quantization.angle_bits);
+
+					if (reader.ReadBool()) {
+						entity.radius = reader.ReadBits(quantization.radius_bits);
+						entity.kind = reader.ReadBits(4);
+					}
+				}
+			}
+			decoded.push_back(entity);
+		}
+
+		if (reader.Overflowed())
+			return false;
+
+		NetSnapshotEncoder::Record& record = history[id % NET_SNAPSHOT_HISTORY];
+		record.id = id;
+		record.valid = true;
+		record.entities.swap(decoded);
+
+		entities.resize(record.entities.size());
+		for (size_t i = 0; i < record.entities.size(); i++)
+			entities[i] = NetSnapshotEncoder::Dequantize(quantization, record.entities[i]);
+		return true;
+	}
+}
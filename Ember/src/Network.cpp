@@ -0,0 +1,379 @@
+#include "Network.h"
+#include "BitStream.h"
+#include "Logger.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+	#pragma comment(lib, "ws2_32.lib")
+#else
+	#include <arpa/inet.h>
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <netdb.h>
+	#include <netinet/in.h>
+	#include <sys/socket.h>
+	#include <unistd.h>
+#endif
+
+namespace Ember {
+	/* Bits in front of each message: more flag, channel, reliable id and size. */
+	static constexpr uint32_t MESSAGE_HEADER_BITS = 1 + 1 + 16 + 11;
+	static constexpr uint32_t PACKET_HEADER_BITS = 32 + 16 + 1 + 16 + 32;
+
+	static uint32_t network_users = 0;
+
+#if defined(_WIN32)
+	static SOCKET ToSocket(uintptr_t handle) { return (SOCKET)handle; }
+#else
+	static int ToSocket(uintptr_t handle) { return (int)handle; }
+#endif
+
+	bool Network::Init() {
+#if defined(_WIN32)
+		if (network_users == 0) {
+			WSADATA data;
+			if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+				EMBER_LOG_ERROR("WSAStartup failed.");
+				return false;
+			}
+		}
+#endif
+		network_users++;
+		return true;
+	}
+
+	void Network::Destroy() {
+		if (network_users == 0)
+			return;
+
+		network_users--;
+#if defined(_WIN32)
+		if (network_users == 0)
+			WSACleanup();
+#endif
+	}
+
+	bool NetAddress::Parse(const char* text, uint16_t default_port, NetAddress& address) {
+		std::string host = text;
+		uint16_t port = default_port;
+		size_t colon = host.rfind(':');
+		if (colon != std::string::npos) {
+			port = (uint16_t)std::atoi(host.c_str() + colon + 1);
+			host.resize(colon);
+		}
+
+		addrinfo hints = {};
+		hints.ai_family = AF_INET;
+		hints.ai_socktype = SOCK_DGRAM;
+		addrinfo* result = nullptr;
+		if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+			EMBER_LOG_ERROR("Could not resolve address %s.", text);
+			return false;
+		}
+
+		address.ip = ntohl(((sockaddr_in*)result->ai_addr)->sin_addr.s_addr);
+		address.port = port;
+		freeaddrinfo(result);
+		return true;
+	}
+
+	bool UdpSocket::Open(uint16_t bind_port) {
+		Close();
+
+		auto socket_handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		handle = (uintptr_t)socket_handle;
+		if (!IsOpen()) {
+			EMBER_LOG_ERROR("Could not create a UDP socket.");
+			return false;
+		}
+
+		sockaddr_in local = {};
+		local.sin_family = AF_INET;
+		local.sin_addr.s_addr = htonl(INADDR_ANY);
+		local.sin_port = htons(bind_port);
+		if (bind(socket_handle, (const sockaddr*)&local, sizeof(local)) != 0) {
+			EMBER_LOG_ERROR("Could not bind a UDP socket to port %u.", bind_port);
+			Close();
+			return false;
+		}
+
+		socklen_t length = sizeof(local);
+		getsockname(socket_handle, (sockaddr*)&local, &length);
+		port = ntohs(local.sin_port);
+
+#if defined(_WIN32)
+		u_long non_blocking = 1;
+		bool blocking = ioctlsocket(socket_handle, FIONBIO, &non_blocking) != 0;
+#else
+		bool blocking = fcntl(socket_handle, F_SETFL, O_NONBLOCK) != 0;
+#endif
+		if (blocking) {
+			EMBER_LOG_ERROR("Could not make a UDP socket non blocking.");
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void UdpSocket::Close() {
+		if (!IsOpen())
+			return;
+
+#if defined(_WIN32)
+		closesocket(ToSocket(handle));
+#else
+		close(ToSocket(handle));
+#endif
+		handle = INVALID_HANDLE;
+		port = 0;
+	}
+
+	bool UdpSocket::Send(const NetAddress& address, const void* data, size_t size) {
+		if (!IsOpen())
+			return false;
+
+		sockaddr_in remote = {};
+		remote.sin_family = AF_INET;
+		remote.sin_addr.s_addr = htonl(address.ip);
+		remote.sin_port = htons(address.port);
+		return sendto(ToSocket(handle), (const char*)data, (int)size, 0, (const sockaddr*)&remote, sizeof(remote)) == (int)size;
+	}
+
+	size_t UdpSocket::Receive(NetAddress& address, void* buffer, size_t capacity) {
+		while (IsOpen()) {
+			sockaddr_in remote = {};
+			socklen_t length = sizeof(remote);
+			int received = (int)recvfrom(ToSocket(handle), (char*)buffer, (int)capacity, 0, (sockaddr*)&remote, &length);
+			if (received > 0) {
+				address.ip = ntohl(remote.sin_addr.s_addr);
+				address.port = ntohs(remote.sin_port);
+				return (size_t)received;
+			}
+
+#if defined(_WIN32)
+			/* Windows reports an earlier send to a closed port on the next receive, it says nothing about this one. */
+			if (received < 0 && WSAGetLastError() == WSAECONNRESET)
+				continue;
+#endif
+			break;
+		}
+		return 0;
+	}
+
+	void NetConnection::Init(const NetAddress& remote, uint64_t now) {
+		address = remote;
+		last_receive = now;
+		stats = NetStats();
+
+		sequence = 0;
+		sent_packets.clear();
+		sent_packets.resize(NET_PACKET_WINDOW);
+		acked_packets.clear();
+
+		remote_sequence = 0;
+		received_bits = 0;
+		received_any = false;
+
+		next_reliable_id = 0;
+		reliable_out.clear();
+		unreliable_out.clear();
+		unreliable_written = 0;
+
+		next_receive_id = 0;
+		reliable_in.clear();
+		reliable_in.resize(NET_RELIABLE_WINDOW);
+		inbox.clear();
+	}
+
+	bool NetConnection::Send(NetChannel channel, const void* data, size_t size) {
+		if (size > NET_MAX_MESSAGE_SIZE) {
+			EMBER_LOG_ERROR("Network message of %u bytes is over the %u byte limit.", (uint32_t)size, (uint32_t)NET_MAX_MESSAGE_SIZE);
+			return false;
+		}
+
+		const uint8_t* bytes = (const uint8_t*)data;
+		if (channel == NetChannel::Unreliable) {
+			unreliable_out.emplace_back(bytes, bytes + size);
+			return true;
+		}
+
+		/* The receiver buffers at most a window of messages ahead of the oldest one it is missing. */
+		if (!reliable_out.empty() && (uint16_t)(next_reliable_id - reliable_out.front().id) >= NET_RELIABLE_WINDOW) {
+			EMBER_LOG_WARNING("Reliable channel to the remote end is full, message dropped.");
+			return false;
+		}
+
+		reliable_out.push_back({ next_reliable_id++, false, 0, std::vector<uint8_t>(bytes, bytes + size) });
+		return true;
+	}
+
+	bool NetConnection::Receive(std::vector<uint8_t>& message) {
+		if (inbox.empty())
+			return false;
+
+		message.swap(inbox.front());
+		inbox.pop_front();
+		return true;
+	}
+
+	void NetConnection::PopAcked(std::vector<uint16_t>& acked) {
+		acked.swap(acked_packets);
+		acked_packets.clear();
+	}
+
+	size_t NetConnection::WritePacket(uint8_t* buffer, size_t capacity, uint64_t now) {
+		SentPacket& packet = sent_packets[sequence % NET_PACKET_WINDOW];
+		packet.sequence = sequence;
+		packet.time = now;
+		packet.valid = true;
+		packet.acked = false;
+		packet.messages.clear();
+
+		BitWriter writer(buffer, capacity);
+		writer.WriteBits(NET_PROTOCOL_ID, 32);
+		writer.WriteBits(sequence, 16);
+		writer.WriteBool(received_any);
+		writer.WriteBits(remote_sequence, 16);
+		writer.WriteBits(received_bits, 32);
+
+		/* Room for a message of size bytes plus the end marker. */
+		auto fits = [&](size_t size) { return writer.GetBitsWritten() + MESSAGE_HEADER_BITS + size * 8 + 1 <= capacity * 8; };
+
+		for (OutgoingMessage& message : reliable_out) {
+			if (message.acked || (message.last_sent != 0 && now - message.last_sent < NET_RESEND_INTERVAL) || !fits(message.data.size()))
+				continue;
+
+			writer.WriteBool(true);
+			writer.WriteBits((uint32_t)NetChannel::Reliable, 1);
+			writer.WriteBits(message.id, 16);
+			writer.WriteBits((uint32_t)message.data.size(), 11);
+			writer.WriteBytes(message.data.data(), message.data.size());
+			message.last_sent = (now != 0) ? now : 1;
+			packet.messages.push_back(message.id);
+		}
+
+		unreliable_written = 0;
+		for (const std::vector<uint8_t>& message : unreliable_out) {
+			if (!fits(message.size()))
+				break;
+
+			writer.WriteBool(true);
+			writer.WriteBits((uint32_t)NetChannel::Unreliable, 1);
+			writer.WriteBits((uint32_t)message.size(), 11);
+			writer.WriteBytes(message.data(), message.size());
+			unreliable_written++;
+		}
+		unreliable_out.clear();
+
+		writer.WriteBool(false);
+		size_t size = writer.Flush();
+
+		sequence++;
+		stats.packets_sent++;
+		stats.bytes_sent += size;
+		return size;
+	}
+
+	bool NetConnection::ReadPacket(const uint8_t* data, size_t size, uint64_t now) {
+		BitReader reader(data, size);
+		if (size * 8 < PACKET_HEADER_BITS + 1 || reader.ReadBits(32) != NET_PROTOCOL_ID)
+			return false;
+
+		uint16_t packet_sequence = (uint16_t)reader.ReadBits(16);
+		bool has_acks = reader.ReadBool();
+		uint16_t ack = (uint16_t)reader.ReadBits(16);
+		uint32_t ack_bits = reader.ReadBits(32);
+
+		/* Bit i of received_bits stands for remote_sequence - 1 - i. */
+		if (!received_any || SequenceGreater(packet_sequence, remote_sequence)) {
+			uint16_t shift = (uint16_t)(packet_sequence - remote_sequence);
+			if (!received_any || shift > 32)
+				received_bits = 0;
+			else
+				received_bits = (shift == 32) ? 1u << 31 : (received_bits << shift) | (1u << (shift - 1));
+			remote_sequence = packet_sequence;
+			received_any = true;
+		}
+		else {
+			uint16_t age = (uint16_t)(remote_sequence - packet_sequence);
+			if (age == 0 || age > 32 || (received_bits & (1u << (age - 1))))
+				return false;
+			received_bits |= 1u << (age - 1);
+		}
+
+		if (has_acks) {
+			Acknowledge(ack, now);
+			for (uint32_t i = 0; i < 32; i++)
+				if (ack_bits & (1u << i))
+					Acknowledge((uint16_t)(ack - 1 - i), now);
+		}
+
+		std::vector<uint8_t> message;
+		while (reader.ReadBool()) {
+			NetChannel channel = (NetChannel)reader.ReadBits(1);
+			uint16_t id = (channel == NetChannel::Reliable) ? (uint16_t)reader.ReadBits(16) : 0;
+			uint32_t message_size = reader.ReadBits(11);
+			if (reader.Overflowed() || message_size * 8 > reader.GetBitsRemaining())
+				return false;
+
+			message.resize(message_size);
+			reader.ReadBytes(message.data(), message_size);
+
+			if (channel == NetChannel::Unreliable) {
+				inbox.push_back(message);
+				continue;
+			}
+
+			uint16_t ahead = (uint16_t)(id - next_receive_id);
+			if (SequenceGreater(next_receive_id, id) || ahead >= NET_RELIABLE_WINDOW)
+				continue;
+
+			IncomingMessage& slot = reliable_in[id % NET_RELIABLE_WINDOW];
+			if (!slot.valid) {
+				slot.id = id;
+				slot.valid = true;
+				slot.data = message;
+			}
+		}
+
+		while (reliable_in[next_receive_id % NET_RELIABLE_WINDOW].valid && reliable_in[next_receive_id % NET_RELIABLE_WINDOW].id == next_receive_id) {
+			IncomingMessage& slot = reliable_in[next_receive_id % NET_RELIABLE_WINDOW];
+			inbox.push_back(std::move(slot.data));
+			slot.data.clear();
+			slot.valid = false;
+			next_receive_id++;
+		}
+
+		last_receive = now;
+		stats.packets_received++;
+		stats.bytes_received += size;
+		return !reader.Overflowed();
+	}
+
+	void NetConnection::Acknowledge(uint16_t acked_sequence, uint64_t now) {
+		SentPacket& packet = sent_packets[acked_sequence % NET_PACKET_WINDOW];
+		if (!packet.valid || packet.acked || packet.sequence != acked_sequence)
+			return;
+
+		packet.acked = true;
+		acked_packets.push_back(acked_sequence);
+		stats.packets_acked++;
+
+		float round_trip = (float)((now - packet.time) / 1000000.0);
+		stats.round_trip_time = (stats.packets_acked == 1) ? round_trip : stats.round_trip_time + (round_trip - stats.round_trip_time) * 0.1f;
+
+		for (uint16_t id : packet.messages)
+			for (OutgoingMessage& message : reliable_out)
+				if (message.id == id)
+					message.acked = true;
+
+		while (!reliable_out.empty() && reliable_out.front().acked)
+			reliable_out.pop_front();
+	}
+}
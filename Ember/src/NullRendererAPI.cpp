@@ -0,0 +1,447 @@
+#include "NullRendererAPI.h"
+
+#include <cstring>
+
+namespace Ember {
+	void NullRendererAPI::DrawIndexed(uint32_t index_count) {
+		stats.calls++;
+		stats.draw_calls++;
+	}
+
+	void NullRendererAPI::DrawArraysInstanced(uint32_t vertex_count, uint32_t instance_count) {
+		stats.calls++;
+		stats.draw_calls++;
+	}
+
+	void NullRendererAPI::DrawMultiIndirect(const void* indirect, uint32_t count, uint32_t stride) {
+		stats.calls++;
+		stats.draw_calls += count;
+	}
+
+	uint32_t NullRendererAPI::CreateBuffer() {
+		stats.calls++;
+		stats.buffers++;
+		return next_id++;
+	}
+
+	void NullRendererAPI::DeleteBuffer(uint32_t id) {
+		stats.calls++;
+		if (id)
+			stats.buffers--;
+	}
+
+	void NullRendererAPI::BufferData(BufferTarget target, uint32_t size, const void* data, BufferUsage usage) {
+		stats.calls++;
+		if (data)
+			stats.bytes_uploaded += size;
+	}
+
+	void NullRendererAPI::BufferSubData(BufferTarget target, uint32_t offset, uint32_t size, const void* data) {
+		stats.calls++;
+		stats.bytes_uploaded += size;
+	}
+
+	uint32_t NullRendererAPI::CreateVertexArray() {
+		stats.calls++;
+		stats.vertex_arrays++;
+		return next_id++;
+	}
+
+	void NullRendererAPI::DeleteVertexArray(uint32_t id) {
+		stats.calls++;
+		if (id)
+			stats.vertex_arrays--;
+	}
+
+	uint32_t NullRendererAPI::CreateProgram(const ShaderSources& sources) {
+		stats.calls++;
+		stats.programs++;
+		return next_id++;
+	}
+
+	void NullRendererAPI::DeleteProgram(uint32_t program) {
+		stats.calls++;
+		if (program)
+			stats.programs--;
+	}
+
+	uint32_t NullRendererAPI::CreateTexture(uint32_t width, uint32_t height, TextureFormat format) {
+		stats.calls++;
+		stats.textures++;
+		return next_id++;
+	}
+
+	void NullRendererAPI::DeleteTexture(uint32_t id) {
+		stats.calls++;
+		if (id)
+			stats.textures--;
+	}
+
+	void NullRendererAPI::SetTextureData(uint32_t id, uint32_t width, uint32_t height, TextureFormat format, const void* data) {
+		stats.calls++;
+		stats.bytes_uploaded += (uint64_t)width * height * GetBytesPerPixel(format);
+	}
+
+	void NullRendererAPI::SetTextureSubData(uint32_t id, int32_t x, int32_t y, uint32_t w, uint32_t h, TextureFormat format, uint32_t row_length, const void* data) {
+		stats.calls++;
+		stats.bytes_uploaded += (uint64_t)w * h * GetBytesPerPixel(format);
+	}
+
+	void NullRendererAPI::SetBoundTextureData(int32_t x, int32_t y, int32_t w, int32_t h, TextureFormat format, const void* pixels) {
+		stats.calls++;
+		stats.bytes_uploaded += (uint64_t)w * h * GetBytesPerPixel(format);
+	}
+
+	void NullRendererAPI::ReadPixels(int32_t x, int32_t y, int32_t w, int32_t h, void* pixels) {
+		stats.calls++;
+		memset(pixels, 0, (size_t)w * h * 3);
+	}
+
+	/* The attachments count as textures, DeleteFrameBuffer leaves them to DeleteTexture like OpenGL. */
+	uint32_t NullRendererAPI::CreateFrameBuffer(uint32_t width, uint32_t height, uint32_t& color_attachment, uint32_t& depth_stencil_attachment) {
+		stats.calls++;
+		stats.textures += 2;
+		color_attachment = next_id++;
+		depth_stencil_attachment = next_id++;
+		return next_id++;
+	}
+
+	uint32_t RecordingRendererAPI::CountCalls(RendererAPICallType type) const {
+		uint32_t count = 0;
+		for (const RendererAPICall& call : calls)
+			if (call.type == type)
+				count++;
+		return count;
+	}
+
+	const RendererAPICall* RecordingRendererAPI::FindLast(RendererAPICallType type) const {
+		for (size_t i = calls.size(); i > 0; i--)
+			if (calls[i - 1].type == type)
+				return &calls[i - 1];
+		return nullptr;
+	}
+
+	RendererAPICall& RecordingRendererAPI::Record(RendererAPICallType type, std::initializer_list<uint32_t> args, const void* data, size_t size) {
+		RendererAPICall& call = calls.emplace_back();
+		call.type = type;
+
+		size_t i = 0;
+		for (uint32_t arg : args)
+			if (i < sizeof(call.args) / sizeof(call.args[0]))
+				call.args[i++] = arg;
+
+		if (data && size)
+			call.data.assign((const uint8_t*)data, (const uint8_t*)data + size);
+		return call;
+	}
+
+	void RecordingRendererAPI::Init() {
+		NullRendererAPI::Init();
+		Record(RendererAPICallType::Init, {});
+	}
+
+	void RecordingRendererAPI::SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+		NullRendererAPI::SetViewport(x, y, w, h);
+		Record(RendererAPICallType::SetViewport, { x, y, w, h });
+	}
+
+	void RecordingRendererAPI::Clear() {
+		NullRendererAPI::Clear();
+		Record(RendererAPICallType::Clear, {});
+	}
+
+	void RecordingRendererAPI::SetClearColor(float r, float g, float b, float a) {
+		NullRendererAPI::SetClearColor(r, g, b, a);
+		RendererAPICall& call = Record(RendererAPICallType::SetClearColor, {});
+		call.values[0] = r;
+		call.values[1] = g;
+		call.values[2] = b;
+		call.values[3] = a;
+	}
+
+	void RecordingRendererAPI::SetPolygonMode(uint32_t face, uint32_t mode) {
+		NullRendererAPI::SetPolygonMode(face, mode);
+		Record(RendererAPICallType::SetPolygonMode, { face, mode });
+	}
+
+	void RecordingRendererAPI::SetLineWidth(float width) {
+		NullRendererAPI::SetLineWidth(width);
+		Record(RendererAPICallType::SetLineWidth, {}).values[0] = width;
+	}
+
+	void RecordingRendererAPI::SetClipDistances(uint32_t count) {
+		NullRendererAPI::SetClipDistances(count);
+		Record(RendererAPICallType::SetClipDistances, { count });
+	}
+
+	void RecordingRendererAPI::Finish() {
+		NullRendererAPI::Finish();
+		Record(RendererAPICallType::Finish, {});
+	}
+
+	uint64_t RecordingRendererAPI::InsertFence() {
+		uint64_t fence = NullRendererAPI::InsertFence();
+		Record(RendererAPICallType::InsertFence, { (uint32_t)fence });
+		return fence;
+	}
+
+	bool RecordingRendererAPI::IsFenceSignaled(uint64_t fence) {
+		bool signaled = NullRendererAPI::IsFenceSignaled(fence);
+		Record(RendererAPICallType::IsFenceSignaled, { (uint32_t)fence, (uint32_t)signaled });
+		return signaled;
+	}
+
+	void RecordingRendererAPI::DeleteFence(uint64_t fence) {
+		NullRendererAPI::DeleteFence(fence);
+		Record(RendererAPICallType::DeleteFence, { (uint32_t)fence });
+	}
+
+	void RecordingRendererAPI::WaitFence(uint64_t fence) {
+		NullRendererAPI::WaitFence(fence);
+		Record(RendererAPICallType::WaitFence, { (uint32_t)fence });
+	}
+
+	uint32_t RecordingRendererAPI::CreateTimerQuery() {
+		uint32_t id = NullRendererAPI::CreateTimerQuery();
+		Record(RendererAPICallType::CreateTimerQuery, { id });
+		return id;
+	}
+
+	void RecordingRendererAPI::DeleteTimerQuery(uint32_t id) {
+		NullRendererAPI::DeleteTimerQuery(id);
+		Record(RendererAPICallType::DeleteTimerQuery, { id });
+	}
+
+	void RecordingRendererAPI::BeginTimerQuery(uint32_t id) {
+		NullRendererAPI::BeginTimerQuery(id);
+		Record(RendererAPICallType::BeginTimerQuery, { id });
+	}
+
+	void RecordingRendererAPI::EndTimerQuery() {
+		NullRendererAPI::EndTimerQuery();
+		Record(RendererAPICallType::EndTimerQuery, {});
+	}
+
+	bool RecordingRendererAPI::GetTimerQueryResult(uint32_t id, uint64_t& nanoseconds) {
+		bool available = NullRendererAPI::GetTimerQueryResult(id, nanoseconds);
+		Record(RendererAPICallType::GetTimerQueryResult, { id, (uint32_t)available });
+		return available;
+	}
+
+	void RecordingRendererAPI::DrawIndexed(uint32_t index_count) {
+		NullRendererAPI::DrawIndexed(index_count);
+		Record(RendererAPICallType::DrawIndexed, { index_count });
+	}
+
+	void RecordingRendererAPI::DrawArraysInstanced(uint32_t vertex_count, uint32_t instance_count) {
+		NullRendererAPI::DrawArraysInstanced(vertex_count, instance_count);
+		Record(RendererAPICallType::DrawArraysInstanced, { vertex_count, instance_count });
+	}
+
+	void RecordingRendererAPI::DrawMultiIndirect(const void* indirect, uint32_t count, uint32_t stride) {
+		NullRendererAPI::DrawMultiIndirect(indirect, count, stride);
+		Record(RendererAPICallType::DrawMultiIndirect, { (uint32_t)(uintptr_t)indirect, count, stride });
+	}
+
+	uint32_t RecordingRendererAPI::CreateBuffer() {
+		uint32_t id = NullRendererAPI::CreateBuffer();
+		Record(RendererAPICallType::CreateBuffer, { id });
+		return id;
+	}
+
+	void RecordingRendererAPI::DeleteBuffer(uint32_t id) {
+		NullRendererAPI::DeleteBuffer(id);
+		Record(RendererAPICallType::DeleteBuffer, { id });
+		if (unpack_buffer == id)
+			unpack_buffer = 0;
+	}
+
+	void RecordingRendererAPI::BindBuffer(BufferTarget target, uint32_t id) {
+		NullRendererAPI::BindBuffer(target, id);
+		Record(RendererAPICallType::BindBuffer, { (uint32_t)target, id });
+		if (target == BufferTarget::PixelUnpack)
+			unpack_buffer = id;
+	}
+
+	void RecordingRendererAPI::BufferData(BufferTarget target, uint32_t size, const void* data, BufferUsage usage) {
+		NullRendererAPI::BufferData(target, size, data, usage);
+		Record(RendererAPICallType::BufferData, { (uint32_t)target, size, (uint32_t)usage }, data, size);
+	}
+
+	void RecordingRendererAPI::BufferSubData(BufferTarget target, uint32_t offset, uint32_t size, const void* data) {
+		NullRendererAPI::BufferSubData(target, offset, size, data);
+		Record(RendererAPICallType::BufferSubData, { (uint32_t)target, offset, size }, data, size);
+	}
+
+	void* RecordingRendererAPI::MapBufferStorage(BufferTarget target, uint32_t size) {
+		void* mapped = NullRendererAPI::MapBufferStorage(target, size);
+		Record(RendererAPICallType::MapBufferStorage, { (uint32_t)target, size });
+		return mapped;
+	}
+
+	void RecordingRendererAPI::BindBufferBase(BufferTarget target, uint32_t binding, uint32_t id) {
+		NullRendererAPI::BindBufferBase(target, binding, id);
+		Record(RendererAPICallType::BindBufferBase, { (uint32_t)target, binding, id });
+	}
+
+	void RecordingRendererAPI::BindBufferRange(BufferTarget target, uint32_t binding, uint32_t id, uint32_t offset, uint32_t size) {
+		NullRendererAPI::BindBufferRange(target, binding, id, offset, size);
+		Record(RendererAPICallType::BindBufferRange, { (uint32_t)target, binding, id, offset, size });
+	}
+
+	uint32_t RecordingRendererAPI::GetBlockIndex(uint32_t program, const char* name) {
+		uint32_t block = NullRendererAPI::GetBlockIndex(program, name);
+		Record(RendererAPICallType::GetBlockIndex, { program, block }, name, strlen(name));
+		return block;
+	}
+
+	void RecordingRendererAPI::SetUniformBlockBinding(uint32_t program, uint32_t block, uint32_t binding) {
+		NullRendererAPI::SetUniformBlockBinding(program, block, binding);
+		Record(RendererAPICallType::SetUniformBlockBinding, { program, block, binding });
+	}
+
+	void RecordingRendererAPI::SetStorageBlockBinding(uint32_t program, uint32_t block, uint32_t binding) {
+		NullRendererAPI::SetStorageBlockBinding(program, block, binding);
+		Record(RendererAPICallType::SetStorageBlockBinding, { program, block, binding });
+	}
+
+	uint32_t RecordingRendererAPI::CreateVertexArray() {
+		uint32_t id = NullRendererAPI::CreateVertexArray();
+		Record(RendererAPICallType::CreateVertexArray, { id });
+		return id;
+	}
+
+	void RecordingRendererAPI::DeleteVertexArray(uint32_t id) {
+		NullRendererAPI::DeleteVertexArray(id);
+		Record(RendererAPICallType::DeleteVertexArray, { id });
+	}
+
+	void RecordingRendererAPI::BindVertexArray(uint32_t id) {
+		NullRendererAPI::BindVertexArray(id);
+		Record(RendererAPICallType::BindVertexArray, { id });
+	}
+
+	void RecordingRendererAPI::SetVertexAttribute(uint32_t index, uint32_t size, VertexShaderType type, bool normalized, uint32_t stride, size_t offset) {
+		NullRendererAPI::SetVertexAttribute(index, size, type, normalized, stride, offset);
+		Record(RendererAPICallType::SetVertexAttribute, { index, size, (uint32_t)type, (uint32_t)normalized, stride, (uint32_t)offset });
+	}
+
+	void RecordingRendererAPI::EnableVertexAttribute(uint32_t index) {
+		NullRendererAPI::EnableVertexAttribute(index);
+		Record(RendererAPICallType::EnableVertexAttribute, { index });
+	}
+
+	uint32_t RecordingRendererAPI::CreateProgram(const ShaderSources& sources) {
+		uint32_t program = NullRendererAPI::CreateProgram(sources);
+		Record(RendererAPICallType::CreateProgram, { (uint32_t)sources.size(), program });
+		return program;
+	}
+
+	void RecordingRendererAPI::DeleteProgram(uint32_t program) {
+		NullRendererAPI::DeleteProgram(program);
+		Record(RendererAPICallType::DeleteProgram, { program });
+	}
+
+	void RecordingRendererAPI::UseProgram(uint32_t program) {
+		NullRendererAPI::UseProgram(program);
+		Record(RendererAPICallType::UseProgram, { program });
+	}
+
+	int32_t RecordingRendererAPI::GetUniformLocation(uint32_t program, const char* name) {
+		int32_t location = NullRendererAPI::GetUniformLocation(program, name);
+		Record(RendererAPICallType::GetUniformLocation, { program, (uint32_t)location }, name, strlen(name));
+		return location;
+	}
+
+	void RecordingRendererAPI::GetUniformNames(uint32_t program, std::vector<std::string>& names) {
+		NullRendererAPI::GetUniformNames(program, names);
+		Record(RendererAPICallType::GetUniformNames, { program });
+	}
+
+	void RecordingRendererAPI::SetUniformFloat(uint32_t program, int32_t location, float value) {
+		NullRendererAPI::SetUniformFloat(program, location, value);
+		Record(RendererAPICallType::SetUniformFloat, { program, (uint32_t)location }).values[0] = value;
+	}
+
+	void RecordingRendererAPI::SetUniformVec3(uint32_t program, int32_t location, const float* vec3) {
+		NullRendererAPI::SetUniformVec3(program, location, vec3);
+		RendererAPICall& call = Record(RendererAPICallType::SetUniformVec3, { program, (uint32_t)location });
+		memcpy(call.values, vec3, 3 * sizeof(float));
+	}
+
+	void RecordingRendererAPI::SetUniformMat4(uint32_t program, int32_t location, const float* mat4) {
+		NullRendererAPI::SetUniformMat4(program, location, mat4);
+		Record(RendererAPICallType::SetUniformMat4, { program, (uint32_t)location }, mat4, 16 * sizeof(float));
+	}
+
+	void RecordingRendererAPI::SetUniformIntArray(uint32_t program, int32_t location, const int* values, uint32_t count) {
+		NullRendererAPI::SetUniformIntArray(program, location, values, count);
+		Record(RendererAPICallType::SetUniformIntArray, { program, (uint32_t)location, count }, values, count * sizeof(int));
+	}
+
+	uint32_t RecordingRendererAPI::CreateTexture(uint32_t width, uint32_t height, TextureFormat format) {
+		uint32_t id = NullRendererAPI::CreateTexture(width, height, format);
+		Record(RendererAPICallType::CreateTexture, { width, height, (uint32_t)format, id });
+		return id;
+	}
+
+	void RecordingRendererAPI::DeleteTexture(uint32_t id) {
+		NullRendererAPI::DeleteTexture(id);
+		Record(RendererAPICallType::DeleteTexture, { id });
+	}
+
+	void RecordingRendererAPI::SetTextureData(uint32_t id, uint32_t width, uint32_t height, TextureFormat format, const void* data) {
+		NullRendererAPI::SetTextureData(id, width, height, format, data);
+		Record(RendererAPICallType::SetTextureData, { id, width, height, (uint32_t)format }, data, (size_t)width * height * GetBytesPerPixel(format));
+	}
+
+	/* The rows are kept tightly packed. From a bound PixelUnpack buffer there is nothing to copy. */
+	void RecordingRendererAPI::SetTextureSubData(uint32_t id, int32_t x, int32_t y, uint32_t w, uint32_t h, TextureFormat format, uint32_t row_length, const void* data) {
+		NullRendererAPI::SetTextureSubData(id, x, y, w, h, format, row_length, data);
+		RendererAPICall& call = Record(RendererAPICallType::SetTextureSubData, { id, (uint32_t)x, (uint32_t)y, w, h, (uint32_t)format });
+		if (unpack_buffer || !data)
+			return;
+
+		size_t row_size = (size_t)w * GetBytesPerPixel(format);
+		size_t source_stride = (size_t)row_length * GetBytesPerPixel(format);
+		call.data.resize(row_size * h);
+		for (uint32_t row = 0; row < h; row++)
+			memcpy(call.data.data() + row * row_size, (const uint8_t*)data + row * source_stride, row_size);
+	}
+
+	void RecordingRendererAPI::BindTextureUnit(uint32_t slot, uint32_t id) {
+		NullRendererAPI::BindTextureUnit(slot, id);
+		Record(RendererAPICallType::BindTextureUnit, { slot, id });
+	}
+
+	void RecordingRendererAPI::BindTexture(uint32_t id) {
+		NullRendererAPI::BindTexture(id);
+		Record(RendererAPICallType::BindTexture, { id });
+	}
+
+	void RecordingRendererAPI::SetBoundTextureData(int32_t x, int32_t y, int32_t w, int32_t h, TextureFormat format, const void* pixels) {
+		NullRendererAPI::SetBoundTextureData(x, y, w, h, format, pixels);
+		Record(RendererAPICallType::SetBoundTextureData, { (uint32_t)x, (uint32_t)y, (uint32_t)w, (uint32_t)h, (uint32_t)format }, pixels, (size_t)w * h * GetBytesPerPixel(format));
+	}
+
+	void RecordingRendererAPI::ReadPixels(int32_t x, int32_t y, int32_t w, int32_t h, void* pixels) {
+		NullRendererAPI::ReadPixels(x, y, w, h, pixels);
+		Record(RendererAPICallType::ReadPixels, { (uint32_t)x, (uint32_t)y, (uint32_t)w, (uint32_t)h });
+	}
+
+	uint32_t RecordingRendererAPI::CreateFrameBuffer(uint32_t width, uint32_t height, uint32_t& color_attachment, uint32_t& depth_stencil_attachment) {
+		uint32_t id = NullRendererAPI::CreateFrameBuffer(width, height, color_attachment, depth_stencil_attachment);
+		Record(RendererAPICallType::CreateFrameBuffer, { width, height, color_attachment, depth_stencil_attachment, id });
+		return id;
+	}
+
+	void RecordingRendererAPI::DeleteFrameBuffer(uint32_t id) {
+		NullRendererAPI::DeleteFrameBuffer(id);
+		Record(RendererAPICallType::DeleteFrameBuffer, { id });
+	}
+
+	void RecordingRendererAPI::BindFrameBuffer(uint32_t id) {
+		NullRendererAPI::BindFrameBuffer(id);
+		Record(RendererAPICallType::BindFrameBuffer, { id });
+	}
+}
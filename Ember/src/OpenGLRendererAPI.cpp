@@ -0,0 +1,406 @@
+#include "OpenGLRendererAPI.h"
+#include "Buffers.h"
+#include "Logger.h"
+
+#include <glad/glad.h>
+
+namespace Ember {
+	static GLenum ToOpenGL(BufferTarget target) {
+		switch (target) {
+		case BufferTarget::Vertex: return GL_ARRAY_BUFFER;
+		case BufferTarget::Index: return GL_ELEMENT_ARRAY_BUFFER;
+		case BufferTarget::Uniform: return GL_UNIFORM_BUFFER;
+		case BufferTarget::Indirect: return GL_DRAW_INDIRECT_BUFFER;
+		case BufferTarget::ShaderStorage: return GL_SHADER_STORAGE_BUFFER;
+		case BufferTarget::PixelUnpack: return GL_PIXEL_UNPACK_BUFFER;
+		}
+		return GL_NONE;
+	}
+
+	static GLenum ToOpenGL(VertexShaderType type) {
+		switch (type) {
+		case VertexShaderType::Float: return GL_FLOAT;
+		case VertexShaderType::Int: return GL_INT;
+		case VertexShaderType::None: return GL_NONE;
+		}
+		return GL_NONE;
+	}
+
+	static GLenum ToOpenGL(ShaderStage stage) {
+		switch (stage) {
+		case ShaderStage::Vertex: return GL_VERTEX_SHADER;
+		case ShaderStage::Fragment: return GL_FRAGMENT_SHADER;
+		case ShaderStage::Geometry: return GL_GEOMETRY_SHADER;
+		case ShaderStage::TessControl: return GL_TESS_CONTROL_SHADER;
+		case ShaderStage::TessEval: return GL_TESS_EVALUATION_SHADER;
+		}
+		return GL_NONE;
+	}
+
+	static GLenum InternalFormat(TextureFormat format) {
+		switch (format) {
+		case TextureFormat::RGB8: return GL_RGB8;
+		case TextureFormat::RGBA8: return GL_RGBA8;
+		case TextureFormat::R8: return GL_R8;
+		}
+		return GL_NONE;
+	}
+
+	static GLenum DataFormat(TextureFormat format) {
+		switch (format) {
+		case TextureFormat::RGB8: return GL_RGB;
+		case TextureFormat::RGBA8: return GL_RGBA;
+		case TextureFormat::R8: return GL_RED;
+		}
+		return GL_NONE;
+	}
+
+	void OpenGLRendererAPI::Init() {
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glEnable(GL_DEPTH_TEST);
+		glEnable(GL_STENCIL_TEST);
+		glEnable(GL_MULTISAMPLE);
+
+		/* Pixel rows are tightly packed in every format, RGB and R8 rows are not a multiple of 4 bytes. */
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	}
+
+	void OpenGLRendererAPI::SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+		glViewport(x, y, w, h);
+	}
+
+	void OpenGLRendererAPI::Clear() {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+
+	void OpenGLRendererAPI::SetClearColor(float r, float g, float b, float a) {
+		glClearColor(r, g, b, a);
+	}
+
+	void OpenGLRendererAPI::SetPolygonMode(uint32_t face, uint32_t mode) {
+		glPolygonMode(face, mode);
+	}
+
+	void OpenGLRendererAPI::SetLineWidth(float width) {
+		glLineWidth(width);
+	}
+
+	/* Every implementation has at least 8. */
+	void OpenGLRendererAPI::SetClipDistances(uint32_t count) {
+		for (uint32_t i = 0; i < 8; i++) {
+			if (i < count)
+				glEnable(GL_CLIP_DISTANCE0 + i);
+			else
+				glDisable(GL_CLIP_DISTANCE0 + i);
+		}
+	}
+
+	void OpenGLRendererAPI::Finish() {
+		glFinish();
+	}
+
+	/* Fences are the GLsync handles themselves. */
+	uint64_t OpenGLRendererAPI::InsertFence() {
+		return (uint64_t)(uintptr_t)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	bool OpenGLRendererAPI::IsFenceSignaled(uint64_t fence) {
+		GLenum result = glClientWaitSync((GLsync)(uintptr_t)fence, 0, 0);
+		return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED;
+	}
+
+	void OpenGLRendererAPI::DeleteFence(uint64_t fence) {
+		glDeleteSync((GLsync)(uintptr_t)fence);
+	}
+
+	/* The first wait flushes, so the fence is sure to reach the GPU. */
+	void OpenGLRendererAPI::WaitFence(uint64_t fence) {
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		while (true) {
+			GLenum result = glClientWaitSync((GLsync)(uintptr_t)fence, flags, 1000000);
+			if (result != GL_TIMEOUT_EXPIRED)
+				return;
+			flags = 0;
+		}
+	}
+
+	uint32_t OpenGLRendererAPI::CreateTimerQuery() {
+		uint32_t id;
+		glGenQueries(1, &id);
+		return id;
+	}
+
+	void OpenGLRendererAPI::DeleteTimerQuery(uint32_t id) {
+		glDeleteQueries(1, &id);
+	}
+
+	void OpenGLRendererAPI::BeginTimerQuery(uint32_t id) {
+		glBeginQuery(GL_TIME_ELAPSED, id);
+	}
+
+	void OpenGLRendererAPI::EndTimerQuery() {
+		glEndQuery(GL_TIME_ELAPSED);
+	}
+
+	bool OpenGLRendererAPI::GetTimerQueryResult(uint32_t id, uint64_t& nanoseconds) {
+		GLint available = 0;
+		glGetQueryObjectiv(id, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			return false;
+
+		GLuint64 result = 0;
+		glGetQueryObjectui64v(id, GL_QUERY_RESULT, &result);
+		nanoseconds = result;
+		return true;
+	}
+
+	void OpenGLRendererAPI::DrawIndexed(uint32_t index_count) {
+		glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, 0);
+	}
+
+	void OpenGLRendererAPI::DrawArraysInstanced(uint32_t vertex_count, uint32_t instance_count) {
+		glDrawArraysInstanced(GL_TRIANGLES, 0, vertex_count, instance_count);
+	}
+
+	void OpenGLRendererAPI::DrawMultiIndirect(const void* indirect, uint32_t count, uint32_t stride) {
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, indirect, count, stride);
+	}
+
+	uint32_t OpenGLRendererAPI::CreateBuffer() {
+		uint32_t id;
+		glGenBuffers(1, &id);
+		return id;
+	}
+
+	void OpenGLRendererAPI::DeleteBuffer(uint32_t id) {
+		glDeleteBuffers(1, &id);
+	}
+
+	void OpenGLRendererAPI::BindBuffer(BufferTarget target, uint32_t id) {
+		glBindBuffer(ToOpenGL(target), id);
+	}
+
+	void OpenGLRendererAPI::BufferData(BufferTarget target, uint32_t size, const void* data, BufferUsage usage) {
+		glBufferData(ToOpenGL(target), size, data, (usage == BufferUsage::Static) ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+	}
+
+	void OpenGLRendererAPI::BufferSubData(BufferTarget target, uint32_t offset, uint32_t size, const void* data) {
+		glBufferSubData(ToOpenGL(target), offset, size, data);
+	}
+
+	void* OpenGLRendererAPI::MapBufferStorage(BufferTarget target, uint32_t size) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(ToOpenGL(target), size, nullptr, flags);
+		return glMapBufferRange(ToOpenGL(target), 0, size, flags);
+	}
+
+	void OpenGLRendererAPI::BindBufferBase(BufferTarget target, uint32_t binding, uint32_t id) {
+		glBindBufferBase(ToOpenGL(target), binding, id);
+	}
+
+	void OpenGLRendererAPI::BindBufferRange(BufferTarget target, uint32_t binding, uint32_t id, uint32_t offset, uint32_t size) {
+		glBindBufferRange(ToOpenGL(target), binding, id, offset, size);
+	}
+
+	uint32_t OpenGLRendererAPI::GetBlockIndex(uint32_t program, const char* name) {
+		return glGetUniformBlockIndex(program, name);
+	}
+
+	void OpenGLRendererAPI::SetUniformBlockBinding(uint32_t program, uint32_t block, uint32_t binding) {
+		glUniformBlockBinding(program, block, binding);
+	}
+
+	void OpenGLRendererAPI::SetStorageBlockBinding(uint32_t program, uint32_t block, uint32_t binding) {
+		glShaderStorageBlockBinding(program, block, binding);
+	}
+
+	uint32_t OpenGLRendererAPI::CreateVertexArray() {
+		uint32_t id;
+		glGenVertexArrays(1, &id);
+		return id;
+	}
+
+	void OpenGLRendererAPI::DeleteVertexArray(uint32_t id) {
+		glDeleteVertexArrays(1, &id);
+	}
+
+	void OpenGLRendererAPI::BindVertexArray(uint32_t id) {
+		glBindVertexArray(id);
+	}
+
+	void OpenGLRendererAPI::SetVertexAttribute(uint32_t index, uint32_t size, VertexShaderType type, bool normalized, uint32_t stride, size_t offset) {
+		glVertexAttribPointer(index, size, ToOpenGL(type), normalized ? GL_TRUE : GL_FALSE, stride, (void*)offset);
+	}
+
+	void OpenGLRendererAPI::EnableVertexAttribute(uint32_t index) {
+		glEnableVertexAttribArray(index);
+	}
+
+	uint32_t OpenGLRendererAPI::CompileShader(const std::string& source, uint32_t type) {
+		uint32_t id = glCreateShader(type);
+		const char* src = source.c_str();
+		glShaderSource(id, 1, &src, nullptr);
+		glCompileShader(id);
+
+		int result;
+		glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+		if (!result)
+		{
+			int length;
+			glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+			char* message = (char*)malloc(length * sizeof(char));
+			glGetShaderInfoLog(id, length, &length, message);
+			EMBER_LOG_ERROR("Shader failed to load: %s", message);
+			free(message);
+
+			glDeleteShader(id);
+			return 0;
+		}
+
+		return id;
+	}
+
+	uint32_t OpenGLRendererAPI::CreateProgram(const ShaderSources& sources) {
+		uint32_t program = glCreateProgram();
+
+		for (auto& shader : sources) {
+			uint32_t s = CompileShader(shader.second.str(), ToOpenGL((ShaderStage)shader.first));
+			glAttachShader(program, s);
+			glDeleteShader(s);
+		}
+
+		glLinkProgram(program);
+		glValidateProgram(program);
+
+		return program;
+	}
+
+	void OpenGLRendererAPI::DeleteProgram(uint32_t program) {
+		glDeleteProgram(program);
+	}
+
+	void OpenGLRendererAPI::UseProgram(uint32_t program) {
+		glUseProgram(program);
+	}
+
+	int32_t OpenGLRendererAPI::GetUniformLocation(uint32_t program, const char* name) {
+		return glGetUniformLocation(program, name);
+	}
+
+	void OpenGLRendererAPI::GetUniformNames(uint32_t program, std::vector<std::string>& names) {
+		GLint count;
+		GLint size;
+		GLenum type;
+
+		const GLsizei bufSize = 16;
+		GLchar name[bufSize];
+		GLsizei length;
+
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+
+		for (GLint i = 0; i < count; i++) {
+			glGetActiveUniform(program, (GLuint)i, bufSize, &length, &size, &type, name);
+			names.push_back(name);
+		}
+	}
+
+	void OpenGLRendererAPI::SetUniformFloat(uint32_t program, int32_t location, float value) {
+		glProgramUniform1f(program, location, value);
+	}
+
+	void OpenGLRendererAPI::SetUniformVec3(uint32_t program, int32_t location, const float* vec3) {
+		glProgramUniform3f(program, location, vec3[0], vec3[1], vec3[2]);
+	}
+
+	void OpenGLRendererAPI::SetUniformMat4(uint32_t program, int32_t location, const float* mat4) {
+		glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, mat4);
+	}
+
+	void OpenGLRendererAPI::SetUniformIntArray(uint32_t program, int32_t location, const int* values, uint32_t count) {
+		glProgramUniform1iv(program, location, count, values);
+	}
+
+	uint32_t OpenGLRendererAPI::CreateTexture(uint32_t width, uint32_t height, TextureFormat format) {
+		uint32_t id;
+		glCreateTextures(GL_TEXTURE_2D, 1, &id);
+		glTextureStorage2D(id, 1, InternalFormat(format), width, height);
+
+		/* Single channel textures are font atlases, sampled the way Font always set them up. */
+		if (format == TextureFormat::R8) {
+			glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+			glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+			glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+			return id;
+		}
+
+		glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		return id;
+	}
+
+	void OpenGLRendererAPI::DeleteTexture(uint32_t id) {
+		glDeleteTextures(1, &id);
+	}
+
+	void OpenGLRendererAPI::SetTextureData(uint32_t id, uint32_t width, uint32_t height, TextureFormat format, const void* data) {
+		glTextureSubImage2D(id, 0, 0, 0, width, height, DataFormat(format), GL_UNSIGNED_BYTE, data);
+	}
+
+	void OpenGLRendererAPI::SetTextureSubData(uint32_t id, int32_t x, int32_t y, uint32_t w, uint32_t h, TextureFormat format, uint32_t row_length, const void* data) {
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+		glTextureSubImage2D(id, 0, x, y, w, h, DataFormat(format), GL_UNSIGNED_BYTE, data);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	}
+
+	void OpenGLRendererAPI::BindTextureUnit(uint32_t slot, uint32_t id) {
+		glBindTextureUnit(slot, id);
+	}
+
+	void OpenGLRendererAPI::BindTexture(uint32_t id) {
+		glBindTexture(GL_TEXTURE_2D, id);
+	}
+
+	void OpenGLRendererAPI::SetBoundTextureData(int32_t x, int32_t y, int32_t w, int32_t h, TextureFormat format, const void* pixels) {
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, DataFormat(format), GL_UNSIGNED_BYTE, pixels);
+	}
+
+	void OpenGLRendererAPI::ReadPixels(int32_t x, int32_t y, int32_t w, int32_t h, void* pixels) {
+		glReadPixels(x, y, w, h, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+	}
+
+	uint32_t OpenGLRendererAPI::CreateFrameBuffer(uint32_t width, uint32_t height, uint32_t& color_attachment, uint32_t& depth_stencil_attachment) {
+		glCreateTextures(GL_TEXTURE_2D, 1, &color_attachment);
+		glTextureStorage2D(color_attachment, 1, GL_RGBA8, width, height);
+		glTextureParameteri(color_attachment, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTextureParameteri(color_attachment, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTextureParameteri(color_attachment, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(color_attachment, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glCreateTextures(GL_TEXTURE_2D, 1, &depth_stencil_attachment);
+		glTextureStorage2D(depth_stencil_attachment, 1, GL_DEPTH24_STENCIL8, width, height);
+
+		uint32_t id;
+		glCreateFramebuffers(1, &id);
+		glNamedFramebufferTexture(id, GL_COLOR_ATTACHMENT0, color_attachment, 0);
+		glNamedFramebufferTexture(id, GL_DEPTH_STENCIL_ATTACHMENT, depth_stencil_attachment, 0);
+
+		if (glCheckNamedFramebufferStatus(id, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			EMBER_LOG_ERROR("Failed to load framebuffer.");
+		return id;
+	}
+
+	void OpenGLRendererAPI::DeleteFrameBuffer(uint32_t id) {
+		glDeleteFramebuffers(1, &id);
+	}
+
+	void OpenGLRendererAPI::BindFrameBuffer(uint32_t id) {
+		glBindFramebuffer(GL_FRAMEBUFFER, id);
+	}
+}
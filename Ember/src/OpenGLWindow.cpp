@@ -1,6 +1,7 @@
 #include "OpenGLWindow.h"
 #include "Logger.h"
 #include "Config.h"
+#include "RenderThread.h"
 
 namespace Ember {
 	OpenGLWindow::OpenGLWindow(WindowProperties* properties, uint32_t major_opengl, uint32_t minor_opengl) {
@@ -31,7 +32,9 @@ namespace Ember {
 		gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress);
 #endif
 
-		SDL_GL_SetSwapInterval(1);
+		applied_swap_interval = properties->swap_interval;
+		applied_max_frame_rate = properties->max_frame_rate;
+		ApplyPresentation(applied_swap_interval, applied_max_frame_rate);
 	}
 
 	OpenGLWindow::~OpenGLWindow() {
@@ -40,6 +43,39 @@ namespace Ember {
 
 	void OpenGLWindow::Update() {
 		UpdateWindowAttributes();
+
+		if (properties->swap_interval != applied_swap_interval || properties->max_frame_rate != applied_max_frame_rate) {
+			SwapInterval swap_interval = applied_swap_interval = properties->swap_interval;
+			float max_frame_rate = applied_max_frame_rate = properties->max_frame_rate;
+			if (RenderThread::IsRecording())
+				RenderThread::Submit([=, this]() { ApplyPresentation(swap_interval, max_frame_rate); });
+			else
+				ApplyPresentation(swap_interval, max_frame_rate);
+		}
+
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([this]() { Present(); });
+		Present();
+	}
+
+	void OpenGLWindow::Present() {
+		pacer.Wait();
 		SDL_GL_SwapWindow(native_window);
+		pacer.OnPresent();
+	}
+
+	void OpenGLWindow::ApplyPresentation(SwapInterval swap_interval, float max_frame_rate) {
+		if (SDL_GL_SetSwapInterval((int)swap_interval) < 0 && swap_interval == SwapInterval::Adaptive) {
+			EMBER_LOG_WARNING("Adaptive vsync is not supported, falling back to vsync.");
+			SDL_GL_SetSwapInterval((int)SwapInterval::VSync);
+		}
+
+		SDL_DisplayMode mode;
+		float refresh_frame_time = 0.0f;
+		if (swap_interval != SwapInterval::Off && SDL_GetWindowDisplayMode(native_window, &mode) == 0 && mode.refresh_rate > 0)
+			refresh_frame_time = 1000.0f / mode.refresh_rate;
+
+		pacer.SetExpectedFrameTime(refresh_frame_time);
+		pacer.SetTargetFrameRate(max_frame_rate);
 	}
 }
\ No newline at end of file
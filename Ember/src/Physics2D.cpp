@@ -0,0 +1,684 @@
+#include "Physics2D.h"
+#include "JobSystem.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "Clock.h"
+#include "FastMath.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace Ember {
+	static float Cross(const glm::vec2& a, const glm::vec2& b) { return a.x * b.y - a.y * b.x; }
+	static glm::vec2 Cross(float w, const glm::vec2& r) { return { -w * r.y, w * r.x }; }
+
+	PolygonShape PolygonShape::FromPoints(const glm::vec2* points, uint32_t count) {
+		PolygonShape shape;
+		if (count < 3) {
+			EMBER_LOG_ERROR("PolygonShape needs at least 3 points, got %u.", count);
+			return shape;
+		}
+
+		/* Monotone chain convex hull, counter clockwise. */
+		std::vector<glm::vec2> sorted(points, points + count);
+		std::sort(sorted.begin(), sorted.end(), [](const glm::vec2& a, const glm::vec2& b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+
+		std::vector<glm::vec2> hull(2 * count);
+		uint32_t k = 0;
+		for (uint32_t i = 0; i < count; i++) {
+			while (k >= 2 && Cross(hull[k - 1] - hull[k - 2], sorted[i] - hull[k - 2]) <= 0.0f)
+				k--;
+			hull[k++] = sorted[i];
+		}
+		for (int32_t i = (int32_t)count - 2, lower = k + 1; i >= 0; i--) {
+			while (k >= (uint32_t)lower && Cross(hull[k - 1] - hull[k - 2], sorted[i] - hull[k - 2]) <= 0.0f)
+				k--;
+			hull[k++] = sorted[i];
+		}
+		hull.resize(k - 1);
+
+		if (hull.size() < 3) {
+			EMBER_LOG_ERROR("PolygonShape points are collinear.");
+			return shape;
+		}
+
+		/* Dropping hull vertices keeps the polygon convex. */
+		uint32_t hull_count = (uint32_t)hull.size();
+		shape.count = std::min(hull_count, PHYSICS_MAX_POLYGON_VERTICES);
+		if (hull_count > PHYSICS_MAX_POLYGON_VERTICES)
+			EMBER_LOG_WARNING("PolygonShape hull has %u vertices, keeping %u.", hull_count, PHYSICS_MAX_POLYGON_VERTICES);
+		for (uint32_t i = 0; i < shape.count; i++)
+			shape.vertices[i] = hull[(size_t)i * hull_count / shape.count];
+
+		/* Area, centroid and second moment from a triangle fan around the first vertex. */
+		glm::vec2 reference = shape.vertices[0];
+		glm::vec2 center = { 0.0f, 0.0f };
+		float area = 0.0f;
+		float inertia = 0.0f;
+		for (uint32_t i = 1; i + 1 < shape.count; i++) {
+			glm::vec2 e1 = shape.vertices[i] - reference;
+			glm::vec2 e2 = shape.vertices[i + 1] - reference;
+			float d = Cross(e1, e2);
+			float triangle_area = 0.5f * d;
+			area += triangle_area;
+			center += triangle_area * (e1 + e2) / 3.0f;
+
+			float int_x2 = e1.x * e1.x + e2.x * e1.x + e2.x * e2.x;
+			float int_y2 = e1.y * e1.y + e2.y * e1.y + e2.y * e2.y;
+			inertia += (0.25f / 3.0f * d) * (int_x2 + int_y2);
+		}
+
+		center /= area;
+		shape.area = area;
+		shape.inertia = inertia - area * glm::dot(center, center);
+		shape.centroid = reference + center;
+
+		for (uint32_t i = 0; i < shape.count; i++) {
+			shape.vertices[i] -= shape.centroid;
+			shape.radius = std::max(shape.radius, glm::length(shape.vertices[i]));
+		}
+		for (uint32_t i = 0; i < shape.count; i++) {
+			glm::vec2 edge = shape.vertices[(i + 1) % shape.count] - shape.vertices[i];
+			shape.normals[i] = glm::normalize(glm::vec2(edge.y, -edge.x));
+		}
+		return shape;
+	}
+
+	void PhysicsWorld::Init(const PhysicsSettings& physics_settings) {
+		settings = physics_settings;
+		grid.Init(settings.cell_size);
+	}
+
+	void PhysicsWorld::Destroy() {
+		Clear();
+		shapes.clear();
+	}
+
+	uint32_t PhysicsWorld::AddShape(const PolygonShape& shape) {
+		shapes.push_back(shape);
+		return (uint32_t)shapes.size() - 1;
+	}
+
+	BodyHandle PhysicsWorld::CreateBody(const BodyDefinition& definition) {
+		if (definition.shape >= shapes.size() || shapes[definition.shape].count == 0) {
+			EMBER_LOG_ERROR("PhysicsWorld::CreateBody got an invalid shape %u.", definition.shape);
+			return BodyHandle();
+		}
+
+		uint32_t index;
+		if (!free_bodies.empty()) {
+			index = free_bodies.back();
+			free_bodies.pop_back();
+		}
+		else {
+			index = (uint32_t)bodies.size();
+			bodies.emplace_back();
+		}
+
+		RigidBody& body = bodies[index];
+		uint32_t generation = body.generation + 1;
+		body = RigidBody();
+		body.generation = generation;
+		body.active = true;
+
+		body.type = definition.type;
+		body.shape = definition.shape;
+		body.scale = definition.scale;
+		body.position = definition.position;
+		body.angle = definition.angle;
+		body.velocity = definition.velocity;
+		body.angular_velocity = definition.angular_velocity;
+		body.friction = definition.friction;
+		body.restitution = definition.restitution;
+		body.sensor = definition.sensor;
+		body.category = definition.category;
+		body.mask = definition.mask;
+		body.user_data = definition.user_data;
+
+		if (body.type == BodyType::Dynamic) {
+			const PolygonShape& shape = shapes[body.shape];
+			float scale_squared = body.scale * body.scale;
+			float mass = definition.density * shape.area * scale_squared;
+			float inertia = definition.density * shape.inertia * scale_squared * scale_squared;
+			body.inv_mass = (mass > 0.0f) ? 1.0f / mass : 1.0f;
+			body.inv_inertia = (inertia > 0.0f) ? 1.0f / inertia : 0.0f;
+		}
+		if (body.type == BodyType::Static) {
+			body.velocity = { 0.0f, 0.0f };
+			body.angular_velocity = 0.0f;
+		}
+
+		UpdateBounds(body);
+		body_count++;
+		return { index, body.generation };
+	}
+
+	void PhysicsWorld::DestroyBody(BodyHandle& handle) {
+		RigidBody* body = GetBody(handle);
+		handle = BodyHandle();
+		if (!body)
+			return;
+
+		body->active = false;
+		body_count--;
+		/* Slots are reused after the next step, so cached contacts of the old body cannot leak into a new one. */
+		released_bodies.push_back((uint32_t)(body - bodies.data()));
+	}
+
+	void PhysicsWorld::Clear() {
+		bodies.clear();
+		free_bodies.clear();
+		released_bodies.clear();
+		body_count = 0;
+		pairs.clear();
+		manifolds.clear();
+		contact_events.clear();
+		cache.clear();
+		next_cache.clear();
+	}
+
+	RigidBody* PhysicsWorld::GetBody(BodyHandle handle) {
+		if (handle.index >= bodies.size())
+			return nullptr;
+
+		RigidBody& body = bodies[handle.index];
+		return (body.active && body.generation == handle.generation) ? &body : nullptr;
+	}
+
+	void PhysicsWorld::WakeBody(BodyHandle handle) {
+		if (RigidBody* body = GetBody(handle)) {
+			body->awake = true;
+			body->sleep_time = 0.0f;
+		}
+	}
+
+	void PhysicsWorld::UpdateBounds(RigidBody& body) {
+		float radius = shapes[body.shape].radius * body.scale;
+		body.bounds = { body.position.x - radius, body.position.y - radius, body.position.x + radius, body.position.y + radius };
+	}
+
+	bool PhysicsWorld::ShouldCollide(const RigidBody& a, const RigidBody& b) const {
+		if (!(a.category & b.mask) || !(b.category & a.mask) || (a.sensor && b.sensor))
+			return false;
+
+		if (!IsMoving(a) && !IsMoving(b))
+			return false;
+
+		return a.type == BodyType::Dynamic || b.type == BodyType::Dynamic || a.sensor || b.sensor;
+	}
+
+	struct WorldPolygon {
+		glm::vec2 vertices[PHYSICS_MAX_POLYGON_VERTICES];
+		glm::vec2 normals[PHYSICS_MAX_POLYGON_VERTICES];
+		uint32_t count;
+	};
+
+	static void TransformPolygon(const PolygonShape& shape, const RigidBody& body, WorldPolygon& polygon) {
+		float s, c;
+		FastMath::SinCos(body.angle, s, c);
+		polygon.count = shape.count;
+		for (uint32_t i = 0; i < shape.count; i++) {
+			glm::vec2 v = shape.vertices[i] * body.scale;
+			polygon.vertices[i] = body.position + glm::vec2(c * v.x - s * v.y, s * v.x + c * v.y);
+			polygon.normals[i] = { c * shape.normals[i].x - s * shape.normals[i].y, s * shape.normals[i].x + c * shape.normals[i].y };
+		}
+	}
+
+	static float FindMaxSeparation(const WorldPolygon& a, const WorldPolygon& b, uint32_t& edge) {
+		float max_separation = -FLT_MAX;
+		for (uint32_t i = 0; i < a.count; i++) {
+			float separation = FLT_MAX;
+			for (uint32_t j = 0; j < b.count; j++)
+				separation = std::min(separation, glm::dot(a.normals[i], b.vertices[j] - a.vertices[i]));
+
+			if (separation > max_separation) {
+				max_separation = separation;
+				edge = i;
+			}
+		}
+		return max_separation;
+	}
+
+	struct ClipVertex {
+		glm::vec2 point;
+		uint32_t feature;
+	};
+
+	static uint32_t ClipSegment(ClipVertex out[2], const ClipVertex in[2], const glm::vec2& normal, float offset, uint32_t clip_feature) {
+		uint32_t count = 0;
+		float distance0 = glm::dot(normal, in[0].point) - offset;
+		float distance1 = glm::dot(normal, in[1].point) - offset;
+
+		if (distance0 <= 0.0f)
+			out[count++] = in[0];
+		if (distance1 <= 0.0f)
+			out[count++] = in[1];
+
+		if (distance0 * distance1 < 0.0f) {
+			float t = distance0 / (distance0 - distance1);
+			out[count].point = in[0].point + t * (in[1].point - in[0].point);
+			out[count].feature = in[0].feature | clip_feature;
+			count++;
+		}
+		return count;
+	}
+
+	void PhysicsWorld::Collide(ContactManifold& manifold) const {
+		manifold.point_count = 0;
+		const RigidBody& body_a = bodies[manifold.body_a];
+		const RigidBody& body_b = bodies[manifold.body_b];
+
+		WorldPolygon polygon_a, polygon_b;
+		TransformPolygon(shapes[body_a.shape], body_a, polygon_a);
+		TransformPolygon(shapes[body_b.shape], body_b, polygon_b);
+
+		uint32_t edge_a = 0, edge_b = 0;
+		float separation_a = FindMaxSeparation(polygon_a, polygon_b, edge_a);
+		if (separation_a > 0.0f)
+			return;
+		float separation_b = FindMaxSeparation(polygon_b, polygon_a, edge_b);
+		if (separation_b > 0.0f)
+			return;
+
+		/* The reference face is the one of least penetration, biased towards a so the choice does not flicker. */
+		const WorldPolygon* reference = &polygon_a;
+		const WorldPolygon* incident = &polygon_b;
+		uint32_t edge = edge_a;
+		bool flip = false;
+		if (separation_b > separation_a + 0.1f * settings.linear_slop) {
+			reference = &polygon_b;
+			incident = &polygon_a;
+			edge = edge_b;
+			flip = true;
+		}
+
+		glm::vec2 normal = reference->normals[edge];
+		uint32_t incident_edge = 0;
+		float min_dot = FLT_MAX;
+		for (uint32_t i = 0; i < incident->count; i++) {
+			float d = glm::dot(normal, incident->normals[i]);
+			if (d < min_dot) {
+				min_dot = d;
+				incident_edge = i;
+			}
+		}
+
+		uint32_t incident_next = (incident_edge + 1) % incident->count;
+		ClipVertex incident_points[2] = {
+			{ incident->vertices[incident_edge], (edge << 16) | (incident_edge << 8) },
+			{ incident->vertices[incident_next], (edge << 16) | (incident_next << 8) }
+		};
+
+		glm::vec2 v1 = reference->vertices[edge];
+		glm::vec2 v2 = reference->vertices[(edge + 1) % reference->count];
+		glm::vec2 tangent = glm::normalize(v2 - v1);
+
+		ClipVertex clipped1[2], clipped2[2];
+		if (ClipSegment(clipped1, incident_points, -tangent, -glm::dot(tangent, v1), 0x1) < 2)
+			return;
+		if (ClipSegment(clipped2, clipped1, tangent, glm::dot(tangent, v2), 0x2) < 2)
+			return;
+
+		float front = glm::dot(normal, v1);
+		manifold.normal = flip ? -normal : normal;
+		for (uint32_t i = 0; i < 2; i++) {
+			float separation = glm::dot(normal, clipped2[i].point) - front;
+			if (separation > 0.0f)
+				continue;
+
+			ContactPoint& point = manifold.points[manifold.point_count++];
+			point = ContactPoint();
+			point.point = clipped2[i].point - 0.5f * separation * normal;
+			point.separation = separation;
+			point.feature = clipped2[i].feature | (flip ? 0x80000000u : 0u);
+		}
+
+		const CachedManifold* cached = FindCached(PairKey(manifold.body_a, manifold.body_b));
+		if (!cached)
+			return;
+
+		for (uint32_t i = 0; i < manifold.point_count; i++) {
+			for (uint32_t j = 0; j < cached->point_count; j++) {
+				if (cached->points[j].feature == manifold.points[i].feature) {
+					manifold.points[i].normal_impulse = cached->points[j].normal_impulse;
+					manifold.points[i].tangent_impulse = cached->points[j].tangent_impulse;
+				}
+			}
+		}
+	}
+
+	uint32_t PhysicsWorld::FindRoot(uint32_t body) {
+		while (island_parents[body] != body) {
+			island_parents[body] = island_parents[island_parents[body]];
+			body = island_parents[body];
+		}
+		return body;
+	}
+
+	void PhysicsWorld::BuildIslands() {
+		island_parents.resize(bodies.size());
+		for (uint32_t i = 0; i < (uint32_t)bodies.size(); i++)
+			island_parents[i] = i;
+
+		for (const ContactManifold& manifold : manifolds) {
+			const RigidBody& a = bodies[manifold.body_a];
+			const RigidBody& b = bodies[manifold.body_b];
+			if (a.sensor || b.sensor || a.type != BodyType::Dynamic || b.type != BodyType::Dynamic)
+				continue;
+
+			uint32_t root_a = FindRoot(manifold.body_a);
+			uint32_t root_b = FindRoot(manifold.body_b);
+			if (root_a != root_b)
+				island_parents[root_a] = root_b;
+		}
+
+		uint32_t island_count = 0;
+		for (RigidBody& body : bodies)
+			body.island = UINT32_MAX;
+		for (uint32_t i = 0; i < (uint32_t)bodies.size(); i++) {
+			RigidBody& body = bodies[i];
+			if (!body.active || body.type != BodyType::Dynamic || !body.awake)
+				continue;
+
+			RigidBody& root = bodies[FindRoot(i)];
+			if (root.island == UINT32_MAX)
+				root.island = island_count++;
+			body.island = root.island;
+		}
+
+		/* Counting sort of bodies and contacts by island. */
+		island_body_starts.assign(island_count + 1, 0);
+		island_contact_starts.assign(island_count + 1, 0);
+		for (const RigidBody& body : bodies)
+			if (body.island != UINT32_MAX)
+				island_body_starts[body.island + 1]++;
+
+		auto manifold_island = [this](const ContactManifold& manifold) {
+			const RigidBody& a = bodies[manifold.body_a];
+			const RigidBody& b = bodies[manifold.body_b];
+			if (a.sensor || b.sensor)
+				return UINT32_MAX;
+			return (a.type == BodyType::Dynamic) ? a.island : b.island;
+		};
+		for (const ContactManifold& manifold : manifolds) {
+			uint32_t island = manifold_island(manifold);
+			if (island != UINT32_MAX)
+				island_contact_starts[island + 1]++;
+		}
+
+		for (uint32_t i = 0; i < island_count; i++) {
+			island_body_starts[i + 1] += island_body_starts[i];
+			island_contact_starts[i + 1] += island_contact_starts[i];
+		}
+
+		island_bodies.resize(island_body_starts[island_count]);
+		island_contacts.resize(island_contact_starts[island_count]);
+		std::vector<uint32_t>& body_cursor = island_parents;
+		body_cursor.assign(island_body_starts.begin(), island_body_starts.end());
+		for (uint32_t i = 0; i < (uint32_t)bodies.size(); i++)
+			if (bodies[i].island != UINT32_MAX)
+				island_bodies[body_cursor[bodies[i].island]++] = i;
+
+		body_cursor.assign(island_contact_starts.begin(), island_contact_starts.end());
+		for (uint32_t i = 0; i < (uint32_t)manifolds.size(); i++) {
+			uint32_t island = manifold_island(manifolds[i]);
+			if (island != UINT32_MAX)
+				island_contacts[body_cursor[island]++] = i;
+		}
+
+		stats.islands = island_count;
+	}
+
+	void PhysicsWorld::PrepareContacts(ContactManifold& manifold, float dt) {
+		RigidBody& a = bodies[manifold.body_a];
+		RigidBody& b = bodies[manifold.body_b];
+		glm::vec2 normal = manifold.normal;
+		glm::vec2 tangent = { normal.y, -normal.x };
+
+		for (uint32_t i = 0; i < manifold.point_count; i++) {
+			ContactPoint& point = manifold.points[i];
+			point.offset_a = point.point - a.position;
+			point.offset_b = point.point - b.position;
+
+			float rn_a = Cross(point.offset_a, normal);
+			float rn_b = Cross(point.offset_b, normal);
+			float normal_mass = a.inv_mass + b.inv_mass + a.inv_inertia * rn_a * rn_a + b.inv_inertia * rn_b * rn_b;
+			point.normal_mass = (normal_mass > 0.0f) ? 1.0f / normal_mass : 0.0f;
+
+			float rt_a = Cross(point.offset_a, tangent);
+			float rt_b = Cross(point.offset_b, tangent);
+			float tangent_mass = a.inv_mass + b.inv_mass + a.inv_inertia * rt_a * rt_a + b.inv_inertia * rt_b * rt_b;
+			point.tangent_mass = (tangent_mass > 0.0f) ? 1.0f / tangent_mass : 0.0f;
+
+			glm::vec2 relative = b.velocity + Cross(b.angular_velocity, point.offset_b) - a.velocity - Cross(a.angular_velocity, point.offset_a);
+			float normal_velocity = glm::dot(relative, normal);
+			point.velocity_bias = -settings.baumgarte / dt * std::min(0.0f, point.separation + settings.linear_slop);
+			if (normal_velocity < -settings.restitution_threshold)
+				point.velocity_bias = std::max(point.velocity_bias, -manifold.restitution * normal_velocity);
+
+			/* Warm start with last step's impulses. */
+			glm::vec2 impulse = point.normal_impulse * normal + point.tangent_impulse * tangent;
+			if (a.type == BodyType::Dynamic) {
+				a.velocity -= a.inv_mass * impulse;
+				a.angular_velocity -= a.inv_inertia * Cross(point.offset_a, impulse);
+			}
+			if (b.type == BodyType::Dynamic) {
+				b.velocity += b.inv_mass * impulse;
+				b.angular_velocity += b.inv_inertia * Cross(point.offset_b, impulse);
+			}
+		}
+	}
+
+	void PhysicsWorld::SolveContacts(ContactManifold& manifold) {
+		RigidBody& a = bodies[manifold.body_a];
+		RigidBody& b = bodies[manifold.body_b];
+		bool write_a = a.type == BodyType::Dynamic;
+		bool write_b = b.type == BodyType::Dynamic;
+		glm::vec2 normal = manifold.normal;
+		glm::vec2 tangent = { normal.y, -normal.x };
+
+		for (uint32_t i = 0; i < manifold.point_count; i++) {
+			ContactPoint& point = manifold.points[i];
+
+			glm::vec2 relative = b.velocity + Cross(b.angular_velocity, point.offset_b) - a.velocity - Cross(a.angular_velocity, point.offset_a);
+			float lambda = -point.tangent_mass * glm::dot(relative, tangent);
+			float max_friction = manifold.friction * point.normal_impulse;
+			float tangent_impulse = glm::clamp(point.tangent_impulse + lambda, -max_friction, max_friction);
+			lambda = tangent_impulse - point.tangent_impulse;
+			point.tangent_impulse = tangent_impulse;
+
+			glm::vec2 impulse = lambda * tangent;
+			if (write_a) {
+				a.velocity -= a.inv_mass * impulse;
+				a.angular_velocity -= a.inv_inertia * Cross(point.offset_a, impulse);
+			}
+			if (write_b) {
+				b.velocity += b.inv_mass * impulse;
+				b.angular_velocity += b.inv_inertia * Cross(point.offset_b, impulse);
+			}
+
+			relative = b.velocity + Cross(b.angular_velocity, point.offset_b) - a.velocity - Cross(a.angular_velocity, point.offset_a);
+			lambda = -point.normal_mass * (glm::dot(relative, normal) - point.velocity_bias);
+			float normal_impulse = std::max(point.normal_impulse + lambda, 0.0f);
+			lambda = normal_impulse - point.normal_impulse;
+			point.normal_impulse = normal_impulse;
+
+			impulse = lambda * normal;
+			if (write_a) {
+				a.velocity -= a.inv_mass * impulse;
+				a.angular_velocity -= a.inv_inertia * Cross(point.offset_a, impulse);
+			}
+			if (write_b) {
+				b.velocity += b.inv_mass * impulse;
+				b.angular_velocity += b.inv_inertia * Cross(point.offset_b, impulse);
+			}
+		}
+	}
+
+	/*
+	* Only touches the island's own dynamic bodies and contacts; static and kinematic bodies are read but never
+	* written, which is what lets islands run on different threads.
+	*/
+	void PhysicsWorld::SolveIsland(uint32_t island, float dt) {
+		uint32_t contact_begin = island_contact_starts[island];
+		uint32_t contact_end = island_contact_starts[island + 1];
+		uint32_t body_begin = island_body_starts[island];
+		uint32_t body_end = island_body_starts[island + 1];
+
+		for (uint32_t i = contact_begin; i < contact_end; i++)
+			PrepareContacts(manifolds[island_contacts[i]], dt);
+
+		for (uint32_t iteration = 0; iteration < settings.velocity_iterations; iteration++)
+			for (uint32_t i = contact_begin; i < contact_end; i++)
+				SolveContacts(manifolds[island_contacts[i]]);
+
+		float linear_tolerance = settings.sleep_linear_velocity * settings.sleep_linear_velocity;
+		float angular_tolerance = settings.sleep_angular_velocity * settings.sleep_angular_velocity;
+		float min_sleep_time = FLT_MAX;
+		for (uint32_t i = body_begin; i < body_end; i++) {
+			RigidBody& body = bodies[island_bodies[i]];
+			body.position += body.velocity * dt;
+			body.angle += body.angular_velocity * dt;
+
+			if (glm::dot(body.velocity, body.velocity) > linear_tolerance || body.angular_velocity * body.angular_velocity > angular_tolerance)
+				body.sleep_time = 0.0f;
+			else
+				body.sleep_time += dt;
+			min_sleep_time = std::min(min_sleep_time, body.sleep_time);
+		}
+
+		if (settings.allow_sleep && min_sleep_time >= settings.time_to_sleep) {
+			for (uint32_t i = body_begin; i < body_end; i++) {
+				RigidBody& body = bodies[island_bodies[i]];
+				body.awake = false;
+				body.velocity = { 0.0f, 0.0f };
+				body.angular_velocity = 0.0f;
+			}
+		}
+	}
+
+	void PhysicsWorld::Step(float dt) {
+		if (dt <= 0.0f)
+			return;
+
+		uint64_t start = Clock::Now();
+
+		for (RigidBody& body : bodies)
+			if (body.active && body.type == BodyType::Dynamic && body.awake)
+				body.velocity += settings.gravity * dt;
+
+		grid.Clear();
+		for (uint32_t i = 0; i < (uint32_t)bodies.size(); i++) {
+			if (!bodies[i].active)
+				continue;
+			UpdateBounds(bodies[i]);
+			grid.Insert(i, bodies[i].bounds);
+		}
+		grid.Build();
+
+		pairs.clear();
+		grid.ForEachPair([this](uint32_t a, uint32_t b) {
+			if (a > b)
+				std::swap(a, b);
+			if (ShouldCollide(bodies[a], bodies[b]))
+				pairs.push_back({ a, b });
+		});
+
+		manifolds.resize(pairs.size());
+		JobCounter counter;
+		JobSystem::ParallelFor((uint32_t)pairs.size(), settings.narrowphase_batch, [this](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) {
+				ContactManifold& manifold = manifolds[i];
+				manifold.body_a = pairs[i].a;
+				manifold.body_b = pairs[i].b;
+				manifold.friction = std::sqrt(bodies[pairs[i].a].friction * bodies[pairs[i].b].friction);
+				manifold.restitution = std::max(bodies[pairs[i].a].restitution, bodies[pairs[i].b].restitution);
+				Collide(manifold);
+			}
+		}, &counter);
+		JobSystem::Wait(counter);
+
+		manifolds.erase(std::remove_if(manifolds.begin(), manifolds.end(), [](const ContactManifold& manifold) { return manifold.point_count == 0; }), manifolds.end());
+
+		contact_events.clear();
+		for (const ContactManifold& manifold : manifolds) {
+			RigidBody& a = bodies[manifold.body_a];
+			RigidBody& b = bodies[manifold.body_b];
+			if (!FindCached(PairKey(manifold.body_a, manifold.body_b)))
+				contact_events.push_back({ GetHandle(manifold.body_a), GetHandle(manifold.body_b), manifold.points[0].point, manifold.normal });
+
+			if (a.sensor || b.sensor)
+				continue;
+			if (a.type == BodyType::Dynamic && !a.awake)
+				WakeBody(GetHandle(manifold.body_a));
+			if (b.type == BodyType::Dynamic && !b.awake)
+				WakeBody(GetHandle(manifold.body_b));
+		}
+
+		BuildIslands();
+
+		uint32_t island_count = stats.islands;
+		JobSystem::ParallelFor(island_count, settings.island_batch, [this, dt](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++)
+				SolveIsland(i, dt);
+		}, &counter);
+		JobSystem::Wait(counter);
+
+		stats.awake_bodies = 0;
+		for (RigidBody& body : bodies) {
+			if (!body.active)
+				continue;
+			if (body.type == BodyType::Kinematic) {
+				body.position += body.velocity * dt;
+				body.angle += body.angular_velocity * dt;
+			}
+			if (body.type == BodyType::Dynamic && body.awake)
+				stats.awake_bodies++;
+		}
+
+		next_cache.clear();
+		for (const ContactManifold& manifold : manifolds) {
+			CachedManifold cached;
+			cached.key = PairKey(manifold.body_a, manifold.body_b);
+			cached.point_count = manifold.point_count;
+			for (uint32_t i = 0; i < manifold.point_count; i++)
+				cached.points[i] = { manifold.points[i].feature, manifold.points[i].normal_impulse, manifold.points[i].tangent_impulse };
+			next_cache.push_back(cached);
+		}
+		/* Resting contacts of sleeping bodies are not collided, keep them so waking up does not report them again. */
+		for (const CachedManifold& cached : cache) {
+			const RigidBody& a = bodies[cached.key >> 32];
+			const RigidBody& b = bodies[cached.key & 0xFFFFFFFF];
+			if (a.active && b.active && !IsMoving(a) && !IsMoving(b))
+				next_cache.push_back(cached);
+		}
+		/* Stable so a pair collided this step wins over its carried over copy. */
+		std::stable_sort(next_cache.begin(), next_cache.end(), [](const CachedManifold& a, const CachedManifold& b) { return a.key < b.key; });
+		next_cache.erase(std::unique(next_cache.begin(), next_cache.end(), [](const CachedManifold& a, const CachedManifold& b) { return a.key == b.key; }), next_cache.end());
+		cache.swap(next_cache);
+
+		free_bodies.insert(free_bodies.end(), released_bodies.begin(), released_bodies.end());
+		released_bodies.clear();
+
+		stats.bodies = body_count;
+		stats.pairs = (uint32_t)pairs.size();
+		stats.contacts = (uint32_t)manifolds.size();
+		stats.step_time = (float)Clock::ToMilliseconds(Clock::Now() - start);
+		Profiler::SetValue("Physics step", stats.step_time, ProfilerUnit::Milliseconds);
+		Profiler::SetValue("Physics awake bodies", stats.awake_bodies);
+	}
+
+	const PhysicsWorld::CachedManifold* PhysicsWorld::FindCached(uint64_t key) const {
+		auto it = std::lower_bound(cache.begin(), cache.end(), key, [](const CachedManifold& cached, uint64_t value) { return cached.key < value; });
+		return (it != cache.end() && it->key == key) ? &*it : nullptr;
+	}
+
+	void PhysicsWorld::RegisterState(SnapshotHistory& history) {
+		history.RegisterVector(&bodies, "Physics bodies");
+		history.RegisterVector(&free_bodies, "Physics free bodies");
+		history.RegisterVector(&released_bodies, "Physics released bodies");
+		history.RegisterVector(&cache, "Physics contact cache");
+		history.Register(&body_count, "Physics body count");
+	}
+}
@@ -0,0 +1,97 @@
+#include "Profiler.h"
+#include "Renderer.h"
+#include "MemoryTracker.h"
+
+#include <SDL.h>
+#include <mutex>
+#include <cstring>
+#include <cstdio>
+
+namespace Ember {
+	static ProfilerEntry profiler_entries[MAX_PROFILER_ENTRIES];
+	static size_t profiler_entry_count = 0;
+	static std::mutex profiler_mutex;
+
+	static ProfilerEntry* FindEntry(const char* name, ProfilerUnit unit) {
+		for (size_t i = 0; i < profiler_entry_count; i++)
+			if (strncmp(profiler_entries[i].name, name, MAX_PROFILER_NAME_LENGTH - 1) == 0)
+				return &profiler_entries[i];
+
+		if (profiler_entry_count == MAX_PROFILER_ENTRIES)
+			return nullptr;
+
+		ProfilerEntry* entry = &profiler_entries[profiler_entry_count++];
+		snprintf(entry->name, MAX_PROFILER_NAME_LENGTH, "%s", name);
+		entry->unit = unit;
+		entry->value = 0.0;
+		return entry;
+	}
+
+	void Profiler::SetValue(const char* name, double value, ProfilerUnit unit) {
+		std::lock_guard<std::mutex> lock(profiler_mutex);
+		if (ProfilerEntry* entry = FindEntry(name, unit))
+			entry->value = value;
+	}
+
+	void Profiler::AddValue(const char* name, double value, ProfilerUnit unit) {
+		std::lock_guard<std::mutex> lock(profiler_mutex);
+		if (ProfilerEntry* entry = FindEntry(name, unit))
+			entry->value += value;
+	}
+
+	double Profiler::GetValue(const char* name) {
+		std::lock_guard<std::mutex> lock(profiler_mutex);
+		for (size_t i = 0; i < profiler_entry_count; i++)
+			if (strncmp(profiler_entries[i].name, name, MAX_PROFILER_NAME_LENGTH - 1) == 0)
+				return profiler_entries[i].value;
+		return 0.0;
+	}
+
+	size_t Profiler::GetEntries(ProfilerEntry* entries, size_t max_entries) {
+		std::lock_guard<std::mutex> lock(profiler_mutex);
+		size_t count = (profiler_entry_count < max_entries) ? profiler_entry_count : max_entries;
+		memcpy(entries, profiler_entries, count * sizeof(ProfilerEntry));
+		return count;
+	}
+
+	static void FormatValue(char* buffer, size_t size, const char* name, double value, ProfilerUnit unit) {
+		switch (unit) {
+		case ProfilerUnit::Milliseconds: snprintf(buffer, size, "%s: %.3f ms", name, value); break;
+		case ProfilerUnit::Bytes: snprintf(buffer, size, "%s: %.2f MB", name, value / (1024.0 * 1024.0)); break;
+		default: snprintf(buffer, size, "%s: %.0f", name, value); break;
+		}
+	}
+
+	void Profiler::DrawOverlay(Font* font, const glm::vec2& position, const glm::vec2& scale, const glm::vec4& color) {
+		ProfilerEntry entries[MAX_PROFILER_ENTRIES];
+		size_t count = GetEntries(entries, MAX_PROFILER_ENTRIES);
+
+		char line[128];
+		glm::vec2 pos = position;
+		float line_height = font->height * scale.y * 1.2f;
+
+		for (size_t i = 0; i < count; i++) {
+			FormatValue(line, sizeof(line), entries[i].name, entries[i].value, entries[i].unit);
+			Renderer::RenderText(font, line, pos, scale, color);
+			pos.y -= line_height;
+		}
+
+#ifdef EMBER_MEMORY_TRACKING
+		for (size_t i = 0; i < (size_t)MemoryTag::Count; i++) {
+			MemoryTagStats stats = MemoryTracker::GetStats((MemoryTag)i);
+			snprintf(line, sizeof(line), "%s: %.2f MB cpu (peak %.2f), %.2f MB gpu (peak %.2f)", MemoryTracker::GetTagName((MemoryTag)i),
+				stats.cpu_current / (1024.0 * 1024.0), stats.cpu_peak / (1024.0 * 1024.0), stats.gpu_current / (1024.0 * 1024.0), stats.gpu_peak / (1024.0 * 1024.0));
+			Renderer::RenderText(font, line, pos, scale, color);
+			pos.y -= line_height;
+		}
+#endif
+	}
+
+	ProfileScope::ProfileScope(const char* name)
+		: name(name), start(SDL_GetPerformanceCounter()) { }
+
+	ProfileScope::~ProfileScope() {
+		uint64_t end = SDL_GetPerformanceCounter();
+		Profiler::SetValue(name, (double)(end - start) * 1000.0 / (double)SDL_GetPerformanceFrequency(), ProfilerUnit::Milliseconds);
+	}
+}
@@ -2,15 +2,24 @@
 
 namespace Ember {
 	static std::random_device random_device;
-	static std::mt19937 random_engine(random_device());
+	static RandomEngine random_engine(((uint64_t)random_device() << 32) | random_device());
 
+	/* Distributions are built per call, a static one would keep the bounds of the first call forever. */
 	int RandomGenerator::GenRandom(int min, int max) {
-		static std::uniform_int_distribution<int> int_distro(min, max);
+		std::uniform_int_distribution<int> int_distro(min, max);
 		return int_distro(random_engine);
 	}
 
 	double RandomGenerator::GenRandom(double min, double max) {
-		static std::uniform_real_distribution<double> dbl_distro(min, max);
+		std::uniform_real_distribution<double> dbl_distro(min, max);
 		return dbl_distro(random_engine);
 	}
+
+	void RandomGenerator::Seed(uint64_t seed) {
+		random_engine.Seed(seed);
+	}
+
+	RandomEngine& RandomGenerator::GetEngine() {
+		return random_engine;
+	}
 }
\ No newline at end of file
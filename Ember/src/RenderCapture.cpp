@@ -0,0 +1,463 @@
+#include "RenderCapture.h"
+#include "Font.h"
+#include "Logger.h"
+#include "MemoryTracker.h"
+#include "Renderer.h"
+#include "RenderThread.h"
+#include "Shader.h"
+#include "Texture.h"
+
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+
+namespace Ember {
+	static constexpr uint16_t DEFAULT_SHADER = UINT16_MAX;
+
+	struct CaptureData {
+		bool active = false;
+		std::string path;
+		uint32_t frame_limit = 0;
+		uint32_t frames = 0;
+		std::vector<uint8_t> buffer;
+		std::unordered_map<const void*, uint16_t> shaders;
+		std::unordered_map<const void*, uint16_t> fonts;
+	};
+
+	static CaptureData capture_data;
+
+	template<typename T>
+	static void Write(const T& value) {
+		const uint8_t* bytes = (const uint8_t*)&value;
+		capture_data.buffer.insert(capture_data.buffer.end(), bytes, bytes + sizeof(T));
+	}
+
+	static void WriteOp(RenderTraceOp op) {
+		Write((uint8_t)op);
+	}
+
+	/* Length, characters and the terminator, so replay can pass the string straight from the trace. */
+	static void WriteString(const char* text) {
+		size_t length = strlen(text);
+		if (length > UINT16_MAX - 1)
+			length = UINT16_MAX - 1;
+		Write((uint16_t)length);
+		capture_data.buffer.insert(capture_data.buffer.end(), (const uint8_t*)text, (const uint8_t*)text + length);
+		capture_data.buffer.push_back(0);
+	}
+
+	void RenderCapture::Begin(const char* path, uint32_t frame_count) {
+		if (RenderThread::IsRecording()) {
+			std::string copy = path;
+			return RenderThread::Submit([=]() { Begin(copy.c_str(), frame_count); });
+		}
+
+		if (capture_data.active)
+			End();
+
+		capture_data.active = true;
+		capture_data.path = path;
+		capture_data.frame_limit = frame_count;
+		capture_data.frames = 0;
+		capture_data.buffer.clear();
+		capture_data.shaders.clear();
+		capture_data.fonts.clear();
+
+		Write(RENDER_TRACE_MAGIC);
+		Write(RENDER_TRACE_VERSION);
+		EMBER_LOG("Capturing renderer commands to '%s'.", path);
+	}
+
+	void RenderCapture::End() {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { End(); });
+
+		if (!capture_data.active)
+			return;
+		capture_data.active = false;
+
+		FILE* file = fopen(capture_data.path.c_str(), "wb");
+		if (!file) {
+			EMBER_LOG_ERROR("Could not write render trace '%s'.", capture_data.path.c_str());
+			return;
+		}
+
+		fwrite(capture_data.buffer.data(), 1, capture_data.buffer.size(), file);
+		fclose(file);
+		EMBER_LOG_GOOD("Wrote %u frames (%u bytes) of renderer commands to '%s'.", capture_data.frames, (uint32_t)capture_data.buffer.size(), capture_data.path.c_str());
+
+		std::vector<uint8_t>().swap(capture_data.buffer);
+	}
+
+	bool RenderCapture::IsCapturing() {
+		return capture_data.active;
+	}
+
+	void RenderCapture::RecordBeginScene(const RenderView* views, uint32_t view_count, int flags) {
+		if (view_count == 1 && views[0].viewport == glm::vec4(0.0f, 0.0f, 1.0f, 1.0f)) {
+			WriteOp(RenderTraceOp::BeginScene);
+			Write(views[0].camera.GetProjection());
+			Write(views[0].camera.GetView());
+			Write((int32_t)flags);
+			return;
+		}
+
+		WriteOp(RenderTraceOp::BeginViews);
+		Write((uint8_t)view_count);
+		for (uint32_t i = 0; i < view_count; i++) {
+			Write(views[i].camera.GetProjection());
+			Write(views[i].camera.GetView());
+			Write(views[i].viewport);
+		}
+		Write((int32_t)flags);
+	}
+
+	void RenderCapture::RecordEndScene() {
+		WriteOp(RenderTraceOp::EndScene);
+	}
+
+	void RenderCapture::RecordShader(Shader* shader) {
+		uint16_t index = DEFAULT_SHADER;
+		if (shader) {
+			auto found = capture_data.shaders.find(shader);
+			if (found == capture_data.shaders.end()) {
+				index = (uint16_t)capture_data.shaders.size();
+				capture_data.shaders[shader] = index;
+
+				WriteOp(RenderTraceOp::DefineShader);
+				Write(index);
+				WriteString(shader->GetPath().c_str());
+			}
+			else
+				index = found->second;
+		}
+
+		WriteOp(RenderTraceOp::SetShader);
+		Write(index);
+	}
+
+	void RenderCapture::RecordQuad(const Transform2D& transform, float z, const glm::vec4& color, uint32_t texture, const glm::vec2 tex_coords[]) {
+		WriteOp(RenderTraceOp::Quad);
+		Write(transform);
+		Write(z);
+		Write(color);
+		Write(texture);
+
+		/* Most quads use the default coordinates, they are only stored when they differ. */
+		bool custom = tex_coords != TEX_COORDS && memcmp(tex_coords, TEX_COORDS, sizeof(TEX_COORDS)) != 0;
+		Write((uint8_t)custom);
+		if (custom)
+			for (size_t i = 0; i < QUAD_VERTEX_COUNT; i++)
+				Write(tex_coords[i]);
+	}
+
+	void RenderCapture::RecordLine(const glm::vec2& p1, const glm::vec2& p2, const glm::vec4& color, float width) {
+		WriteOp(RenderTraceOp::Line);
+		Write(p1);
+		Write(p2);
+		Write(color);
+		Write(width);
+	}
+
+	void RenderCapture::RecordShape(const Transform2D& transform, float z, const glm::vec4& color, const glm::vec4& shape) {
+		WriteOp(RenderTraceOp::Shape);
+		Write(transform);
+		Write(z);
+		Write(color);
+		Write(shape);
+	}
+
+	void RenderCapture::RecordText(Font* font, const char* text, const glm::vec2& pos, const glm::vec2& scale, const glm::vec4& color) {
+		uint16_t index;
+		auto found = capture_data.fonts.find(font);
+		if (found == capture_data.fonts.end()) {
+			index = (uint16_t)capture_data.fonts.size();
+			capture_data.fonts[font] = index;
+
+			WriteOp(RenderTraceOp::DefineFont);
+			Write(index);
+			Write(font->texture);
+			Write(font->width);
+			Write(font->height);
+			Write(font->size);
+			Write((uint16_t)font->glyphs.size());
+			for (const auto& glyph : font->glyphs) {
+				Write(glyph.first);
+				Write(glyph.second);
+			}
+		}
+		else
+			index = found->second;
+
+		WriteOp(RenderTraceOp::Text);
+		Write(index);
+		Write(pos);
+		Write(scale);
+		Write(color);
+		WriteString(text);
+	}
+
+	void RenderCapture::RecordEndFrame() {
+		WriteOp(RenderTraceOp::EndFrame);
+		capture_data.frames++;
+		if (capture_data.frame_limit != 0 && capture_data.frames >= capture_data.frame_limit)
+			End();
+	}
+
+	RenderReplay::~RenderReplay() {
+		Destroy();
+	}
+
+	bool RenderReplay::Load(const char* path) {
+		Destroy();
+
+		FILE* file = fopen(path, "rb");
+		if (!file) {
+			EMBER_LOG_ERROR("Could not open render trace '%s'.", path);
+			return false;
+		}
+
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		data.resize(size > 0 ? (size_t)size : 0);
+		size_t read = fread(data.data(), 1, data.size(), file);
+		fclose(file);
+
+		size_t offset = 0;
+		uint16_t version = 0;
+		if (read == data.size() && data.size() >= sizeof(uint32_t) + sizeof(uint16_t) && Read<uint32_t>(offset) == RENDER_TRACE_MAGIC)
+			version = Read<uint16_t>(offset);
+		if (version == 0 || version > RENDER_TRACE_VERSION) {
+			EMBER_LOG_ERROR("'%s' is not a render trace of version %u or older.", path, RENDER_TRACE_VERSION);
+			data.clear();
+			return false;
+		}
+
+		/* One pass finds the frames and creates the resources, so replaying never loads anything. */
+		size_t frame_start = offset;
+		bool valid = true;
+		while (valid && offset < data.size()) {
+			RenderTraceOp op = Read<RenderTraceOp>(offset);
+			command_count++;
+			switch (op) {
+			case RenderTraceOp::DefineShader: {
+				uint16_t index = Read<uint16_t>(offset);
+				const char* shader_path = ReadString(offset);
+				if (!shader_path)
+					break;
+
+				if (shaders.size() <= index)
+					shaders.resize(index + 1);
+				shaders[index] = std::make_unique<Shader>(shader_path);
+				Renderer::InitRendererShader(shaders[index].get());
+				break;
+			}
+			case RenderTraceOp::DefineFont: {
+				uint16_t index = Read<uint16_t>(offset);
+				if (fonts.size() <= index)
+					fonts.resize(index + 1);
+				fonts[index] = std::make_unique<Font>();
+
+				Font* font = fonts[index].get();
+				font->texture = GetTexture(Read<uint32_t>(offset));
+				font->width = Read<uint32_t>(offset);
+				font->height = Read<uint32_t>(offset);
+				font->size = Read<uint32_t>(offset);
+				uint16_t glyph_count = Read<uint16_t>(offset);
+				for (uint16_t i = 0; i < glyph_count; i++) {
+					char character = Read<char>(offset);
+					font->glyphs[character] = Read<Glyph>(offset);
+				}
+
+				/* Matches what Font::Init tracks, the destructor releases it. */
+				EMBER_TRACK_GPU_ALLOC(MemoryTag::Font, font->width * font->height);
+				EMBER_TRACK_ALLOC(MemoryTag::Font, font->glyphs.size() * sizeof(std::pair<const char, Glyph>));
+				break;
+			}
+			case RenderTraceOp::BeginScene:
+				offset += 2 * sizeof(glm::mat4) + sizeof(int32_t);
+				break;
+			case RenderTraceOp::BeginViews: {
+				uint8_t view_count = Read<uint8_t>(offset);
+				valid = view_count <= MAX_VIEW_COUNT;
+				offset += view_count * (2 * sizeof(glm::mat4) + sizeof(glm::vec4)) + sizeof(int32_t);
+				break;
+			}
+			case RenderTraceOp::SetShader: {
+				uint16_t index = Read<uint16_t>(offset);
+				valid = index == DEFAULT_SHADER || (index < shaders.size() && shaders[index]);
+				break;
+			}
+			case RenderTraceOp::Quad: {
+				offset += sizeof(Transform2D) + sizeof(float) + sizeof(glm::vec4);
+				uint32_t texture = Read<uint32_t>(offset);
+				if (texture != 0)
+					GetTexture(texture);
+				if (Read<uint8_t>(offset))
+					offset += QUAD_VERTEX_COUNT * sizeof(glm::vec2);
+				break;
+			}
+			case RenderTraceOp::Line:
+				offset += 2 * sizeof(glm::vec2) + sizeof(glm::vec4) + sizeof(float);
+				break;
+			case RenderTraceOp::Shape:
+				offset += sizeof(Transform2D) + sizeof(float) + 2 * sizeof(glm::vec4);
+				break;
+			case RenderTraceOp::Text: {
+				uint16_t index = Read<uint16_t>(offset);
+				valid = index < fonts.size() && fonts[index];
+				offset += 2 * sizeof(glm::vec2) + sizeof(glm::vec4);
+				ReadString(offset);
+				break;
+			}
+			case RenderTraceOp::EndFrame:
+				frame_offsets.push_back(frame_start);
+				frame_start = offset;
+				break;
+			case RenderTraceOp::EndScene:
+				break;
+			default:
+				valid = false;
+				break;
+			}
+		}
+
+		if (!valid) {
+			EMBER_LOG_ERROR("Render trace '%s' is damaged near byte %u.", path, (uint32_t)offset);
+			Destroy();
+			return false;
+		}
+
+		if (offset != data.size()) {
+			EMBER_LOG_ERROR("Render trace '%s' is truncated.", path);
+			Destroy();
+			return false;
+		}
+		return true;
+	}
+
+	void RenderReplay::Destroy() {
+		fonts.clear();
+		shaders.clear();
+		textures.clear();
+		recorded_textures.clear();
+		frame_offsets.clear();
+		data.clear();
+		command_count = 0;
+	}
+
+	const char* RenderReplay::ReadString(size_t& offset) const {
+		uint16_t length = Read<uint16_t>(offset);
+		size_t end = offset + length;
+		if (end >= data.size() || data[end] != 0) {
+			offset = data.size() + 1;
+			return nullptr;
+		}
+
+		const char* text = (const char*)data.data() + offset;
+		offset = end + 1;
+		return text;
+	}
+
+	uint32_t RenderReplay::GetTexture(uint32_t recorded) {
+		for (size_t i = 0; i < recorded_textures.size(); i++)
+			if (recorded_textures[i] == recorded)
+				return textures[i]->GetTextureId();
+
+		uint32_t white = 0xFFFFFFFF;
+		textures.push_back(std::make_unique<Texture>(1, 1));
+		textures.back()->SetData(&white);
+		recorded_textures.push_back(recorded);
+		return textures.back()->GetTextureId();
+	}
+
+	void RenderReplay::ReplayFrame(uint32_t frame) {
+		size_t offset = frame_offsets[frame];
+		for (;;) {
+			RenderTraceOp op = Read<RenderTraceOp>(offset);
+			switch (op) {
+			case RenderTraceOp::DefineShader: {
+				offset += sizeof(uint16_t);
+				offset += Read<uint16_t>(offset) + 1;
+				break;
+			}
+			case RenderTraceOp::DefineFont: {
+				offset += sizeof(uint16_t) + 4 * sizeof(uint32_t);
+				offset += Read<uint16_t>(offset) * (sizeof(char) + sizeof(Glyph));
+				break;
+			}
+			case RenderTraceOp::BeginScene: {
+				camera.SetMatrixProjection(Read<glm::mat4>(offset));
+				camera.SetMatrixView(Read<glm::mat4>(offset));
+				Renderer::BeginScene(camera, Read<int32_t>(offset));
+				break;
+			}
+			case RenderTraceOp::BeginViews: {
+				RenderView views[MAX_VIEW_COUNT];
+				uint8_t view_count = Read<uint8_t>(offset);
+				for (uint8_t i = 0; i < view_count; i++) {
+					views[i].camera.SetMatrixProjection(Read<glm::mat4>(offset));
+					views[i].camera.SetMatrixView(Read<glm::mat4>(offset));
+					views[i].viewport = Read<glm::vec4>(offset);
+				}
+				Renderer::BeginScene(views, view_count, Read<int32_t>(offset));
+				break;
+			}
+			case RenderTraceOp::EndScene:
+				Renderer::EndScene();
+				break;
+			case RenderTraceOp::SetShader: {
+				uint16_t index = Read<uint16_t>(offset);
+				if (index == DEFAULT_SHADER)
+					Renderer::SetShaderToDefualt();
+				else
+					Renderer::SetShader(shaders[index].get());
+				break;
+			}
+			case RenderTraceOp::Quad: {
+				Transform2D transform = Read<Transform2D>(offset);
+				float z = Read<float>(offset);
+				glm::vec4 color = Read<glm::vec4>(offset);
+				uint32_t texture = Read<uint32_t>(offset);
+				glm::vec2 coords[QUAD_VERTEX_COUNT];
+				const glm::vec2* tex_coords = TEX_COORDS;
+				if (Read<uint8_t>(offset)) {
+					for (size_t i = 0; i < QUAD_VERTEX_COUNT; i++)
+						coords[i] = Read<glm::vec2>(offset);
+					tex_coords = coords;
+				}
+				Renderer::SubmitQuad(transform, z, color, texture ? GetTexture(texture) : 0, tex_coords);
+				break;
+			}
+			case RenderTraceOp::Line: {
+				glm::vec2 p1 = Read<glm::vec2>(offset);
+				glm::vec2 p2 = Read<glm::vec2>(offset);
+				glm::vec4 color = Read<glm::vec4>(offset);
+				Renderer::DrawLine(p1, p2, color, Read<float>(offset));
+				break;
+			}
+			case RenderTraceOp::Shape: {
+				Transform2D transform = Read<Transform2D>(offset);
+				float z = Read<float>(offset);
+				glm::vec4 color = Read<glm::vec4>(offset);
+				Renderer::SubmitShape(transform, z, color, Read<glm::vec4>(offset));
+				break;
+			}
+			case RenderTraceOp::Text: {
+				Font* font = fonts[Read<uint16_t>(offset)].get();
+				glm::vec2 pos = Read<glm::vec2>(offset);
+				glm::vec2 scale = Read<glm::vec2>(offset);
+				glm::vec4 color = Read<glm::vec4>(offset);
+				uint16_t length = Read<uint16_t>(offset);
+				Renderer::RenderText(font, (const char*)data.data() + offset, pos, scale, color);
+				offset += length + 1;
+				break;
+			}
+			case RenderTraceOp::EndFrame:
+				Renderer::EndFrame();
+				return;
+			}
+		}
+	}
+}
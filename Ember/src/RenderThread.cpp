@@ -0,0 +1,216 @@
+#include "RenderThread.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "Clock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Ember {
+	void RenderCommandQueue::Init(size_t capacity) {
+		Clear();
+		arena.Init(capacity);
+	}
+
+	void RenderCommandQueue::Destroy() {
+		Clear();
+		arena.Destroy();
+	}
+
+	const char* RenderCommandQueue::CopyString(const char* text) {
+		size_t size = strlen(text) + 1;
+		char* copy = arena.Allocate<char>(size);
+		memcpy(copy, text, size);
+		return copy;
+	}
+
+	void RenderCommandQueue::Execute() {
+		for (CommandHeader* it = head; it; it = it->next)
+			it->invoke(it->data, true);
+		Reset();
+	}
+
+	void RenderCommandQueue::Clear() {
+		for (CommandHeader* it = head; it; it = it->next)
+			it->invoke(it->data, false);
+		Reset();
+	}
+
+	void RenderCommandQueue::Reset() {
+		head = nullptr;
+		tail = nullptr;
+		command_count = 0;
+		arena.Reset();
+	}
+
+	struct RenderThreadData {
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable frame_submitted;
+		std::condition_variable frame_completed;
+
+		RenderCommandQueue queues[RENDER_THREAD_FRAME_COUNT];
+		uint64_t input_timestamps[RENDER_THREAD_FRAME_COUNT] = { };
+		uint64_t submitted_frames = 0;
+		uint64_t completed_frames = 0;
+
+		Window* window = nullptr;
+		bool running = false;
+		bool stop = false;
+
+		std::atomic<float> input_latency{ 0.0f };
+		std::vector<void (*)()> publishers;
+	};
+
+	static RenderThreadData render_thread_data;
+	static thread_local bool is_recording = false;
+
+	static float ElapsedMilliseconds(uint64_t start, uint64_t end) {
+		return (float)Clock::ToMilliseconds(end - start);
+	}
+
+	static void RenderLoop() {
+		SDL_Window* native_window = static_cast<SDL_Window*>(render_thread_data.window->GetNativeWindow());
+		SDL_GL_MakeCurrent(native_window, *render_thread_data.window->Context());
+
+		while (true) {
+			uint64_t frame;
+			uint64_t input_timestamp;
+			{
+				std::unique_lock<std::mutex> lock(render_thread_data.mutex);
+				render_thread_data.frame_submitted.wait(lock, [] {
+					return render_thread_data.stop || render_thread_data.submitted_frames > render_thread_data.completed_frames;
+				});
+
+				if (render_thread_data.submitted_frames == render_thread_data.completed_frames)
+					break;
+
+				frame = render_thread_data.completed_frames;
+				input_timestamp = render_thread_data.input_timestamps[frame % RENDER_THREAD_FRAME_COUNT];
+			}
+
+			RenderCommandQueue& queue = render_thread_data.queues[frame % RENDER_THREAD_FRAME_COUNT];
+			Profiler::SetValue("Render thread commands", queue.GetCommandCount());
+
+			uint64_t start = Clock::Now();
+			queue.Execute();
+			uint64_t end = Clock::Now();
+
+			float latency = ElapsedMilliseconds(input_timestamp, end);
+			render_thread_data.input_latency.store(latency, std::memory_order_relaxed);
+			Profiler::SetValue("Render thread frame", ElapsedMilliseconds(start, end), ProfilerUnit::Milliseconds);
+			Profiler::SetValue("Input latency", latency, ProfilerUnit::Milliseconds);
+
+			{
+				std::lock_guard<std::mutex> lock(render_thread_data.mutex);
+				for (auto publish : render_thread_data.publishers)
+					publish();
+				render_thread_data.completed_frames++;
+			}
+			render_thread_data.frame_completed.notify_one();
+		}
+
+		SDL_GL_MakeCurrent(native_window, nullptr);
+	}
+
+	void RenderThread::Start(Window* window) {
+		if (render_thread_data.running)
+			return;
+
+		if (!window->Context()) {
+			EMBER_LOG_ERROR("Render thread requires a window with an OpenGL context.");
+			return;
+		}
+
+		for (auto& queue : render_thread_data.queues)
+			queue.Init();
+		render_thread_data.window = window;
+		render_thread_data.submitted_frames = 0;
+		render_thread_data.completed_frames = 0;
+		render_thread_data.stop = false;
+		for (auto publish : render_thread_data.publishers)
+			publish();
+		render_thread_data.running = true;
+		is_recording = true;
+
+		SDL_GL_MakeCurrent(static_cast<SDL_Window*>(window->GetNativeWindow()), nullptr);
+		render_thread_data.thread = std::thread(RenderLoop);
+	}
+
+	void RenderThread::Stop() {
+		if (!render_thread_data.running)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(render_thread_data.mutex);
+			render_thread_data.stop = true;
+		}
+		render_thread_data.frame_submitted.notify_one();
+		render_thread_data.thread.join();
+
+		is_recording = false;
+		render_thread_data.running = false;
+		for (auto& queue : render_thread_data.queues)
+			queue.Destroy();
+
+		Window* window = render_thread_data.window;
+		SDL_GL_MakeCurrent(static_cast<SDL_Window*>(window->GetNativeWindow()), *window->Context());
+	}
+
+	bool RenderThread::IsActive() {
+		return render_thread_data.running;
+	}
+
+	bool RenderThread::IsRecording() {
+		return is_recording;
+	}
+
+	void RenderThread::BeginFrame() {
+		uint64_t start = Clock::Now();
+		{
+			std::unique_lock<std::mutex> lock(render_thread_data.mutex);
+			render_thread_data.frame_completed.wait(lock, [] {
+				return render_thread_data.submitted_frames - render_thread_data.completed_frames < RENDER_THREAD_FRAME_COUNT;
+			});
+		}
+		Profiler::SetValue("Game thread wait", ElapsedMilliseconds(start, Clock::Now()), ProfilerUnit::Milliseconds);
+	}
+
+	void RenderThread::EndFrame(uint64_t input_timestamp) {
+		{
+			std::lock_guard<std::mutex> lock(render_thread_data.mutex);
+			render_thread_data.input_timestamps[render_thread_data.submitted_frames % RENDER_THREAD_FRAME_COUNT] = input_timestamp;
+			render_thread_data.submitted_frames++;
+		}
+		render_thread_data.frame_submitted.notify_one();
+	}
+
+	RenderCommandQueue& RenderThread::GetRecordQueue() {
+		return render_thread_data.queues[render_thread_data.submitted_frames % RENDER_THREAD_FRAME_COUNT];
+	}
+
+	float RenderThread::GetInputLatency() {
+		return render_thread_data.input_latency.load(std::memory_order_relaxed);
+	}
+
+	void RenderThread::AddPublisher(void (*publish)()) {
+		std::lock_guard<std::mutex> lock(render_thread_data.mutex);
+		auto& publishers = render_thread_data.publishers;
+		if (std::find(publishers.begin(), publishers.end(), publish) == publishers.end())
+			publishers.push_back(publish);
+	}
+
+	void RenderThread::RemovePublisher(void (*publish)()) {
+		std::lock_guard<std::mutex> lock(render_thread_data.mutex);
+		auto& publishers = render_thread_data.publishers;
+		publishers.erase(std::remove(publishers.begin(), publishers.end(), publish), publishers.end());
+	}
+
+	std::unique_lock<std::mutex> RenderThread::LockPublished() {
+		return std::unique_lock<std::mutex>(render_thread_data.mutex);
+	}
+}
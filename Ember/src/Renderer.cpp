@@ -2,12 +2,21 @@
 #include "Logger.h"
 #include "RendererCommands.h"
 #include "TextureAtlas.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include "RenderThread.h"
+#include "RendererAPI.h"
+#include "RenderCapture.h"
+#include "GPUResources.h"
+#include "Clock.h"
+#include "FastMath.h"
 #include <gtc/matrix_transform.hpp>
 #include <glad/glad.h>
+#include <algorithm>
+#include <cfloat>
 
 namespace Ember {
 	glm::mat4 GetModelMatrix(const glm::vec3& position, const glm::vec2& size);
-	glm::mat4 GetRotatedModelMatrix(const glm::vec3& position, const glm::vec2& size, const glm::vec3& rotation_orientation, float degree);
 
 	struct RendererData {
 		VertexArray* vertex_array;
@@ -23,15 +32,21 @@ namespace Ember {
 
 		uint32_t texture_slot_index = 0;
 		uint32_t textures[MAX_TEXTURE_SLOTS];
-		glm::mat4 proj_view = glm::mat4(1.0f);
-		Camera* camera;
+		ShaderView views[MAX_VIEW_COUNT];
+		uint32_t view_count = 1;
 
 		uint32_t num_of_vertices_in_batch = 0;
 
-		DrawElementsCommand draw_commands[MAX_DRAW_COMMANDS];
-		uint32_t base_vert = 0;
+		std::vector<DrawElementsCommand> draw_commands;
 		uint32_t draw_count = 0;
 		uint32_t current_draw_command_vertex_size = 0;
+		uint32_t current_draw_command_first_index = 0;
+
+		RendererCapacity capacity;
+		uint32_t vertex_capacity = 0;
+		uint32_t index_capacity = 0;
+		uint32_t window_peak_vertices = 0;
+		uint32_t window_scene_count = 0;
 
 		Vertex* vertices_base = nullptr;
 		Vertex* vertices_ptr = nullptr;
@@ -41,12 +56,126 @@ namespace Ember {
 		uint32_t current_material_id = -1;
 
 		int flags;
+
+		glm::vec4 view_bounds = glm::vec4(0.0f);
+		bool cull_enabled = false;
+		/* World size of a pixel in the most zoomed out view, 0 when a view is not orthographic. */
+		float pixel_size = 0.0f;
+		RendererStats stats;
+		RendererStats frame_stats;
+		bool submit_enabled = true;
+
+		/* What the game thread reads while the render thread runs, see RenderThread::AddPublisher. */
+		RendererStats published_stats;
+		RendererCapacityStats published_capacity;
 	};
 
 	static RendererData renderer_data;
 
-	void Renderer::Init() {
-		renderer_data.vertex_buffer = new VertexBuffer(sizeof(Vertex) * MAX_VERTEX_COUNT);
+	/* Planes the shaders write to keep a view in its rectangle: left, right, bottom and top. */
+	constexpr uint32_t VIEW_CLIP_DISTANCES = 4;
+
+	static uint32_t IndexCountForVertices(uint32_t vertex_count) {
+		return (vertex_count / QUAD_VERTEX_COUNT) * QUAD_INDEX_COUNT;
+	}
+
+	static bool IsVisible(float min_x, float min_y, float max_x, float max_y) {
+		if (!renderer_data.cull_enabled)
+			return true;
+
+		const glm::vec4& view = renderer_data.view_bounds;
+		if (max_x < view.x || min_x > view.z || max_y < view.y || min_y > view.w) {
+			renderer_data.stats.culled_primitives++;
+			return false;
+		}
+		return true;
+	}
+
+	static bool IsVisible(const glm::vec2& center, const glm::vec2& half_extents) {
+		return IsVisible(center.x - half_extents.x, center.y - half_extents.y, center.x + half_extents.x, center.y + half_extents.y);
+	}
+
+	static bool IsVisible(const glm::vec4 positions[], size_t count) {
+		if (!renderer_data.cull_enabled)
+			return true;
+
+		glm::vec2 min = positions[0];
+		glm::vec2 max = positions[0];
+		for (size_t i = 1; i < count; i++) {
+			min = glm::min(min, glm::vec2(positions[i]));
+			max = glm::max(max, glm::vec2(positions[i]));
+		}
+		return IsVisible(min.x, min.y, max.x, max.y);
+	}
+
+	static glm::vec2 QuadCenter(const glm::vec3& position, const glm::vec2& size) {
+		if (renderer_data.flags & RenderFlags::TopLeftCornerPos)
+			return { position.x + (size.x / 2), position.y + (size.y / 2) };
+		return { position.x, position.y };
+	}
+
+	/* Rotations about the z axis stay 2D affine, other axes need the full model matrix. */
+	static bool PlanarRotation(const glm::vec3& axis, float degrees, float& radians) {
+		if (axis.x != 0.0f || axis.y != 0.0f || axis.z == 0.0f)
+			return false;
+
+		radians = glm::radians((axis.z > 0.0f) ? degrees : -degrees);
+		return true;
+	}
+
+	static bool ComputeViewBounds(const glm::mat4& projection, const glm::mat4& proj_view, glm::vec4& bounds) {
+		if (projection[2][3] != 0.0f || projection[3][3] != 1.0f)
+			return false;
+
+		glm::mat4 inverse = glm::inverse(proj_view);
+		bounds = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (int i = 0; i < 8; i++) {
+			glm::vec4 corner = inverse * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+			bounds.x = std::min(bounds.x, corner.x);
+			bounds.y = std::min(bounds.y, corner.y);
+			bounds.z = std::max(bounds.z, corner.x);
+			bounds.w = std::max(bounds.w, corner.y);
+		}
+		return true;
+	}
+
+	static void AllocateStaging(uint32_t vertex_capacity) {
+		uint32_t index_capacity = IndexCountForVertices(vertex_capacity);
+		Vertex* vertices = new Vertex[vertex_capacity];
+		uint32_t* indices = new uint32_t[index_capacity];
+		EMBER_TRACK_ALLOC(MemoryTag::Renderer, sizeof(Vertex) * vertex_capacity + sizeof(uint32_t) * index_capacity);
+
+		size_t vertices_used = renderer_data.vertices_ptr - renderer_data.vertices_base;
+		size_t indices_used = renderer_data.index_ptr - renderer_data.index_base;
+		if (renderer_data.vertices_base) {
+			memcpy(vertices, renderer_data.vertices_base, vertices_used * sizeof(Vertex));
+			memcpy(indices, renderer_data.index_base, indices_used * sizeof(uint32_t));
+
+			delete[] renderer_data.vertices_base;
+			delete[] renderer_data.index_base;
+			EMBER_TRACK_FREE(MemoryTag::Renderer, sizeof(Vertex) * renderer_data.vertex_capacity + sizeof(uint32_t) * renderer_data.index_capacity);
+		}
+
+		renderer_data.vertices_base = vertices;
+		renderer_data.vertices_ptr = vertices + vertices_used;
+		renderer_data.index_base = indices;
+		renderer_data.index_ptr = indices + indices_used;
+		renderer_data.vertex_capacity = vertex_capacity;
+		renderer_data.index_capacity = index_capacity;
+	}
+
+	void Renderer::Init(const RendererCapacity& capacity) {
+		renderer_data.capacity = capacity;
+		if (renderer_data.capacity.initial_quad_count == 0)
+			renderer_data.capacity.initial_quad_count = 1;
+		if (renderer_data.capacity.initial_draw_commands == 0)
+			renderer_data.capacity.initial_draw_commands = 1;
+		if (renderer_data.capacity.max_quad_count < renderer_data.capacity.initial_quad_count)
+			renderer_data.capacity.max_quad_count = renderer_data.capacity.initial_quad_count;
+
+		uint32_t vertex_capacity = (uint32_t)(renderer_data.capacity.initial_quad_count * QUAD_VERTEX_COUNT);
+
+		renderer_data.vertex_buffer = new VertexBuffer(sizeof(Vertex) * vertex_capacity);
 		renderer_data.vertex_array = new VertexArray();
 
 		VertexBufferLayout layout;
@@ -54,35 +183,50 @@ namespace Ember {
 		layout.AddToBuffer(VertexBufferElement(4, false, VertexShaderType::Float));
 		layout.AddToBuffer(VertexBufferElement(2, false, VertexShaderType::Float));
 		layout.AddToBuffer(VertexBufferElement(2, false, VertexShaderType::Float));
+		layout.AddToBuffer(VertexBufferElement(4, false, VertexShaderType::Float));
 
 		renderer_data.vertex_buffer->SetLayout(layout);
 
-		renderer_data.vertices_base = new Vertex[MAX_VERTEX_COUNT];
-		renderer_data.index_base = new uint32_t[MAX_INDEX_COUNT];
+		AllocateStaging(vertex_capacity);
 
-		renderer_data.index_buffer = new IndexBuffer(MAX_INDEX_COUNT * sizeof(uint32_t));
+		renderer_data.index_buffer = new IndexBuffer(renderer_data.index_capacity * sizeof(uint32_t));
 		renderer_data.vertex_array->SetIndexBufferSize(renderer_data.index_buffer->GetCount());
 		renderer_data.vertex_array->AddVertexBuffer(renderer_data.vertex_buffer, VertexBufferFormat::VNCVNCVNC);
 
-		renderer_data.indirect_draw_buffer = new IndirectDrawBuffer(sizeof(renderer_data.draw_commands));
+		renderer_data.draw_commands.resize(renderer_data.capacity.initial_draw_commands);
+		renderer_data.indirect_draw_buffer = new IndirectDrawBuffer((uint32_t)(sizeof(DrawElementsCommand) * renderer_data.draw_commands.size()));
 
 		renderer_data.default_shader.Init("shaders/default_shader.glsl");
 		InitRendererShader(&renderer_data.default_shader);
 
-		renderer_data.ssbo = new ShaderStorageBuffer(sizeof(glm::mat4), 0);
+		renderer_data.ssbo = new ShaderStorageBuffer(sizeof(ShaderView) * MAX_VIEW_COUNT, 0);
+		RenderThread::AddPublisher(PublishStats);
 	}
 
 	void Renderer::Destroy() {
+		RenderThread::RemovePublisher(PublishStats);
+
 		delete renderer_data.vertex_array;
 		delete renderer_data.vertex_buffer;
 		delete renderer_data.index_buffer;
 		delete renderer_data.indirect_draw_buffer;
+		delete renderer_data.ssbo;
+		renderer_data.default_shader.Destroy();
 
 		delete[] renderer_data.vertices_base;
 		delete[] renderer_data.index_base;
+		EMBER_TRACK_FREE(MemoryTag::Renderer, sizeof(Vertex) * renderer_data.vertex_capacity + sizeof(uint32_t) * renderer_data.index_capacity);
+		renderer_data.vertices_base = renderer_data.vertices_ptr = nullptr;
+		renderer_data.index_base = renderer_data.index_ptr = nullptr;
+		renderer_data.vertex_capacity = renderer_data.index_capacity = 0;
+
+		std::vector<DrawElementsCommand>().swap(renderer_data.draw_commands);
 	}
 
 	void Renderer::InitRendererShader(Shader* shader) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { InitRendererShader(shader); });
+
 		shader->Bind();
 		int sampler[MAX_TEXTURE_SLOTS];
 		for (int i = 0; i < MAX_TEXTURE_SLOTS; i++) {
@@ -92,19 +236,220 @@ namespace Ember {
 	}
 
 	void Renderer::BeginScene(Camera& camera, int flags) {
+		RenderView view;
+		view.camera = camera;
+		BeginScene(&view, 1, flags);
+	}
+
+	void Renderer::BeginScene(const RenderView* views, uint32_t view_count, int flags) {
+		if (RenderThread::IsRecording()) {
+			const RenderView* copy = RenderThread::CopyArray(views, view_count);
+			return RenderThread::Submit([=]() { BeginScene(copy, view_count, flags); });
+		}
+
+		view_count = std::min(view_count, (uint32_t)MAX_VIEW_COUNT);
+		if (RenderCapture::IsCapturing())
+			RenderCapture::RecordBeginScene(views, view_count, flags);
+
 		renderer_data.flags = flags;
-		renderer_data.proj_view = camera.GetProjection() * camera.GetView();
+		renderer_data.view_count = view_count;
+		renderer_data.cull_enabled = !(flags & RenderFlags::NoCulling) && view_count > 0;
+		renderer_data.view_bounds = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+		renderer_data.pixel_size = 0.0f;
+		uint32_t width, height;
+		RendererCommand::GetViewportSize(width, height);
+		bool orthographic = true;
+		for (uint32_t i = 0; i < view_count; i++) {
+			const Camera& camera = views[i].camera;
+			ShaderView& view = renderer_data.views[i];
+			view.proj_view = camera.GetProjection() * camera.GetView();
+			view.viewport = views[i].viewport;
+			/* Later views get nearer slices of the depth range, so they cover the ones before them. */
+			view.depth_range = { (float)(view_count - 1 - i) / view_count, (float)(view_count - i) / view_count, 0.0f, 0.0f };
+
+			glm::vec4 bounds;
+			if (!ComputeViewBounds(camera.GetProjection(), view.proj_view, bounds)) {
+				renderer_data.cull_enabled = false;
+				orthographic = false;
+				continue;
+			}
+			if (width > 0 && height > 0 && view.viewport.z > 0.0f && view.viewport.w > 0.0f) {
+				float pixel_size = std::max((bounds.z - bounds.x) / (view.viewport.z * width), (bounds.w - bounds.y) / (view.viewport.w * height));
+				renderer_data.pixel_size = std::max(renderer_data.pixel_size, pixel_size);
+			}
+			if (!renderer_data.cull_enabled)
+				continue;
+			renderer_data.view_bounds = { std::min(renderer_data.view_bounds.x, bounds.x), std::min(renderer_data.view_bounds.y, bounds.y),
+				std::max(renderer_data.view_bounds.z, bounds.z), std::max(renderer_data.view_bounds.w, bounds.w) };
+		}
+
+		if (!orthographic)
+			renderer_data.pixel_size = 0.0f;
 
-		renderer_data.camera = &camera;
 		renderer_data.current_shader = &renderer_data.default_shader;
 		renderer_data.current_material_id = -1;
 		StartBatch();
 	}
 
 	void Renderer::EndScene() {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { EndScene(); });
+
+		if (RenderCapture::IsCapturing())
+			RenderCapture::RecordEndScene();
+
 		MakeCommand();
 		GoToNextDrawCommand();
 		Render();
+		UpdateCapacity();
+	}
+
+	void Renderer::EnsureBatchCapacity(uint32_t vertex_count) {
+		uint32_t needed = renderer_data.num_of_vertices_in_batch + vertex_count;
+		if (needed <= renderer_data.vertex_capacity)
+			return;
+
+		uint32_t max_vertices = (uint32_t)(renderer_data.capacity.max_quad_count * QUAD_VERTEX_COUNT);
+		if (renderer_data.vertex_capacity >= max_vertices) {
+			NewBatch();
+			return;
+		}
+
+		uint32_t vertex_capacity = renderer_data.vertex_capacity;
+		while (vertex_capacity < needed && vertex_capacity < max_vertices)
+			vertex_capacity *= 2;
+		if (vertex_capacity > max_vertices)
+			vertex_capacity = max_vertices;
+
+		AllocateStaging(vertex_capacity);
+		if (needed > renderer_data.vertex_capacity)
+			NewBatch();
+	}
+
+	void Renderer::UpdateCapacity() {
+		if (renderer_data.num_of_vertices_in_batch > renderer_data.window_peak_vertices)
+			renderer_data.window_peak_vertices = renderer_data.num_of_vertices_in_batch;
+
+		if (++renderer_data.window_scene_count < renderer_data.capacity.shrink_after_scenes)
+			return;
+
+		uint32_t min_vertices = (uint32_t)(renderer_data.capacity.initial_quad_count * QUAD_VERTEX_COUNT);
+		uint32_t vertex_capacity = renderer_data.vertex_capacity;
+		while (vertex_capacity / 2 >= min_vertices && renderer_data.window_peak_vertices * 4 < vertex_capacity)
+			vertex_capacity /= 2;
+
+		if (vertex_capacity != renderer_data.vertex_capacity) {
+			AllocateStaging(vertex_capacity);
+			renderer_data.vertex_buffer->Resize(sizeof(Vertex) * renderer_data.vertex_capacity);
+			renderer_data.index_buffer->Resize(sizeof(uint32_t) * renderer_data.index_capacity);
+		}
+
+		renderer_data.window_peak_vertices = 0;
+		renderer_data.window_scene_count = 0;
+		Profiler::SetValue("Batch capacity (quads)", renderer_data.vertex_capacity / QUAD_VERTEX_COUNT);
+	}
+
+	RendererCapacityStats Renderer::GetCapacityStats() {
+		if (RenderThread::IsRecording()) {
+			auto lock = RenderThread::LockPublished();
+			return renderer_data.published_capacity;
+		}
+		return ReadCapacityStats();
+	}
+
+	RendererStats Renderer::GetStats() {
+		if (RenderThread::IsRecording()) {
+			auto lock = RenderThread::LockPublished();
+			return renderer_data.published_stats;
+		}
+		return renderer_data.frame_stats;
+	}
+
+	void Renderer::PublishStats() {
+		renderer_data.published_stats = renderer_data.frame_stats;
+		renderer_data.published_capacity = ReadCapacityStats();
+	}
+
+	RendererCapacityStats Renderer::ReadCapacityStats() {
+		RendererCapacityStats stats;
+		stats.vertex_capacity = renderer_data.vertex_capacity;
+		stats.index_capacity = renderer_data.index_capacity;
+		stats.draw_command_capacity = (uint32_t)renderer_data.draw_commands.size();
+		stats.gpu_vertex_bytes = renderer_data.vertex_buffer->GetSize();
+		stats.gpu_index_bytes = renderer_data.index_buffer->GetSize();
+		return stats;
+	}
+
+	void Renderer::EndFrame() {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { EndFrame(); });
+
+		if (RenderCapture::IsCapturing())
+			RenderCapture::RecordEndFrame();
+
+		renderer_data.frame_stats = renderer_data.stats;
+		renderer_data.stats = RendererStats();
+		Profiler::SetValue("Primitives drawn", renderer_data.frame_stats.primitives);
+		Profiler::SetValue("Primitives culled", renderer_data.frame_stats.culled_primitives);
+		Profiler::SetValue("Batches", renderer_data.frame_stats.batches);
+		Profiler::SetValue("Batch submit time", renderer_data.frame_stats.submit_time / 1000000.0, ProfilerUnit::Milliseconds);
+
+		GPUResources::EndFrame();
+	}
+
+	bool Renderer::GetViewBounds(const Camera& camera, glm::vec4& bounds) {
+		return ComputeViewBounds(camera.GetProjection(), camera.GetProjection() * camera.GetView(), bounds);
+	}
+
+	uint32_t Renderer::CullBounds(const Camera& camera, const glm::vec4* bounds, uint32_t count, uint32_t* visible_indices) {
+		glm::vec4 view;
+		if (!GetViewBounds(camera, view)) {
+			for (uint32_t i = 0; i < count; i++)
+				visible_indices[i] = i;
+			return count;
+		}
+
+		uint32_t visible = 0;
+		uint32_t i = 0;
+#ifdef EMBER_SIMD_SSE2
+		__m128 view_min_x = _mm_set1_ps(view.x);
+		__m128 view_min_y = _mm_set1_ps(view.y);
+		__m128 view_max_x = _mm_set1_ps(view.z);
+		__m128 view_max_y = _mm_set1_ps(view.w);
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 min_x = _mm_loadu_ps(&bounds[i].x);
+			__m128 min_y = _mm_loadu_ps(&bounds[i + 1].x);
+			__m128 max_x = _mm_loadu_ps(&bounds[i + 2].x);
+			__m128 max_y = _mm_loadu_ps(&bounds[i + 3].x);
+			_MM_TRANSPOSE4_PS(min_x, min_y, max_x, max_y);
+
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(max_x, view_min_x), _mm_cmple_ps(min_x, view_max_x)),
+				_mm_and_ps(_mm_cmpge_ps(max_y, view_min_y), _mm_cmple_ps(min_y, view_max_y)));
+			int mask = _mm_movemask_ps(inside);
+
+			/* Always writes, only advances past visible entries, so there are no branches on the mask. */
+			for (uint32_t lane = 0; lane < 4; lane++) {
+				visible_indices[visible] = i + lane;
+				visible += (mask >> lane) & 1;
+			}
+		}
+#endif
+		for (; i < count; i++) {
+			const glm::vec4& b = bounds[i];
+			visible_indices[visible] = i;
+			visible += (b.z >= view.x && b.x <= view.z && b.w >= view.y && b.y <= view.w) ? 1 : 0;
+		}
+
+		AddCulledPrimitives(count - visible);
+		return visible;
+	}
+
+	void Renderer::AddCulledPrimitives(uint32_t count) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { AddCulledPrimitives(count); });
+
+		renderer_data.stats.culled_primitives += count;
 	}
 
 	uint32_t Renderer::GetShaderId() {
@@ -112,25 +457,40 @@ namespace Ember {
 	}
 
 	void Renderer::StartBatch() {
-		memset(renderer_data.textures, NULL, renderer_data.texture_slot_index * sizeof(Texture));
+		memset(renderer_data.textures, 0, renderer_data.texture_slot_index * sizeof(renderer_data.textures[0]));
 		renderer_data.texture_slot_index = 0;
 		renderer_data.num_of_vertices_in_batch = 0;
 		renderer_data.index_offset = 0;
 
-		renderer_data.base_vert = 0;
 		renderer_data.draw_count = 0;
 		renderer_data.current_draw_command_vertex_size = 0;
+		renderer_data.current_draw_command_first_index = 0;
 
 		renderer_data.vertices_ptr = renderer_data.vertices_base;
 		renderer_data.index_ptr = renderer_data.index_base;
 	}
 
 	void Renderer::SetPolygonLineThickness(float thickness) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { SetPolygonLineThickness(thickness); });
+
 		if (thickness > 0)
-			glLineWidth(thickness);
+			RendererAPI::Get()->SetLineWidth(thickness);
+	}
+
+	void Renderer::SetSubmitEnabled(bool enabled) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { SetSubmitEnabled(enabled); });
+
+		renderer_data.submit_enabled = enabled;
 	}
 
 	void Renderer::Render() {
+		renderer_data.stats.batches++;
+		if (!renderer_data.submit_enabled)
+			return;
+
+		uint64_t start = Clock::Now();
 		if ((renderer_data.flags & RenderFlags::PolygonMode))
 			RendererCommand::PolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
@@ -138,35 +498,61 @@ namespace Ember {
 		renderer_data.index_buffer->Bind();
 		renderer_data.vertex_buffer->Bind();
 
+		uint32_t draw_commands_size = (uint32_t)(renderer_data.draw_count * sizeof(DrawElementsCommand));
 		renderer_data.indirect_draw_buffer->Bind();
-		renderer_data.indirect_draw_buffer->SetData(renderer_data.draw_commands, sizeof(renderer_data.draw_commands), 0);
+		if (renderer_data.indirect_draw_buffer->GetSize() < draw_commands_size)
+			renderer_data.indirect_draw_buffer->AllocateData((uint32_t)(renderer_data.draw_commands.size() * sizeof(DrawElementsCommand)), nullptr);
+		renderer_data.indirect_draw_buffer->SetData(renderer_data.draw_commands.data(), draw_commands_size, 0);
 
 		renderer_data.current_shader->Bind();
 
 		renderer_data.ssbo->Bind();
-		renderer_data.ssbo->SetData((void*)&renderer_data.proj_view, sizeof(glm::mat4), 0);
+		renderer_data.ssbo->SetData((void*)renderer_data.views, (uint32_t)(renderer_data.view_count * sizeof(ShaderView)), 0);
 		renderer_data.ssbo->BindToBindPoint();
 
-		for (uint32_t i = 0; i < renderer_data.texture_slot_index; i++)
-			if (renderer_data.textures[i]) 
-				glBindTextureUnit(i, renderer_data.textures[i]);
+		for (uint32_t i = 0; i < renderer_data.texture_slot_index; i++) {
+			if (!renderer_data.textures[i])
+				continue;
+			/* Slots keep raw ids, a texture destroyed after it was drawn this scene is caught here. */
+			EMBER_CHECK_GPU_USE(GPUResourceType::Texture, renderer_data.textures[i]);
+			RendererAPI::Get()->BindTextureUnit(i, renderer_data.textures[i]);
+		}
 		uint32_t vertex_buf_size = (uint32_t)((uint8_t*)renderer_data.vertices_ptr - (uint8_t*)renderer_data.vertices_base);
 		uint32_t index_buf_size = (uint32_t)((uint8_t*)renderer_data.index_ptr - (uint8_t*)renderer_data.index_base);
 
+		if (renderer_data.vertex_buffer->GetSize() < vertex_buf_size)
+			renderer_data.vertex_buffer->Resize(sizeof(Vertex) * renderer_data.vertex_capacity);
+		if (renderer_data.index_buffer->GetSize() < index_buf_size)
+			renderer_data.index_buffer->Resize(sizeof(uint32_t) * renderer_data.index_capacity);
+
 		renderer_data.vertex_buffer->SetData(renderer_data.vertices_base, vertex_buf_size);
 		renderer_data.index_buffer->SetData(renderer_data.index_base, index_buf_size);
 
 		renderer_data.vertex_array->SetIndexBufferSize(renderer_data.index_buffer->GetCount());
 
-		RendererCommand::DrawMultiIndirect(nullptr, renderer_data.draw_count + 1, 0);
+		bool multi_view = renderer_data.view_count > 1;
+		if (multi_view)
+			RendererAPI::Get()->SetClipDistances(VIEW_CLIP_DISTANCES);
+		RendererCommand::DrawMultiIndirect(nullptr, renderer_data.draw_count, 0);
+		if (multi_view)
+			RendererAPI::Get()->SetClipDistances(0);
+		renderer_data.stats.submit_time += Clock::Now() - start;
 	}
 
 	void Renderer::NewBatch() {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { NewBatch(); });
+
+		MakeCommand();
+		GoToNextDrawCommand();
 		Render();
 		StartBatch();
 	}
 
 	void Renderer::Submit(VertexArray* vertex_array, IndexBuffer* index_buffer, Shader* shader) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { Submit(vertex_array, index_buffer, shader); });
+
 		shader->Bind();
 		vertex_array->Bind();
 		index_buffer->Bind();
@@ -175,18 +561,81 @@ namespace Ember {
 	}
 
 	void Renderer::DrawQuad(const glm::mat4& translation, const glm::vec4& color, float texture_id, const glm::vec2 tex_coords[]) {
-		if (renderer_data.num_of_vertices_in_batch + QUAD_VERTEX_COUNT > MAX_VERTEX_COUNT)
-			NewBatch();
+		if (RenderThread::IsRecording()) {
+			const glm::vec2* coords = RenderThread::CopyArray(tex_coords, QUAD_VERTEX_COUNT);
+			return RenderThread::Submit([=]() { DrawQuad(translation, color, texture_id, coords); });
+		}
+
+		glm::vec4 positions[QUAD_VERTEX_COUNT];
+		for (size_t i = 0; i < QUAD_VERTEX_COUNT; i++)
+			positions[i] = translation * QUAD_POSITIONS[i];
+		if (!IsVisible(positions, QUAD_VERTEX_COUNT))
+			return;
+
+		EnsureBatchCapacity(QUAD_VERTEX_COUNT);
+		WriteQuadVertices(positions, color, texture_id, tex_coords, glm::vec4(0.0f));
+	}
+
+	void Renderer::BuildQuad(const glm::mat4& translation, const glm::vec4& color, uint32_t texture, const glm::vec2 tex_coords[]) {
+		glm::vec4 positions[QUAD_VERTEX_COUNT];
+		for (size_t i = 0; i < QUAD_VERTEX_COUNT; i++)
+			positions[i] = translation * QUAD_POSITIONS[i];
+		if (!IsVisible(positions, QUAD_VERTEX_COUNT))
+			return;
+
+		WriteQuad(positions, color, texture, tex_coords);
+	}
+
+	void Renderer::DrawQuad(const Transform2D& transform, float z, const glm::vec4& color, Texture* texture, const glm::vec2 tex_coords[]) {
+		SubmitQuad(transform, z, color, texture ? texture->GetTextureId() : 0, tex_coords);
+	}
 
+	void Renderer::SubmitQuad(const Transform2D& transform, float z, const glm::vec4& color, uint32_t texture, const glm::vec2 tex_coords[]) {
+		if (RenderThread::IsRecording()) {
+			const glm::vec2* coords = RenderThread::CopyArray(tex_coords, QUAD_VERTEX_COUNT);
+			return RenderThread::Submit([=]() { SubmitQuad(transform, z, color, texture, coords); });
+		}
+
+		if (RenderCapture::IsCapturing())
+			RenderCapture::RecordQuad(transform, z, color, texture, tex_coords);
+		BuildQuad(transform, z, color, texture, tex_coords);
+	}
+
+	void Renderer::BuildQuad(const Transform2D& transform, float z, const glm::vec4& color, uint32_t texture, const glm::vec2 tex_coords[]) {
+		glm::vec2 half_x = transform.x_axis * 0.5f;
+		glm::vec2 half_y = transform.y_axis * 0.5f;
+		if (!IsVisible(transform.translation, glm::abs(half_x) + glm::abs(half_y)))
+			return;
+
+		glm::vec2 center = transform.translation;
+		glm::vec4 positions[QUAD_VERTEX_COUNT] = {
+			{ center - half_x - half_y, z, 1.0f },
+			{ center + half_x - half_y, z, 1.0f },
+			{ center + half_x + half_y, z, 1.0f },
+			{ center - half_x + half_y, z, 1.0f }
+		};
+
+		WriteQuad(positions, color, texture, tex_coords);
+	}
+
+	void Renderer::WriteQuad(const glm::vec4 positions[], const glm::vec4& color, uint32_t texture, const glm::vec2 tex_coords[], const glm::vec4& shape) {
+		/* Room first, a new batch started after taking the slot would leave the quad pointing at a slot it no longer has. */
+		EnsureBatchCapacity(QUAD_VERTEX_COUNT);
+		float texture_id = texture ? CalculateTextureIndex(texture) : -1.0f;
+		WriteQuadVertices(positions, color, texture_id, tex_coords, shape);
+	}
+
+	void Renderer::WriteQuadVertices(const glm::vec4 positions[], const glm::vec4& color, float texture_id, const glm::vec2 tex_coords[], const glm::vec4& shape) {
 		CalculateSquareIndices();
 
-		for (size_t i = 0; i < QUAD_VERTEX_COUNT; i++) {    
+		for (size_t i = 0; i < QUAD_VERTEX_COUNT; i++) {
 			Vertex vertex;
-			vertex.position = translation * QUAD_POSITIONS[i];
+			vertex.position = positions[i];
 			vertex.color = color;
 			vertex.texture_coordinates = tex_coords[i];
 			vertex.texture_id = texture_id;
 			vertex.material_id = (float)renderer_data.current_material_id;
+			vertex.shape = shape;
 
 			*renderer_data.vertices_ptr = vertex;
 			renderer_data.vertices_ptr++;
@@ -195,6 +644,7 @@ namespace Ember {
 		}
 
 		renderer_data.current_draw_command_vertex_size += 6;
+		renderer_data.stats.primitives++;
 	}
 
 	void Renderer::CalculateSquareIndices() {
@@ -226,44 +676,59 @@ namespace Ember {
 	}
 
 	void Renderer::DrawTriangle(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color) {
-		if (renderer_data.num_of_vertices_in_batch + QUAD_VERTEX_COUNT > MAX_VERTEX_COUNT)
-			NewBatch();
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawTriangle(position, size, color); });
 
-		CalculateTriangleIndices();
-		glm::mat4 translation = GetModelMatrix(position, size);
-
-		for (size_t i = 0; i < TRIANGLE_VERTEX_COUNT; i++) {
-			Vertex vertex;
-			vertex.position = translation * TRIANGLE_POSITIONS[i];
-			vertex.color = color;
-			vertex.texture_coordinates = { 0, 0 };
-			vertex.texture_id = -1.0f;
-			vertex.material_id = (float)renderer_data.current_material_id;
+		WriteTriangle(Transform2D::TranslateScale(QuadCenter(position, size), size), position.z, color);
+	}
 
-			*renderer_data.vertices_ptr = vertex;
-			renderer_data.vertices_ptr++;
+	void Renderer::DrawTriangle(const glm::vec3& position, float rotation, const glm::vec3& rotation_orientation, const glm::vec2& size, const glm::vec4& color) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawTriangle(position, rotation, rotation_orientation, size, color); });
 
-			renderer_data.num_of_vertices_in_batch++;
+		float radians;
+		if (PlanarRotation(rotation_orientation, rotation, radians)) {
+			WriteTriangle(Transform2D::TranslateScaleRotate(QuadCenter(position, size), size, radians), position.z, color);
+			return;
 		}
 
-		renderer_data.current_draw_command_vertex_size += 3;
-	}
-
-	void Renderer::DrawTriangle(const glm::vec3& position, float rotation, const glm::vec3& rotation_orientation, const glm::vec2& size, const glm::vec4& color) {
 		glm::mat4 translation = GetModelMatrix(position, size);
 		translation = glm::rotate(translation, glm::radians(rotation), rotation_orientation);
-		if (renderer_data.num_of_vertices_in_batch + QUAD_VERTEX_COUNT > MAX_VERTEX_COUNT)
-			NewBatch();
+
+		glm::vec4 positions[TRIANGLE_VERTEX_COUNT];
+		for (size_t i = 0; i < TRIANGLE_VERTEX_COUNT; i++)
+			positions[i] = translation * TRIANGLE_POSITIONS[i];
+		WriteTriangle(positions, color);
+	}
+
+	void Renderer::WriteTriangle(const Transform2D& transform, float z, const glm::vec4& color) {
+		glm::vec2 half_x = transform.x_axis * 0.5f;
+		glm::vec2 half_y = transform.y_axis * 0.5f;
+		if (!IsVisible(transform.translation, glm::abs(half_x) + glm::abs(half_y)))
+			return;
+
+		glm::vec2 center = transform.translation;
+		glm::vec4 positions[TRIANGLE_VERTEX_COUNT] = {
+			{ center - half_x - half_y, z, 1.0f },
+			{ center + half_x - half_y, z, 1.0f },
+			{ center + half_y, z, 1.0f }
+		};
+		WriteTriangle(positions, color);
+	}
+
+	void Renderer::WriteTriangle(const glm::vec4 positions[], const glm::vec4& color) {
+		EnsureBatchCapacity(QUAD_VERTEX_COUNT);
 
 		CalculateTriangleIndices();
 
 		for (size_t i = 0; i < TRIANGLE_VERTEX_COUNT; i++) {
 			Vertex vertex;
-			vertex.position = translation * TRIANGLE_POSITIONS[i];
+			vertex.position = positions[i];
 			vertex.color = color;
 			vertex.texture_coordinates = { 0, 0 };
 			vertex.texture_id = -1.0f;
 			vertex.material_id = (float)renderer_data.current_material_id;
+			vertex.shape = glm::vec4(0.0f);
 
 			*renderer_data.vertices_ptr = vertex;
 			renderer_data.vertices_ptr++;
@@ -272,43 +737,137 @@ namespace Ember {
 		}
 
 		renderer_data.current_draw_command_vertex_size += 3;
+		renderer_data.stats.primitives++;
 	}
 
 	void Renderer::DrawLine(const glm::vec2& p1, const glm::vec2& p2, const glm::vec4& color, float width) {
-		float x = p2.x - p1.x;
-		float y = p2.y - p1.y;
-		glm::mat4 trans = glm::translate(glm::mat4(1.0f), { p1.x + (x / 2), p1.y + (y / 2), 0 });
-		glm::mat4 scale = glm::scale(glm::mat4(1.0f), { sqrtf((x * x) + (y * y)), width, 1.0f });
-		glm::mat4 rotate = glm::rotate(glm::mat4(1.0f), atan2f(y, x), { 0, 0, 1 });
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawLine(p1, p2, color, width); });
+
+		if (RenderCapture::IsCapturing())
+			RenderCapture::RecordLine(p1, p2, color, width);
+		BuildQuad(Transform2D::Line(p1, p2, width), 0.0f, color, 0, TEX_COORDS);
+	}
 
-		glm::mat4 model = trans * rotate * scale;
+	void Renderer::DrawCircle(const glm::vec3& center, float radius, const glm::vec4& color) {
+		DrawRing(center, radius, 0.0f, color);
+	}
+
+	void Renderer::DrawRing(const glm::vec3& center, float radius, float thickness, const glm::vec4& color) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawRing(center, radius, thickness, color); });
 
-		DrawQuad(model, color, -1, TEX_COORDS);
+		if (radius <= 0.0f)
+			return;
+		SubmitShape(Transform2D::TranslateScale(center, glm::vec2(radius * 2.0f)), center.z, color, { radius, radius, radius, thickness });
+	}
+
+	void Renderer::DrawRoundedRect(const glm::vec3& position, const glm::vec2& size, float corner_radius, const glm::vec4& color, float rotation) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawRoundedRect(position, size, corner_radius, color, rotation); });
+
+		glm::vec2 half_size = glm::abs(size) * 0.5f;
+		float radius = std::clamp(corner_radius, 0.0f, std::min(half_size.x, half_size.y));
+		SubmitShape(Transform2D::TranslateRotateScale(QuadCenter(position, size), glm::radians(rotation), size), position.z, color, { half_size, radius, 0.0f });
+	}
+
+	void Renderer::DrawCapsule(const glm::vec3& p1, const glm::vec3& p2, float radius, const glm::vec4& color) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawCapsule(p1, p2, radius, color); });
+
+		if (radius <= 0.0f)
+			return;
+
+		/* The line's quad, longer by a cap at each end. */
+		glm::vec2 direction = glm::vec2(p2) - glm::vec2(p1);
+		float length = glm::length(direction);
+		glm::vec2 axis = (length > 0.0f) ? direction / length : glm::vec2(1.0f, 0.0f);
+		glm::vec3 center = (p1 + p2) * 0.5f;
+		Transform2D transform = { axis * (length + radius * 2.0f), glm::vec2(-axis.y, axis.x) * (radius * 2.0f), center };
+		SubmitShape(transform, center.z, color, { length * 0.5f + radius, radius, radius, 0.0f });
+	}
+
+	void Renderer::SubmitShape(const Transform2D& transform, float z, const glm::vec4& color, const glm::vec4& shape) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { SubmitShape(transform, z, color, shape); });
+
+		if (RenderCapture::IsCapturing())
+			RenderCapture::RecordShape(transform, z, color, shape);
+
+		/* A pixel wider on every side, so the fade centered on the edge is not cut off by the quad. */
+		float x_length = glm::length(transform.x_axis);
+		float y_length = glm::length(transform.y_axis);
+		glm::vec2 grow = {
+			(x_length > 0.0f) ? 1.0f + 2.0f * renderer_data.pixel_size / x_length : 1.0f,
+			(y_length > 0.0f) ? 1.0f + 2.0f * renderer_data.pixel_size / y_length : 1.0f
+		};
+		glm::vec2 half_x = transform.x_axis * (0.5f * grow.x);
+		glm::vec2 half_y = transform.y_axis * (0.5f * grow.y);
+		if (!IsVisible(transform.translation, glm::abs(half_x) + glm::abs(half_y)))
+			return;
+
+		glm::vec2 center = transform.translation;
+		glm::vec4 positions[QUAD_VERTEX_COUNT] = {
+			{ center - half_x - half_y, z, 1.0f },
+			{ center + half_x - half_y, z, 1.0f },
+			{ center + half_x + half_y, z, 1.0f },
+			{ center - half_x + half_y, z, 1.0f }
+		};
+		glm::vec2 extent = glm::vec2(shape) * grow;
+		glm::vec2 local[QUAD_VERTEX_COUNT] = {
+			{ -extent.x, -extent.y }, { extent.x, -extent.y }, { extent.x, extent.y }, { -extent.x, extent.y }
+		};
+		WriteQuad(positions, color, 0, local, shape);
 	}
 
 	void Renderer::GoToNextDrawCommand() {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { GoToNextDrawCommand(); });
+
 		renderer_data.draw_count++;
-		renderer_data.base_vert += renderer_data.num_of_vertices_in_batch;
+		renderer_data.current_draw_command_first_index += renderer_data.current_draw_command_vertex_size;
 		renderer_data.current_draw_command_vertex_size = 0;
+
+		if (renderer_data.draw_count == renderer_data.draw_commands.size())
+			renderer_data.draw_commands.resize(renderer_data.draw_commands.size() * 2);
 	}
 
 	void Renderer::MakeCommand() {
-		renderer_data.draw_commands[renderer_data.draw_count].vertex_count = renderer_data.current_draw_command_vertex_size;
-		renderer_data.draw_commands[renderer_data.draw_count].instance_count = 1;
-		renderer_data.draw_commands[renderer_data.draw_count].first_index = 0;
-		renderer_data.draw_commands[renderer_data.draw_count].base_vertex = renderer_data.base_vert;
-		renderer_data.draw_commands[renderer_data.draw_count].base_instance = renderer_data.draw_count;
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { MakeCommand(); });
+
+		DrawElementsCommand& command = renderer_data.draw_commands[renderer_data.draw_count];
+		command.vertex_count = renderer_data.current_draw_command_vertex_size;
+		command.instance_count = renderer_data.view_count;
+		command.first_index = renderer_data.current_draw_command_first_index;
+		command.base_vertex = 0;
+		command.base_instance = renderer_data.draw_count;
 	}
 
 	void Renderer::SetShader(Shader* shader) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { SetShader(shader); });
+
+		if (RenderCapture::IsCapturing())
+			RenderCapture::RecordShader(shader);
+
 		renderer_data.current_shader = shader;
 	}
 
 	void Renderer::SetShaderToDefualt() {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { SetShaderToDefualt(); });
+
+		if (RenderCapture::IsCapturing())
+			RenderCapture::RecordShader(nullptr);
+
 		renderer_data.current_shader = &renderer_data.default_shader;
 	}
 
 	void Renderer::SetMaterialId(uint32_t material_id) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { SetMaterialId(material_id); });
+
 		renderer_data.current_material_id = material_id;
 	}
 
@@ -319,72 +878,124 @@ namespace Ember {
 	}
 
 	void Renderer::DrawQuad(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color) {
-		glm::mat4 model = GetModelMatrix(position, size);
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawQuad(position, size, color); });
 
-		DrawQuad(model, color, -1.0f, TEX_COORDS);
+		SubmitQuad(Transform2D::TranslateScale(QuadCenter(position, size), size), position.z, color, 0, TEX_COORDS);
 	}
 
 	void Renderer::DrawQuad(const glm::vec3& position, const glm::vec2& size, Texture* texture, const glm::vec4& color) {
-		glm::mat4 model = GetModelMatrix(position, size);
-		DrawQuad(model, color, CalculateTextureIndex(texture), TEX_COORDS);
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawQuad(position, size, texture, color); });
+
+		SubmitQuad(Transform2D::TranslateScale(QuadCenter(position, size), size), position.z, color, texture->GetTextureId(), TEX_COORDS);
 	}
 
 	void Renderer::DrawQuad(const glm::vec3& position, const glm::vec2& size, uint32_t texture, const glm::vec4& color) {
-		glm::mat4 model = GetModelMatrix(position, size);
-		DrawQuad(model, color, CalculateTextureIndex(texture), TEX_COORDS);
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawQuad(position, size, texture, color); });
+
+		SubmitQuad(Transform2D::TranslateScale(QuadCenter(position, size), size), position.z, color, texture, TEX_COORDS);
 	}
 
 	void Renderer::DrawQuad(const glm::vec3& position, const glm::vec2& size, const glm::vec2 tex_coords[], const glm::vec4& color) {
-		glm::mat4 model = GetModelMatrix(position, size);
-		DrawQuad(model, color, -1.0f, tex_coords);
+		if (RenderThread::IsRecording()) {
+			const glm::vec2* coords = RenderThread::CopyArray(tex_coords, QUAD_VERTEX_COUNT);
+			return RenderThread::Submit([=]() { DrawQuad(position, size, coords, color); });
+		}
+
+		SubmitQuad(Transform2D::TranslateScale(QuadCenter(position, size), size), position.z, color, 0, tex_coords);
 	}
 
 	void Renderer::DrawQuad(const glm::vec3& position, const glm::vec2& size, Texture* texture, const glm::vec2 tex_coords[], const glm::vec4& color) {
-		glm::mat4 model = GetModelMatrix(position, size);
-		DrawQuad(model, color, CalculateTextureIndex(texture), tex_coords);
+		if (RenderThread::IsRecording()) {
+			const glm::vec2* coords = RenderThread::CopyArray(tex_coords, QUAD_VERTEX_COUNT);
+			return RenderThread::Submit([=]() { DrawQuad(position, size, texture, coords, color); });
+		}
+
+		SubmitQuad(Transform2D::TranslateScale(QuadCenter(position, size), size), position.z, color, texture->GetTextureId(), tex_coords);
 	}
 
 	void Renderer::DrawRotatedQuad(const glm::vec3& position, float rotation, const glm::vec3& rotation_orientation, const glm::vec2& size, const glm::vec4& color) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawRotatedQuad(position, rotation, rotation_orientation, size, color); });
+
+		float radians;
+		if (PlanarRotation(rotation_orientation, rotation, radians)) {
+			SubmitQuad(Transform2D::TranslateRotateScale({ position.x, position.y }, radians, size), 0.0f, color, 0, TEX_COORDS);
+			return;
+		}
+
 		glm::mat4 trans = glm::translate(glm::mat4(1.0f), { position.x, position.y, 0 });
 		glm::mat4 scale = glm::scale(glm::mat4(1.0f), { size.x, size.y, 1.0f });
 		glm::mat4 rotate = glm::rotate(glm::mat4(1.0f), glm::radians(rotation), rotation_orientation);
 
-		glm::mat4 model = trans * rotate * scale;
-
-		DrawQuad(model, color, -1.0f, TEX_COORDS);
+		DrawQuad(trans * rotate * scale, color, -1.0f, TEX_COORDS);
 	}
 
 	void Renderer::DrawRotatedQuad(const glm::vec3& position, float rotation, const glm::vec3& rotation_orientation, const glm::vec2& size, Texture* texture, const glm::vec4& color) {
-		glm::mat4 model = GetModelMatrix(position, size);
-		model = glm::rotate(model, glm::radians(rotation), rotation_orientation);
-		DrawQuad(model, color, CalculateTextureIndex(texture), TEX_COORDS);
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawRotatedQuad(position, rotation, rotation_orientation, size, texture, color); });
+
+		DrawScaledRotatedQuad(position, rotation, rotation_orientation, size, texture->GetTextureId(), TEX_COORDS, color);
 	}
 
 	void Renderer::DrawRotatedQuad(const glm::vec3& position, float rotation, const glm::vec3& rotation_orientation, const glm::vec2& size, const glm::vec2 tex_coords[], const glm::vec4& color) {
-		glm::mat4 model = GetModelMatrix(position, size);
-		model = glm::rotate(model, glm::radians(rotation), rotation_orientation);
-		DrawQuad(model, color, -1.0f, tex_coords);
+		if (RenderThread::IsRecording()) {
+			const glm::vec2* coords = RenderThread::CopyArray(tex_coords, QUAD_VERTEX_COUNT);
+			return RenderThread::Submit([=]() { DrawRotatedQuad(position, rotation, rotation_orientation, size, coords, color); });
+		}
+
+		DrawScaledRotatedQuad(position, rotation, rotation_orientation, size, 0, tex_coords, color);
 	}
 
 	void Renderer::DrawRotatedQuad(const glm::vec3& position, float rotation, const glm::vec3& rotation_orientation, const glm::vec2& size, const glm::vec2 tex_coords[], Texture* texture, const glm::vec4& color) {
+		if (RenderThread::IsRecording()) {
+			const glm::vec2* coords = RenderThread::CopyArray(tex_coords, QUAD_VERTEX_COUNT);
+			return RenderThread::Submit([=]() { DrawRotatedQuad(position, rotation, rotation_orientation, size, coords, texture, color); });
+		}
+
+		DrawScaledRotatedQuad(position, rotation, rotation_orientation, size, texture->GetTextureId(), tex_coords, color);
+	}
+
+	/* These overloads have always rotated before scaling (translate * scale * rotate), kept for existing callers. */
+	void Renderer::DrawScaledRotatedQuad(const glm::vec3& position, float rotation, const glm::vec3& rotation_orientation, const glm::vec2& size, uint32_t texture, const glm::vec2 tex_coords[], const glm::vec4& color) {
+		float radians;
+		if (PlanarRotation(rotation_orientation, rotation, radians)) {
+			SubmitQuad(Transform2D::TranslateScaleRotate(QuadCenter(position, size), size, radians), position.z, color, texture, tex_coords);
+			return;
+		}
+
 		glm::mat4 model = GetModelMatrix(position, size);
 		model = glm::rotate(model, glm::radians(rotation), rotation_orientation);
-		DrawQuad(model, color, CalculateTextureIndex(texture), tex_coords);
+		BuildQuad(model, color, texture, tex_coords);
 	}
 
 	void Renderer::DrawCube(const glm::vec3& position, const glm::vec3& size, const glm::vec4& color) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawCube(position, size, color); });
+
 		glm::mat4 model = glm::translate(glm::mat4(1.0f), { position.x, position.y, position.z }) * glm::scale(glm::mat4(1.0f), { size.x, size.y, size.z });
 		DrawCube(model, color, -1.0f, TEX_COORDS);
 	}
 
 	void Renderer::DrawCube(const glm::vec3& position, const glm::vec3& size, Texture* texture, const glm::vec4& color) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawCube(position, size, texture, color); });
+
 		glm::mat4 model = glm::translate(glm::mat4(1.0f), { position.x, position.y, position.z }) * glm::scale(glm::mat4(1.0f), { size.x, size.y, size.z });
+		/* Like WriteQuad, the slot is only taken once the batch has room for the cube. */
+		EnsureBatchCapacity(CUBE_VERTEX_COUNT);
 		DrawCube(model, color, CalculateTextureIndex(texture), TEX_COORDS);
 	}
 
 	void Renderer::DrawCube(const glm::mat4& translation, const glm::vec4& color, float texture_id, const glm::vec2 tex_coords[]) {
-		if (renderer_data.num_of_vertices_in_batch + CUBE_VERTEX_COUNT > MAX_VERTEX_COUNT)
-			NewBatch();
+		if (RenderThread::IsRecording()) {
+			const glm::vec2* coords = RenderThread::CopyArray(tex_coords, QUAD_VERTEX_COUNT);
+			return RenderThread::Submit([=]() { DrawCube(translation, color, texture_id, coords); });
+		}
+
+		EnsureBatchCapacity(CUBE_VERTEX_COUNT);
 
 		for (uint32_t i = 0; i < CUBE_FACES; i++)
 			CalculateSquareIndices();
@@ -403,6 +1014,7 @@ namespace Ember {
 			vertex.texture_coordinates = tex_coords[i % 4];
 			vertex.texture_id = texture_id;
 			vertex.material_id = (float)renderer_data.current_material_id;
+			vertex.shape = glm::vec4(0.0f);
 
 			*renderer_data.vertices_ptr = vertex;
 			renderer_data.vertices_ptr++;
@@ -411,14 +1023,31 @@ namespace Ember {
 		}
 
 		renderer_data.current_draw_command_vertex_size += 36;
+		renderer_data.stats.primitives++;
 	}
 
 	void Renderer::RenderText(Font* font, const std::string& text, const glm::vec2& pos, const glm::vec2& scale, const glm::vec4& color) {
+		RenderText(font, text.c_str(), pos, scale, color);
+	}
+
+	void Renderer::RenderText(Font* font, const char* text, const glm::vec2& pos, const glm::vec2& scale, const glm::vec4& color) {
+		if (RenderThread::IsRecording()) {
+			const char* copy = RenderThread::CopyString(text);
+			return RenderThread::Submit([=]() { RenderText(font, copy, pos, scale, color); });
+		}
+
+		if (RenderCapture::IsCapturing())
+			RenderCapture::RecordText(font, text, pos, scale, color);
+
 		float x = pos.x;
 		float y= pos.y;
 
-		for (auto& c : text) {
-			Glyph character = font->glyphs[c];
+		for (const char* it = text; *it; it++) {
+			char c = *it;
+			auto glyph = font->glyphs.find(c);
+			if (glyph == font->glyphs.end())
+				continue;
+			const Glyph& character = glyph->second;
 			float normalized_width = TextureAtlas::CalculateSpriteCoordinate({ character.size.x, 0 }, font->width, font->height).x - 0.00002f * font->size;
 
 			float xpos = x + character.bearing.x * scale.x;
@@ -427,6 +1056,10 @@ namespace Ember {
 			float w = character.size.x * scale.x;
 			float h = character.size.y * scale.y;
 
+			x += (character.advance.x >> 6) * scale.x;
+			if (!IsVisible(xpos, ypos, xpos + w, ypos + h))
+				continue;
+
 			float clean = 0.00001f * font->size;
 
 			glm::vec2 coords[] = {
@@ -436,38 +1069,14 @@ namespace Ember {
 				{ character.offset + clean, 0.0f }
 			};
 
-			if (renderer_data.num_of_vertices_in_batch + QUAD_VERTEX_COUNT > MAX_VERTEX_COUNT)
-				NewBatch();
-
-			CalculateSquareIndices();
-			float tex_id = CalculateTextureIndex(font->texture);
-
-			glm::vec4 pos[] = {
+			glm::vec4 positions[] = {
 				{ xpos, ypos, 0.0f, 1.0f },
 				{ xpos + w,  ypos, 0.0f, 1.0f },
 				{ xpos + w,  ypos + h, 0.0f, 1.0f },
-				{ xpos, ypos + h, 0.0f, 1.0f },
-
+				{ xpos, ypos + h, 0.0f, 1.0f }
 			};
 
-			for (size_t i = 0; i < QUAD_VERTEX_COUNT; i++) {
-				Vertex vertex;
-				vertex.position = pos[i];
-				vertex.color = color;
-				vertex.texture_coordinates = coords[i];
-				vertex.texture_id = tex_id;
-				vertex.material_id = (float)renderer_data.current_material_id;
-
-				*renderer_data.vertices_ptr = vertex;
-				renderer_data.vertices_ptr++;
-				 
-				renderer_data.num_of_vertices_in_batch++;
-			}
-
-			renderer_data.current_draw_command_vertex_size += 6;
-
-
-			x += (character.advance.x >> 6) * scale.x;
+			WriteQuad(positions, color, font->texture, coords);
 		}
 	}
 
@@ -483,12 +1092,12 @@ namespace Ember {
 				texture_id = (float)i;
 
 		if (texture_id == -1.0f) {
+			if (renderer_data.texture_slot_index == MAX_TEXTURE_SLOTS)
+				NewBatch();
+
 			renderer_data.textures[renderer_data.texture_slot_index] = id;
 			texture_id = (float)renderer_data.texture_slot_index;
 			renderer_data.texture_slot_index++;
-
-			if (renderer_data.texture_slot_index == MAX_TEXTURE_SLOTS)
-				NewBatch();
 		}
 
 		return texture_id;
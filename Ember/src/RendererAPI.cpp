@@ -0,0 +1,20 @@
+#include "RendererAPI.h"
+#include "OpenGLRendererAPI.h"
+
+namespace Ember {
+	static OpenGLRendererAPI opengl_api;
+	RendererAPI* RendererAPI::current = &opengl_api;
+
+	void RendererAPI::Set(RendererAPI* api) {
+		current = api ? api : &opengl_api;
+	}
+
+	uint32_t GetBytesPerPixel(TextureFormat format) {
+		switch (format) {
+		case TextureFormat::RGB8: return 3;
+		case TextureFormat::RGBA8: return 4;
+		case TextureFormat::R8: return 1;
+		}
+		return 0;
+	}
+}
@@ -1,39 +1,78 @@
 #include "RendererCommands.h"
-#include <glad/glad.h>
+#include "RenderThread.h"
+#include "RendererAPI.h"
 
 namespace Ember {
+	static uint32_t viewport_width = 0;
+	static uint32_t viewport_height = 0;
+
 	void RendererCommand::Init() {
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnable(GL_DEPTH_TEST);
-		glEnable(GL_STENCIL_TEST);
-		glEnable(GL_MULTISAMPLE);
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { Init(); });
+
+		RendererAPI::Get()->Init();
+	}
+
+	void RendererCommand::SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { SetViewport(x, y, w, h); });
+
+		viewport_width = w;
+		viewport_height = h;
+		RendererAPI::Get()->SetViewport(x, y, w, h);
 	}
 
-	void RendererCommand::SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h) { 
-		glViewport(x, y, w, h);
+	void RendererCommand::GetViewportSize(uint32_t& width, uint32_t& height) {
+		width = viewport_width;
+		height = viewport_height;
 	}
-	void RendererCommand::Clear() { 
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	void RendererCommand::Clear() {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { Clear(); });
+
+		RendererAPI::Get()->Clear();
 	}
 
-	void RendererCommand::SetClearColor(float r, float g, float b, float a) { 
-		glClearColor(r, g, b, a);
+	void RendererCommand::SetClearColor(float r, float g, float b, float a) {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { SetClearColor(r, g, b, a); });
+
+		RendererAPI::Get()->SetClearColor(r, g, b, a);
 	}
 
 	void RendererCommand::DrawVertexArray(VertexArray* vertex_array) {
-		glDrawElements(GL_TRIANGLES, vertex_array->GetIndexBufferSize(), GL_UNSIGNED_INT, 0);
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawVertexArray(vertex_array); });
+
+		RendererAPI::Get()->DrawIndexed(vertex_array->GetIndexBufferSize());
 	}
 
 	void RendererCommand::DrawVertexArrayInstanced(VertexArray* vertex_array, uint32_t instance_count) {
-		glDrawArraysInstanced(GL_TRIANGLES, 0, vertex_array->GetIndexBufferSize(), instance_count);
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawVertexArrayInstanced(vertex_array, instance_count); });
+
+		RendererAPI::Get()->DrawArraysInstanced(vertex_array->GetIndexBufferSize(), instance_count);
 	}
 
 	void RendererCommand::DrawMultiIndirect(const void* indirect, uint32_t count, uint32_t stride) {
-		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, indirect, count, stride);
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { DrawMultiIndirect(indirect, count, stride); });
+
+		RendererAPI::Get()->DrawMultiIndirect(indirect, count, stride);
 	}
 
 	void RendererCommand::PolygonMode(uint32_t face, uint32_t mode) {
-		glPolygonMode(face, mode);
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { PolygonMode(face, mode); });
+
+		RendererAPI::Get()->SetPolygonMode(face, mode);
+	}
+
+	void RendererCommand::Finish() {
+		if (RenderThread::IsRecording())
+			return RenderThread::Submit([=]() { Finish(); });
+
+		RendererAPI::Get()->Finish();
 	}
 }
\ No newline at end of file
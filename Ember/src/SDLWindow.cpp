@@ -52,9 +52,27 @@ namespace Ember {
 	}
 
 	void SDLWindow::UpdateWindowAttributes() {
-		SDL_SetWindowSize(native_window, properties->width, properties->height);
-		SDL_SetWindowTitle(native_window, properties->name.c_str());
-		SDL_SetWindowFullscreen(native_window, properties->full_screen);
+		if (properties->width != applied_properties.width || properties->height != applied_properties.height) {
+			SDL_SetWindowSize(native_window, properties->width, properties->height);
+			applied_properties.width = properties->width;
+			applied_properties.height = properties->height;
+		}
+
+		if (properties->name != applied_properties.name) {
+			SDL_SetWindowTitle(native_window, properties->name.c_str());
+			applied_properties.name = properties->name;
+		}
+
+		if (properties->full_screen != applied_properties.full_screen) {
+			SDL_SetWindowFullscreen(native_window, IsFullScreen(properties));
+			applied_properties.full_screen = properties->full_screen;
+		}
+	}
+
+	void SDLWindow::OnResized(int width, int height) {
+		Window::OnResized(width, height);
+		applied_properties.width = width;
+		applied_properties.height = height;
 	}
 
 	void SDLWindow::SetWindowIcon(const char* file_path) {
@@ -73,6 +91,9 @@ namespace Ember {
 
 			native_window = SDL_CreateWindow(properties->name.c_str(), properties->position.x, properties->position.y, properties->width,
 				properties->height, window_flags);
+
+			applied_properties = *properties;
+			applied_properties.full_screen = (window_flags & SDL_WINDOW_FULLSCREEN) ? true : false;
 		}
 
 		return (native_window != nullptr);
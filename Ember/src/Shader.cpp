@@ -1,7 +1,7 @@
 #include "Shader.h"
 #include "Logger.h"
+#include "GPUResources.h"
 
-#include <glad/glad.h>
 #include <gtc/type_ptr.hpp>
 #include <fstream>
 #include <sstream>
@@ -15,53 +15,43 @@ namespace Ember {
 	}
 
 	Shader::~Shader() {
-		glDeleteProgram(shader_id);
+		Destroy();
+	}
+
+	void Shader::Destroy() {
+		if (!shader_id)
+			return;
+
+		if (current_shader_binded == shader_id)
+			current_shader_binded = 0;
+		GPUResources::Release(GPUResourceType::Program, shader_id);
+		shader_id = 0;
 	}
 
 	void Shader::Bind() {
 		if (shader_id != current_shader_binded) {
-			glUseProgram(shader_id);
+			RendererAPI::Get()->UseProgram(shader_id);
 			current_shader_binded = shader_id;
 		}
 	}
 
 	void Shader::UnBind() {
-		glUseProgram(0);
+		RendererAPI::Get()->UseProgram(0);
 		current_shader_binded = 0;
 	}
 
 	void Shader::Init(const std::string& file_path) {
-		shader_id = CreateShader(ParseShader(file_path));
-	}
-
-	uint32_t Shader::CompileShader(const std::string& source, uint32_t type) {
-		uint32_t id = glCreateShader(type);
-		const char* src = source.c_str();
-		glShaderSource(id, 1, &src, nullptr);
-		glCompileShader(id);
-
-		int result;
-		glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-		if (!result)
-		{
-			int length;
-			glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-			char* message = (char*)malloc(length * sizeof(char));
-			glGetShaderInfoLog(id, length, &length, message);
-			EMBER_LOG_ERROR("Shader failed to load: %s", message);
-
-			glDeleteShader(id);
-			return 0;
-		}
-
-		return id;
+		Destroy();
+		path = file_path;
+		shader_id = RendererAPI::Get()->CreateProgram(ParseShader(file_path));
 	}
 
 	ShaderSources Shader::ParseShader(const std::string& file_path) {
 		std::ifstream stream(file_path);
 
 		enum class ShaderType {
-			NONE = -1, VERTEX = GL_VERTEX_SHADER, FRAGMENT = GL_FRAGMENT_SHADER, GEOMETRY = GL_GEOMETRY_SHADER, TESS_EVAL = GL_TESS_EVALUATION_SHADER, TESS_CONTROL = GL_TESS_CONTROL_SHADER
+			NONE = -1, VERTEX = (int)ShaderStage::Vertex, FRAGMENT = (int)ShaderStage::Fragment, GEOMETRY = (int)ShaderStage::Geometry,
+			TESS_EVAL = (int)ShaderStage::TessEval, TESS_CONTROL = (int)ShaderStage::TessControl
 		};
 
 		ShaderType type = ShaderType::NONE;
@@ -97,39 +87,24 @@ namespace Ember {
 		return ss;
 	}
 
-	uint32_t Shader::CreateShader(const ShaderSources& shader_sources) {
-		uint32_t program = glCreateProgram();
-
-		for (auto& shader : shader_sources) {
-			uint32_t s = CompileShader(shader.second.str(), shader.first);
-			glAttachShader(program, s);
-			glDeleteShader(s);
-		}
-
-		glLinkProgram(program);  
-		glValidateProgram(program);
-
-		return program;
-	}
-
 	uint32_t ProgramGetUniformLocation(uint32_t id, const std::string& name) {
-		return (glGetUniformLocation(id, name.c_str()));
+		return RendererAPI::Get()->GetUniformLocation(id, name.c_str());
 	}
 
 	void ProgramSet1f(uint32_t id, const std::string& name, float value) {
-		glProgramUniform1f(id, ProgramGetUniformLocation(id, name), value);
+		RendererAPI::Get()->SetUniformFloat(id, ProgramGetUniformLocation(id, name), value);
 	}
 
 	void ProgramSetMat4f(uint32_t id, const std::string& name, const glm::mat4& mat4) {
-		glProgramUniformMatrix4fv(id, ProgramGetUniformLocation(id, name), 1, GL_FALSE, glm::value_ptr(mat4));
+		RendererAPI::Get()->SetUniformMat4(id, ProgramGetUniformLocation(id, name), glm::value_ptr(mat4));
 	}
 
 	void ProgramSetVec3f(uint32_t id, const std::string& name, const glm::vec3& vec3) {
-		glProgramUniform3f(id, ProgramGetUniformLocation(id, name), vec3.x, vec3.y, vec3.z);
+		RendererAPI::Get()->SetUniformVec3(id, ProgramGetUniformLocation(id, name), glm::value_ptr(vec3));
 	}
 
 	void ProgramSetIntArray(uint32_t id, const std::string& name, int* array) {
-		glProgramUniform1iv(id, ProgramGetUniformLocation(id, name), sizeof(array) / sizeof(int), array);
+		RendererAPI::Get()->SetUniformIntArray(id, ProgramGetUniformLocation(id, name), array, sizeof(array) / sizeof(int));
 	}
 
 	void Shader::Set1f(const std::string& name, float value) {
@@ -137,40 +112,24 @@ namespace Ember {
 	}
 
 	uint32_t Shader::GetUniformLocation(const std::string& name) {
-		return (glGetUniformLocation(shader_id, name.c_str()));
+		return RendererAPI::Get()->GetUniformLocation(shader_id, name.c_str());
 	}
 
 	void Shader::SetMat4f(const std::string& name, const glm::mat4& mat4) {
-		glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat4));
+		RendererAPI::Get()->SetUniformMat4(shader_id, GetUniformLocation(name), glm::value_ptr(mat4));
 	}
 
 	void Shader::SetVec3f(const std::string& name, const glm::vec3& vec3) {
-		glUniform3f(GetUniformLocation(name), vec3.x, vec3.y, vec3.z);
+		RendererAPI::Get()->SetUniformVec3(shader_id, GetUniformLocation(name), glm::value_ptr(vec3));
 	}
 
 	void Shader::SetIntArray(const std::string& name, int* array, uint32_t size) {
-		glUniform1iv(GetUniformLocation(name), size, array);
+		RendererAPI::Get()->SetUniformIntArray(shader_id, GetUniformLocation(name), array, size);
 	}
 
 	std::vector<std::string> GetUniformNames(uint32_t id) {
-		GLint i;
-		GLint count;
-
-		GLint size;
-		GLenum type;
-
-		const GLsizei bufSize = 16;
-		GLchar name[bufSize];
-		GLsizei length;
 		std::vector<std::string> names;
-
-		glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
-
-		for (i = 0; i < count; i++) {
-			glGetActiveUniform(id, (GLuint)i, bufSize, &length, &size, &type, name);
-			names.push_back(name);
-		}
-
+		RendererAPI::Get()->GetUniformNames(id, names);
 		return names;
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,224 @@
+#include "Snapshot.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Ember {
+	void SnapshotHistory::Init(uint32_t frame_count, size_t memory_budget, size_t size) {
+		if (frame_count < 2) {
+			EMBER_LOG_WARNING("SnapshotHistory needs at least 2 frames, got %u.", frame_count);
+			frame_count = 2;
+		}
+
+		/* The whole budget is allocated up front, history never grows past it. */
+		page_size = std::max<size_t>(size, 16);
+		uint32_t page_count = (uint32_t)(memory_budget / page_size);
+		page_data.assign((size_t)page_count * page_size, 0);
+		page_references.assign(page_count, 0);
+		free_pages.resize(page_count);
+		for (uint32_t i = 0; i < page_count; i++)
+			free_pages[i] = page_count - 1 - i;
+
+		frames.clear();
+		frames.resize(frame_count);
+		latest = UINT32_MAX;
+		stats = SnapshotStats();
+		stats.page_capacity = page_count;
+	}
+
+	void SnapshotHistory::Destroy() {
+		regions.clear();
+		frames.clear();
+		page_data.clear();
+		page_references.clear();
+		free_pages.clear();
+		latest = UINT32_MAX;
+	}
+
+	void SnapshotHistory::Register(void* data, size_t size, const char* name) {
+		AddRegion({ data, size, name, nullptr, nullptr, nullptr });
+	}
+
+	void SnapshotHistory::AddRegion(const Region& region) {
+		Clear();
+		regions.push_back(region);
+	}
+
+	void SnapshotHistory::Clear() {
+		for (Frame& frame : frames)
+			if (frame.valid)
+				ReleaseFrame(frame);
+		latest = UINT32_MAX;
+		stats.frames = 0;
+	}
+
+	void SnapshotHistory::ReleaseFrame(Frame& frame) {
+		for (uint32_t page : frame.pages)
+			if (--page_references[page] == 0)
+				free_pages.push_back(page);
+
+		frame.pages.clear();
+		frame.valid = false;
+		stats.frames--;
+	}
+
+	bool SnapshotHistory::DropOldest() {
+		uint32_t count = (uint32_t)frames.size();
+		for (uint32_t i = 1; i <= count; i++) {
+			uint32_t index = (latest + i) % count;
+			if (!frames[index].valid)
+				continue;
+
+			ReleaseFrame(frames[index]);
+			if (index == latest)
+				latest = UINT32_MAX;
+			return true;
+		}
+		return false;
+	}
+
+	uint32_t SnapshotHistory::FindFrame(uint64_t frame) const {
+		for (uint32_t i = 0; i < (uint32_t)frames.size(); i++)
+			if (frames[i].valid && frames[i].frame == frame)
+				return i;
+		return UINT32_MAX;
+	}
+
+	uint64_t SnapshotHistory::GetOldestFrame() const {
+		uint32_t count = (uint32_t)frames.size();
+		for (uint32_t i = 1; i <= count && latest != UINT32_MAX; i++)
+			if (frames[(latest + i) % count].valid)
+				return frames[(latest + i) % count].frame;
+		return 0;
+	}
+
+	uint64_t SnapshotHistory::GetLatestFrame() const {
+		return (latest != UINT32_MAX) ? frames[latest].frame : 0;
+	}
+
+	bool SnapshotHistory::Capture(uint64_t frame) {
+		if (frames.empty() || regions.empty()) {
+			EMBER_LOG_ERROR("SnapshotHistory::Capture called before Init or without registered regions.");
+			return false;
+		}
+
+		uint32_t count = (uint32_t)frames.size();
+
+		/* Capturing a frame again (after a restore or a rewind) replaces it and everything after it. */
+		while (latest != UINT32_MAX && frames[latest].frame >= frame) {
+			ReleaseFrame(frames[latest]);
+			uint32_t previous = (latest + count - 1) % count;
+			latest = frames[previous].valid ? previous : UINT32_MAX;
+		}
+
+		uint32_t slot = (latest == UINT32_MAX) ? 0 : (latest + 1) % count;
+		Frame& target = frames[slot];
+		if (target.valid)
+			ReleaseFrame(target);
+		const Frame* previous = (latest != UINT32_MAX) ? &frames[latest] : nullptr;
+
+		/* First pass compares against the previous frame and takes references to the pages that did not change. */
+		pending_pages.clear();
+		target.region_bytes.clear();
+		size_t previous_page_start = 0;
+		uint32_t new_pages = 0;
+		for (size_t r = 0; r < regions.size(); r++) {
+			const Region& region = regions[r];
+			size_t bytes = region.bytes ? region.bytes(region.owner) : region.size;
+			const uint8_t* source = (const uint8_t*)(region.data ? region.data(region.owner) : region.owner);
+			target.region_bytes.push_back(bytes);
+
+			size_t previous_bytes = previous ? previous->region_bytes[r] : 0;
+			size_t page_count = (bytes + page_size - 1) / page_size;
+			size_t previous_page_count = (previous_bytes + page_size - 1) / page_size;
+			for (size_t p = 0; p < page_count; p++) {
+				size_t offset = p * page_size;
+				size_t length = std::min(page_size, bytes - offset);
+				uint32_t shared = UINT32_MAX;
+
+				if (p < previous_page_count && std::min(page_size, previous_bytes - offset) == length) {
+					uint32_t candidate = previous->pages[previous_page_start + p];
+					if (std::memcmp(GetPage(candidate), source + offset, length) == 0) {
+						shared = candidate;
+						page_references[shared]++;
+					}
+				}
+
+				if (shared == UINT32_MAX)
+					new_pages++;
+				pending_pages.push_back(shared);
+			}
+			previous_page_start += previous_page_count;
+		}
+
+		while (free_pages.size() < new_pages) {
+			if (DropOldest())
+				continue;
+
+			EMBER_LOG_ERROR("SnapshotHistory budget of %u pages is too small for one frame.", stats.page_capacity);
+			for (uint32_t page : pending_pages)
+				if (page != UINT32_MAX && --page_references[page] == 0)
+					free_pages.push_back(page);
+			stats.pages_used = stats.page_capacity - (uint32_t)free_pages.size();
+			return false;
+		}
+
+		/* Second pass copies the pages that changed. */
+		size_t pending = 0;
+		size_t state_bytes = 0;
+		for (size_t r = 0; r < regions.size(); r++) {
+			const Region& region = regions[r];
+			size_t bytes = target.region_bytes[r];
+			const uint8_t* source = (const uint8_t*)(region.data ? region.data(region.owner) : region.owner);
+			for (size_t offset = 0; offset < bytes; offset += page_size, pending++) {
+				if (pending_pages[pending] != UINT32_MAX)
+					continue;
+
+				uint32_t page = free_pages.back();
+				free_pages.pop_back();
+				page_references[page] = 1;
+				std::memcpy(GetPage(page), source + offset, std::min(page_size, bytes - offset));
+				pending_pages[pending] = page;
+			}
+			state_bytes += bytes;
+		}
+
+		target.pages.assign(pending_pages.begin(), pending_pages.end());
+		target.frame = frame;
+		target.valid = true;
+		latest = slot;
+
+		stats.frames++;
+		stats.pages_used = stats.page_capacity - (uint32_t)free_pages.size();
+		stats.state_bytes = state_bytes;
+		stats.last_new_pages = new_pages;
+		stats.last_shared_pages = (uint32_t)pending_pages.size() - new_pages;
+		return true;
+	}
+
+	bool SnapshotHistory::Restore(uint64_t frame) {
+		uint32_t index = FindFrame(frame);
+		if (index == UINT32_MAX)
+			return false;
+
+		const Frame& source = frames[index];
+		size_t page = 0;
+		for (size_t r = 0; r < regions.size(); r++) {
+			const Region& region = regions[r];
+			size_t bytes = source.region_bytes[r];
+			uint8_t* destination = (uint8_t*)(region.resize ? region.resize(region.owner, bytes) : region.owner);
+			for (size_t offset = 0; offset < bytes; offset += page_size, page++)
+				std::memcpy(destination + offset, GetPage(source.pages[page]), std::min(page_size, bytes - offset));
+		}
+
+		uint32_t count = (uint32_t)frames.size();
+		while (latest != index) {
+			ReleaseFrame(frames[latest]);
+			latest = (latest + count - 1) % count;
+		}
+
+		stats.pages_used = stats.page_capacity - (uint32_t)free_pages.size();
+		return true;
+	}
+}
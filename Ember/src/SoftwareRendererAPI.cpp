@@ -0,0 +1,932 @@
+#include "SoftwareRendererAPI.h"
+#include "Buffers.h"
+#include "FastMath.h"
+#include "JobSystem.h"
+#include "Logger.h"
+#include "Renderer.h"
+#include "RendererCommands.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Ember {
+	/* 4 bits of subpixel precision keep the edge values of a partly covered tile within 32 bits. */
+	constexpr int32_t SUBPIXEL_BITS = 4;
+	constexpr int32_t SUBPIXEL_SCALE = 1 << SUBPIXEL_BITS;
+	constexpr int32_t SUBPIXEL_HALF = SUBPIXEL_SCALE / 2;
+	/* Pixels past the viewport a triangle may reach before it is clipped. */
+	constexpr float GUARD_BAND = 8192.0f;
+	constexpr uint32_t MAX_CLIP_VERTICES = 9;
+
+	static uint8_t ToUnorm8(float value) {
+		return (uint8_t)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+
+	static const uint8_t* Texel(const uint8_t* texels, uint32_t width, int32_t x, int32_t y) {
+		return texels + ((size_t)y * width + x) * 4;
+	}
+
+	/* Repeat wraps every texture but the font atlases, which clamp to a transparent black border. */
+	static const uint8_t* Fetch(const uint8_t* texels, uint32_t width, uint32_t height, bool border, int32_t x, int32_t y) {
+		static const uint8_t transparent[4] = {};
+		if (border) {
+			if (x < 0 || y < 0 || x >= (int32_t)width || y >= (int32_t)height)
+				return transparent;
+			return Texel(texels, width, x, y);
+		}
+
+		if ((uint32_t)x >= width) {
+			x %= (int32_t)width;
+			x = (x < 0) ? x + width : x;
+		}
+		if ((uint32_t)y >= height) {
+			y %= (int32_t)height;
+			y = (y < 0) ? y + height : y;
+		}
+		return Texel(texels, width, x, y);
+	}
+
+	/* Bilinear weights have 8 bits and each step rounds, as in llvmpipe's fixed point filtering. */
+	static int32_t Lerp(int32_t a, int32_t b, int32_t weight) {
+		return (a * 256 + (b - a) * weight + 128) >> 8;
+	}
+
+	/* std::floor is a library call without SSE4.1. */
+	static int32_t FloorToInt(float value) {
+		int32_t truncated = (int32_t)value;
+		return (value < (float)truncated) ? truncated - 1 : truncated;
+	}
+
+	static glm::vec4 Sample(const uint8_t* texels, uint32_t width, uint32_t height, bool border, bool linear, float u, float v) {
+		float x = u * width;
+		float y = v * height;
+		if (!linear) {
+			const uint8_t* texel = Fetch(texels, width, height, border, FloorToInt(x), FloorToInt(y));
+			return glm::vec4(texel[0], texel[1], texel[2], texel[3]) * (1.0f / 255.0f);
+		}
+
+		x -= 0.5f;
+		y -= 0.5f;
+		int32_t x0 = FloorToInt(x);
+		int32_t y0 = FloorToInt(y);
+		int32_t wx = (int32_t)((x - x0) * 256.0f + 0.5f);
+		int32_t wy = (int32_t)((y - y0) * 256.0f + 0.5f);
+
+		const uint8_t* t00 = Fetch(texels, width, height, border, x0, y0);
+		const uint8_t* t10 = Fetch(texels, width, height, border, x0 + 1, y0);
+		const uint8_t* t01 = Fetch(texels, width, height, border, x0, y0 + 1);
+		const uint8_t* t11 = Fetch(texels, width, height, border, x0 + 1, y0 + 1);
+
+		glm::vec4 result;
+		for (uint32_t i = 0; i < 4; i++)
+			result[i] = (float)Lerp(Lerp(t00[i], t10[i], wx), Lerp(t01[i], t11[i], wx), wy);
+		return result * (1.0f / 255.0f);
+	}
+
+	/* Plane of a value over pixel coordinates relative to the first vertex: value, d/dx, d/dy. */
+	static glm::vec3 MakePlane(const double x[3], const double y[3], double inv_area, double v0, double v1, double v2) {
+		double dx1 = x[1] - x[0], dy1 = y[1] - y[0];
+		double dx2 = x[2] - x[0], dy2 = y[2] - y[0];
+		double dv1 = v1 - v0, dv2 = v2 - v0;
+		return glm::vec3((float)v0, (float)((dv1 * dy2 - dv2 * dy1) * inv_area), (float)((dv2 * dx1 - dv1 * dx2) * inv_area));
+	}
+
+	static float Evaluate(const glm::vec3& plane, float x, float y) {
+		return plane.x + plane.y * x + plane.z * y;
+	}
+
+	/* The default shader's shape distance: a rounded box, hollowed out to an outline when it has one. */
+	static float ShapeDistance(const glm::vec4& shape, const glm::vec2& p) {
+		float radius = std::min(shape.z, std::min(shape.x, shape.y));
+		glm::vec2 q = glm::abs(p) - glm::vec2(shape) + radius;
+		float d = glm::length(glm::max(q, 0.0f)) + std::min(std::max(q.x, q.y), 0.0f) - radius;
+		if (shape.w > 0.0f)
+			d = std::abs(d + shape.w * 0.5f) - shape.w * 0.5f;
+		return d;
+	}
+
+	SoftwareRendererAPI::SoftwareRendererAPI(uint32_t width, uint32_t height) {
+		Resize(width, height);
+	}
+
+	void SoftwareRendererAPI::Resize(uint32_t width, uint32_t height) {
+		this->width = width;
+		this->height = height;
+		color_buffer.assign((size_t)width * height * 4, 0);
+		depth_buffer.assign((size_t)width * height, 1.0f);
+
+		viewport[0] = viewport[1] = 0;
+		viewport[2] = (int32_t)width;
+		viewport[3] = (int32_t)height;
+
+		tiles_x = (width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+		tiles_y = (height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+		bins.assign((size_t)tiles_x * tiles_y, std::vector<uint32_t>());
+	}
+
+	void SoftwareRendererAPI::SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+		NullRendererAPI::SetViewport(x, y, w, h);
+		viewport[0] = (int32_t)x;
+		viewport[1] = (int32_t)y;
+		viewport[2] = (int32_t)w;
+		viewport[3] = (int32_t)h;
+	}
+
+	void SoftwareRendererAPI::Clear() {
+		NullRendererAPI::Clear();
+		for (size_t i = 0; i < color_buffer.size(); i += 4)
+			memcpy(&color_buffer[i], clear_color, 4);
+		std::fill(depth_buffer.begin(), depth_buffer.end(), 1.0f);
+	}
+
+	void SoftwareRendererAPI::SetClearColor(float r, float g, float b, float a) {
+		NullRendererAPI::SetClearColor(r, g, b, a);
+		clear_color[0] = ToUnorm8(r);
+		clear_color[1] = ToUnorm8(g);
+		clear_color[2] = ToUnorm8(b);
+		clear_color[3] = ToUnorm8(a);
+	}
+
+	void SoftwareRendererAPI::DrawIndexed(uint32_t index_count) {
+		NullRendererAPI::DrawIndexed(index_count);
+
+		DrawState state;
+		std::vector<uint8_t>* index_buffer = GetBound(BufferTarget::Index);
+		if (!index_buffer || !BeginDraw(state))
+			return;
+
+		index_count = std::min(index_count, (uint32_t)(index_buffer->size() / sizeof(uint32_t)));
+		SetupIndexed(state, (const uint32_t*)index_buffer->data(), index_count, 0);
+		RasterizeTriangles(state);
+	}
+
+	/* There are no per instance attributes, every instance draws the same triangles. */
+	void SoftwareRendererAPI::DrawArraysInstanced(uint32_t vertex_count, uint32_t instance_count) {
+		NullRendererAPI::DrawArraysInstanced(vertex_count, instance_count);
+
+		DrawState state;
+		if (!BeginDraw(state))
+			return;
+
+		if (sequential_indices.size() < vertex_count) {
+			sequential_indices.resize(vertex_count);
+			for (uint32_t i = 0; i < vertex_count; i++)
+				sequential_indices[i] = i;
+		}
+
+		for (uint32_t instance = 0; instance < instance_count; instance++)
+			SetupIndexed(state, sequential_indices.data(), vertex_count, 0);
+		RasterizeTriangles(state);
+	}
+
+	void SoftwareRendererAPI::DrawMultiIndirect(const void* indirect, uint32_t count, uint32_t stride) {
+		NullRendererAPI::DrawMultiIndirect(indirect, count, stride);
+
+		DrawState state;
+		std::vector<uint8_t>* index_buffer = GetBound(BufferTarget::Index);
+		std::vector<uint8_t>* indirect_buffer = GetBound(BufferTarget::Indirect);
+		if (!index_buffer || !indirect_buffer || !BeginDraw(state))
+			return;
+
+		if (stride == 0)
+			stride = sizeof(DrawElementsCommand);
+
+		const uint32_t* indices = (const uint32_t*)index_buffer->data();
+		uint32_t index_capacity = (uint32_t)(index_buffer->size() / sizeof(uint32_t));
+		int32_t scene_viewport[4];
+		std::copy(viewport, viewport + 4, scene_viewport);
+		size_t offset = (size_t)indirect;
+		for (uint32_t i = 0; i < count; i++, offset += stride) {
+			if (offset + sizeof(DrawElementsCommand) > indirect_buffer->size())
+				break;
+
+			DrawElementsCommand command;
+			memcpy(&command, indirect_buffer->data() + offset, sizeof(command));
+			if (command.first_index >= index_capacity)
+				continue;
+
+			uint32_t index_count = std::min(command.vertex_count, index_capacity - command.first_index);
+			for (uint32_t instance = 0; instance < command.instance_count; instance++) {
+				SelectView(state, instance, scene_viewport);
+				SetupIndexed(state, indices + command.first_index, index_count, command.base_vertex);
+			}
+		}
+		std::copy(scene_viewport, scene_viewport + 4, viewport);
+		RasterizeTriangles(state);
+	}
+
+	std::vector<uint8_t>* SoftwareRendererAPI::GetBound(BufferTarget target) {
+		uint32_t id = (target == BufferTarget::Index) ? vertex_arrays[bound_vertex_array].index_buffer : bound_buffers[(uint32_t)target];
+		return id ? &buffers[id] : nullptr;
+	}
+
+	void SoftwareRendererAPI::DeleteBuffer(uint32_t id) {
+		NullRendererAPI::DeleteBuffer(id);
+		buffers.erase(id);
+
+		for (uint32_t& bound : bound_buffers)
+			if (bound == id)
+				bound = 0;
+		for (uint32_t& bound : storage_bindings)
+			if (bound == id)
+				bound = 0;
+		VertexArrayState& vertex_array = vertex_arrays[bound_vertex_array];
+		if (vertex_array.index_buffer == id)
+			vertex_array.index_buffer = 0;
+	}
+
+	/* The index buffer binding belongs to the bound vertex array, as in OpenGL. */
+	void SoftwareRendererAPI::BindBuffer(BufferTarget target, uint32_t id) {
+		NullRendererAPI::BindBuffer(target, id);
+		if (target == BufferTarget::Index)
+			vertex_arrays[bound_vertex_array].index_buffer = id;
+		else
+			bound_buffers[(uint32_t)target] = id;
+	}
+
+	void SoftwareRendererAPI::BufferData(BufferTarget target, uint32_t size, const void* data, BufferUsage usage) {
+		NullRendererAPI::BufferData(target, size, data, usage);
+
+		std::vector<uint8_t>* buffer = GetBound(target);
+		if (!buffer) {
+			EMBER_LOG_ERROR("Software renderer: BufferData without a bound buffer.");
+			return;
+		}
+
+		buffer->assign(size, 0);
+		if (data)
+			memcpy(buffer->data(), data, size);
+	}
+
+	void SoftwareRendererAPI::BufferSubData(BufferTarget target, uint32_t offset, uint32_t size, const void* data) {
+		NullRendererAPI::BufferSubData(target, offset, size, data);
+
+		std::vector<uint8_t>* buffer = GetBound(target);
+		if (!buffer || (size_t)offset + size > buffer->size()) {
+			EMBER_LOG_ERROR("Software renderer: BufferSubData of %u bytes at %u is outside the bound buffer.", size, offset);
+			return;
+		}
+
+		memcpy(buffer->data() + offset, data, size);
+	}
+
+	/* The buffer's memory is the storage, it moves only when the buffer is given new data. */
+	void* SoftwareRendererAPI::MapBufferStorage(BufferTarget target, uint32_t size) {
+		NullRendererAPI::MapBufferStorage(target, size);
+
+		std::vector<uint8_t>* buffer = GetBound(target);
+		if (!buffer)
+			return nullptr;
+
+		buffer->assign(size, 0);
+		return buffer->data();
+	}
+
+	void SoftwareRendererAPI::BindBufferBase(BufferTarget target, uint32_t binding, uint32_t id) {
+		BindBufferRange(target, binding, id, 0, 0);
+	}
+
+	void SoftwareRendererAPI::BindBufferRange(BufferTarget target, uint32_t binding, uint32_t id, uint32_t offset, uint32_t size) {
+		NullRendererAPI::BindBufferRange(target, binding, id, offset, size);
+
+		bound_buffers[(uint32_t)target] = id;
+		if (target == BufferTarget::ShaderStorage && binding < sizeof(storage_bindings) / sizeof(storage_bindings[0])) {
+			storage_bindings[binding] = id;
+			storage_offsets[binding] = offset;
+		}
+	}
+
+	void SoftwareRendererAPI::DeleteVertexArray(uint32_t id) {
+		NullRendererAPI::DeleteVertexArray(id);
+		if (id == 0)
+			return;
+
+		vertex_arrays.erase(id);
+		if (bound_vertex_array == id)
+			bound_vertex_array = 0;
+	}
+
+	void SoftwareRendererAPI::BindVertexArray(uint32_t id) {
+		NullRendererAPI::BindVertexArray(id);
+		bound_vertex_array = id;
+	}
+
+	/* Attributes read the vertex buffer bound when they are set, as in OpenGL. */
+	void SoftwareRendererAPI::SetVertexAttribute(uint32_t index, uint32_t size, VertexShaderType type, bool normalized, uint32_t stride, size_t offset) {
+		NullRendererAPI::SetVertexAttribute(index, size, type, normalized, stride, offset);
+		if (index >= SOFTWARE_MAX_ATTRIBUTES)
+			return;
+
+		Attribute& attribute = vertex_arrays[bound_vertex_array].attributes[index];
+		attribute.buffer = bound_buffers[(uint32_t)BufferTarget::Vertex];
+		attribute.size = std::min(size, 4u);
+		attribute.stride = stride ? stride : attribute.size * 4;
+		attribute.offset = offset;
+		attribute.is_float = (type != VertexShaderType::Int);
+	}
+
+	void SoftwareRendererAPI::EnableVertexAttribute(uint32_t index) {
+		NullRendererAPI::EnableVertexAttribute(index);
+		if (index < SOFTWARE_MAX_ATTRIBUTES)
+			vertex_arrays[bound_vertex_array].attributes[index].enabled = true;
+	}
+
+	uint32_t SoftwareRendererAPI::CreateProgram(const ShaderSources& sources) {
+		uint32_t program = NullRendererAPI::CreateProgram(sources);
+
+		bool coverage = false;
+		auto fragment = sources.find((uint32_t)ShaderStage::Fragment);
+		if (fragment != sources.end()) {
+			std::string source = fragment->second.str();
+			size_t red = source.find(").r");
+			coverage = red != std::string::npos && (red + 3 == source.size() || !isalnum((unsigned char)source[red + 3]));
+		}
+
+		programs[program] = coverage;
+		return program;
+	}
+
+	void SoftwareRendererAPI::DeleteProgram(uint32_t program) {
+		NullRendererAPI::DeleteProgram(program);
+		programs.erase(program);
+		if (bound_program == program)
+			bound_program = 0;
+	}
+
+	void SoftwareRendererAPI::UseProgram(uint32_t program) {
+		NullRendererAPI::UseProgram(program);
+		bound_program = program;
+	}
+
+	uint32_t SoftwareRendererAPI::CreateTexture(uint32_t width, uint32_t height, TextureFormat format) {
+		uint32_t id = NullRendererAPI::CreateTexture(width, height, format);
+
+		TextureStorage& texture = textures[id];
+		texture.width = width;
+		texture.height = height;
+		texture.format = format;
+		texture.texels.assign((size_t)width * height * 4, 0);
+		return id;
+	}
+
+	void SoftwareRendererAPI::DeleteTexture(uint32_t id) {
+		NullRendererAPI::DeleteTexture(id);
+		textures.erase(id);
+
+		for (uint32_t& unit : units)
+			if (unit == id)
+				unit = 0;
+		if (bound_texture == id)
+			bound_texture = 0;
+	}
+
+	/* Single channel data samples as red, like GL_RED. */
+	void SoftwareRendererAPI::CopyToTexture(TextureStorage& texture, int32_t x, int32_t y, uint32_t w, uint32_t h, TextureFormat format, uint32_t row_length, const uint8_t* source) {
+		uint32_t source_bpp = GetBytesPerPixel(format);
+		for (uint32_t row = 0; row < h; row++) {
+			for (uint32_t column = 0; column < w; column++) {
+				int32_t tx = x + (int32_t)column, ty = y + (int32_t)row;
+				if (tx < 0 || ty < 0 || tx >= (int32_t)texture.width || ty >= (int32_t)texture.height)
+					continue;
+
+				const uint8_t* in = source + ((size_t)row * row_length + column) * source_bpp;
+				uint8_t* out = &texture.texels[((size_t)ty * texture.width + tx) * 4];
+				out[0] = in[0];
+				out[1] = (format == TextureFormat::R8) ? 0 : in[1];
+				out[2] = (format == TextureFormat::R8) ? 0 : in[2];
+				out[3] = (format == TextureFormat::RGBA8) ? in[3] : 255;
+			}
+		}
+	}
+
+	const uint8_t* SoftwareRendererAPI::GetTexels(uint32_t id) const {
+		auto found = textures.find(id);
+		return (found != textures.end()) ? found->second.texels.data() : nullptr;
+	}
+
+	void SoftwareRendererAPI::SetTextureData(uint32_t id, uint32_t width, uint32_t height, TextureFormat format, const void* data) {
+		NullRendererAPI::SetTextureData(id, width, height, format, data);
+
+		auto found = textures.find(id);
+		if (found != textures.end() && data)
+			CopyToTexture(found->second, 0, 0, width, height, format, width, (const uint8_t*)data);
+	}
+
+	void SoftwareRendererAPI::SetTextureSubData(uint32_t id, int32_t x, int32_t y, uint32_t w, uint32_t h, TextureFormat format, uint32_t row_length, const void* data) {
+		NullRendererAPI::SetTextureSubData(id, x, y, w, h, format, row_length, data);
+
+		auto found = textures.find(id);
+		if (found == textures.end() || !w || !h)
+			return;
+
+		const uint8_t* source = (const uint8_t*)data;
+		if (std::vector<uint8_t>* unpack = GetBound(BufferTarget::PixelUnpack)) {
+			size_t offset = (size_t)(uintptr_t)data;
+			size_t size = ((size_t)row_length * (h - 1) + w) * GetBytesPerPixel(format);
+			if (offset + size > unpack->size()) {
+				EMBER_LOG_ERROR("Software renderer: SetTextureSubData reads past the bound pixel unpack buffer.");
+				return;
+			}
+			source = unpack->data() + offset;
+		}
+
+		if (source)
+			CopyToTexture(found->second, x, y, w, h, format, row_length, source);
+	}
+
+	void SoftwareRendererAPI::BindTextureUnit(uint32_t slot, uint32_t id) {
+		NullRendererAPI::BindTextureUnit(slot, id);
+		if (slot < SOFTWARE_TEXTURE_UNITS)
+			units[slot] = id;
+	}
+
+	void SoftwareRendererAPI::BindTexture(uint32_t id) {
+		NullRendererAPI::BindTexture(id);
+		bound_texture = id;
+	}
+
+	void SoftwareRendererAPI::SetBoundTextureData(int32_t x, int32_t y, int32_t w, int32_t h, TextureFormat format, const void* pixels) {
+		NullRendererAPI::SetBoundTextureData(x, y, w, h, format, pixels);
+
+		auto found = textures.find(bound_texture);
+		if (found != textures.end() && w > 0 && h > 0)
+			CopyToTexture(found->second, x, y, w, h, format, w, (const uint8_t*)pixels);
+	}
+
+	/* Tightly packed RGB rows, bottom row first. Pixels outside the buffer are left untouched. */
+	void SoftwareRendererAPI::ReadPixels(int32_t x, int32_t y, int32_t w, int32_t h, void* pixels) {
+		NullRendererAPI::ReadPixels(x, y, w, h, pixels);
+
+		uint8_t* out = (uint8_t*)pixels;
+		for (int32_t row = 0; row < h; row++) {
+			for (int32_t column = 0; column < w; column++) {
+				int32_t px = x + column, py = y + row;
+				if (px < 0 || py < 0 || px >= (int32_t)width || py >= (int32_t)height)
+					continue;
+
+				memcpy(out + ((size_t)row * w + column) * 3, &color_buffer[((size_t)py * width + px) * 4], 3);
+			}
+		}
+	}
+
+	uint32_t SoftwareRendererAPI::CreateFrameBuffer(uint32_t width, uint32_t height, uint32_t& color_attachment, uint32_t& depth_stencil_attachment) {
+		stats.calls++;
+		color_attachment = depth_stencil_attachment = 0;
+		return 0;
+	}
+
+	bool SoftwareRendererAPI::BeginDraw(DrawState& state) {
+		if (width == 0 || height == 0)
+			return false;
+
+		state.vertex_array = &vertex_arrays[bound_vertex_array];
+		for (uint32_t i = 0; i < SOFTWARE_MAX_ATTRIBUTES; i++) {
+			const Attribute& attribute = state.vertex_array->attributes[i];
+			auto buffer = attribute.enabled ? buffers.find(attribute.buffer) : buffers.end();
+			state.attribute_data[i] = (buffer != buffers.end()) ? buffer->second.data() : nullptr;
+			state.attribute_size[i] = (buffer != buffers.end()) ? buffer->second.size() : 0;
+		}
+		if (!state.attribute_data[0])
+			return false;
+
+		state.proj_view = glm::mat4(1.0f);
+		auto storage = buffers.find(storage_bindings[0]);
+		if (storage != buffers.end() && storage_offsets[0] + sizeof(glm::mat4) <= storage->second.size())
+			memcpy(&state.proj_view, storage->second.data() + storage_offsets[0], sizeof(glm::mat4));
+
+		/* Sampler i reads unit i, the Renderer sets its texture array up that way. */
+		for (uint32_t i = 0; i < SOFTWARE_TEXTURE_UNITS; i++) {
+			auto texture = textures.find(units[i]);
+			state.units[i] = (units[i] && texture != textures.end()) ? &texture->second : nullptr;
+		}
+
+		auto program = programs.find(bound_program);
+		state.coverage = (program != programs.end()) && program->second;
+		return true;
+	}
+
+	/* The rectangle becomes the viewport, the depth slice is folded into the matrix. */
+	void SoftwareRendererAPI::SelectView(DrawState& state, uint32_t view, const int32_t scene_viewport[4]) {
+		auto storage = buffers.find(storage_bindings[0]);
+		size_t offset = storage_offsets[0] + (size_t)view * sizeof(ShaderView);
+		if (storage == buffers.end() || offset + sizeof(ShaderView) > storage->second.size())
+			return;
+
+		ShaderView data;
+		memcpy(&data, storage->second.data() + offset, sizeof(data));
+		glm::mat4 depth(1.0f);
+		depth[2][2] = data.depth_range.y - data.depth_range.x;
+		depth[3][2] = data.depth_range.x + data.depth_range.y - 1.0f;
+		state.proj_view = depth * data.proj_view;
+
+		int32_t min_x = (int32_t)std::lround(data.viewport.x * scene_viewport[2]);
+		int32_t min_y = (int32_t)std::lround(data.viewport.y * scene_viewport[3]);
+		viewport[0] = scene_viewport[0] + min_x;
+		viewport[1] = scene_viewport[1] + min_y;
+		viewport[2] = (int32_t)std::lround((data.viewport.x + data.viewport.z) * scene_viewport[2]) - min_x;
+		viewport[3] = (int32_t)std::lround((data.viewport.y + data.viewport.w) * scene_viewport[3]) - min_y;
+	}
+
+	/* Attributes follow the default shader: position, color, texture coordinates, texture index, then shape. */
+	SoftwareRendererAPI::ClipVertex SoftwareRendererAPI::FetchVertex(const DrawState& state, uint32_t index, glm::vec4& color, float& texture, glm::vec4& shape) const {
+		glm::vec4 values[5] = {
+			glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),
+			glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),
+			glm::vec4(0.0f)
+		};
+
+		for (uint32_t i = 0; i < 5; i++) {
+			const Attribute& attribute = state.vertex_array->attributes[i];
+			size_t offset = attribute.offset + (size_t)index * attribute.stride;
+			if (!state.attribute_data[i] || offset + attribute.size * 4 > state.attribute_size[i])
+				continue;
+
+			const uint8_t* data = state.attribute_data[i] + offset;
+			for (uint32_t component = 0; component < attribute.size; component++) {
+				if (attribute.is_float) {
+					memcpy(&values[i][component], data + component * 4, 4);
+				}
+				else {
+					int32_t value;
+					memcpy(&value, data + component * 4, 4);
+					values[i][component] = (float)value;
+				}
+			}
+		}
+
+		color = values[1];
+		texture = values[3].x;
+		shape = values[4];
+		return { state.proj_view * glm::vec4(glm::vec3(values[0]), 1.0f), glm::vec2(values[2]) };
+	}
+
+	void SoftwareRendererAPI::SetupIndexed(const DrawState& state, const uint32_t* indices, uint32_t index_count, uint32_t base_vertex) {
+		ClipVertex vertices[3];
+		glm::vec4 color, shape;
+		float texture = -1.0f;
+
+		for (uint32_t i = 0; i + 3 <= index_count; i += 3) {
+			for (uint32_t v = 0; v < 3; v++)
+				vertices[v] = FetchVertex(state, indices[i + v] + base_vertex, color, texture, shape);
+			SetupPrimitive(state, vertices, color, texture, shape);
+		}
+	}
+
+	void SoftwareRendererAPI::SetupPrimitive(const DrawState& state, const ClipVertex vertices[3], const glm::vec4& color, float texture, const glm::vec4& shape) {
+		int32_t slot = (texture != -1.0f) ? (int32_t)texture : -1;
+
+		/* Distances to the near, far and guard band planes, positive inside. */
+		float guard_x = 1.0f + 2.0f * GUARD_BAND / std::max(viewport[2], 1);
+		float guard_y = 1.0f + 2.0f * GUARD_BAND / std::max(viewport[3], 1);
+		auto distance = [guard_x, guard_y](const glm::vec4& p, uint32_t plane) {
+			switch (plane) {
+			case 0: return p.w + p.z;
+			case 1: return p.w - p.z;
+			case 2: return guard_x * p.w + p.x;
+			case 3: return guard_x * p.w - p.x;
+			case 4: return guard_y * p.w + p.y;
+			default: return guard_y * p.w - p.y;
+			}
+		};
+
+		bool inside = true;
+		for (uint32_t plane = 0; plane < 6; plane++) {
+			uint32_t outside = 0;
+			for (uint32_t v = 0; v < 3; v++)
+				outside += distance(vertices[v].position, plane) < 0.0f;
+			if (outside == 3)
+				return;
+			inside &= (outside == 0);
+		}
+
+		if (inside)
+			return SetupTriangle(state, vertices[0], vertices[1], vertices[2], color, slot, shape);
+
+		ClipVertex polygon[MAX_CLIP_VERTICES], clipped[MAX_CLIP_VERTICES];
+		uint32_t count = 3;
+		std::copy(vertices, vertices + 3, polygon);
+
+		for (uint32_t plane = 0; plane < 6 && count >= 3; plane++) {
+			uint32_t clipped_count = 0;
+			for (uint32_t i = 0; i < count; i++) {
+				const ClipVertex& a = polygon[i];
+				const ClipVertex& b = polygon[(i + 1) % count];
+				float da = distance(a.position, plane);
+				float db = distance(b.position, plane);
+
+				if (da >= 0.0f && clipped_count < MAX_CLIP_VERTICES)
+					clipped[clipped_count++] = a;
+				if ((da >= 0.0f) != (db >= 0.0f) && clipped_count < MAX_CLIP_VERTICES) {
+					float t = da / (da - db);
+					clipped[clipped_count++] = { glm::mix(a.position, b.position, t), glm::mix(a.tex_coord, b.tex_coord, t) };
+				}
+			}
+
+			count = clipped_count;
+			std::copy(clipped, clipped + count, polygon);
+		}
+
+		for (uint32_t i = 1; i + 1 < count; i++) {
+			raster_stats.clipped_triangles++;
+			SetupTriangle(state, polygon[0], polygon[i], polygon[i + 1], color, slot, shape);
+		}
+	}
+
+	void SoftwareRendererAPI::SetupTriangle(const DrawState& state, const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2, const glm::vec4& color, int32_t texture, const glm::vec4& shape) {
+		const ClipVertex* vertices[3] = { &v0, &v1, &v2 };
+		int32_t sx[3], sy[3];
+		float depth[3];
+		double inv_w[3];
+
+		for (uint32_t i = 0; i < 3; i++) {
+			const glm::vec4& p = vertices[i]->position;
+			if (p.w <= 0.0f)
+				return;
+
+			inv_w[i] = 1.0 / p.w;
+			float x = viewport[0] + (p.x / p.w + 1.0f) * 0.5f * viewport[2];
+			float y = viewport[1] + (p.y / p.w + 1.0f) * 0.5f * viewport[3];
+			sx[i] = (int32_t)std::lround(x * SUBPIXEL_SCALE);
+			sy[i] = (int32_t)std::lround(y * SUBPIXEL_SCALE);
+			depth[i] = p.z / p.w * 0.5f + 0.5f;
+		}
+
+		int64_t area = (int64_t)(sx[1] - sx[0]) * (sy[2] - sy[0]) - (int64_t)(sx[2] - sx[0]) * (sy[1] - sy[0]);
+		if (area == 0)
+			return;
+
+		/* Faces are not culled, clockwise triangles are turned around. */
+		uint32_t order[3] = { 0, 1, 2 };
+		if (area < 0) {
+			std::swap(order[1], order[2]);
+			area = -area;
+		}
+
+		Triangle triangle;
+		int32_t min_x = INT32_MAX, min_y = INT32_MAX, max_x = INT32_MIN, max_y = INT32_MIN;
+		for (uint32_t i = 0; i < 3; i++) {
+			uint32_t j = order[(i + 1) % 3], k = order[(i + 2) % 3];
+			int32_t dx = sx[k] - sx[j];
+			int32_t dy = sy[k] - sy[j];
+
+			triangle.a[i] = -dy;
+			triangle.b[i] = dx;
+			triangle.c[i] = -((int64_t)triangle.a[i] * sx[j] + (int64_t)triangle.b[i] * sy[j]);
+
+			/* Left and top edges own the pixels centered on them. */
+			if (!(dy < 0 || (dy == 0 && dx < 0)))
+				triangle.c[i] -= 1;
+
+			min_x = std::min(min_x, sx[i]);
+			min_y = std::min(min_y, sy[i]);
+			max_x = std::max(max_x, sx[i]);
+			max_y = std::max(max_y, sy[i]);
+		}
+
+		/* Pixels whose centers fall in the bounds, within the viewport and the buffer. */
+		auto first_pixel = [](int32_t sub) { return (int32_t)std::ceil((sub - SUBPIXEL_HALF) / (float)SUBPIXEL_SCALE); };
+		auto last_pixel = [](int32_t sub) { return (int32_t)std::floor((sub - SUBPIXEL_HALF) / (float)SUBPIXEL_SCALE); };
+		triangle.min_x = std::max({ first_pixel(min_x), viewport[0], 0 });
+		triangle.min_y = std::max({ first_pixel(min_y), viewport[1], 0 });
+		triangle.max_x = std::min({ last_pixel(max_x), viewport[0] + viewport[2] - 1, (int32_t)width - 1 });
+		triangle.max_y = std::min({ last_pixel(max_y), viewport[1] + viewport[3] - 1, (int32_t)height - 1 });
+		if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y)
+			return;
+
+		double x[3], y[3];
+		for (uint32_t i = 0; i < 3; i++) {
+			x[i] = (double)sx[order[i]] / SUBPIXEL_SCALE;
+			y[i] = (double)sy[order[i]] / SUBPIXEL_SCALE;
+		}
+		double inv_area = (double)(SUBPIXEL_SCALE * SUBPIXEL_SCALE) / (double)area;
+		triangle.origin_x = (float)x[0];
+		triangle.origin_y = (float)y[0];
+
+		const glm::vec2& t0 = vertices[order[0]]->tex_coord;
+		const glm::vec2& t1 = vertices[order[1]]->tex_coord;
+		const glm::vec2& t2 = vertices[order[2]]->tex_coord;
+		double w0 = inv_w[order[0]], w1 = inv_w[order[1]], w2 = inv_w[order[2]];
+		triangle.depth = MakePlane(x, y, inv_area, depth[order[0]], depth[order[1]], depth[order[2]]);
+		triangle.inv_w = MakePlane(x, y, inv_area, w0, w1, w2);
+		triangle.u_w = MakePlane(x, y, inv_area, t0.x * w0, t1.x * w1, t2.x * w2);
+		triangle.v_w = MakePlane(x, y, inv_area, t0.y * w0, t1.y * w1, t2.y * w2);
+
+		triangle.color = color;
+		triangle.texture = (state.coverage && texture < 0) ? 0 : texture;
+		triangle.linear = false;
+		triangle.shape = shape;
+
+		/* Like the texel footprint below, taken at the center, exact for the Renderer's flat quads. */
+		float cx = (float)((x[1] + x[2]) / 3.0 - x[0] / 1.5);
+		float cy = (float)((y[1] + y[2]) / 3.0 - y[0] / 1.5);
+		if (shape.x > 0.0f) {
+			float w = Evaluate(triangle.inv_w, cx, cy);
+			float u = Evaluate(triangle.u_w, cx, cy) / w;
+			float v = Evaluate(triangle.v_w, cx, cy) / w;
+			triangle.shape_dx = { (triangle.u_w.y - u * triangle.inv_w.y) / w, (triangle.v_w.y - v * triangle.inv_w.y) / w };
+			triangle.shape_dy = { (triangle.u_w.z - u * triangle.inv_w.z) / w, (triangle.v_w.z - v * triangle.inv_w.z) / w };
+		}
+
+		/*
+		* Minification (linear) or magnification (nearest) is picked once per triangle from the texel footprint at its
+		* center, exact for the Renderer's flat quads. Font atlases are always linear.
+		*/
+		const TextureStorage* sampled = (triangle.texture >= 0 && triangle.texture < (int32_t)SOFTWARE_TEXTURE_UNITS) ? state.units[triangle.texture] : nullptr;
+		if (sampled && sampled->format == TextureFormat::R8) {
+			triangle.linear = true;
+		}
+		else if (sampled) {
+			float w = Evaluate(triangle.inv_w, cx, cy);
+			float u = Evaluate(triangle.u_w, cx, cy) / w;
+			float v = Evaluate(triangle.v_w, cx, cy) / w;
+
+			float du_dx = (triangle.u_w.y - u * triangle.inv_w.y) / w * sampled->width;
+			float dv_dx = (triangle.v_w.y - v * triangle.inv_w.y) / w * sampled->height;
+			float du_dy = (triangle.u_w.z - u * triangle.inv_w.z) / w * sampled->width;
+			float dv_dy = (triangle.v_w.z - v * triangle.inv_w.z) / w * sampled->height;
+			float rho = std::max(du_dx * du_dx + dv_dx * dv_dx, du_dy * du_dy + dv_dy * dv_dy);
+			triangle.linear = rho > 1.0f;
+		}
+
+		raster_stats.triangles++;
+		triangles.push_back(triangle);
+	}
+
+	void SoftwareRendererAPI::RasterizeTriangles(const DrawState& state) {
+		if (triangles.empty())
+			return;
+
+		for (uint32_t t = 0; t < (uint32_t)triangles.size(); t++) {
+			const Triangle& triangle = triangles[t];
+			uint32_t first_x = triangle.min_x / SOFTWARE_TILE_SIZE, last_x = triangle.max_x / SOFTWARE_TILE_SIZE;
+			uint32_t first_y = triangle.min_y / SOFTWARE_TILE_SIZE, last_y = triangle.max_y / SOFTWARE_TILE_SIZE;
+
+			for (uint32_t ty = first_y; ty <= last_y; ty++) {
+				for (uint32_t tx = first_x; tx <= last_x; tx++) {
+					std::vector<uint32_t>& bin = bins[ty * tiles_x + tx];
+					if (bin.empty())
+						active_tiles.push_back(ty * tiles_x + tx);
+					bin.push_back(t);
+				}
+			}
+		}
+
+		tile_fragments.assign(active_tiles.size(), 0);
+		JobCounter counter;
+		JobSystem::ParallelFor((uint32_t)active_tiles.size(), 1, [this, &state](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++)
+				tile_fragments[i] = RasterizeTile(state, active_tiles[i]);
+		}, &counter);
+		JobSystem::Wait(counter);
+
+		raster_stats.tiles += (uint32_t)active_tiles.size();
+		for (size_t i = 0; i < active_tiles.size(); i++) {
+			raster_stats.fragments += tile_fragments[i];
+			bins[active_tiles[i]].clear();
+		}
+		active_tiles.clear();
+		triangles.clear();
+	}
+
+	uint64_t SoftwareRendererAPI::RasterizeTile(const DrawState& state, uint32_t tile) {
+		int32_t tile_x = (int32_t)((tile % tiles_x) * SOFTWARE_TILE_SIZE);
+		int32_t tile_y = (int32_t)((tile / tiles_x) * SOFTWARE_TILE_SIZE);
+		uint64_t fragments = 0;
+
+		for (uint32_t t : bins[tile]) {
+			const Triangle& triangle = triangles[t];
+			int32_t x0 = std::max(triangle.min_x, tile_x);
+			int32_t y0 = std::max(triangle.min_y, tile_y);
+			int32_t x1 = std::min(triangle.max_x, tile_x + (int32_t)SOFTWARE_TILE_SIZE - 1);
+			int32_t y1 = std::min(triangle.max_y, tile_y + (int32_t)SOFTWARE_TILE_SIZE - 1);
+
+			/*
+			* Edges that pass the whole rectangle are skipped. An edge that crosses it has values within 32 bits
+			* there, so the rest step in 32 bit lanes.
+			*/
+			int32_t edge_row[3] = {}, step_x[3] = {}, step_y[3] = {};
+			uint32_t partial = 0;
+			bool rejected = false;
+			for (uint32_t i = 0; i < 3 && !rejected; i++) {
+				int64_t dx = (int64_t)triangle.a[i] * SUBPIXEL_SCALE;
+				int64_t dy = (int64_t)triangle.b[i] * SUBPIXEL_SCALE;
+				int64_t corner = triangle.a[i] * ((int64_t)x0 * SUBPIXEL_SCALE + SUBPIXEL_HALF) +
+					triangle.b[i] * ((int64_t)y0 * SUBPIXEL_SCALE + SUBPIXEL_HALF) + triangle.c[i];
+				int64_t span_x = dx * (x1 - x0), span_y = dy * (y1 - y0);
+				int64_t low = corner + std::min<int64_t>(span_x, 0) + std::min<int64_t>(span_y, 0);
+				int64_t high = corner + std::max<int64_t>(span_x, 0) + std::max<int64_t>(span_y, 0);
+
+				if (high < 0)
+					rejected = true;
+				else if (low < 0) {
+					edge_row[partial] = (int32_t)corner;
+					step_x[partial] = (int32_t)dx;
+					step_y[partial] = (int32_t)dy;
+					partial++;
+				}
+			}
+			if (rejected)
+				continue;
+
+			for (int32_t y = y0; y <= y1; y++) {
+				int32_t x = x0;
+#ifdef EMBER_SIMD_SSE2
+				__m128i edges[3], steps[3];
+				for (uint32_t i = 0; i < 3; i++) {
+					edges[i] = _mm_add_epi32(_mm_set1_epi32(i < partial ? edge_row[i] : 0),
+						_mm_set_epi32(3 * step_x[i], 2 * step_x[i], step_x[i], 0));
+					steps[i] = _mm_set1_epi32(4 * step_x[i]);
+				}
+
+				for (; x <= x1; x += 4) {
+					__m128i outside = _mm_or_si128(_mm_or_si128(edges[0], edges[1]), edges[2]);
+					uint32_t mask = ~(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF;
+					if (x1 - x < 3)
+						mask &= (1u << (x1 - x + 1)) - 1;
+
+					for (; mask; mask &= mask - 1) {
+						uint32_t lane = 0;
+						while (!(mask & (1u << lane)))
+							lane++;
+						ShadeFragment(state, triangle, x + lane, y, fragments);
+					}
+
+					for (uint32_t i = 0; i < 3; i++)
+						edges[i] = _mm_add_epi32(edges[i], steps[i]);
+				}
+#else
+				int32_t edges[3] = { edge_row[0], edge_row[1], edge_row[2] };
+				for (; x <= x1; x++) {
+					if ((edges[0] | edges[1] | edges[2]) >= 0)
+						ShadeFragment(state, triangle, x, y, fragments);
+					for (uint32_t i = 0; i < 3; i++)
+						edges[i] += step_x[i];
+				}
+#endif
+				for (uint32_t i = 0; i < 3; i++)
+					edge_row[i] += step_y[i];
+			}
+		}
+
+		return fragments;
+	}
+
+	void SoftwareRendererAPI::ShadeFragment(const DrawState& state, const Triangle& triangle, int32_t x, int32_t y, uint64_t& fragments) {
+		float fx = x + 0.5f - triangle.origin_x;
+		float fy = y + 0.5f - triangle.origin_y;
+		size_t pixel = (size_t)y * width + x;
+
+		float depth = Evaluate(triangle.depth, fx, fy);
+		if (!(depth < depth_buffer[pixel]))
+			return;
+
+		glm::vec4 color = triangle.color;
+		if (triangle.shape.x > 0.0f) {
+			float w = Evaluate(triangle.inv_w, fx, fy);
+			glm::vec2 p = glm::vec2(Evaluate(triangle.u_w, fx, fy), Evaluate(triangle.v_w, fx, fy)) / w;
+			float d = ShapeDistance(triangle.shape, p);
+			float width = glm::length(glm::vec2(ShapeDistance(triangle.shape, p + triangle.shape_dx), ShapeDistance(triangle.shape, p + triangle.shape_dy)) - d);
+			float coverage = std::clamp(0.5f - d / std::max(width, 1e-6f), 0.0f, 1.0f);
+			if (coverage <= 0.0f)
+				return;
+			color.a *= coverage;
+		}
+		else if (triangle.texture >= 0) {
+			glm::vec4 sampled(0.0f, 0.0f, 0.0f, 1.0f);
+			const TextureStorage* texture = (triangle.texture < (int32_t)SOFTWARE_TEXTURE_UNITS) ? state.units[triangle.texture] : nullptr;
+			if (texture && texture->width && texture->height) {
+				float w = Evaluate(triangle.inv_w, fx, fy);
+				float u = Evaluate(triangle.u_w, fx, fy) / w;
+				float v = Evaluate(triangle.v_w, fx, fy) / w;
+				sampled = Sample(texture->texels.data(), texture->width, texture->height, texture->format == TextureFormat::R8, triangle.linear, u, v);
+			}
+
+			if (state.coverage)
+				color *= glm::vec4(1.0f, 1.0f, 1.0f, sampled.r);
+			else if (color == glm::vec4(-1.0f))
+				color = sampled;
+			else
+				color *= sampled;
+		}
+
+		color = glm::clamp(color, glm::vec4(0.0f), glm::vec4(1.0f));
+		depth_buffer[pixel] = depth;
+
+		fragments++;
+
+		/* Fully transparent and opaque fragments, like the edges and insides of sprites, skip the blend. */
+		uint8_t* out = &color_buffer[pixel * 4];
+		float alpha = color.a;
+		if (alpha <= 0.0f)
+			return;
+		if (alpha >= 1.0f) {
+			for (uint32_t i = 0; i < 4; i++)
+				out[i] = ToUnorm8(color[i]);
+			return;
+		}
+
+		for (uint32_t i = 0; i < 4; i++)
+			out[i] = ToUnorm8(color[i] * alpha + out[i] * (1.0f / 255.0f) * (1.0f - alpha));
+	}
+}
@@ -0,0 +1,123 @@
+#include "SpatialGrid.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+namespace Ember {
+	void SpatialGrid::Init(float size, uint32_t buckets) {
+		if (size <= 0.0f) {
+			EMBER_LOG_ERROR("SpatialGrid cell size must be positive, got %f.", size);
+			size = 1.0f;
+		}
+
+		/* Bucket count is rounded up to a power of two so the hash can be masked. */
+		uint32_t count = 1;
+		while (count < buckets)
+			count <<= 1;
+
+		cell_size = size;
+		inverse_cell_size = 1.0f / size;
+		bucket_count = count;
+		bucket_starts.assign(bucket_count + 1, 0);
+		Clear();
+	}
+
+	void SpatialGrid::Clear() {
+		pending.clear();
+		entries.clear();
+		std::fill(bucket_starts.begin(), bucket_starts.end(), 0);
+	}
+
+	void SpatialGrid::Insert(uint32_t id, const glm::vec4& bounds) {
+		int32_t min_x = CellCoordinate(bounds.x);
+		int32_t min_y = CellCoordinate(bounds.y);
+		int32_t max_x = CellCoordinate(bounds.z);
+		int32_t max_y = CellCoordinate(bounds.w);
+
+		for (int32_t y = min_y; y <= max_y; y++)
+			for (int32_t x = min_x; x <= max_x; x++)
+				pending.push_back({ bounds, x, y, id });
+	}
+
+	void SpatialGrid::Build() {
+		std::fill(bucket_starts.begin(), bucket_starts.end(), 0);
+		for (const Entry& entry : pending)
+			bucket_starts[Bucket(entry.cell_x, entry.cell_y) + 1]++;
+		for (uint32_t i = 0; i < bucket_count; i++)
+			bucket_starts[i + 1] += bucket_starts[i];
+
+		entries.resize(pending.size());
+		bucket_cursors.assign(bucket_starts.begin(), bucket_starts.end() - 1);
+		for (const Entry& entry : pending)
+			entries[bucket_cursors[Bucket(entry.cell_x, entry.cell_y)]++] = entry;
+		pending.clear();
+	}
+
+	void SpatialGrid::QueryBounds(const glm::vec4& bounds, std::vector<uint32_t>& results) const {
+		if (entries.empty())
+			return;
+
+		int32_t min_x = CellCoordinate(bounds.x);
+		int32_t min_y = CellCoordinate(bounds.y);
+		int32_t max_x = CellCoordinate(bounds.z);
+		int32_t max_y = CellCoordinate(bounds.w);
+
+		for (int32_t y = min_y; y <= max_y; y++) {
+			for (int32_t x = min_x; x <= max_x; x++) {
+				uint32_t bucket = Bucket(x, y);
+				for (uint32_t i = bucket_starts[bucket]; i < bucket_starts[bucket + 1]; i++) {
+					const Entry& entry = entries[i];
+					if (entry.cell_x != x || entry.cell_y != y || !Overlaps(entry.bounds, bounds))
+						continue;
+
+					if (CellCoordinate(glm::max(entry.bounds.x, bounds.x)) != x || CellCoordinate(glm::max(entry.bounds.y, bounds.y)) != y)
+						continue;
+
+					results.push_back(entry.id);
+				}
+			}
+		}
+	}
+
+	void SpatialGrid::QuerySegment(const glm::vec2& start, const glm::vec2& end, float radius, std::vector<uint32_t>& results) const {
+		size_t first = results.size();
+		std::vector<uint32_t> step_ids;
+		WalkSegment(start, end, radius, step_ids, [&results](const std::vector<uint32_t>& ids, float) {
+			results.insert(results.end(), ids.begin(), ids.end());
+			return true;
+		});
+
+		/* Objects spanning several cells show up once per cell. */
+		std::sort(results.begin() + first, results.end());
+		results.erase(std::unique(results.begin() + first, results.end()), results.end());
+	}
+
+	void SpatialGrid::QueryCell(int32_t cell_x, int32_t cell_y, const glm::vec2& start, const glm::vec2& inverse_direction, float radius, std::vector<uint32_t>& results) const {
+		uint32_t bucket = Bucket(cell_x, cell_y);
+		for (uint32_t i = bucket_starts[bucket]; i < bucket_starts[bucket + 1]; i++) {
+			const Entry& entry = entries[i];
+			if (entry.cell_x != cell_x || entry.cell_y != cell_y)
+				continue;
+
+			/* Slab test of the segment against the grown bounds. */
+			float t_min = 0.0f, t_max = 1.0f;
+			for (int axis = 0; axis < 2; axis++) {
+				float low = entry.bounds[axis] - radius;
+				float high = entry.bounds[axis + 2] + radius;
+				if (inverse_direction[axis] == FLT_MAX) {
+					if (start[axis] < low || start[axis] > high)
+						t_min = 2.0f;
+					continue;
+				}
+
+				float t0 = (low - start[axis]) * inverse_direction[axis];
+				float t1 = (high - start[axis]) * inverse_direction[axis];
+				t_min = glm::max(t_min, glm::min(t0, t1));
+				t_max = glm::min(t_max, glm::max(t0, t1));
+			}
+
+			if (t_min <= t_max)
+				results.push_back(entry.id);
+		}
+	}
+}
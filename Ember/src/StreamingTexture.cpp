@@ -0,0 +1,190 @@
+#include "StreamingTexture.h"
+#include "GPUResources.h"
+#include "MemoryTracker.h"
+#include "RenderThread.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace Ember {
+	struct StreamingTextureSlice {
+		uint32_t buffer = 0;
+		uint8_t* mapped = nullptr;
+		uint64_t fence = 0;
+	};
+
+	/* Everything the uploads touch, only used on the thread that owns the context. */
+	struct StreamingTextureRing {
+		uint32_t texture = 0;
+		uint32_t width = 0, height = 0;
+		TextureFormat format = TextureFormat::RGBA8;
+
+		StreamingTextureSlice slices[STREAMING_TEXTURE_SLICES];
+		uint32_t next = 0;
+		bool mapped = false;
+		std::atomic<uint32_t> stalls{ 0 };
+	};
+
+	static uint32_t GetSliceSize(const StreamingTextureRing* ring) {
+		return ring->width * ring->height * GetBytesPerPixel(ring->format);
+	}
+
+	/* Slices have immutable storage, so their buffers are deleted instead of pooled. */
+	static StreamingTextureRing* CreateRing(uint32_t texture, uint32_t width, uint32_t height, TextureFormat format) {
+		RendererAPI* api = RendererAPI::Get();
+		StreamingTextureRing* ring = new StreamingTextureRing();
+		ring->texture = texture;
+		ring->width = width;
+		ring->height = height;
+		ring->format = format;
+
+		ring->mapped = true;
+		for (StreamingTextureSlice& slice : ring->slices) {
+			slice.buffer = api->CreateBuffer();
+			api->BindBuffer(BufferTarget::PixelUnpack, slice.buffer);
+			slice.mapped = (uint8_t*)api->MapBufferStorage(BufferTarget::PixelUnpack, GetSliceSize(ring));
+			ring->mapped = ring->mapped && slice.mapped;
+		}
+		api->BindBuffer(BufferTarget::PixelUnpack, 0);
+
+		if (!ring->mapped) {
+			for (StreamingTextureSlice& slice : ring->slices) {
+				GPUResources::Release(GPUResourceType::Buffer, slice.buffer);
+				slice = StreamingTextureSlice();
+			}
+			return ring;
+		}
+
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Texture, GetSliceSize(ring) * STREAMING_TEXTURE_SLICES);
+		return ring;
+	}
+
+	static void DestroyRing(StreamingTextureRing* ring) {
+		RendererAPI* api = RendererAPI::Get();
+		for (StreamingTextureSlice& slice : ring->slices) {
+			if (slice.fence)
+				api->DeleteFence(slice.fence);
+			GPUResources::Release(GPUResourceType::Buffer, slice.buffer);
+		}
+
+		if (ring->mapped)
+			EMBER_TRACK_GPU_FREE(MemoryTag::Texture, GetSliceSize(ring) * STREAMING_TEXTURE_SLICES);
+		delete ring;
+	}
+
+	/*
+	* Rows row_length pixels apart go into the next slice at the place they have in the texture, so the slice is
+	* uploaded with the texture's own row length.
+	*/
+	static void Upload(StreamingTextureRing* ring, int32_t x, int32_t y, uint32_t w, uint32_t h, const uint8_t* source, uint32_t row_length) {
+		RendererAPI* api = RendererAPI::Get();
+		if (!ring->mapped)
+			return api->SetTextureSubData(ring->texture, x, y, w, h, ring->format, row_length, source);
+
+		StreamingTextureSlice& slice = ring->slices[ring->next];
+		ring->next = (ring->next + 1) % STREAMING_TEXTURE_SLICES;
+		if (slice.fence) {
+			if (!api->IsFenceSignaled(slice.fence)) {
+				ring->stalls++;
+				api->WaitFence(slice.fence);
+			}
+			api->DeleteFence(slice.fence);
+			slice.fence = 0;
+		}
+
+		uint32_t bpp = GetBytesPerPixel(ring->format);
+		size_t offset = ((size_t)y * ring->width + x) * bpp;
+		for (uint32_t row = 0; row < h; row++)
+			memcpy(slice.mapped + offset + (size_t)row * ring->width * bpp, source + (size_t)row * row_length * bpp, (size_t)w * bpp);
+
+		api->BindBuffer(BufferTarget::PixelUnpack, slice.buffer);
+		api->SetTextureSubData(ring->texture, x, y, w, h, ring->format, ring->width, (const void*)(uintptr_t)offset);
+		api->BindBuffer(BufferTarget::PixelUnpack, 0);
+		slice.fence = api->InsertFence();
+	}
+
+	StreamingTexture::StreamingTexture(uint32_t width, uint32_t height, TextureFormat format) {
+		Init(width, height, format);
+	}
+
+	StreamingTexture::~StreamingTexture() {
+		if (!ring)
+			return;
+
+		StreamingTextureRing* ring = this->ring;
+		if (RenderThread::IsRecording())
+			RenderThread::Submit([=]() { DestroyRing(ring); });
+		else
+			DestroyRing(ring);
+	}
+
+	void StreamingTexture::Init(uint32_t width, uint32_t height, TextureFormat format) {
+		Texture::Init(width, height, format);
+		pixels.assign((size_t)width * height * GetBytesPerPixel(format), 0);
+		ring = CreateRing(GetTextureId(), width, height, format);
+	}
+
+	void StreamingTexture::Update(int32_t x, int32_t y, uint32_t w, uint32_t h, const void* data) {
+		int32_t min_x = std::max(x, 0), min_y = std::max(y, 0);
+		int32_t max_x = (int32_t)std::min<int64_t>((int64_t)x + w, GetWidth());
+		int32_t max_y = (int32_t)std::min<int64_t>((int64_t)y + h, GetHeight());
+		if (max_x <= min_x || max_y <= min_y)
+			return;
+
+		uint32_t bpp = GetBytesPerPixel(GetFormat());
+		const uint8_t* source = (const uint8_t*)data;
+		size_t row_size = (size_t)(max_x - min_x) * bpp;
+		for (int32_t row = min_y; row < max_y; row++) {
+			const uint8_t* in = source + ((size_t)(row - y) * w + (min_x - x)) * bpp;
+			memcpy(&pixels[((size_t)row * GetWidth() + min_x) * bpp], in, row_size);
+		}
+
+		if (!IsDirty()) {
+			dirty_min_x = min_x;
+			dirty_min_y = min_y;
+			dirty_max_x = max_x;
+			dirty_max_y = max_y;
+			return;
+		}
+
+		dirty_min_x = std::min(dirty_min_x, min_x);
+		dirty_min_y = std::min(dirty_min_y, min_y);
+		dirty_max_x = std::max(dirty_max_x, max_x);
+		dirty_max_y = std::max(dirty_max_y, max_y);
+	}
+
+	void StreamingTexture::Update(const void* data) {
+		Update(0, 0, GetWidth(), GetHeight(), data);
+	}
+
+	void StreamingTexture::Flush() {
+		if (!IsDirty() || !ring)
+			return;
+
+		int32_t x = dirty_min_x, y = dirty_min_y;
+		uint32_t w = dirty_max_x - dirty_min_x, h = dirty_max_y - dirty_min_y;
+		uint32_t bpp = GetBytesPerPixel(GetFormat());
+		const uint8_t* source = &pixels[((size_t)y * GetWidth() + x) * bpp];
+		dirty_min_x = dirty_min_y = dirty_max_x = dirty_max_y = 0;
+		uploads++;
+		bytes += (uint64_t)w * h * bpp;
+
+		if (!RenderThread::IsRecording())
+			return Upload(ring, x, y, w, h, source, GetWidth());
+
+		/* The next Update may change the copy before the render thread runs, the dirty rows go into the queue. */
+		const uint8_t* rows = RenderThread::CopyArray(source, ((size_t)(h - 1) * GetWidth() + w) * bpp);
+		uint32_t row_length = GetWidth();
+		StreamingTextureRing* ring = this->ring;
+		RenderThread::Submit([=]() { Upload(ring, x, y, w, h, rows, row_length); });
+	}
+
+	StreamingTextureStats StreamingTexture::GetStats() const {
+		StreamingTextureStats stats;
+		stats.uploads = uploads;
+		stats.bytes = bytes;
+		stats.stalls = ring ? ring->stalls.load() : 0;
+		return stats;
+	}
+}
@@ -1,96 +1,97 @@
 #include "Texture.h"
 #include "TextureLoader.h"
 #include "Logger.h"
+#include "MemoryTracker.h"
+#include "GPUResources.h"
 
 #include <iostream>
-#include <glad/glad.h>
 
 #define RED 0
 #define GREEN 1
 #define BLUE 2
 
 namespace Ember {
+	/* A pooled texture keeps the contents of its last owner until it is given new data. */
+	static GPUHandle Create(uint32_t width, uint32_t height, TextureFormat format) {
+		bool pooled;
+		return GPUResources::CreateTexture(width, height, format, pooled);
+	}
+
 	Texture::Texture(const char* file_path, bool flip) {
 		Init(file_path, flip);
 	}
 
-	Texture::Texture(uint32_t width, uint32_t height) {
-		Init(width, height);
+	Texture::Texture(uint32_t width, uint32_t height, TextureFormat format) {
+		Init(width, height, format);
 	}
 
 	void Texture::Init(const char* file_path, bool flip) {
 		path = file_path;
 		SDL_Surface* s = Ember::TextureLoader::Load(file_path);
+		if (!s)
+			return;
 		if (flip)
 			Ember::TextureLoader::FlipVertically(s);
-		width = s->w;
-		height = s->h;
-		if (s->format->BytesPerPixel == 4) {
-			internal_format = GL_RGBA8;
-			data_format = GL_RGBA;
-		}
-		else if (s->format->BytesPerPixel == 3) {
-			internal_format = GL_RGB8;
-			data_format = GL_RGB;
-		}
+		if (s->format->BytesPerPixel == 4)
+			format = TextureFormat::RGBA8;
+		else if (s->format->BytesPerPixel == 3)
+			format = TextureFormat::RGB8;
 
+		/* Without pixels the texture stays invalid and 0 by 0, it holds no GPU memory. */
 		if (s->pixels) {
-			glCreateTextures(GL_TEXTURE_2D, 1, &texture_id);
-			glTextureStorage2D(texture_id, 1, internal_format, width, height);
-
-			glTextureParameteri(texture_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTextureParameteri(texture_id, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-			glTextureParameteri(texture_id, GL_TEXTURE_WRAP_S, GL_REPEAT);
-			glTextureParameteri(texture_id, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-			glTextureSubImage2D(texture_id, 0, 0, 0, width, height, data_format, GL_UNSIGNED_BYTE, s->pixels);
+			width = s->w;
+			height = s->h;
+			texture = Create(width, height, format);
+			RendererAPI::Get()->SetTextureData(texture.id, width, height, format, s->pixels);
+			EMBER_TRACK_GPU_ALLOC(MemoryTag::Texture, GetSizeInBytes());
 		}
 
 		Ember::TextureLoader::Free(s);
 	}
 
-	void Texture::Init(uint32_t width, uint32_t height) {
-		internal_format = GL_RGBA8;
-		data_format = GL_RGBA;
-
-		glCreateTextures(GL_TEXTURE_2D, 1, &texture_id);
-		glTextureStorage2D(texture_id, 1, internal_format, width, height);
-
-		glTextureParameteri(texture_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTextureParameteri(texture_id, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	void Texture::Init(uint32_t width, uint32_t height, TextureFormat format) {
+		this->width = width;
+		this->height = height;
+		this->format = format;
 
-		glTextureParameteri(texture_id, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTextureParameteri(texture_id, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		texture = Create(width, height, format);
+		EMBER_TRACK_GPU_ALLOC(MemoryTag::Texture, GetSizeInBytes());
 	}
 
 	Texture::~Texture() {
-		glDeleteTextures(1, &texture_id);
+		if (texture.IsValid())
+			EMBER_TRACK_GPU_FREE(MemoryTag::Texture, GetSizeInBytes());
+		GPUResources::ReleaseTexture(texture, width, height, format);
+	}
+
+	uint32_t Texture::GetSizeInBytes() const {
+		return width * height * GetBytesPerPixel(format);
 	}
 
 	void Texture::SetData(void* data) {
-		uint32_t bpp = data_format == GL_RGBA ? 4 : 3;
-		glTextureSubImage2D(texture_id, 0, 0, 0, width, height, data_format, GL_UNSIGNED_BYTE, data);
+		EMBER_CHECK_GPU_USE(GPUResourceType::Texture, texture);
+		RendererAPI::Get()->SetTextureData(texture.id, width, height, format, data);
 	}
 
 	void Texture::Bind(uint32_t slot) {
-		glBindTextureUnit(slot, texture_id);
+		EMBER_CHECK_GPU_USE(GPUResourceType::Texture, texture);
+		RendererAPI::Get()->BindTextureUnit(slot, texture.id);
 	}
 
 	void Texture::UnBind() {
-		glBindTexture(GL_TEXTURE_2D, 0);
+		RendererAPI::Get()->BindTexture(0);
 	}
 
 	void BindTexture(uint32_t id) {
-		glBindTexture(GL_TEXTURE_2D, id);
+		RendererAPI::Get()->BindTexture(id);
 	}
 
-	void SetPixels(const glm::ivec2& position, void* pixels, const glm::ivec2& size) {
-		glTexSubImage2D(GL_TEXTURE_2D, 0, position.x, position.y, size.x, size.y, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+	void SetPixels(const glm::ivec2& position, void* pixels, const glm::ivec2& size, TextureFormat format) {
+		RendererAPI::Get()->SetBoundTextureData(position.x, position.y, size.x, size.y, format, pixels);
 	}
 
 	void GetPixels(const glm::ivec2& position, void* pixels, const glm::ivec2& size) {
-		glReadPixels(position.x, position.y, size.x, size.y, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+		RendererAPI::Get()->ReadPixels(position.x, position.y, size.x, size.y, pixels);
 	}
 }
 
@@ -1,7 +1,5 @@
 #include "Timer.h"
 
-constexpr int SECOND_MIL = 1000;
-
 namespace Ember {
 	Timer::Timer() {
 		StartTimer();
@@ -12,28 +10,35 @@ namespace Ember {
 	}
 
 	void Timer::StartTimer() {
+		if (!on || last_time == 0)
+			last_time = Clock::Now();
 		on = true;
 	}
 
 	void Timer::Update() {
+		previous_seconds = seconds;
 		if (on) {
-			current_time = SDL_GetTicks();
-			if (current_time > last_time + SECOND_MIL) {
-				last_time = current_time;
-				seconds++;
-			}
+			uint64_t current_time = Clock::Now();
+			elapsed += current_time - last_time;
+			last_time = current_time;
+			seconds = (int)(elapsed / NANOSECONDS_PER_SECOND);
 		}
 	}
 
 	void Timer::StopTimer() {
+		if (on)
+			Update();
 		on = false;
 	}
 
 	void Timer::Reset() {
+		elapsed = 0;
 		seconds = 0;
+		previous_seconds = 0;
+		last_time = Clock::Now();
 	}
 
 	bool Timer::FetchAt(int timer_spot) {
-		return (seconds == timer_spot);
+		return (previous_seconds < timer_spot && seconds >= timer_spot);
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,194 @@
+#include "TimerWheel.h"
+
+namespace Ember {
+	constexpr uint32_t TIMER_WHEEL_SLOT_MASK = TIMER_WHEEL_SLOTS - 1;
+	constexpr uint64_t TIMER_WHEEL_MAX_DELAY = (1ull << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1;
+	constexpr uint32_t TIMER_WHEEL_NONE = UINT32_MAX;
+
+	TimerWheel::TimerWheel(uint64_t tick)
+		: tick_length((tick) ? tick : TIMER_WHEEL_DEFAULT_TICK) {
+		for (auto& slot : slots)
+			slot = TIMER_WHEEL_NONE;
+	}
+
+	uint64_t TimerWheel::ToTicks(uint64_t time) const {
+		uint64_t ticks = (time + tick_length - 1) / tick_length;
+		if (ticks == 0)
+			return 1;
+		return (ticks > TIMER_WHEEL_MAX_DELAY) ? TIMER_WHEEL_MAX_DELAY : ticks;
+	}
+
+	TimerHandle TimerWheel::Schedule(uint64_t delay, const Callback& callback, uint64_t period) {
+		uint32_t index = free_list;
+		if (index != TIMER_WHEEL_NONE)
+			free_list = nodes[index].next;
+		else {
+			index = (uint32_t)nodes.size();
+			nodes.emplace_back();
+		}
+
+		TimerNode& node = nodes[index];
+		node.callback = callback;
+		node.expires = current_tick + ToTicks(delay);
+		node.period = period;
+		node.active = true;
+		timer_count++;
+
+		Insert(index);
+
+		TimerHandle handle;
+		handle.index = index;
+		handle.generation = node.generation;
+		return handle;
+	}
+
+	bool TimerWheel::Cancel(TimerHandle& handle) {
+		if (!Find(handle))
+			return false;
+
+		if (handle.index == firing)
+			nodes[handle.index].active = false;
+		else {
+			Unlink(handle.index);
+			Release(handle.index);
+		}
+
+		handle = TimerHandle();
+		return true;
+	}
+
+	void TimerWheel::Clear() {
+		for (uint32_t slot = 0; slot < TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS; slot++) {
+			while (slots[slot] != TIMER_WHEEL_NONE) {
+				uint32_t index = slots[slot];
+				Unlink(index);
+				Release(index);
+			}
+		}
+
+		if (firing != TIMER_WHEEL_NONE)
+			nodes[firing].active = false;
+	}
+
+	const TimerWheel::TimerNode* TimerWheel::Find(TimerHandle handle) const {
+		if (handle.index >= nodes.size())
+			return nullptr;
+
+		const TimerNode& node = nodes[handle.index];
+		return (node.active && node.generation == handle.generation) ? &node : nullptr;
+	}
+
+	bool TimerWheel::IsPending(TimerHandle handle) const {
+		return Find(handle) != nullptr;
+	}
+
+	uint64_t TimerWheel::GetRemaining(TimerHandle handle) const {
+		const TimerNode* node = Find(handle);
+		if (!node || node->expires <= current_tick)
+			return 0;
+
+		uint64_t remaining = (node->expires - current_tick) * tick_length;
+		return (remaining > pending_time) ? remaining - pending_time : 0;
+	}
+
+	void TimerWheel::Insert(uint32_t index) {
+		TimerNode& node = nodes[index];
+		uint64_t delay = node.expires - current_tick;
+
+		uint32_t level = 0;
+		while (level + 1 < TIMER_WHEEL_LEVELS && delay >= (1ull << (TIMER_WHEEL_SLOT_BITS * (level + 1))))
+			level++;
+
+		uint32_t slot = level * TIMER_WHEEL_SLOTS + (uint32_t)((node.expires >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK);
+		node.slot = slot;
+		node.previous = TIMER_WHEEL_NONE;
+		node.next = slots[slot];
+		if (node.next != TIMER_WHEEL_NONE)
+			nodes[node.next].previous = index;
+		slots[slot] = index;
+	}
+
+	void TimerWheel::Unlink(uint32_t index) {
+		TimerNode& node = nodes[index];
+		if (node.previous != TIMER_WHEEL_NONE)
+			nodes[node.previous].next = node.next;
+		else
+			slots[node.slot] = node.next;
+
+		if (node.next != TIMER_WHEEL_NONE)
+			nodes[node.next].previous = node.previous;
+
+		node.previous = TIMER_WHEEL_NONE;
+		node.next = TIMER_WHEEL_NONE;
+		node.slot = TIMER_WHEEL_NONE;
+	}
+
+	void TimerWheel::Release(uint32_t index) {
+		TimerNode& node = nodes[index];
+		node.callback = nullptr;
+		node.active = false;
+		node.generation++;
+		node.next = free_list;
+		free_list = index;
+		timer_count--;
+	}
+
+	void TimerWheel::Cascade(uint32_t level) {
+		uint32_t slot = level * TIMER_WHEEL_SLOTS + (uint32_t)((current_tick >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK);
+		uint32_t index = slots[slot];
+		slots[slot] = TIMER_WHEEL_NONE;
+
+		while (index != TIMER_WHEEL_NONE) {
+			uint32_t next = nodes[index].next;
+			Insert(index);
+			index = next;
+		}
+	}
+
+	void TimerWheel::Tick() {
+		current_tick++;
+
+		if ((current_tick & TIMER_WHEEL_SLOT_MASK) == 0) {
+			for (uint32_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+				Cascade(level);
+				if ((current_tick >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK)
+					break;
+			}
+		}
+
+		uint32_t slot = (uint32_t)(current_tick & TIMER_WHEEL_SLOT_MASK);
+		while (slots[slot] != TIMER_WHEEL_NONE) {
+			uint32_t index = slots[slot];
+			Unlink(index);
+
+			/* The callback is moved out since scheduling from inside it can reallocate the node storage. */
+			Callback callback = std::move(nodes[index].callback);
+			firing = index;
+			callback();
+			firing = TIMER_WHEEL_NONE;
+
+			TimerNode& node = nodes[index];
+			if (node.active && node.period) {
+				node.callback = std::move(callback);
+				node.expires = current_tick + ToTicks(node.period);
+				Insert(index);
+			}
+			else
+				Release(index);
+		}
+	}
+
+	void TimerWheel::Advance(uint64_t delta) {
+		pending_time += delta;
+		uint64_t ticks = pending_time / tick_length;
+		pending_time -= ticks * tick_length;
+
+		if (timer_count == 0) {
+			current_tick += ticks;
+			return;
+		}
+
+		for (uint64_t i = 0; i < ticks; i++)
+			Tick();
+	}
+}
@@ -1,35 +1,29 @@
 #include "VertexArray.h"
-#include <glad/glad.h>
+#include "RendererAPI.h"
+#include "GPUResources.h"
 
 namespace Ember {
 	static uint32_t current_vertex_array_id = 0;
 
-	static GLenum VertexShaderTypeToOpenGL(VertexShaderType type) {
-		switch (type) {
-		case VertexShaderType::Float: return GL_FLOAT;
-		case VertexShaderType::Int: return GL_INT;
-		case VertexShaderType::None: return GL_NONE;
-		}
-		return GL_NONE;
-	}
-
 	VertexArray::VertexArray() {
-		glGenVertexArrays(1, &vertex_array_buffer_id);
+		vertex_array_buffer_id = RendererAPI::Get()->CreateVertexArray();
 	}
 
 	VertexArray::~VertexArray() {
-		glDeleteVertexArrays(1, &vertex_array_buffer_id);
+		if (current_vertex_array_id == vertex_array_buffer_id)
+			current_vertex_array_id = 0;
+		GPUResources::Release(GPUResourceType::VertexArray, vertex_array_buffer_id);
 	}
 
 	void VertexArray::Bind(){
 		if (current_vertex_array_id != vertex_array_buffer_id) {
-			glBindVertexArray(vertex_array_buffer_id);
+			RendererAPI::Get()->BindVertexArray(vertex_array_buffer_id);
 			current_vertex_array_id = vertex_array_buffer_id;
 		}
 	}
 
 	void VertexArray::UnBind(){
-		glBindVertexArray(0);
+		RendererAPI::Get()->BindVertexArray(0);
 		current_vertex_array_id = 0;
 	}
 
@@ -42,14 +36,14 @@ namespace Ember {
 		for (auto& elements : vertex_buf->GetLayout()->GetLayout()) {
 			switch (format) {
 			case VertexBufferFormat::VNCVNCVNC:
-				glVertexAttribPointer(elements.index, elements.size, VertexShaderTypeToOpenGL(elements.type), elements.normalized ? GL_TRUE : GL_FALSE,
+				RendererAPI::Get()->SetVertexAttribute(elements.index, elements.size, elements.type, elements.normalized,
 					stride * GetSizeInBytes(elements.type),
-					(void*)(elements.offset * GetSizeInBytes(elements.type)));
+					elements.offset * GetSizeInBytes(elements.type));
 				break;
 			case VertexBufferFormat::VVVCCCNNN:
-				glVertexAttribPointer(elements.index, elements.size, VertexShaderTypeToOpenGL(elements.type), elements.normalized ? GL_TRUE : GL_FALSE,
+				RendererAPI::Get()->SetVertexAttribute(elements.index, elements.size, elements.type, elements.normalized,
 					0,
-					(void*)(elements.offset * GetSizeInBytes(elements.type)));
+					elements.offset * GetSizeInBytes(elements.type));
 				break;
 			}
 
@@ -58,7 +52,7 @@ namespace Ember {
 	}
 
 	void VertexArray::EnableVertexAttrib(uint32_t index) {
-		glEnableVertexAttribArray(index);
+		RendererAPI::Get()->EnableVertexAttribute(index);
 	}
 
 	void VertexArray::SetArrayForInstancing(std::shared_ptr<VertexBuffer>& vertex_buf, uint32_t offset_sizes[], uint32_t stride_sizes[]) {
@@ -66,9 +60,9 @@ namespace Ember {
 		Bind();
 		uint32_t i = 0;
 		for (auto& elements : vertex_buf->GetLayout()->GetLayout()) {
-			glVertexAttribPointer(elements.index, elements.size, VertexShaderTypeToOpenGL(elements.type), elements.normalized ? GL_TRUE : GL_FALSE,
+			RendererAPI::Get()->SetVertexAttribute(elements.index, elements.size, elements.type, elements.normalized,
 				stride_sizes[i],
-				(void*)offset_sizes[i]);
+				offset_sizes[i]);
 			i++;
 			EnableVertexAttrib(elements.index);
 		}
@@ -0,0 +1,148 @@
+#include "Application.h"
+#include "Renderer.h"
+#include "RendererCommands.h"
+#include "RenderCapture.h"
+#include "SoftwareRendererAPI.h"
+#include "Clock.h"
+#include "GPUResources.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define SCREEN_WIDTH 1280
+#define SCREEN_HEIGHT 720
+
+/*
+* Replays a trace written by RenderCapture (F5 in Asteroids) and reports where each frame's time goes:
+* building batches on the CPU, uploading and drawing them, and the GPU finishing the frame.
+*
+* Replay <trace> [iterations] [--cpu-only] [--software] [--threads <workers>]
+*
+* --software rasterizes on the CPU with SoftwareRendererAPI, so the time is in submit rather than finish. It runs
+* headless, without a window or a GL context, with the tiles spread over --threads JobSystem workers (by default one
+* less than the hardware threads; 0 rasterizes on the main thread only).
+*/
+static bool Benchmark(Ember::RenderReplay& trace, const char* path, uint32_t iterations, bool cpu_only) {
+	if (!trace.Load(path) || trace.GetFrameCount() == 0) {
+		printf("Could not load any frames from '%s'.\n", path);
+		return false;
+	}
+
+	printf("%s: %u frames, %u commands, %u bytes\n", path, trace.GetFrameCount(), trace.GetCommandCount(), (uint32_t)trace.GetTraceBytes());
+	Ember::Renderer::SetSubmitEnabled(!cpu_only);
+
+	/* One untimed pass so the batch storage has grown to what the trace needs. */
+	for (uint32_t frame = 0; frame < trace.GetFrameCount(); frame++)
+		trace.ReplayFrame(frame);
+	Ember::RendererCommand::Finish();
+
+	uint64_t build = 0, submit = 0, finish = 0, worst = 0;
+	uint64_t batches = 0, primitives = 0;
+	for (uint32_t i = 0; i < iterations; i++) {
+		for (uint32_t frame = 0; frame < trace.GetFrameCount(); frame++) {
+			uint64_t start = Ember::Clock::Now();
+			trace.ReplayFrame(frame);
+			uint64_t replayed = Ember::Clock::Now();
+			if (!cpu_only)
+				Ember::RendererCommand::Finish();
+			uint64_t end = Ember::Clock::Now();
+
+			Ember::RendererStats stats = Ember::Renderer::GetStats();
+			build += (replayed - start) - stats.submit_time;
+			submit += stats.submit_time;
+			finish += end - replayed;
+			worst = std::max(worst, end - start);
+			batches += stats.batches;
+			primitives += stats.primitives;
+		}
+	}
+
+	double frames = (double)iterations * trace.GetFrameCount();
+	printf("%.0f frames replayed%s\n", frames, cpu_only ? " (CPU only)" : "");
+	printf("  primitives/frame %10.1f\n", primitives / frames);
+	printf("  batches/frame    %10.2f\n", batches / frames);
+	printf("  build            %10.3f ms\n", Ember::Clock::ToMilliseconds(build) / frames);
+	printf("  submit           %10.3f ms\n", Ember::Clock::ToMilliseconds(submit) / frames);
+	printf("  finish           %10.3f ms\n", Ember::Clock::ToMilliseconds(finish) / frames);
+	printf("  worst frame      %10.3f ms\n", Ember::Clock::ToMilliseconds(worst));
+	return true;
+}
+
+class Replay : public Ember::Application {
+public:
+	void OnCreate() {
+		Ember::RendererCommand::Init();
+		Ember::Renderer::Init();
+		Ember::RendererCommand::SetViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+	}
+
+	virtual ~Replay() {
+		trace.Destroy();
+		Ember::Renderer::Destroy();
+	}
+
+	bool Benchmark(const char* path, uint32_t iterations, bool cpu_only) {
+		return ::Benchmark(trace, path, iterations, cpu_only);
+	}
+private:
+	Ember::RenderReplay trace;
+};
+
+/* Sets up only what the renderer needs, which Application::Initialize would otherwise do along with the window. */
+static bool BenchmarkSoftware(const char* path, uint32_t iterations, bool cpu_only, uint32_t threads) {
+	Ember::LogImpl::Init();
+	Ember::Memory::Init();
+	Ember::JobSystem::Init(threads);
+
+	Ember::SoftwareRendererAPI software_api(SCREEN_WIDTH, SCREEN_HEIGHT);
+	Ember::RendererAPI::Set(&software_api);
+	Ember::RendererCommand::Init();
+	Ember::Renderer::Init();
+	Ember::RendererCommand::SetViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+	printf("software: %u JobSystem workers\n", Ember::JobSystem::GetThreadCount());
+	Ember::RenderReplay trace;
+	bool result = Benchmark(trace, path, iterations, cpu_only);
+	Ember::SoftwareRasterStats stats = software_api.GetRasterStats();
+	printf("  software: %u triangles, %u clipped, %u tiles, %llu fragments\n", stats.triangles, stats.clipped_triangles, stats.tiles, (unsigned long long)stats.fragments);
+
+	trace.Destroy();
+	Ember::Renderer::Destroy();
+	Ember::GPUResources::Flush();
+
+	Ember::JobSystem::Destroy();
+	Ember::Memory::Destroy();
+	Ember::LogImpl::Destroy();
+	return result;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		printf("Usage: Replay <trace> [iterations] [--cpu-only] [--software] [--threads <workers>]\n");
+		return 1;
+	}
+
+	uint32_t iterations = 10;
+	uint32_t threads = UINT32_MAX;
+	bool cpu_only = false;
+	bool software = false;
+	for (int i = 2; i < argc; i++) {
+		if (strcmp(argv[i], "--cpu-only") == 0)
+			cpu_only = true;
+		else if (strcmp(argv[i], "--software") == 0)
+			software = true;
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			threads = (uint32_t)atoi(argv[++i]);
+		else if (atoi(argv[i]) > 0)
+			iterations = (uint32_t)atoi(argv[i]);
+	}
+
+	if (software)
+		return BenchmarkSoftware(argv[1], iterations, cpu_only, threads) ? 0 : 1;
+
+	Replay replay;
+	replay.Initialize("Replay", SCREEN_WIDTH, SCREEN_HEIGHT);
+	return replay.Benchmark(argv[1], iterations, cpu_only) ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+#include "Tests.h"
+#include "AABBTree.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace Ember;
+
+static glm::vec4 Box(const glm::vec2& center, float half_size) {
+	return { center.x - half_size, center.y - half_size, center.x + half_size, center.y + half_size };
+}
+
+static bool Overlaps(const glm::vec4& a, const glm::vec4& b) {
+	return a.x <= b.z && b.x <= a.z && a.y <= b.w && b.y <= a.w;
+}
+
+/* Moves, removals and batched inserts against a plain list of boxes queried by brute force. */
+TEST(AABBTreeQueriesMatchBruteForce) {
+	std::mt19937 random(64);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto point = [&]() { return glm::vec2(unit(random) * 1000.0f, unit(random) * 1000.0f); };
+
+	AABBTree tree;
+	tree.Init(2.0f);
+	std::vector<glm::vec4> boxes;
+	std::vector<uint32_t> proxies;
+	std::vector<bool> alive;
+	for (uint32_t i = 0; i < 2000; i++) {
+		boxes.push_back(Box(point(), 1.0f + unit(random) * 9.0f));
+		proxies.push_back(tree.Insert(boxes.back(), i));
+		alive.push_back(true);
+	}
+
+	const uint32_t batch = 3000;
+	std::vector<glm::vec4> batch_boxes(batch);
+	std::vector<uint64_t> batch_data(batch);
+	std::vector<uint32_t> batch_proxies(batch);
+	for (uint32_t i = 0; i < batch; i++) {
+		batch_boxes[i] = Box(point(), 1.0f + unit(random) * 9.0f);
+		batch_data[i] = boxes.size() + i;
+	}
+	tree.InsertBatch(batch_boxes.data(), batch_data.data(), batch, batch_proxies.data());
+	boxes.insert(boxes.end(), batch_boxes.begin(), batch_boxes.end());
+	proxies.insert(proxies.end(), batch_proxies.begin(), batch_proxies.end());
+	alive.resize(boxes.size(), true);
+
+	std::vector<uint32_t> results(boxes.size());
+	uint32_t bounds_mismatches = 0, nearest_mismatches = 0, ray_mismatches = 0;
+	for (uint32_t round = 0; round < 20; round++) {
+		for (uint32_t i = 0; i < boxes.size(); i++) {
+			if (!alive[i])
+				continue;
+			glm::vec2 displacement = { unit(random) * 6.0f - 3.0f, unit(random) * 6.0f - 3.0f };
+			boxes[i] += glm::vec4(displacement, displacement);
+			tree.Move(proxies[i], boxes[i], displacement);
+		}
+		for (uint32_t k = 0; k < 20; k++) {
+			uint32_t i = random() % boxes.size();
+			if (alive[i]) {
+				tree.Remove(proxies[i]);
+				alive[i] = false;
+			}
+		}
+
+		for (uint32_t query = 0; query < 20; query++) {
+			glm::vec4 bounds = Box(point(), 5.0f + unit(random) * 75.0f);
+			uint32_t found = tree.QueryBounds(bounds, results.data(), (uint32_t)results.size());
+			std::set<uint64_t> got, expected;
+			for (uint32_t j = 0; j < found; j++)
+				got.insert(tree.GetUserData(results[j]));
+			for (uint32_t i = 0; i < boxes.size(); i++)
+				if (alive[i] && Overlaps(boxes[i], bounds))
+					expected.insert(i);
+			bounds_mismatches += (got != expected) ? 1 : 0;
+
+			glm::vec2 center = point();
+			TreeNearest nearest[5];
+			uint32_t nearest_count = tree.QueryNearest(center, 5, nearest);
+			std::vector<float> distances;
+			for (uint32_t i = 0; i < boxes.size(); i++) {
+				if (!alive[i])
+					continue;
+				glm::vec2 closest = glm::clamp(center, glm::vec2(boxes[i].x, boxes[i].y), glm::vec2(boxes[i].z, boxes[i].w));
+				distances.push_back(glm::dot(closest - center, closest - center));
+			}
+			std::sort(distances.begin(), distances.end());
+			nearest_mismatches += (nearest_count != 5) ? 1 : 0;
+			for (uint32_t j = 0; j < nearest_count; j++)
+				nearest_mismatches += (std::fabs(distances[j] - nearest[j].distance_squared) > 1.0e-3f) ? 1 : 0;
+
+			glm::vec2 start = point(), end = point(), direction = end - start;
+			TreeRayHit hits[3];
+			uint32_t hit_count = tree.RayCast(start, end, hits, 3);
+			std::vector<float> fractions;
+			for (uint32_t i = 0; i < boxes.size(); i++) {
+				if (!alive[i])
+					continue;
+				float enter = 0.0f, exit = 1.0f;
+				for (int axis = 0; axis < 2; axis++) {
+					float low = (boxes[i][axis] - start[axis]) / direction[axis];
+					float high = (boxes[i][axis + 2] - start[axis]) / direction[axis];
+					enter = std::max(enter, std::min(low, high));
+					exit = std::min(exit, std::max(low, high));
+				}
+				if (enter <= exit)
+					fractions.push_back(enter);
+			}
+			std::sort(fractions.begin(), fractions.end());
+			ray_mismatches += (hit_count != std::min<size_t>(3, fractions.size())) ? 1 : 0;
+			for (uint32_t j = 0; j < hit_count && j < fractions.size(); j++)
+				ray_mismatches += (std::fabs(fractions[j] - hits[j].fraction) > 1.0e-5f) ? 1 : 0;
+		}
+	}
+
+	CHECK(bounds_mismatches == 0);
+	CHECK(nearest_mismatches == 0);
+	CHECK(ray_mismatches == 0);
+	CHECK(tree.GetProxyCount() == (uint32_t)std::count(alive.begin(), alive.end(), true));
+}
+
+TEST(AABBTreeReportsTotalBeyondCapacity) {
+	AABBTree tree;
+	tree.Init();
+	for (uint32_t i = 0; i < 100; i++)
+		tree.Insert(Box({ (float)i, 0.0f }, 0.5f), i);
+
+	uint32_t results[10];
+	CHECK(tree.QueryBounds({ -1.0f, -1.0f, 200.0f, 1.0f }, results, 10) == 100);
+	CHECK(tree.QueryPoint({ 50.0f, 0.0f }, results, 10) >= 1);
+	CHECK(tree.QueryBounds({ 500.0f, 500.0f, 600.0f, 600.0f }, results, 10) == 0);
+}
+
+/* Tree queries against the linear scans they replace, radius 100 queries in a 10000 x 10000 world. */
+BENCHMARK(AABBTreeVersusLinearScan) {
+	std::mt19937 random(64);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto point = [&]() { return glm::vec2(unit(random) * 10000.0f, unit(random) * 10000.0f); };
+
+	for (uint32_t count : { 1000u, 10000u, 100000u, 1000000u }) {
+		std::vector<glm::vec4> boxes(count);
+		for (glm::vec4& box : boxes)
+			box = Box(point(), 1.0f + unit(random) * 9.0f);
+
+		AABBTree tree;
+		tree.Init(2.0f);
+		std::vector<uint32_t> proxies(count), results(count);
+		double start = Tests::Seconds();
+		tree.InsertBatch(boxes.data(), nullptr, count, proxies.data());
+		double build = Tests::Seconds() - start;
+
+		start = Tests::Seconds();
+		for (uint32_t i = 0; i < count; i++) {
+			glm::vec2 displacement = { unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f };
+			boxes[i] += glm::vec4(displacement, displacement);
+			tree.Move(proxies[i], boxes[i], displacement);
+		}
+		double move = Tests::Seconds() - start;
+
+		const uint32_t queries = 2000;
+		uint64_t sink = 0;
+		start = Tests::Seconds();
+		for (uint32_t query = 0; query < queries; query++)
+			sink += tree.QueryCircle(point(), 100.0f, results.data(), count);
+		double tree_circle = Tests::Seconds() - start;
+
+		uint32_t linear_queries = std::max(20u, 20000000u / count);
+		start = Tests::Seconds();
+		for (uint32_t query = 0; query < linear_queries; query++) {
+			glm::vec2 center = point();
+			uint32_t found = 0;
+			for (uint32_t i = 0; i < count; i++) {
+				glm::vec2 closest = glm::clamp(center, glm::vec2(boxes[i].x, boxes[i].y), glm::vec2(boxes[i].z, boxes[i].w));
+				if (glm::dot(closest - center, closest - center) <= 100.0f * 100.0f)
+					results[found++] = i;
+			}
+			sink += found;
+		}
+		double linear_circle = Tests::Seconds() - start;
+
+		TreeNearest nearest[8];
+		start = Tests::Seconds();
+		for (uint32_t query = 0; query < queries; query++)
+			sink += tree.QueryNearest(point(), 8, nearest);
+		double tree_nearest = Tests::Seconds() - start;
+
+		TreeRayHit hit;
+		start = Tests::Seconds();
+		for (uint32_t query = 0; query < queries; query++)
+			sink += tree.RayCast(point(), point(), &hit, 1);
+		double tree_ray = Tests::Seconds() - start;
+
+		printf("  %7u boxes: build %7.1f ms, move %4.0f ns, circle %6.2f us (linear %9.1f us), nearest 8 %5.2f us, first ray hit %5.2f us (%u)\n",
+			count, build * 1.0e3, move * 1.0e9 / count, tree_circle * 1.0e6 / queries, linear_circle * 1.0e6 / linear_queries,
+			tree_nearest * 1.0e6 / queries, tree_ray * 1.0e6 / queries, (uint32_t)(sink % 7));
+	}
+}
@@ -0,0 +1,139 @@
+#include "Tests.h"
+#include "Collision2D.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Ember;
+
+TEST(CollisionSweepCircleTimeOfImpact) {
+	/* A circle of radius 10 at x = 100, the last candidate so the SIMD tail is used too. */
+	glm::vec3 circles[5] = { { 0.0f, 500.0f, 5.0f }, { 50.0f, -500.0f, 5.0f }, { 300.0f, 300.0f, 5.0f }, { -300.0f, 0.0f, 5.0f }, { 100.0f, 0.0f, 10.0f } };
+	uint32_t ids[5] = { 0, 1, 2, 3, 4 };
+
+	SweepHit hit = Collision2D::SweepCircle({ { 0.0f, 0.0f }, { 200.0f, 0.0f }, 0.0f }, circles, ids, 5);
+	CHECK(hit.id == 4);
+	CHECK_NEAR(hit.time, 90.0 / 200.0, 1.0e-6);
+	CHECK_NEAR(hit.point.x, 90.0, 1.0e-3);
+	CHECK_NEAR(hit.normal.x, -1.0, 1.0e-5);
+
+	/* A swept radius of 5 touches 5 units earlier. */
+	hit = Collision2D::SweepCircle({ { 0.0f, 0.0f }, { 200.0f, 0.0f }, 5.0f }, circles, ids, 5);
+	CHECK(hit.id == 4);
+	CHECK_NEAR(hit.time, 85.0 / 200.0, 1.0e-6);
+
+	/* Passing 12 units to the side misses the ray but not a radius of 5. */
+	CHECK(!Collision2D::SweepCircle({ { 0.0f, 12.0f }, { 200.0f, 12.0f }, 0.0f }, circles, ids, 5).IsHit());
+	CHECK(Collision2D::SweepCircle({ { 0.0f, 12.0f }, { 200.0f, 12.0f }, 5.0f }, circles, ids, 5).id == 4);
+
+	/* Starting inside is a hit at time 0, stopping short is no hit. */
+	hit = Collision2D::SweepCircle({ { 95.0f, 0.0f }, { 200.0f, 0.0f }, 0.0f }, circles, ids, 5);
+	CHECK(hit.id == 4 && hit.time == 0.0f);
+	CHECK(!Collision2D::SweepCircle({ { 0.0f, 0.0f }, { 80.0f, 0.0f }, 0.0f }, circles, ids, 5).IsHit());
+}
+
+/* A bullet tested only at its end points skips a small asteroid once it moves more than the asteroid's diameter per step. */
+TEST(CollisionNoTunnellingAtAnySpeed) {
+	glm::vec3 asteroid = { 0.0f, 0.0f, 2.0f };
+	uint32_t id = 0;
+	for (float speed : { 10.0f, 100.0f, 1.0e4f, 1.0e6f }) {
+		SweepHit hit = Collision2D::SweepCircle({ { -speed * 0.5f, 0.5f }, { speed * 0.5f, 0.5f }, 0.0f }, &asteroid, &id, 1);
+		CHECK(hit.IsHit());
+		CHECK_NEAR(hit.point.x, -std::sqrt(4.0 - 0.25), speed * 1.0e-6);
+	}
+}
+
+struct CircleField {
+	std::vector<glm::vec3> circles;
+	std::vector<SweepQuery> queries;
+	SpatialGrid grid;
+};
+
+static void BuildField(CircleField& field, uint32_t circle_count, uint32_t query_count, float max_move) {
+	std::mt19937 random(63);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	field.grid.Init(64.0f);
+	field.circles.resize(circle_count);
+	for (uint32_t i = 0; i < circle_count; i++) {
+		glm::vec3& circle = field.circles[i];
+		circle = { unit(random) * 4000.0f, unit(random) * 4000.0f, 2.0f + unit(random) * 28.0f };
+		field.grid.Insert(i, { circle.x - circle.z, circle.y - circle.z, circle.x + circle.z, circle.y + circle.z });
+	}
+	field.grid.Build();
+
+	field.queries.resize(query_count);
+	for (uint32_t i = 0; i < query_count; i++) {
+		glm::vec2 start = { unit(random) * 4000.0f, unit(random) * 4000.0f };
+		float angle = unit(random) * 6.2831853f;
+		float length = unit(random) * max_move;
+		field.queries[i] = { start, start + length * glm::vec2(std::cos(angle), std::sin(angle)), (i % 3 == 0) ? 0.0f : unit(random) * 5.0f };
+	}
+}
+
+TEST(CollisionGridSweepMatchesBruteForce) {
+	CircleField field;
+	BuildField(field, 5000, 5000, 400.0f);
+	std::vector<uint32_t> all(field.circles.size());
+	for (uint32_t i = 0; i < all.size(); i++)
+		all[i] = i;
+
+	std::vector<SweepHit> hits(field.queries.size());
+	Collision2D::SweepCircles(field.queries.data(), (uint32_t)field.queries.size(), field.grid, field.circles.data(), hits.data());
+	uint32_t hit_count = 0, mismatches = 0;
+	for (uint32_t i = 0; i < field.queries.size(); i++) {
+		SweepHit expected = Collision2D::SweepCircle(field.queries[i], field.circles.data(), all.data(), (uint32_t)all.size());
+		hit_count += expected.IsHit() ? 1 : 0;
+		mismatches += (expected.IsHit() != hits[i].IsHit() || (expected.IsHit() && std::fabs(expected.time - hits[i].time) > 1.0e-6f)) ? 1 : 0;
+	}
+	CHECK(hit_count > 0);
+	CHECK(mismatches == 0);
+}
+
+/*
+* The batched sweep against substepping: point tests every 2 units along each move (the smallest radius, so
+* substepping cannot tunnel either) through grid bounds queries.
+*/
+BENCHMARK(CollisionSweepVersusSubstepping) {
+	for (float max_move : { 20.0f, 100.0f, 400.0f }) {
+		CircleField field;
+		BuildField(field, 5000, 20000, max_move);
+		uint32_t query_count = (uint32_t)field.queries.size();
+		std::vector<SweepHit> hits(query_count);
+		const uint32_t rounds = 5;
+
+		double start = Tests::Seconds();
+		for (uint32_t round = 0; round < rounds; round++)
+			Collision2D::SweepCircles(field.queries.data(), query_count, field.grid, field.circles.data(), hits.data());
+		double swept = Tests::Seconds();
+
+		std::vector<uint32_t> candidates;
+		uint32_t found = 0;
+		for (uint32_t round = 0; round < rounds; round++) {
+			for (const SweepQuery& query : field.queries) {
+				glm::vec2 move = query.end - query.start;
+				uint32_t steps = std::max(1u, (uint32_t)std::ceil(glm::length(move) / 2.0f));
+				bool hit = false;
+				for (uint32_t step = 1; step <= steps && !hit; step++) {
+					glm::vec2 point = query.start + move * ((float)step / steps);
+					candidates.clear();
+					field.grid.QueryBounds({ point - query.radius, point + query.radius }, candidates);
+					for (uint32_t candidate : candidates) {
+						glm::vec2 offset = point - glm::vec2(field.circles[candidate]);
+						float reach = field.circles[candidate].z + query.radius;
+						hit = hit || glm::dot(offset, offset) <= reach * reach;
+					}
+				}
+				found += hit ? 1 : 0;
+			}
+		}
+		double substepped = Tests::Seconds();
+
+		uint32_t swept_hits = 0;
+		for (const SweepHit& hit : hits)
+			swept_hits += hit.IsHit() ? 1 : 0;
+		printf("  moves up to %3.0f: sweep %6.3f us, substeps %7.3f us per query (%u and %u hits)\n", max_move,
+			(swept - start) * 1.0e6 / (rounds * query_count), (substepped - swept) * 1.0e6 / (rounds * query_count), swept_hits, found / rounds);
+	}
+}
@@ -0,0 +1,309 @@
+#include "Tests.h"
+#include "Coroutine.h"
+#include "JobSystem.h"
+#include "TimerWheel.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Ember;
+
+/* Runs TaskScheduler on its own timer wheel for the length of a test, with worker_count JobSystem workers. */
+class SchedulerScope {
+public:
+	SchedulerScope(uint32_t worker_count = 0) {
+		JobSystem::Init(worker_count);
+		TaskScheduler::Init(&timers);
+	}
+
+	~SchedulerScope() {
+		TaskScheduler::Destroy();
+		JobSystem::Destroy();
+	}
+
+	/* One frame of the application loop. */
+	void Frame(uint64_t delta = 0) {
+		timers.Advance(delta);
+		TaskScheduler::Update();
+	}
+
+	TimerWheel timers;
+};
+
+static Task<void> CountFrames(uint32_t& frames, uint32_t count) {
+	for (uint32_t i = 0; i < count; i++) {
+		frames++;
+		co_await NextFrame();
+	}
+}
+
+TEST(CoroutineNextFrameResumesOncePerUpdate) {
+	SchedulerScope scope;
+	uint32_t frames = 0;
+	/* Start runs the task up to its first suspension. */
+	TaskScheduler::Start(CountFrames(frames, 3));
+	CHECK(frames == 1);
+	CHECK(TaskScheduler::GetActiveCount() == 1);
+
+	scope.Frame();
+	CHECK(frames == 2);
+	scope.Frame();
+	CHECK(frames == 3);
+	CHECK(TaskScheduler::GetActiveCount() == 1);
+
+	/* The last resume returns from the task, which frees itself. */
+	scope.Frame();
+	CHECK(frames == 3);
+	CHECK(TaskScheduler::GetActiveCount() == 0);
+}
+
+static Task<void> WaitThenSet(float seconds, bool& done) {
+	co_await WaitSeconds(seconds);
+	done = true;
+}
+
+TEST(CoroutineWaitSecondsFollowsTheTimerWheel) {
+	SchedulerScope scope;
+	bool done = false, immediate = false;
+	TaskScheduler::Start(WaitThenSet(0.5f, done));
+	/* A zero wait does not suspend. */
+	TaskScheduler::Start(WaitThenSet(0.0f, immediate));
+	CHECK(immediate);
+	CHECK(TaskScheduler::GetActiveCount() == 1);
+
+	scope.Frame(Clock::FromSeconds(0.4));
+	CHECK(!done);
+	scope.Frame(Clock::FromSeconds(0.1));
+	CHECK(done);
+	CHECK(TaskScheduler::GetActiveCount() == 0);
+}
+
+static Task<void> WaitForFlag(const bool& flag, uint32_t& resumed) {
+	co_await WaitUntil([&flag]() { return flag; });
+	resumed++;
+}
+
+TEST(CoroutineWaitUntilChecksEveryUpdate) {
+	SchedulerScope scope;
+	bool flag = false;
+	uint32_t resumed = 0;
+	TaskScheduler::Start(WaitForFlag(flag, resumed));
+
+	for (uint32_t i = 0; i < 5; i++)
+		scope.Frame();
+	CHECK(resumed == 0);
+
+	flag = true;
+	scope.Frame();
+	CHECK(resumed == 1);
+	CHECK(TaskScheduler::GetActiveCount() == 0);
+
+	/* Already true, so the task runs straight through. */
+	TaskScheduler::Start(WaitForFlag(flag, resumed));
+	CHECK(resumed == 2);
+}
+
+static Task<void> WaitForCounter(JobCounter& counter, bool& done) {
+	co_await WaitForJob(counter);
+	done = true;
+}
+
+TEST(CoroutineWaitForJobWithAndWithoutWorkers) {
+	/* Without workers the job runs inline, so the counter is complete before the task waits on it. */
+	{
+		SchedulerScope scope(0);
+		JobCounter counter;
+		bool ran = false, done = false;
+		JobSystem::Submit([&ran]() { ran = true; }, &counter);
+		TaskScheduler::Start(WaitForCounter(counter, done));
+		CHECK(ran && done);
+	}
+
+	{
+		SchedulerScope scope(2);
+		JobCounter counter;
+		std::atomic<bool> release = false;
+		bool done = false;
+		JobSystem::Submit([&release]() {
+			while (!release.load())
+				std::this_thread::yield();
+		}, &counter);
+		TaskScheduler::Start(WaitForCounter(counter, done));
+
+		scope.Frame();
+		scope.Frame();
+		CHECK(!done);
+
+		release = true;
+		while (!counter.IsComplete())
+			std::this_thread::yield();
+		CHECK(!done);
+		scope.Frame();
+		CHECK(done);
+	}
+}
+
+static Task<void> Load(int& result, std::thread::id& loaded_on, std::thread::id& resumed_on) {
+	result = co_await LoadAsync<int>([&loaded_on]() {
+		loaded_on = std::this_thread::get_id();
+		return 42;
+	});
+	resumed_on = std::this_thread::get_id();
+}
+
+/* The load runs on a worker when there is one, the task always resumes on the thread calling Update. */
+TEST(CoroutineLoadAsyncResumesOnTheMainThread) {
+	for (uint32_t workers : { 0u, 2u }) {
+		SchedulerScope scope(workers);
+		int result = 0;
+		std::thread::id loaded_on, resumed_on;
+		TaskScheduler::Start(Load(result, loaded_on, resumed_on));
+		CHECK(result == 0);
+
+		for (uint32_t frame = 0; frame < 1000 && TaskScheduler::GetActiveCount() > 0; frame++) {
+			scope.Frame();
+			if (TaskScheduler::GetActiveCount() > 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		CHECK(result == 42);
+		CHECK(resumed_on == std::this_thread::get_id());
+		if (workers == 0)
+			CHECK(loaded_on == std::this_thread::get_id());
+		else
+			CHECK(loaded_on != std::this_thread::get_id());
+	}
+}
+
+static Task<int> Doubled(int value) {
+	co_await NextFrame();
+	co_return value * 2;
+}
+
+static Task<void> SumOfChildren(int& sum) {
+	int a = co_await Doubled(1);
+	int b = co_await Doubled(20);
+	sum = a + b;
+}
+
+TEST(CoroutineAwaitsChildTasks) {
+	SchedulerScope scope;
+	int sum = 0;
+	TaskScheduler::Start(SumOfChildren(sum));
+	/* Only the started task counts as active, children run inside it. */
+	CHECK(TaskScheduler::GetActiveCount() == 1);
+
+	scope.Frame();
+	CHECK(sum == 0);
+	scope.Frame();
+	CHECK(sum == 42);
+	CHECK(TaskScheduler::GetActiveCount() == 0);
+}
+
+/* Counts the frames destroyed while it lives in them. */
+struct FrameGuard {
+	uint32_t* destroyed;
+	~FrameGuard() { (*destroyed)++; }
+};
+
+static Task<void> GuardedWait(uint32_t& destroyed, uint32_t& resumed, uint32_t kind) {
+	FrameGuard guard = { &destroyed };
+	if (kind == 0)
+		co_await NextFrame();
+	else if (kind == 1)
+		co_await WaitSeconds(1.0f);
+	else if (kind == 2)
+		co_await WaitUntil([]() { return false; });
+	else
+		co_await Doubled(1);
+	resumed++;
+}
+
+TEST(CoroutineDestroyFreesSuspendedTasks) {
+	uint32_t destroyed = 0, resumed = 0;
+	TimerWheel timers;
+	TaskScheduler::Init(&timers);
+	for (uint32_t kind = 0; kind < 4; kind++)
+		TaskScheduler::Start(GuardedWait(destroyed, resumed, kind));
+	CHECK(TaskScheduler::GetActiveCount() == 4);
+
+	TaskScheduler::Destroy();
+	CHECK(destroyed == 4);
+	CHECK(TaskScheduler::GetActiveCount() == 0);
+
+	/* The wait still on the wheel fires into a new session without resuming the freed task. */
+	TaskScheduler::Init(&timers);
+	timers.Advance(Clock::FromSeconds(2.0));
+	TaskScheduler::Update();
+	CHECK(resumed == 0);
+	TaskScheduler::Destroy();
+}
+
+static Task<void> RecordFrame(const void*& frame) {
+	/* A local that lives across the suspension is stored in the coroutine frame. */
+	uint32_t local = 0;
+	frame = &local;
+	co_await NextFrame();
+	local++;
+}
+
+/* Finished frames go back to the pool, the next task of the same size takes the same memory. */
+TEST(CoroutineFramePoolReusesFrames) {
+	SchedulerScope scope;
+	const void* first = nullptr;
+	TaskScheduler::Start(RecordFrame(first));
+	scope.Frame();
+	CHECK(TaskScheduler::GetActiveCount() == 0);
+
+	uint32_t reused = 0;
+	for (uint32_t i = 0; i < 10; i++) {
+		const void* frame = nullptr;
+		TaskScheduler::Start(RecordFrame(frame));
+		scope.Frame();
+		reused += (frame == first);
+	}
+	CHECK(reused == 10);
+}
+
+static void CheckParallelFor(uint32_t count, uint32_t batch_size) {
+	std::vector<std::atomic<uint32_t>> visits(count);
+	std::atomic<uint32_t> calls = 0;
+	JobCounter counter;
+	JobSystem::ParallelFor(count, batch_size, [&](uint32_t begin, uint32_t end) {
+		calls++;
+		CHECK(begin < end && end <= count);
+		CHECK(end - begin <= (batch_size ? batch_size : 1));
+		for (uint32_t i = begin; i < end; i++)
+			visits[i]++;
+	}, &counter);
+	JobSystem::Wait(counter);
+
+	CHECK(counter.IsComplete());
+	uint32_t batch = batch_size ? batch_size : 1;
+	CHECK(calls.load() == (count + batch - 1) / batch);
+	uint32_t wrong = 0;
+	for (uint32_t i = 0; i < count; i++)
+		wrong += (visits[i].load() != 1);
+	CHECK(wrong == 0);
+}
+
+TEST(JobSystemParallelForCoversEveryIndexOnce) {
+	for (uint32_t workers : { 0u, 4u }) {
+		JobSystem::Init(workers);
+		CHECK(JobSystem::GetThreadCount() == workers);
+
+		CheckParallelFor(1000, 7);
+		CheckParallelFor(1000, 1000);
+		CheckParallelFor(5, 0);
+		CheckParallelFor(0, 16);
+
+		/* Wait on a counter with nothing pending returns at once. */
+		JobCounter idle;
+		JobSystem::Wait(idle);
+		CHECK(idle.IsComplete());
+
+		JobSystem::Destroy();
+		CHECK(JobSystem::GetThreadCount() == 0);
+	}
+}
@@ -0,0 +1,130 @@
+#include "Tests.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using Ember::FastMath;
+
+static const double PI = 3.14159265358979323846;
+
+/* Largest error of SinCos against the double precision libm over [-range, range]. */
+static double SinCosError(double range, uint32_t samples) {
+	double error = 0.0;
+	for (uint32_t i = 0; i <= samples; i++) {
+		float x = (float)(-range + 2.0 * range * i / samples);
+		float sine, cosine;
+		FastMath::SinCos(x, sine, cosine);
+		error = std::max(error, std::max(std::fabs(sine - std::sin((double)x)), std::fabs(cosine - std::cos((double)x))));
+	}
+	return error;
+}
+
+TEST(FastMathSinCosError) {
+	CHECK_NEAR(SinCosError(8192.0, 4000000), 0.0, 1.0e-7);
+	CHECK_NEAR(SinCosError(1.0e5, 4000000), 0.0, 1.0e-6);
+}
+
+TEST(FastMathSinCosDegreesError) {
+	double error = 0.0;
+	const uint32_t samples = 4000000;
+	for (uint32_t i = 0; i <= samples; i++) {
+		float x = (float)(-1.0e6 + 2.0e6 * i / samples);
+		double radians = std::fmod((double)x, 360.0) * PI / 180.0;
+		float sine, cosine;
+		FastMath::SinCosDegrees(x, sine, cosine);
+		error = std::max(error, std::max(std::fabs(sine - std::sin(radians)), std::fabs(cosine - std::cos(radians))));
+	}
+	CHECK_NEAR(error, 0.0, 1.0e-7);
+
+	for (int32_t k = -400; k <= 400; k++) {
+		float sine, cosine;
+		FastMath::SinCosDegrees(k * 90.0f, sine, cosine);
+		CHECK(sine == (float)std::round(std::sin(k * PI / 2.0)));
+		CHECK(cosine == (float)std::round(std::cos(k * PI / 2.0)));
+	}
+}
+
+TEST(FastMathAtan2Error) {
+	double error = 0.0;
+	const uint32_t samples = 1000000;
+	for (uint32_t i = 0; i < samples; i++) {
+		double angle = -PI + 2.0 * PI * i / samples;
+		for (double radius : { 1.0e-3, 1.0, 1.0e3 }) {
+			float y = (float)(radius * std::sin(angle));
+			float x = (float)(radius * std::cos(angle));
+			error = std::max(error, std::fabs(FastMath::Atan2(y, x) - std::atan2((double)y, (double)x)));
+		}
+	}
+	CHECK_NEAR(error, 0.0, 2.0e-6);
+	CHECK(FastMath::Atan2(0.0f, 0.0f) == 0.0f);
+}
+
+TEST(FastMathInvSqrtError) {
+	double error = 0.0;
+	for (double x = 1.0e-6; x < 1.0e6; x *= 1.0001) {
+		float value = (float)x;
+		error = std::max(error, std::fabs(FastMath::InvSqrt(value) * std::sqrt((double)value) - 1.0));
+	}
+	CHECK_NEAR(error, 0.0, 2.5e-7);
+}
+
+/* The SIMD lanes and the scalar tail have to agree with the scalar functions bit for bit. */
+TEST(FastMathArraysMatchScalar) {
+	const size_t count = 4096 + 3;
+	std::mt19937 random(61);
+	std::uniform_real_distribution<float> distribution(-20000.0f, 20000.0f);
+	std::vector<float> angles(count), sines(count), cosines(count);
+	for (float& angle : angles)
+		angle = distribution(random);
+
+	for (size_t length : { count, count - 3, (size_t)5, (size_t)0 }) {
+		uint32_t mismatches = 0;
+		FastMath::SinCos(angles.data(), sines.data(), cosines.data(), length);
+		for (size_t i = 0; i < length; i++) {
+			float sine, cosine;
+			FastMath::SinCos(angles[i], sine, cosine);
+			mismatches += (sine != sines[i] || cosine != cosines[i]) ? 1 : 0;
+		}
+
+		FastMath::SinCosDegrees(angles.data(), sines.data(), cosines.data(), length);
+		for (size_t i = 0; i < length; i++) {
+			float sine, cosine;
+			FastMath::SinCosDegrees(angles[i], sine, cosine);
+			mismatches += (sine != sines[i] || cosine != cosines[i]) ? 1 : 0;
+		}
+		CHECK(mismatches == 0);
+	}
+}
+
+BENCHMARK(FastMathSinCosThroughput) {
+	const size_t count = 1 << 16;
+	const uint32_t rounds = 100;
+	std::mt19937 random(61);
+	std::uniform_real_distribution<float> distribution(-20000.0f, 20000.0f);
+	std::vector<float> angles(count), sines(count), cosines(count);
+	for (float& angle : angles)
+		angle = distribution(random);
+
+	double start = Tests::Seconds();
+	for (uint32_t round = 0; round < rounds; round++)
+		for (size_t i = 0; i < count; i++) {
+			sines[i] = std::sin(angles[i]);
+			cosines[i] = std::cos(angles[i]);
+		}
+	double libm = Tests::Seconds();
+	for (uint32_t round = 0; round < rounds; round++)
+		for (size_t i = 0; i < count; i++)
+			FastMath::SinCos(angles[i], sines[i], cosines[i]);
+	double scalar = Tests::Seconds();
+	for (uint32_t round = 0; round < rounds; round++)
+		FastMath::SinCos(angles.data(), sines.data(), cosines.data(), count);
+	double arrays = Tests::Seconds();
+
+	double calls = (double)rounds * count;
+	printf("  std::sin + std::cos %8.2f ns\n", (libm - start) * 1.0e9 / calls);
+	printf("  FastMath::SinCos    %8.2f ns\n", (scalar - libm) * 1.0e9 / calls);
+	printf("  array SinCos        %8.2f ns (%g)\n", (arrays - scalar) * 1.0e9 / calls, sines[count / 2]);
+}
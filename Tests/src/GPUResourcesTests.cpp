@@ -0,0 +1,196 @@
+#include "Tests.h"
+#include "GPUResources.h"
+#include "NullRendererAPI.h"
+#include "Renderer.h"
+#include "RendererCommands.h"
+#include "OrthoCamera.h"
+#include "Texture.h"
+
+using namespace Ember;
+
+/* GPUResources on a recording backend, emptied again afterwards. */
+class GPUResourcesScope {
+public:
+	GPUResourcesScope(RecordingRendererAPI* api) {
+		RendererAPI::Set(api);
+		GPUResources::Flush();
+		start = GPUResources::GetStats();
+	}
+
+	~GPUResourcesScope() {
+		GPUResources::Flush();
+		GPUResources::SetAssertOnMisuse(true);
+		RendererAPI::Set(nullptr);
+	}
+
+	GPUResourceStats start;
+};
+
+static bool WasDeleted(const RecordingRendererAPI& api, RendererAPICallType type, uint32_t id) {
+	for (const RendererAPICall& call : api.GetCalls())
+		if (call.type == type && call.args[0] == id)
+			return true;
+	return false;
+}
+
+TEST(GPUResourcesWaitForTheFence) {
+	RecordingRendererAPI api;
+	GPUResourcesScope scope(&api);
+	bool pooled;
+
+	GPUHandle buffer = GPUResources::CreateBuffer(1024, pooled);
+	uint32_t buffer_id = buffer.id;
+	uint32_t vertex_array = api.CreateVertexArray();
+	GPUResources::ReleaseBuffer(buffer, 1024);
+	GPUResources::Release(GPUResourceType::VertexArray, vertex_array);
+	CHECK(!buffer.IsValid());
+
+	/* The GPU is still on the frame that used them: nothing is deleted or handed out again. */
+	api.HoldFences(true);
+	for (uint32_t frame = 0; frame < 10; frame++)
+		GPUResources::EndFrame();
+	CHECK(GPUResources::GetStats().retiring == 2);
+	CHECK(!WasDeleted(api, RendererAPICallType::DeleteVertexArray, vertex_array));
+	CHECK(!WasDeleted(api, RendererAPICallType::DeleteBuffer, buffer_id));
+	GPUHandle other = GPUResources::CreateBuffer(1024, pooled);
+	CHECK(!pooled && other.id != buffer_id);
+	GPUResources::ReleaseBuffer(other, 1024);
+
+	/* Once it passes, the vertex array is deleted and the buffer pooled. */
+	api.HoldFences(false);
+	GPUResources::EndFrame();
+	GPUResources::EndFrame();
+	GPUResourceStats stats = GPUResources::GetStats();
+	CHECK(stats.retiring == 0);
+	CHECK(stats.pooled_buffers == 2);
+	CHECK(WasDeleted(api, RendererAPICallType::DeleteVertexArray, vertex_array));
+	CHECK(!WasDeleted(api, RendererAPICallType::DeleteBuffer, buffer_id));
+}
+
+TEST(GPUResourcesReuseOnlyTheSameSize) {
+	RecordingRendererAPI api;
+	GPUResourcesScope scope(&api);
+	bool pooled;
+
+	GPUHandle buffer = GPUResources::CreateBuffer(4096, pooled);
+	GPUHandle texture = GPUResources::CreateTexture(64, 32, TextureFormat::RGBA8, pooled);
+	uint32_t buffer_id = buffer.id, texture_id = texture.id;
+	GPUResources::ReleaseBuffer(buffer, 4096);
+	GPUResources::ReleaseTexture(texture, 64, 32, TextureFormat::RGBA8);
+	GPUResources::EndFrame();
+	GPUResources::EndFrame();
+
+	GPUHandle smaller = GPUResources::CreateBuffer(2048, pooled);
+	CHECK(!pooled && smaller.id != buffer_id);
+	GPUHandle same = GPUResources::CreateBuffer(4096, pooled);
+	CHECK(pooled && same.id == buffer_id);
+
+	GPUHandle other_format = GPUResources::CreateTexture(64, 32, TextureFormat::R8, pooled);
+	CHECK(!pooled && other_format.id != texture_id);
+	GPUHandle same_texture = GPUResources::CreateTexture(64, 32, TextureFormat::RGBA8, pooled);
+	CHECK(pooled && same_texture.id == texture_id);
+
+	CHECK(GPUResources::GetStats().reused - scope.start.reused == 2);
+	GPUResources::ReleaseBuffer(smaller, 2048);
+	GPUResources::ReleaseBuffer(same, 4096);
+	GPUResources::ReleaseTexture(other_format, 64, 32, TextureFormat::R8);
+	GPUResources::ReleaseTexture(same_texture, 64, 32, TextureFormat::RGBA8);
+}
+
+TEST(GPUResourcesEvictUnusedAndOverBudget) {
+	RecordingRendererAPI api;
+	GPUResourcesScope scope(&api);
+	bool pooled;
+
+	GPUHandle buffer = GPUResources::CreateBuffer(256, pooled);
+	uint32_t buffer_id = buffer.id;
+	GPUResources::ReleaseBuffer(buffer, 256);
+	GPUResources::EndFrame();
+	GPUResources::EndFrame();
+	CHECK(GPUResources::GetStats().pooled_buffers == 1);
+
+	for (uint32_t frame = 0; frame < GPU_POOL_MAX_FRAMES; frame++)
+		GPUResources::EndFrame();
+	CHECK(GPUResources::GetStats().pooled_buffers == 1);
+	GPUResources::EndFrame();
+	CHECK(GPUResources::GetStats().pooled_buffers == 0);
+	CHECK(WasDeleted(api, RendererAPICallType::DeleteBuffer, buffer_id));
+
+	/* 16 MB each, the pool takes four and deletes the fifth. */
+	const uint32_t size = 2048;
+	GPUHandle textures[5];
+	for (GPUHandle& texture : textures)
+		texture = GPUResources::CreateTexture(size, size, TextureFormat::RGBA8, pooled);
+	uint32_t last = textures[4].id;
+	for (GPUHandle& texture : textures)
+		GPUResources::ReleaseTexture(texture, size, size, TextureFormat::RGBA8);
+	GPUResources::EndFrame();
+	GPUResources::EndFrame();
+
+	GPUResourceStats stats = GPUResources::GetStats();
+	CHECK(stats.pooled_textures == 4);
+	CHECK(stats.pooled_bytes == GPU_POOL_MAX_BYTES);
+	CHECK(WasDeleted(api, RendererAPICallType::DeleteTexture, last));
+}
+
+TEST(GPUResourcesHandlesCatchStaleUse) {
+	RecordingRendererAPI api;
+	GPUResourcesScope scope(&api);
+	GPUResources::SetAssertOnMisuse(false);
+	bool pooled;
+
+	GPUHandle first = GPUResources::CreateBuffer(512, pooled);
+	GPUHandle kept = first;
+	CHECK(GPUResources::IsLive(GPUResourceType::Buffer, kept));
+	GPUResources::ReleaseBuffer(first, 512);
+	CHECK(!GPUResources::IsLive(GPUResourceType::Buffer, kept));
+	CHECK(GPUResources::IsReleased(GPUResourceType::Buffer, kept.id));
+
+	/* Releasing the copy too is dropped, the buffer must not be pooled twice. */
+	GPUHandle copy = kept;
+	GPUResources::ReleaseBuffer(copy, 512);
+	CHECK(GPUResources::GetStats().misuses - scope.start.misuses == 1);
+	GPUResources::EndFrame();
+	GPUResources::EndFrame();
+	CHECK(GPUResources::GetStats().pooled_buffers == 1);
+
+	/* The pool hands the id out again, a copy of the old handle still does not match. */
+	GPUHandle reused = GPUResources::CreateBuffer(512, pooled);
+	CHECK(pooled && reused.id == kept.id && reused.generation != kept.generation);
+	CHECK(GPUResources::IsLive(GPUResourceType::Buffer, reused));
+	CHECK(!GPUResources::IsLive(GPUResourceType::Buffer, kept));
+	CHECK(!GPUResources::IsReleased(GPUResourceType::Buffer, reused.id));
+	GPUResources::CheckUse(GPUResourceType::Buffer, kept);
+	CHECK(GPUResources::GetStats().misuses - scope.start.misuses == 2);
+	GPUResources::CheckUse(GPUResourceType::Buffer, reused);
+	CHECK(GPUResources::GetStats().misuses - scope.start.misuses == 2);
+	GPUResources::ReleaseBuffer(reused, 512);
+
+	GPUHandle texture = GPUResources::CreateTexture(8, 8, TextureFormat::RGBA8, pooled);
+	uint32_t texture_id = texture.id;
+	GPUResources::ReleaseTexture(texture, 8, 8, TextureFormat::RGBA8);
+	GPUResources::CheckUse(GPUResourceType::Texture, texture_id);
+	CHECK(GPUResources::GetStats().misuses - scope.start.misuses == 3);
+}
+
+#ifdef EMBER_DEBUG
+/* A texture drawn this scene and destroyed before it ends is caught when the batch binds its slot. */
+TEST(GPUResourcesRendererCatchesDestroyedTexture) {
+	RecordingRendererAPI api;
+	GPUResourcesScope scope(&api);
+	GPUResources::SetAssertOnMisuse(false);
+	RendererCommand::Init();
+	Renderer::Init();
+	OrthoCamera camera(0.0f, 1280.0f, 0.0f, 720.0f);
+
+	Renderer::BeginScene(camera);
+	{
+		Texture texture(4, 4);
+		Renderer::DrawQuad({ 10.0f, 10.0f, 0.0f }, { 5.0f, 5.0f }, &texture);
+	}
+	Renderer::EndScene();
+	Renderer::EndFrame();
+	CHECK(GPUResources::GetStats().misuses - scope.start.misuses == 1);
+	Renderer::Destroy();
+}
+#endif
@@ -0,0 +1,242 @@
+#include "Tests.h"
+#include "Memory.h"
+#include "Logger.h"
+#include "MemoryTracker.h"
+#include "Layer.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+/*
+* Counting replacement of the global allocation functions for the whole Tests executable. The array forms fall through
+* to these.
+*/
+static std::atomic<uint64_t> heap_allocations = 0;
+
+void* operator new(size_t size) {
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer = malloc(size ? size : 1))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+	free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+	free(pointer);
+}
+
+/* The transient work of a frame: arena vectors and strings, nested scratch scopes and a log line. */
+static void SimulateFrame(uint32_t frame, uint32_t objects, Ember::Logger& logger) {
+	Ember::ArenaVector<float> vertices(Ember::Memory::FrameAllocator<float>());
+	for (uint32_t i = 0; i < objects * 8; i++)
+		vertices.push_back((float)(i + frame));
+
+	Ember::ArenaString name(Ember::Memory::FrameAllocator<char>());
+	for (uint32_t i = 0; i < 16; i++)
+		name += "asteroid ";
+
+	{
+		Ember::ScratchMarker scratch;
+		uint32_t* indices = scratch.Allocate<uint32_t>(objects);
+		indices[objects - 1] = frame;
+		{
+			Ember::ScratchMarker nested;
+			Ember::ArenaVector<uint64_t> keys(Ember::ArenaAllocator<uint64_t>(nested.GetArena()));
+			keys.resize(objects, frame);
+		}
+	}
+
+	logger.Log("frame %d, %d vertices\n", frame, (int)vertices.size());
+}
+
+TEST(MemorySteadyStateFramesStayOffTheHeap) {
+	Ember::Memory::Init(4096);
+	Ember::InitializeLoggingSystem();
+	Ember::LogFormat format;
+	format.Init("  [{ts}] {l}");
+	Ember::Logger logger;
+	logger.SetLogFormat(&format);
+
+	/* The first frames overflow the small arenas, which grow to their peak on the next reset. */
+	for (uint32_t frame = 0; frame < 3; frame++) {
+		Ember::Memory::BeginFrame();
+		SimulateFrame(frame, 2000, logger);
+	}
+	CHECK(Ember::Memory::GetFrameArena().GetOverflowCount() > 0);
+
+	/* Arena overflow blocks come from malloc, which the counter does not see, so they are checked separately. */
+	uint32_t frame_overflows = Ember::Memory::GetFrameArena().GetOverflowCount();
+	uint32_t scratch_overflows = Ember::Memory::GetScratchStack().GetOverflowCount();
+	uint64_t before = heap_allocations.load();
+	for (uint32_t frame = 3; frame < 6; frame++) {
+		Ember::Memory::BeginFrame();
+		SimulateFrame(frame, 2000, logger);
+	}
+	CHECK(heap_allocations.load() == before);
+	CHECK(Ember::Memory::GetFrameArena().GetOverflowCount() == frame_overflows);
+	CHECK(Ember::Memory::GetScratchStack().GetOverflowCount() == scratch_overflows);
+
+	/* The counter itself has to see allocations, or the check above proves nothing. */
+	before = heap_allocations.load();
+	static int* volatile probe;
+	probe = new int(0);
+	delete probe;
+	CHECK(heap_allocations.load() == before + 1);
+
+	format.Destroy();
+	Ember::Memory::Destroy();
+}
+
+TEST(MemoryNestedMarkersSurviveOverflow) {
+	Ember::Memory::Init(4096);
+	Ember::Memory::BeginFrame();
+	Ember::LinearArena& scratch = Ember::Memory::GetScratchStack();
+	size_t capacity = scratch.GetCapacity();
+	uint32_t overflows = scratch.GetOverflowCount();
+	const size_t large = capacity * 3;
+
+	/*
+	* Both markers sit at the start of the arena, the inner one overflows into a chained block. Rewinding it empties
+	* the arena, which grows while the outer marker is still alive.
+	*/
+	{
+		Ember::ScratchMarker outer;
+		{
+			Ember::ScratchMarker inner;
+			char* bytes = inner.Allocate<char>(large);
+			bytes[large - 1] = 1;
+		}
+		CHECK(scratch.GetOverflowCount() == overflows + 1);
+		CHECK(scratch.GetCapacity() >= large);
+		CHECK(scratch.GetUsed() == 0);
+
+		uint32_t* value = outer.Allocate<uint32_t>();
+		*value = 7;
+		CHECK(scratch.GetUsed() >= sizeof(uint32_t));
+	}
+	CHECK(scratch.GetUsed() == 0);
+	capacity = scratch.GetCapacity();
+	CHECK(capacity >= large);
+
+	/* A marker inside the arena is not at its start, rewinding to it frees the overflow but does not grow. */
+	overflows = scratch.GetOverflowCount();
+	{
+		Ember::ScratchMarker outer;
+		outer.Allocate<uint32_t>();
+		{
+			Ember::ScratchMarker inner;
+			inner.Allocate<char>(capacity);
+		}
+		CHECK(scratch.GetOverflowCount() == overflows + 1);
+		CHECK(scratch.GetCapacity() == capacity);
+	}
+
+	/* The same nesting as the first round now fits without chaining, and without a frame boundary. */
+	overflows = scratch.GetOverflowCount();
+	{
+		Ember::ScratchMarker outer;
+		{
+			Ember::ScratchMarker inner;
+			inner.Allocate<char>(large);
+		}
+		outer.Allocate<uint32_t>();
+	}
+	CHECK(scratch.GetOverflowCount() == overflows);
+	CHECK(scratch.GetUsed() == 0);
+
+	Ember::Memory::Destroy();
+}
+
+/* Uses more than a fresh scratch stack holds every frame, from whichever worker runs it. */
+class ScratchLayer : public Ember::Layer {
+public:
+	ScratchLayer() : Ember::Layer("Scratch", true) { }
+
+	void OnUpdate(float delta) override {
+		started = true;
+		Ember::ScratchMarker scratch;
+		Ember::ArenaVector<uint32_t> values(Ember::ArenaAllocator<uint32_t>(scratch.GetArena()));
+		for (uint32_t i = 0; i < 40000; i++)
+			values.push_back(i);
+		uint32_t* last = scratch.Allocate<uint32_t>(1000);
+		last[999] = values.back();
+
+		arena = scratch.GetArena();
+		thread = std::this_thread::get_id();
+	}
+
+	std::atomic<bool> started = false;
+	Ember::LinearArena* arena = nullptr;
+	std::thread::id thread;
+};
+
+/* Holds the main thread until the independent layer has started, so Wait cannot take its job off the worker. */
+class GateLayer : public Ember::Layer {
+public:
+	GateLayer(ScratchLayer* layer) : Ember::Layer("Gate"), layer(layer) { }
+
+	void OnUpdate(float delta) override {
+		while (!layer->started.exchange(false))
+			std::this_thread::yield();
+	}
+
+	ScratchLayer* layer;
+};
+
+/* Worker scratch stacks are never reset, rewinding the layer's marker keeps them from growing frame after frame. */
+TEST(MemoryIndependentLayerScratchStaysFlat) {
+	Ember::Memory::Init(4096);
+	Ember::JobSystem::Init(1);
+	Ember::LayerStack stack;
+	ScratchLayer* layer = new ScratchLayer();
+	stack.PushLayer(layer);
+	stack.PushLayer(new GateLayer(layer));
+
+	Ember::Memory::BeginFrame();
+	stack.Update(16.0f);
+	CHECK(layer->thread != std::this_thread::get_id());
+	CHECK(layer->arena && layer->arena != &Ember::Memory::GetScratchStack());
+	if (layer->arena) {
+		/* The first frame overflows the 64 KB stack, the rewind at the end of the scope grows it. */
+		CHECK(layer->arena->GetOverflowCount() > 0);
+		CHECK(layer->arena->GetCapacity() >= layer->arena->GetPeak());
+
+		size_t capacity = layer->arena->GetCapacity();
+		uint32_t overflows = layer->arena->GetOverflowCount();
+		uint32_t changed = 0;
+		for (uint32_t frame = 1; frame < 50; frame++) {
+			Ember::Memory::BeginFrame();
+			stack.Update(16.0f);
+			changed += (layer->arena->GetCapacity() != capacity || layer->arena->GetUsed() != 0);
+		}
+		CHECK(changed == 0);
+		CHECK(layer->arena->GetOverflowCount() == overflows);
+	}
+
+	Ember::JobSystem::Destroy();
+	Ember::Memory::Destroy();
+}
+
+#ifdef EMBER_MEMORY_TRACKING
+/* Log commands are tracked at the size of their concrete class, and Destroy frees exactly that. */
+TEST(MemoryLogCommandsTrackTheirWholeSize) {
+	Ember::InitializeLoggingSystem();
+	size_t before = Ember::MemoryTracker::GetStats(Ember::MemoryTag::Logger).cpu_current;
+
+	Ember::LogFormat format;
+	format.Init("{cR}[{ts}] {l}\n");
+	size_t expected = sizeof(Ember::ColorLogCommand) + sizeof(Ember::TimestampLogCommand) + sizeof(Ember::UserLogCommand)
+		+ sizeof(Ember::NewLineLogCommand);
+	CHECK(format.GetCommands().size() == 4);
+	CHECK(Ember::MemoryTracker::GetStats(Ember::MemoryTag::Logger).cpu_current == before + expected);
+
+	format.Destroy();
+	CHECK(Ember::MemoryTracker::GetStats(Ember::MemoryTag::Logger).cpu_current == before);
+}
+#endif
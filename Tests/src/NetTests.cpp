@@ -0,0 +1,384 @@
+#include "Tests.h"
+#include "NetSession.h"
+#include "SpatialGrid.h"
+#include "BitStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace Ember;
+
+static const uint64_t FRAME_TIME = 16000000;
+
+TEST(NetAckBitfield) {
+	NetConnection sender, receiver;
+	sender.Init(NetAddress::Loopback(1), 0);
+	receiver.Init(NetAddress::Loopback(2), 0);
+
+	/* 40 packets, every third one lost. Only the latest and the 32 before it fit in one ack. */
+	uint8_t packet[NET_MAX_PACKET_SIZE];
+	std::vector<uint16_t> delivered;
+	uint64_t now = 0;
+	for (uint16_t sequence = 0; sequence < 40; sequence++) {
+		now += FRAME_TIME;
+		size_t size = sender.WritePacket(packet, sizeof(packet), now);
+		CHECK(sender.GetLastSequence() == sequence);
+		if (sequence % 3 == 1)
+			continue;
+		CHECK(receiver.ReadPacket(packet, size, now));
+		if (sequence >= 39 - 32)
+			delivered.push_back(sequence);
+	}
+
+	size_t size = receiver.WritePacket(packet, sizeof(packet), now);
+	CHECK(sender.ReadPacket(packet, size, now));
+	std::vector<uint16_t> acked;
+	sender.PopAcked(acked);
+	std::sort(acked.begin(), acked.end());
+	CHECK(acked == delivered);
+
+	/* A late packet is acknowledged by the next reply, a duplicate is refused and acknowledged only once. */
+	now += FRAME_TIME;
+	sender.WritePacket(packet, sizeof(packet), now);
+	size_t late_size = sender.WritePacket(packet, sizeof(packet), now);
+	uint16_t late = sender.GetLastSequence();
+	std::vector<uint8_t> late_packet(packet, packet + late_size);
+	size = sender.WritePacket(packet, sizeof(packet), now);
+	CHECK(receiver.ReadPacket(packet, size, now));
+	CHECK(receiver.ReadPacket(late_packet.data(), late_packet.size(), now));
+	CHECK(!receiver.ReadPacket(late_packet.data(), late_packet.size(), now));
+
+	size = receiver.WritePacket(packet, sizeof(packet), now);
+	CHECK(sender.ReadPacket(packet, size, now));
+	acked.clear();
+	sender.PopAcked(acked);
+	std::sort(acked.begin(), acked.end());
+	CHECK(acked == std::vector<uint16_t>({ late, (uint16_t)(late + 1) }));
+}
+
+TEST(NetReliableOrderUnderLoss) {
+	NetConnection sender, receiver;
+	sender.Init(NetAddress::Loopback(1), 0);
+	receiver.Init(NetAddress::Loopback(2), 0);
+
+	/* 30% of the packets are lost both ways, and the ones in flight arrive shuffled. */
+	std::mt19937 random(66);
+	uint8_t packet[NET_MAX_PACKET_SIZE];
+	std::vector<std::vector<uint8_t>> in_flight;
+	std::vector<uint8_t> message;
+	std::vector<uint16_t> acked;
+	const uint32_t count = 1000;
+	uint32_t sent = 0, received = 0, out_of_order = 0;
+	uint64_t now = 0;
+	for (uint32_t frame = 0; frame < 3000 && received < count; frame++) {
+		now += FRAME_TIME;
+		for (uint32_t i = 0; i < 2 && sent < count; i++)
+			if (sender.Send(NetChannel::Reliable, &sent, sizeof(sent)))
+				sent++;
+
+		size_t size = sender.WritePacket(packet, sizeof(packet), now);
+		if (random() % 10 >= 3)
+			in_flight.emplace_back(packet, packet + size);
+		std::shuffle(in_flight.begin(), in_flight.end(), random);
+		while (in_flight.size() > 2) {
+			receiver.ReadPacket(in_flight.back().data(), in_flight.back().size(), now);
+			in_flight.pop_back();
+		}
+
+		while (receiver.Receive(message)) {
+			uint32_t value = 0;
+			CHECK(message.size() == sizeof(value));
+			memcpy(&value, message.data(), sizeof(value));
+			out_of_order += (value != received) ? 1 : 0;
+			received = value + 1;
+		}
+
+		size = receiver.WritePacket(packet, sizeof(packet), now);
+		if (random() % 10 >= 3)
+			sender.ReadPacket(packet, size, now);
+		sender.PopAcked(acked);
+		receiver.PopAcked(acked);
+	}
+
+	CHECK(sent == count);
+	CHECK(received == count);
+	CHECK(out_of_order == 0);
+}
+
+static NetQuantization TestQuantization() {
+	NetQuantization quantization;
+	quantization.bounds = { 0.0f, 0.0f, 4096.0f, 4096.0f };
+	return quantization;
+}
+
+static std::vector<NetEntityState> DecodeSnapshot(NetSnapshotEncoder& encoder, NetSnapshotDecoder& decoder, uint16_t id, const std::vector<NetEntityState>& entities, size_t& bytes) {
+	uint8_t buffer[NET_MAX_PACKET_SIZE * 4];
+	BitWriter writer(buffer, sizeof(buffer));
+	uint32_t written = encoder.Encode(id, entities.data(), (uint32_t)entities.size(), writer, sizeof(buffer) * 8);
+	CHECK(written == entities.size());
+	bytes = writer.Flush();
+
+	BitReader reader(buffer, bytes);
+	uint16_t decoded_id = 0;
+	std::vector<NetEntityState> decoded;
+	CHECK(decoder.Decode(reader, decoded_id, decoded));
+	CHECK(decoded_id == id);
+	return decoded;
+}
+
+static bool SameEntity(const NetEntityState& a, const NetEntityState& b) {
+	return a.id == b.id && a.position == b.position && a.angle == b.angle && a.radius == b.radius && a.kind == b.kind;
+}
+
+TEST(NetDeltaMatchesFullSnapshot) {
+	NetQuantization quantization = TestQuantization();
+	std::mt19937 random(66);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<NetEntityState> entities;
+	for (uint32_t i = 0; i < 80; i++)
+		entities.push_back({ i * 3 + 1, { unit(random) * 4096.0f, unit(random) * 4096.0f }, unit(random) * 6.0f, 4.0f + unit(random) * 100.0f, (uint8_t)(i % 4) });
+
+	NetSnapshotEncoder encoder;
+	NetSnapshotDecoder decoder;
+	encoder.Init(quantization);
+	decoder.Init(quantization);
+	size_t bytes = 0;
+	DecodeSnapshot(encoder, decoder, 1, entities, bytes);
+	encoder.Acknowledge(1);
+
+	/* Small moves, one large jump, a changed kind, removals and new entities, in no particular order. */
+	for (uint32_t i = 0; i < entities.size(); i += 2) {
+		entities[i].position += glm::vec2(3.0f, -2.0f);
+		entities[i].angle += 0.1f;
+	}
+	entities[5].position = { 10.0f, 4000.0f };
+	entities[7].kind = 3;
+	entities.erase(entities.begin() + 20, entities.begin() + 30);
+	entities.push_back({ 1000, { 100.0f, 100.0f }, 1.0f, 16.0f, 2 });
+	entities.push_back({ 2, { 200.0f, 300.0f }, 2.0f, 32.0f, 1 });
+	std::shuffle(entities.begin(), entities.end(), random);
+
+	size_t delta_bytes = 0;
+	std::vector<NetEntityState> delta = DecodeSnapshot(encoder, decoder, 2, entities, delta_bytes);
+	CHECK(encoder.HasBaseline());
+
+	NetSnapshotEncoder full_encoder;
+	NetSnapshotDecoder full_decoder;
+	full_encoder.Init(quantization);
+	full_decoder.Init(quantization);
+	size_t full_bytes = 0;
+	std::vector<NetEntityState> full = DecodeSnapshot(full_encoder, full_decoder, 2, entities, full_bytes);
+
+	CHECK(delta.size() == entities.size());
+	CHECK(delta.size() == full.size() && std::equal(delta.begin(), delta.end(), full.begin(), SameEntity));
+	CHECK(delta_bytes < full_bytes);
+}
+
+/*
+* A server and three clients over loopback sockets. The entities sit on a 200 unit lattice and drift by less than the
+* gap to any interest edge, so each client has to end up holding exactly the entities its rectangle covers.
+*/
+TEST(NetLoopbackSessionFollowsInterest) {
+	const float world_size = 1600.0f;
+	NetQuantization quantization;
+	quantization.bounds = { 0.0f, 0.0f, world_size, world_size };
+
+	NetServer server;
+	bool listening = server.Init(0, 4, quantization);
+	CHECK(listening);
+	if (!listening)
+		return;
+
+	std::vector<NetEntityState> entities;
+	for (uint32_t y = 0; y < 8; y++)
+		for (uint32_t x = 0; x < 8; x++)
+			entities.push_back({ y * 8 + x + 1, { 100.0f + 200.0f * x, 100.0f + 200.0f * y }, 0.0f, 10.0f, (uint8_t)(x % 3) });
+	SpatialGrid grid;
+	grid.Init(256.0f);
+
+	/* A corner, a block in the middle, and the whole world. */
+	const glm::vec4 interests[] = {
+		{ 0.0f, 0.0f, 450.0f, 450.0f },
+		{ 550.0f, 650.0f, 1250.0f, 1150.0f },
+		{ 0.0f, 0.0f, world_size, world_size }
+	};
+	const uint32_t client_count = 3;
+
+	/* Clients connect one at a time so that client i holds slot i. */
+	uint64_t now = 1;
+	std::vector<NetClient> clients(client_count);
+	for (uint32_t i = 0; i < client_count; i++) {
+		CHECK(clients[i].Init(NetAddress::Loopback(server.GetPort()), quantization, now));
+		bool connected = false;
+		for (uint32_t attempt = 0; attempt < 100 && !connected; attempt++) {
+			now += 33333333;
+			clients[i].Flush(now);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			server.Receive(now);
+			connected = server.IsConnected(i);
+		}
+		CHECK(connected);
+		server.SetInterest(i, interests[i]);
+	}
+
+	/* The entities the server should send each client, found by brute force over the server's state. */
+	auto expected_ids = [&](uint32_t client) {
+		const glm::vec4& interest = interests[client];
+		std::vector<uint32_t> ids;
+		for (const NetEntityState& entity : entities)
+			if (entity.position.x + entity.radius >= interest.x && entity.position.x - entity.radius <= interest.z &&
+				entity.position.y + entity.radius >= interest.y && entity.position.y - entity.radius <= interest.w)
+				ids.push_back(entity.id);
+		return ids;
+	};
+
+	for (uint32_t tick = 0; tick < 30; tick++) {
+		now += 33333333;
+		for (NetClient& client : clients)
+			client.Flush(now);
+		for (NetEntityState& entity : entities) {
+			entity.position += glm::vec2(0.5f, -0.25f);
+			entity.angle += 0.05f;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		server.Receive(now);
+		grid.Clear();
+		for (uint32_t i = 0; i < entities.size(); i++)
+			grid.Insert(i, { entities[i].position - entities[i].radius, entities[i].position + entities[i].radius });
+		grid.Build();
+		server.SendSnapshots(entities.data(), (uint32_t)entities.size(), grid);
+		server.Flush(now);
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		for (NetClient& client : clients)
+			client.Receive(now);
+	}
+
+	for (uint32_t i = 0; i < client_count; i++) {
+		CHECK(server.IsConnected(i));
+		CHECK(clients[i].IsConnected(now));
+
+		std::vector<uint32_t> received;
+		uint32_t mismatches = 0;
+		for (const NetEntityState& entity : clients[i].GetEntities()) {
+			const NetEntityState& actual = entities[entity.id - 1];
+			mismatches += (glm::length(entity.position - actual.position) > 0.1f || entity.kind != actual.kind) ? 1 : 0;
+			received.push_back(entity.id);
+		}
+		CHECK(mismatches == 0);
+
+		CHECK(received == expected_ids(i));
+	}
+	CHECK(expected_ids(0).size() == 4);
+	CHECK(expected_ids(1).size() == 9);
+	CHECK(expected_ids(2).size() == entities.size());
+
+	server.Destroy();
+	for (NetClient& client : clients)
+		client.Destroy();
+}
+
+/* 64 clients over loopback sockets, each watching a moving 1600x900 window of a 16000x16000 world of 20000 entities. */
+BENCHMARK(NetServer64Clients) {
+	const uint32_t entity_count = 20000, client_count = 64;
+	const float world_size = 16000.0f;
+	NetQuantization quantization;
+	quantization.bounds = { 0.0f, 0.0f, world_size, world_size };
+	quantization.position_bits = 18;
+
+	NetServer server;
+	bool listening = server.Init(0, client_count, quantization);
+	CHECK(listening);
+	if (!listening)
+		return;
+	uint64_t now = 1;
+	std::vector<NetClient> clients(client_count);
+	for (NetClient& client : clients)
+		client.Init(NetAddress::Loopback(server.GetPort()), quantization, now);
+
+	std::mt19937 random(66);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<NetEntityState> entities(entity_count);
+	std::vector<glm::vec2> velocities(entity_count);
+	for (uint32_t i = 0; i < entity_count; i++) {
+		entities[i] = { i * 3 + 1, { unit(random) * world_size, unit(random) * world_size }, unit(random) * 6.0f, 8.0f + unit(random) * 60.0f, (uint8_t)(i % 3) };
+		velocities[i] = { unit(random) * 4.0f - 2.0f, unit(random) * 4.0f - 2.0f };
+	}
+	std::vector<glm::vec2> views(client_count);
+	for (glm::vec2& view : views)
+		view = { unit(random) * world_size, unit(random) * world_size };
+
+	SpatialGrid grid;
+	grid.Init(256.0f);
+	const uint32_t ticks = 300, warmup = 100;
+	double tick_total = 0.0, tick_worst = 0.0;
+	uint64_t bytes_at_warmup = 0;
+	for (uint32_t tick = 0; tick < ticks; tick++) {
+		now += 33333333;
+		for (NetClient& client : clients)
+			client.Flush(now);
+		for (uint32_t i = 0; i < entity_count; i++) {
+			glm::vec2& position = entities[i].position;
+			position += velocities[i];
+			position = glm::mod(position + world_size, glm::vec2(world_size));
+			entities[i].angle += 0.01f;
+		}
+
+		double start = Tests::Seconds();
+		server.Receive(now);
+		grid.Clear();
+		for (uint32_t i = 0; i < entity_count; i++) {
+			const NetEntityState& entity = entities[i];
+			grid.Insert(i, { entity.position - entity.radius, entity.position + entity.radius });
+		}
+		grid.Build();
+		for (uint32_t client = 0; client < client_count; client++) {
+			views[client] += glm::vec2(1.0f, 0.5f);
+			server.SetInterest(client, { views[client].x - 800.0f, views[client].y - 450.0f, views[client].x + 800.0f, views[client].y + 450.0f });
+		}
+		server.SendSnapshots(entities.data(), entity_count, grid);
+		server.Flush(now);
+		double elapsed = Tests::Seconds() - start;
+
+		if (tick == warmup)
+			for (uint32_t client = 0; client < client_count; client++)
+				bytes_at_warmup += server.GetStats(client).bytes_sent;
+		if (tick > warmup) {
+			tick_total += elapsed;
+			tick_worst = std::max(tick_worst, elapsed);
+		}
+		for (NetClient& client : clients)
+			client.Receive(now);
+	}
+
+	/* Every client has to hold the server's entities within quantization error. */
+	uint32_t connected = 0;
+	size_t seen = 0, mismatches = 0;
+	for (NetClient& client : clients) {
+		connected += client.IsConnected(now) ? 1 : 0;
+		for (const NetEntityState& entity : client.GetEntities()) {
+			const NetEntityState& actual = entities[(entity.id - 1) / 3];
+			mismatches += (glm::length(entity.position - actual.position) > 0.2f || entity.kind != actual.kind) ? 1 : 0;
+			seen++;
+		}
+	}
+	uint64_t bytes = 0;
+	for (uint32_t client = 0; client < client_count; client++)
+		bytes += server.GetStats(client).bytes_sent;
+	bytes -= bytes_at_warmup;
+
+	uint32_t measured = ticks - warmup - 1;
+	printf("  %u of %u clients connected, %.1f entities each, %zu mismatches\n", connected, client_count, (double)seen / client_count, mismatches);
+	printf("  server tick %.3f ms average, %.3f ms worst\n", tick_total * 1000.0 / measured, tick_worst * 1000.0);
+	printf("  %.1f bytes per client per tick\n", (double)bytes / client_count / measured);
+	CHECK(connected == client_count);
+	CHECK(mismatches == 0);
+
+	server.Destroy();
+	for (NetClient& client : clients)
+		client.Destroy();
+}
@@ -0,0 +1,167 @@
+#include "Tests.h"
+#include "Physics2D.h"
+#include "JobSystem.h"
+
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace Ember;
+
+static const glm::vec2 BOX[4] = { { -10.0f, -10.0f }, { 10.0f, -10.0f }, { 10.0f, 10.0f }, { -10.0f, 10.0f } };
+
+TEST(PhysicsPolygonShape) {
+	/* The interior points are dropped by the hull. */
+	glm::vec2 points[6] = { BOX[0], BOX[1], BOX[2], BOX[3], { 0.0f, 0.0f }, { 5.0f, 5.0f } };
+	PolygonShape shape = PolygonShape::FromPoints(points, 6);
+	CHECK(shape.count == 4);
+	CHECK_NEAR(shape.area, 400.0, 1.0e-3);
+	CHECK_NEAR(shape.inertia, 400.0 * (400.0 + 400.0) / 12.0, 1.0e-1);
+}
+
+TEST(PhysicsStackComesToRest) {
+	PhysicsSettings settings;
+	settings.gravity = { 0.0f, -500.0f };
+	PhysicsWorld world;
+	world.Init(settings);
+	glm::vec2 floor[4] = { { -500.0f, -10.0f }, { 500.0f, -10.0f }, { 500.0f, 10.0f }, { -500.0f, 10.0f } };
+	BodyDefinition ground;
+	ground.type = BodyType::Static;
+	ground.shape = world.AddShape(PolygonShape::FromPoints(floor, 4));
+	world.CreateBody(ground);
+
+	uint32_t box = world.AddShape(PolygonShape::FromPoints(BOX, 4));
+	BodyHandle stack[5];
+	for (uint32_t i = 0; i < 5; i++) {
+		BodyDefinition definition;
+		definition.shape = box;
+		definition.position = { 0.5f * i, 20.0f + 20.5f * i };
+		stack[i] = world.CreateBody(definition);
+	}
+	for (uint32_t step = 0; step < 600; step++)
+		world.Step(1.0f / 60.0f);
+
+	/* Five boxes of 20 on a floor whose top is at 10, within the slop. */
+	CHECK_NEAR(world.GetBody(stack[4])->position.y, 100.0, 2.0);
+	CHECK_NEAR(world.GetBody(stack[4])->angle, 0.0, 0.01);
+	CHECK(world.GetStats().awake_bodies == 0);
+	CHECK(world.GetStats().islands == 0);
+	world.Destroy();
+}
+
+TEST(PhysicsElasticCollision) {
+	PhysicsWorld world;
+	world.Init();
+	uint32_t box = world.AddShape(PolygonShape::FromPoints(BOX, 4));
+	BodyDefinition definition;
+	definition.shape = box;
+	definition.restitution = 1.0f;
+	definition.position = { -30.0f, 0.0f };
+	definition.velocity = { 100.0f, 0.0f };
+	BodyHandle a = world.CreateBody(definition);
+	definition.position = { 30.0f, 0.0f };
+	definition.velocity = { -100.0f, 0.0f };
+	BodyHandle b = world.CreateBody(definition);
+
+	for (uint32_t step = 0; step < 60; step++)
+		world.Step(1.0f / 60.0f);
+	CHECK_NEAR(world.GetBody(a)->velocity.x, -100.0, 1.0);
+	CHECK_NEAR(world.GetBody(b)->velocity.x, 100.0, 1.0);
+	CHECK(world.GetBody(a)->position.x < world.GetBody(b)->position.x - 20.0f);
+
+	world.DestroyBody(a);
+	CHECK(!a.IsValid());
+	CHECK(world.GetBody(a) == nullptr);
+	world.Destroy();
+}
+
+/*
+* A closed arena of asteroid outlines drifting in zero gravity, what the game would do with everything colliding.
+* Returns the average step time in milliseconds and a checksum of the final positions.
+*/
+static double StepAsteroidField(uint32_t count, uint32_t steps, uint32_t workers, float& checksum, PhysicsStats& stats) {
+	if (workers > 0)
+		JobSystem::Init(workers);
+
+	PhysicsWorld world;
+	world.Init();
+	const float size = 12.0f * std::sqrt((float)count);
+	glm::vec2 wall[4] = { { -size, -16.0f }, { size, -16.0f }, { size, 16.0f }, { -size, 16.0f } };
+	uint32_t horizontal = world.AddShape(PolygonShape::FromPoints(wall, 4));
+	for (glm::vec2& point : wall)
+		point = { point.y, point.x };
+	uint32_t vertical = world.AddShape(PolygonShape::FromPoints(wall, 4));
+	BodyDefinition border;
+	border.type = BodyType::Static;
+	for (uint32_t side = 0; side < 4; side++) {
+		border.shape = (side < 2) ? horizontal : vertical;
+		border.position = (side < 2) ? glm::vec2(0.0f, side == 0 ? -size : size) : glm::vec2(side == 2 ? -size : size, 0.0f);
+		world.CreateBody(border);
+	}
+
+	/* The outline of the game's asteroid_model, eight points of uneven radius. */
+	glm::vec2 outline[8];
+	const float radii[8] = { 1.0f, 0.8f, 0.95f, 0.75f, 1.0f, 0.85f, 0.9f, 0.8f };
+	for (uint32_t i = 0; i < 8; i++) {
+		float angle = i * 6.2831853f / 8.0f;
+		outline[i] = glm::vec2(std::cos(angle), std::sin(angle)) * radii[i];
+	}
+	uint32_t asteroid = world.AddShape(PolygonShape::FromPoints(outline, 8));
+
+	std::mt19937 random(62);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (uint32_t i = 0; i < count; i++) {
+		BodyDefinition definition;
+		definition.shape = asteroid;
+		definition.scale = 4.0f + unit(random) * 6.0f;
+		definition.position = { (unit(random) * 2.0f - 1.0f) * (size - 24.0f), (unit(random) * 2.0f - 1.0f) * (size - 24.0f) };
+		definition.angle = unit(random) * 6.2831853f;
+		definition.velocity = { unit(random) * 200.0f - 100.0f, unit(random) * 200.0f - 100.0f };
+		definition.angular_velocity = unit(random) * 2.0f - 1.0f;
+		definition.restitution = 0.5f;
+		world.CreateBody(definition);
+	}
+
+	double start = Tests::Seconds();
+	for (uint32_t step = 0; step < steps; step++)
+		world.Step(1.0f / 60.0f);
+	double elapsed = Tests::Seconds() - start;
+
+	stats = world.GetStats();
+	checksum = 0.0f;
+	for (uint32_t i = 0; i < count + 4; i++)
+		checksum += world.GetBody(world.GetHandle(i))->position.x;
+	world.Destroy();
+	if (workers > 0)
+		JobSystem::Destroy();
+	return elapsed * 1000.0 / steps;
+}
+
+TEST(PhysicsSameResultOnAnyWorkerCount) {
+	PhysicsStats stats;
+	float inline_checksum = 0.0f, parallel_checksum = 0.0f;
+	StepAsteroidField(500, 60, 0, inline_checksum, stats);
+	StepAsteroidField(500, 60, 3, parallel_checksum, stats);
+	CHECK(inline_checksum == parallel_checksum);
+}
+
+/* 10000 colliding asteroids, stepped with 0 (inline) up to one JobSystem worker per hardware thread. */
+BENCHMARK(PhysicsAsteroidField) {
+	const uint32_t count = 10000, steps = 120;
+	uint32_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+	printf("  %u bodies, %u hardware threads\n", count, hardware_threads);
+
+	double inline_time = 0.0;
+	float inline_checksum = 0.0f;
+	for (uint32_t workers = 0; workers <= std::max(hardware_threads, 2u); workers = workers ? workers * 2 : 1) {
+		PhysicsStats stats;
+		float checksum = 0.0f;
+		double time = StepAsteroidField(count, steps, workers, checksum, stats);
+		if (workers == 0) {
+			inline_time = time;
+			inline_checksum = checksum;
+		}
+		printf("  %2u workers %8.3f ms/step (%.2fx)  %u awake, %u contacts, %u islands\n", workers, time, inline_time / time, stats.awake_bodies, stats.contacts, stats.islands);
+		CHECK(checksum == inline_checksum);
+	}
+}
@@ -0,0 +1,628 @@
+#include "Tests.h"
+#include "Renderer.h"
+#include "DynamicResolution.h"
+#include "RendererCommands.h"
+#include "NullRendererAPI.h"
+#include "GPUResources.h"
+#include "OrthoCamera.h"
+#include "RenderCapture.h"
+#include "Shader.h"
+#include "Font.h"
+#include "MemoryTracker.h"
+#include "Texture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <vector>
+
+using namespace Ember;
+
+/* Runs the Renderer on a backend with no GPU for the length of a test. */
+class RendererScope {
+public:
+	RendererScope(RendererAPI* api, const RendererCapacity& capacity = RendererCapacity()) {
+		RendererAPI::Set(api);
+		RendererCommand::Init();
+		Renderer::Init(capacity);
+	}
+
+	~RendererScope() {
+		Renderer::Destroy();
+		GPUResources::Flush();
+		RendererAPI::Set(nullptr);
+	}
+};
+
+/* The data of the last upload to target, as count elements of T. */
+template<typename T>
+static std::vector<T> LastUpload(const RecordingRendererAPI& api, BufferTarget target) {
+	const RendererAPICall* upload = nullptr;
+	for (const RendererAPICall& call : api.GetCalls())
+		if (call.type == RendererAPICallType::BufferSubData && call.args[0] == (uint32_t)target)
+			upload = &call;
+
+	std::vector<T> elements;
+	if (upload) {
+		elements.resize(upload->data.size() / sizeof(T));
+		memcpy(elements.data(), upload->data.data(), elements.size() * sizeof(T));
+	}
+	return elements;
+}
+
+TEST(RendererRecordsOneBatchOfQuads) {
+	RecordingRendererAPI api;
+	RendererScope scope(&api);
+	Texture a(4, 4), b(4, 4);
+	OrthoCamera camera(0.0f, 1280.0f, 0.0f, 720.0f);
+
+	api.ClearCalls();
+	Renderer::BeginScene(camera);
+	Renderer::DrawQuad({ 10.0f, 10.0f, 0.0f }, { 5.0f, 5.0f }, { 1.0f, 0.0f, 0.0f, 1.0f });
+	Renderer::DrawQuad({ 20.0f, 10.0f, 0.0f }, { 5.0f, 5.0f }, &a);
+	Renderer::DrawQuad({ 30.0f, 10.0f, 0.0f }, { 5.0f, 5.0f }, &b);
+	Renderer::DrawQuad({ 40.0f, 10.0f, 0.0f }, { 5.0f, 5.0f }, &a);
+	/* Outside the camera, culled before it reaches the batch. */
+	Renderer::DrawQuad({ -4000.0f, 10.0f, 0.0f }, { 5.0f, 5.0f }, { 1.0f, 0.0f, 0.0f, 1.0f });
+	Renderer::EndScene();
+	Renderer::EndFrame();
+
+	RendererStats stats = Renderer::GetStats();
+	CHECK(stats.primitives == 4);
+	CHECK(stats.culled_primitives == 1);
+	CHECK(stats.batches == 1);
+	CHECK(api.CountCalls(RendererAPICallType::DrawMultiIndirect) == 1);
+
+	/* Each texture takes one slot however often it is drawn, in the order first drawn. */
+	std::vector<const RendererAPICall*> binds;
+	for (const RendererAPICall& call : api.GetCalls())
+		if (call.type == RendererAPICallType::BindTextureUnit)
+			binds.push_back(&call);
+	CHECK(binds.size() == 2);
+	if (binds.size() == 2) {
+		CHECK(binds[0]->args[0] == 0 && binds[0]->args[1] == a.GetTextureId());
+		CHECK(binds[1]->args[0] == 1 && binds[1]->args[1] == b.GetTextureId());
+	}
+
+	std::vector<Vertex> vertices = LastUpload<Vertex>(api, BufferTarget::Vertex);
+	CHECK(vertices.size() == 4 * QUAD_VERTEX_COUNT);
+	if (vertices.size() == 4 * QUAD_VERTEX_COUNT) {
+		const float texture_ids[4] = { -1.0f, 0.0f, 1.0f, 0.0f };
+		for (uint32_t quad = 0; quad < 4; quad++) {
+			const Vertex& corner = vertices[quad * QUAD_VERTEX_COUNT];
+			CHECK_NEAR(corner.position.x, 7.5 + 10.0 * quad, 1.0e-4);
+			CHECK_NEAR(corner.position.y, 7.5, 1.0e-4);
+			CHECK(corner.texture_id == texture_ids[quad]);
+		}
+		CHECK(vertices[0].color == glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+	}
+
+	std::vector<DrawElementsCommand> commands = LastUpload<DrawElementsCommand>(api, BufferTarget::Indirect);
+	CHECK(commands.size() == 1);
+	if (commands.size() == 1) {
+		CHECK(commands[0].vertex_count == 4 * QUAD_INDEX_COUNT);
+		CHECK(commands[0].first_index == 0);
+		CHECK(commands[0].instance_count == 1);
+	}
+}
+
+TEST(RendererDrawsEveryViewFromOneBatch) {
+	RecordingRendererAPI api;
+	RendererScope scope(&api);
+	/* Split screen over two neighbouring areas, and a minimap of both. */
+	RenderView views[3];
+	views[0].camera = OrthoCamera(0.0f, 1280.0f, 0.0f, 720.0f);
+	views[0].viewport = { 0.0f, 0.0f, 0.5f, 1.0f };
+	views[1].camera = OrthoCamera(1280.0f, 2560.0f, 0.0f, 720.0f);
+	views[1].viewport = { 0.5f, 0.0f, 0.5f, 1.0f };
+	views[2].camera = OrthoCamera(0.0f, 2560.0f, 0.0f, 1440.0f);
+	views[2].viewport = { 0.75f, 0.75f, 0.25f, 0.25f };
+
+	api.ClearCalls();
+	for (uint32_t scene = 0; scene < 2; scene++) {
+		Renderer::BeginScene(views, 3);
+		/* Only the first view sees this one, only the second the next, and none the last. */
+		Renderer::DrawQuad({ 100.0f, 100.0f, 0.0f }, { 10.0f, 10.0f }, { 1.0f, 0.0f, 0.0f, 1.0f });
+		Renderer::DrawQuad({ 2000.0f, 100.0f, 0.0f }, { 10.0f, 10.0f }, { 0.0f, 1.0f, 0.0f, 1.0f });
+		Renderer::DrawQuad({ 100.0f, -4000.0f, 0.0f }, { 10.0f, 10.0f }, { 0.0f, 0.0f, 1.0f, 1.0f });
+		Renderer::EndScene();
+	}
+	Renderer::EndFrame();
+
+	/* The vertices are built and uploaded once per scene, not once per view. */
+	RendererStats stats = Renderer::GetStats();
+	CHECK(stats.batches == 2);
+	CHECK(stats.primitives == 4);
+	CHECK(stats.culled_primitives == 2);
+	uint32_t vertex_uploads = 0;
+	for (const RendererAPICall& call : api.GetCalls())
+		if (call.type == RendererAPICallType::BufferSubData && call.args[0] == (uint32_t)BufferTarget::Vertex)
+			vertex_uploads++;
+	CHECK(vertex_uploads == 2);
+	CHECK(LastUpload<Vertex>(api, BufferTarget::Vertex).size() == 2 * QUAD_VERTEX_COUNT);
+
+	/* Each draw command is instanced once per view. */
+	std::vector<DrawElementsCommand> commands = LastUpload<DrawElementsCommand>(api, BufferTarget::Indirect);
+	CHECK(commands.size() == 1);
+	for (const DrawElementsCommand& command : commands)
+		CHECK(command.instance_count == 3);
+
+	std::vector<ShaderView> shader_views = LastUpload<ShaderView>(api, BufferTarget::ShaderStorage);
+	CHECK(shader_views.size() == 3);
+	if (shader_views.size() == 3) {
+		for (uint32_t i = 0; i < 3; i++) {
+			const Camera& camera = views[i].camera;
+			CHECK(shader_views[i].proj_view == camera.GetProjection() * camera.GetView());
+			CHECK(shader_views[i].viewport == views[i].viewport);
+		}
+		/* Later views take nearer, smaller, slices of the depth range. */
+		CHECK(shader_views[2].depth_range.y <= shader_views[1].depth_range.x && shader_views[1].depth_range.y <= shader_views[0].depth_range.x);
+	}
+}
+
+TEST(RendererStartsABatchWhenTextureSlotsRunOut) {
+	RecordingRendererAPI api;
+	RendererScope scope(&api);
+	const uint32_t texture_count = MAX_TEXTURE_SLOTS + 8;
+	std::vector<Texture> textures(texture_count);
+	for (Texture& texture : textures)
+		texture.Init(2, 2);
+	OrthoCamera camera(0.0f, 1280.0f, 0.0f, 720.0f);
+
+	api.ClearCalls();
+	Renderer::BeginScene(camera);
+	for (uint32_t i = 0; i < texture_count; i++)
+		Renderer::DrawQuad({ 20.0f * i + 10.0f, 10.0f, 0.0f }, { 4.0f, 4.0f }, &textures[i]);
+	Renderer::EndScene();
+	Renderer::EndFrame();
+
+	CHECK(Renderer::GetStats().primitives == texture_count);
+	CHECK(Renderer::GetStats().batches == 2);
+	CHECK(api.CountCalls(RendererAPICallType::BindTextureUnit) == texture_count);
+	for (const RendererAPICall& call : api.GetCalls())
+		if (call.type == RendererAPICallType::BindTextureUnit)
+			CHECK(call.args[0] < MAX_TEXTURE_SLOTS);
+}
+
+TEST(RendererPadsShapesByAPixel) {
+	RecordingRendererAPI api;
+	RendererScope scope(&api);
+	OrthoCamera camera(0.0f, 1280.0f, 0.0f, 720.0f);
+	/* Half the camera's size, a pixel is 2 world units. */
+	RendererCommand::SetViewport(0, 0, 640, 360);
+
+	Renderer::BeginScene(camera);
+	Renderer::DrawCircle({ 100.0f, 100.0f, 0.0f }, 10.0f, { 1.0f, 1.0f, 1.0f, 1.0f });
+	Renderer::DrawRoundedRect({ 300.0f, 100.0f, 0.0f }, { 40.0f, 20.0f }, 4.0f, { 1.0f, 1.0f, 1.0f, 1.0f });
+	Renderer::EndScene();
+	Renderer::EndFrame();
+	RendererCommand::SetViewport(0, 0, 0, 0);
+
+	/* The quads grow by a pixel on each side and their shape coordinates with them, the shapes keep their size. */
+	std::vector<Vertex> vertices = LastUpload<Vertex>(api, BufferTarget::Vertex);
+	CHECK(vertices.size() == 2 * QUAD_VERTEX_COUNT);
+	if (vertices.size() == 2 * QUAD_VERTEX_COUNT) {
+		CHECK_NEAR(vertices[0].position.x, 88.0f, 1e-4f);
+		CHECK_NEAR(vertices[2].position.y, 112.0f, 1e-4f);
+		CHECK_NEAR(vertices[0].texture_coordinates.x, -12.0f, 1e-4f);
+		CHECK_NEAR(vertices[2].texture_coordinates.y, 12.0f, 1e-4f);
+		CHECK(vertices[0].shape == glm::vec4(10.0f, 10.0f, 10.0f, 0.0f));
+
+		CHECK_NEAR(vertices[4].position.x, 278.0f, 1e-4f);
+		CHECK_NEAR(vertices[6].position.y, 112.0f, 1e-4f);
+		CHECK_NEAR(vertices[4].texture_coordinates.x, -22.0f, 1e-4f);
+		CHECK_NEAR(vertices[6].texture_coordinates.y, 12.0f, 1e-4f);
+		CHECK(vertices[4].shape == glm::vec4(20.0f, 10.0f, 4.0f, 0.0f));
+	}
+}
+
+/*
+* Walks the recorded frame draw by draw: the texture units bound for a draw, then its vertices. Every textured vertex
+* must name a unit bound for that same draw, holding the texture the quad was drawn with. The tests put the quad's
+* number in the red channel and draw quad i with textures[i % count]. Returns the number of vertices that fail.
+*/
+static uint32_t CountBadTextureSlots(const RecordingRendererAPI& api, const std::vector<Texture>& textures, uint32_t& draws) {
+	uint32_t bad = 0;
+	uint32_t units[MAX_TEXTURE_SLOTS] = {};
+	std::vector<Vertex> vertices;
+	draws = 0;
+
+	for (const RendererAPICall& call : api.GetCalls()) {
+		if (call.type == RendererAPICallType::BindTextureUnit && call.args[0] < MAX_TEXTURE_SLOTS)
+			units[call.args[0]] = call.args[1];
+		else if (call.type == RendererAPICallType::BufferSubData && call.args[0] == (uint32_t)BufferTarget::Vertex) {
+			vertices.resize(call.data.size() / sizeof(Vertex));
+			memcpy(vertices.data(), call.data.data(), vertices.size() * sizeof(Vertex));
+		}
+		else if (call.type == RendererAPICallType::DrawMultiIndirect) {
+			for (const Vertex& vertex : vertices) {
+				uint32_t expected = textures[(uint32_t)vertex.color.r % textures.size()].GetTextureId();
+				int32_t slot = (int32_t)vertex.texture_id;
+				if (slot < 0 || slot >= (int32_t)MAX_TEXTURE_SLOTS || units[slot] != expected)
+					bad++;
+			}
+			for (uint32_t& unit : units)
+				unit = 0;
+			vertices.clear();
+			draws++;
+		}
+	}
+	return bad;
+}
+
+/* The quad that finds its batch full at max_quad_count must take its texture slot in the batch it lands in. */
+TEST(RendererFullBatchKeepsTextureSlots) {
+	RecordingRendererAPI api;
+	RendererCapacity capacity;
+	capacity.initial_quad_count = 64;
+	capacity.max_quad_count = 64;
+	RendererScope scope(&api, capacity);
+	std::vector<Texture> textures(5);
+	for (Texture& texture : textures)
+		texture.Init(2, 2);
+	OrthoCamera camera(0.0f, 1280.0f, 0.0f, 720.0f);
+
+	const uint32_t quads = 64 * 4 + 10;
+	const char* paths[] = { "DrawQuad", "DrawRotatedQuad", "DrawRotatedQuad 3D" };
+	for (uint32_t path = 0; path < 3; path++) {
+		api.ClearCalls();
+		Renderer::BeginScene(camera);
+		for (uint32_t i = 0; i < quads; i++) {
+			glm::vec3 position = { 4.0f * (i % 300) + 10.0f, 8.0f * (i / 300) + 10.0f, 0.0f };
+			glm::vec4 color = { (float)i, 0.0f, 0.0f, 1.0f };
+			Texture* texture = &textures[i % textures.size()];
+			if (path == 0)
+				Renderer::DrawQuad(position, { 2.0f, 2.0f }, texture, color);
+			else if (path == 1)
+				Renderer::DrawRotatedQuad(position, 30.0f, { 0.0f, 0.0f, 1.0f }, { 2.0f, 2.0f }, texture, color);
+			else
+				Renderer::DrawRotatedQuad(position, 30.0f, { 1.0f, 0.0f, 0.0f }, { 2.0f, 2.0f }, texture, color);
+		}
+		Renderer::EndScene();
+		Renderer::EndFrame();
+
+		uint32_t draws = 0;
+		uint32_t bad = CountBadTextureSlots(api, textures, draws);
+		if (bad)
+			printf("  %s: %u vertices point at the wrong texture slot\n", paths[path], bad);
+		CHECK(bad == 0);
+		CHECK(draws == 5);
+		CHECK(Renderer::GetStats().primitives == quads);
+	}
+}
+
+/*
+* Bounds on, just past and across every edge of the view, in a count that is not a multiple of four so both the
+* SIMD groups and the scalar tail see edge cases. Touching an edge counts as visible.
+*/
+TEST(RendererCullBoundsMatchesScalarFilter) {
+	RecordingRendererAPI api;
+	RendererScope scope(&api);
+	OrthoCamera camera(0.0f, 1280.0f, 0.0f, 720.0f);
+	glm::vec4 view;
+	CHECK(Renderer::GetViewBounds(camera, view));
+
+	std::vector<glm::vec4> bounds;
+	const float offsets[] = { -8.0f, -4.0f, -0.5f, 0.0f, 0.5f, 4.0f };
+	for (float offset : offsets) {
+		float mid_y = (view.y + view.w) * 0.5f, mid_x = (view.x + view.z) * 0.5f;
+		/* A 4 unit box whose far side is offset from the left edge, then the same against the right, bottom and top. */
+		bounds.push_back({ view.x + offset - 4.0f, mid_y, view.x + offset, mid_y + 4.0f });
+		bounds.push_back({ view.z - offset, mid_y, view.z - offset + 4.0f, mid_y + 4.0f });
+		bounds.push_back({ mid_x, view.y + offset - 4.0f, mid_x + 4.0f, view.y + offset });
+		bounds.push_back({ mid_x, view.w - offset, mid_x + 4.0f, view.w - offset + 4.0f });
+	}
+	/* Corners, inside on one axis only, and boxes covering the whole view. */
+	bounds.push_back({ view.x - 4.0f, view.y - 4.0f, view.x, view.y });
+	bounds.push_back({ view.z + 0.5f, view.w - 2.0f, view.z + 4.0f, view.w + 2.0f });
+	bounds.push_back({ view.x - 100.0f, view.y - 100.0f, view.z + 100.0f, view.w + 100.0f });
+	uint32_t seed = 12345;
+	while (bounds.size() < 47) {
+		seed = seed * 1664525u + 1013904223u;
+		float x = (float)(seed >> 8) / (float)(1 << 24) * 1600.0f - 160.0f;
+		seed = seed * 1664525u + 1013904223u;
+		float y = (float)(seed >> 8) / (float)(1 << 24) * 1000.0f - 140.0f;
+		bounds.push_back({ x, y, x + 50.0f, y + 30.0f });
+	}
+	const uint32_t count = (uint32_t)bounds.size();
+	CHECK(count % 4 != 0);
+
+	/* Every length, so each entry is at every position of a group and of the tail. */
+	for (uint32_t length = 0; length <= count; length++) {
+		std::vector<uint32_t> expected;
+		for (uint32_t i = 0; i < length; i++) {
+			const glm::vec4& b = bounds[i];
+			if (b.z >= view.x && b.x <= view.z && b.w >= view.y && b.y <= view.w)
+				expected.push_back(i);
+		}
+
+		std::vector<uint32_t> visible(length, UINT32_MAX);
+		Renderer::EndFrame();
+		uint32_t visible_count = Renderer::CullBounds(camera, bounds.data(), length, visible.data());
+		Renderer::EndFrame();
+
+		CHECK(visible_count == expected.size());
+		CHECK(std::equal(expected.begin(), expected.end(), visible.begin()));
+		CHECK(Renderer::GetStats().culled_primitives == length - expected.size());
+	}
+}
+
+/* Ids a call names instead of values: programs for the shader calls, textures for the texture binds. */
+static int IdArgument(RendererAPICallType type) {
+	switch (type) {
+	case RendererAPICallType::UseProgram:
+	case RendererAPICallType::GetUniformLocation:
+	case RendererAPICallType::GetUniformNames:
+	case RendererAPICallType::SetUniformFloat:
+	case RendererAPICallType::SetUniformVec3:
+	case RendererAPICallType::SetUniformMat4:
+	case RendererAPICallType::SetUniformIntArray:
+	case RendererAPICallType::GetBlockIndex:
+	case RendererAPICallType::SetUniformBlockBinding:
+	case RendererAPICallType::SetStorageBlockBinding:
+	case RendererAPICallType::BindTexture:
+		return 0;
+	case RendererAPICallType::BindTextureUnit:
+		return 1;
+	default:
+		return -1;
+	}
+}
+
+/*
+* The same calls with the same values and data. Program and texture ids may differ, replay creates its own, but each
+* must stand for one id of the other list throughout.
+*/
+static uint32_t CountCallDifferences(const std::vector<RendererAPICall>& expected, const std::vector<RendererAPICall>& actual) {
+	if (expected.size() != actual.size())
+		return (uint32_t)std::max(expected.size(), actual.size());
+
+	std::map<uint32_t, uint32_t> forward, backward;
+	uint32_t differences = 0;
+	for (size_t i = 0; i < expected.size(); i++) {
+		const RendererAPICall& a = expected[i];
+		const RendererAPICall& b = actual[i];
+		int id = IdArgument(a.type);
+		bool same = a.type == b.type && a.data == b.data && memcmp(a.values, b.values, sizeof(a.values)) == 0;
+		for (int arg = 0; arg < 6; arg++)
+			same = same && (arg == id || a.args[arg] == b.args[arg]);
+		if (same && id >= 0) {
+			uint32_t from = a.args[id], to = b.args[id];
+			same = forward.emplace(from, to).first->second == to && backward.emplace(to, from).first->second == from;
+		}
+		differences += same ? 0 : 1;
+	}
+	return differences;
+}
+
+static std::vector<uint8_t> ReadBytes(const char* path) {
+	std::ifstream stream(path, std::ios::binary);
+	return std::vector<uint8_t>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+static void WriteBytes(const char* path, const std::vector<uint8_t>& bytes) {
+	std::ofstream stream(path, std::ios::binary);
+	stream.write((const char*)bytes.data(), bytes.size());
+}
+
+/* A trace of one frame replays to the calls the frame made, a cut or damaged trace does not load. */
+TEST(RendererReplaysACapturedFrame) {
+	const char* path = "renderer_tests_capture.trace";
+	RecordingRendererAPI api;
+	RendererScope scope(&api);
+	OrthoCamera camera(0.0f, 1280.0f, 0.0f, 720.0f);
+	Texture texture(4, 4);
+	/* Loaded again by path on replay, the recording backend makes a program whether or not the file exists. */
+	Shader shader("renderer_tests_shader.glsl");
+	Renderer::InitRendererShader(&shader);
+
+	/* A font without a file, the trace carries its glyphs. Tracked like Font::Init, which its destructor assumes. */
+	Texture atlas(64, 16);
+	Font font;
+	font.texture = atlas.GetTextureId();
+	font.width = 64;
+	font.height = 16;
+	font.size = 16;
+	for (char c = 'a'; c <= 'd'; c++)
+		font.glyphs[c] = { { 10, 12 }, { 1, 10 }, { 11 << 6, 0 }, (c - 'a') * 16.0f / 64.0f };
+	EMBER_TRACK_GPU_ALLOC(MemoryTag::Font, font.width * font.height);
+	EMBER_TRACK_ALLOC(MemoryTag::Font, font.glyphs.size() * sizeof(std::pair<const char, Glyph>));
+
+	auto draw_frame = [&]() {
+		Renderer::BeginScene(camera);
+		Renderer::DrawQuad({ 100.0f, 100.0f, 0.0f }, { 20.0f, 20.0f }, { 1.0f, 0.0f, 0.0f, 1.0f });
+		Renderer::DrawQuad({ 140.0f, 100.0f, 0.0f }, { 20.0f, 20.0f }, &texture);
+		Renderer::DrawLine({ 10.0f, 10.0f }, { 300.0f, 200.0f }, { 0.0f, 1.0f, 0.0f, 1.0f }, 3.0f);
+		Renderer::DrawCircle({ 400.0f, 300.0f, 0.0f }, 25.0f, { 0.0f, 0.0f, 1.0f, 1.0f });
+		Renderer::RenderText(&font, "abcdab", { 500.0f, 400.0f }, { 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f, 1.0f });
+		Renderer::EndScene();
+
+		/* BeginScene goes back to the default shader, so the switch comes after it. */
+		Renderer::BeginScene(camera);
+		Renderer::SetShader(&shader);
+		Renderer::DrawRoundedRect({ 600.0f, 300.0f, 0.0f }, { 80.0f, 40.0f }, 6.0f, { 1.0f, 1.0f, 0.0f, 1.0f });
+		Renderer::EndScene();
+		Renderer::SetShaderToDefualt();
+		Renderer::EndFrame();
+	};
+
+	/* One frame first, so buffers the renderer grows on first use are in place for both the capture and the replay. */
+	draw_frame();
+	api.ClearCalls();
+	RenderCapture::Begin(path, 1);
+	draw_frame();
+	CHECK(!RenderCapture::IsCapturing());
+	std::vector<RendererAPICall> captured = api.GetCalls();
+
+	RenderReplay replay;
+	CHECK(replay.Load(path));
+	CHECK(replay.GetFrameCount() == 1);
+	if (replay.GetFrameCount() == 1) {
+		api.ClearCalls();
+		replay.ReplayFrame(0);
+		CHECK(captured.size() > 0);
+		CHECK(CountCallDifferences(captured, api.GetCalls()) == 0);
+		CHECK(api.CountCalls(RendererAPICallType::UseProgram) >= 2);
+	}
+
+	std::vector<uint8_t> trace = ReadBytes(path);
+	CHECK(trace.size() > 64);
+
+	/* Cut anywhere inside a command, the header included, the trace is rejected. */
+	uint32_t accepted = 0;
+	for (size_t cut : { (size_t)3, (size_t)8, trace.size() / 3, trace.size() / 2, trace.size() - 3 }) {
+		WriteBytes(path, std::vector<uint8_t>(trace.begin(), trace.begin() + cut));
+		accepted += replay.Load(path) ? 1 : 0;
+	}
+	CHECK(accepted == 0);
+
+	/* An unknown command, and a version newer than this build reads. */
+	std::vector<uint8_t> damaged = trace;
+	damaged[sizeof(uint32_t) + sizeof(uint16_t)] = 0xEE;
+	WriteBytes(path, damaged);
+	CHECK(!replay.Load(path));
+	damaged = trace;
+	uint16_t version = RENDER_TRACE_VERSION + 1;
+	memcpy(damaged.data() + sizeof(uint32_t), &version, sizeof(version));
+	WriteBytes(path, damaged);
+	CHECK(!replay.Load(path));
+	CHECK(replay.GetFrameCount() == 0);
+
+	/* The untouched trace still loads after the failures. */
+	WriteBytes(path, trace);
+	CHECK(replay.Load(path));
+	CHECK(replay.GetFrameCount() == 1);
+	replay.Destroy();
+	std::remove(path);
+}
+
+/* CPU cost of building batches with nothing behind them: 10000 quads cycling through 40 textures. */
+BENCHMARK(RendererNullBackendQuads) {
+	NullRendererAPI api;
+	RendererScope scope(&api);
+	std::vector<Texture> textures(40);
+	for (Texture& texture : textures)
+		texture.Init(2, 2);
+	OrthoCamera camera(0.0f, 1280.0f, 0.0f, 720.0f);
+
+	const uint32_t frames = 200, quads = 10000;
+	for (int rotated = 0; rotated < 2; rotated++) {
+		double start = Tests::Seconds();
+		for (uint32_t frame = 0; frame < frames; frame++) {
+			Renderer::BeginScene(camera);
+			for (uint32_t i = 0; i < quads; i++) {
+				glm::vec3 position = { (float)(i % 1280), (float)(i % 720), 0.0f };
+				if (rotated)
+					Renderer::DrawRotatedQuad(position, (float)i, { 0.0f, 0.0f, 1.0f }, { 4.0f, 4.0f }, &textures[i % 40]);
+				else
+					Renderer::DrawQuad(position, { 4.0f, 4.0f }, &textures[i % 40]);
+			}
+			Renderer::EndScene();
+			Renderer::EndFrame();
+		}
+		double elapsed = Tests::Seconds() - start;
+		printf("  %s %6.3f ms per frame, %5.1f ns per quad, %u batches\n", rotated ? "DrawRotatedQuad" : "DrawQuad       ",
+			elapsed * 1.0e3 / frames, elapsed * 1.0e9 / ((double)frames * quads), Renderer::GetStats().batches);
+	}
+}
+
+/* One scene whose timer query, and any still in flight, reads milliseconds once they come back. */
+static void RunScene(RecordingRendererAPI& api, DynamicResolution& resolution, float milliseconds, bool available = true) {
+	api.SetTimerResult((uint64_t)(milliseconds * 1000000.0), available);
+	resolution.BeginScene();
+	resolution.EndScene();
+}
+
+/* Results come back one scene later, the scale follows them in the BeginScene after that. */
+TEST(DynamicResolutionDropsAtOnceAndRisesInSteps) {
+	RecordingRendererAPI api;
+	RendererScope scope(&api);
+	DynamicResolution resolution;
+	resolution.Init(1000, 1000, DynamicResolutionSettings(), "renderer_tests_upscale.glsl");
+	CHECK(resolution.IsEnabled());
+
+	/* Twice the 12 ms target at once is half the pixels, the whole drop in one adjustment. */
+	RunScene(api, resolution, 24.0f);
+	RunScene(api, resolution, 24.0f);
+	CHECK_NEAR(resolution.GetStats().scale, std::sqrt(0.5f), 1e-5);
+	CHECK(resolution.GetStats().adjustments == 1);
+
+	/* Far under the target it rises by increase_step per result, never more. */
+	float scale = resolution.GetStats().scale;
+	for (uint32_t step = 1; step <= 3; step++) {
+		RunScene(api, resolution, 1.0f);
+		CHECK_NEAR(resolution.GetStats().scale, scale + 0.05f * step, 1e-5);
+	}
+	CHECK(resolution.GetStats().adjustments == 4);
+
+	/* Until it stops at max_scale, a last step smaller than the dead band still reaches the limit. */
+	for (uint32_t frame = 0; frame < 20; frame++)
+		RunScene(api, resolution, 1.0f);
+	CHECK(resolution.GetStats().scale == 1.0f);
+	uint32_t adjustments = resolution.GetStats().adjustments;
+	RunScene(api, resolution, 1.0f);
+	CHECK(resolution.GetStats().adjustments == adjustments);
+}
+
+TEST(DynamicResolutionHeadroomAndDeadBand) {
+	RecordingRendererAPI api;
+	RendererScope scope(&api);
+	DynamicResolution resolution;
+	resolution.Init(1000, 1000, DynamicResolutionSettings(), "renderer_tests_upscale.glsl");
+
+	/* Far over the target drops to min_scale. */
+	RunScene(api, resolution, 100.0f);
+	RunScene(api, resolution, 100.0f);
+	CHECK(resolution.GetStats().scale == 0.5f);
+	CHECK(resolution.GetStats().adjustments == 1);
+
+	/* Just under the headroom the rise is capped to what brings the scene back to it, less than increase_step. */
+	RunScene(api, resolution, 8.64f);
+	CHECK_NEAR(resolution.GetStats().scale, 0.5f * std::sqrt(9.6f / 8.64f), 1e-4);
+	CHECK(resolution.GetStats().adjustments == 2);
+
+	/* Between headroom * target (9.6 ms) and the target nothing changes. */
+	float scale = resolution.GetStats().scale;
+	for (uint32_t frame = 0; frame < 5; frame++)
+		RunScene(api, resolution, 11.0f);
+	CHECK(resolution.GetStats().scale == scale);
+	CHECK(resolution.GetStats().adjustments == 2);
+
+	/* Slightly over the target asks for less than MIN_SCALE_CHANGE, which is not worth the results in flight. */
+	for (uint32_t frame = 0; frame < 5; frame++)
+		RunScene(api, resolution, 12.2f);
+	CHECK(resolution.GetStats().scale == scale);
+	CHECK(resolution.GetStats().adjustments == 2);
+}
+
+TEST(DynamicResolutionIgnoresStaleResults) {
+	RecordingRendererAPI api;
+	RendererScope scope(&api);
+	DynamicResolution resolution;
+	resolution.Init(1000, 1000, DynamicResolutionSettings(), "renderer_tests_upscale.glsl");
+	RunScene(api, resolution, 12.0f);
+
+	/* Three scenes in flight at 24 ms: the oldest drops the scale, the two drawn before the change are ignored. */
+	RunScene(api, resolution, 0.0f, false);
+	RunScene(api, resolution, 0.0f, false);
+	RunScene(api, resolution, 24.0f);
+	CHECK_NEAR(resolution.GetStats().scale, std::sqrt(0.5f), 1e-5);
+	CHECK(resolution.GetStats().adjustments == 1);
+	CHECK_NEAR(resolution.GetStats().scene_time, 0.0f, 1e-6);
+
+	/* Longer than MAX_SCENE_TIME is a stall, not the scene. */
+	for (uint32_t frame = 0; frame < 3; frame++)
+		RunScene(api, resolution, 400.0f);
+	CHECK_NEAR(resolution.GetStats().scale, std::sqrt(0.5f), 1e-5);
+	CHECK(resolution.GetStats().adjustments == 1);
+	CHECK_NEAR(resolution.GetStats().scene_time, 0.0f, 1e-6);
+
+	/* The scene drawn at the new scale counts. */
+	RunScene(api, resolution, 24.0f);
+	CHECK_NEAR(resolution.GetStats().scale, 0.5f, 1e-5);
+	CHECK(resolution.GetStats().adjustments == 2);
+}
@@ -0,0 +1,166 @@
+#include "Tests.h"
+#include "Snapshot.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace Ember;
+
+struct SnapshotState {
+	uint32_t tick;
+	float positions[64];
+};
+
+static void Fill(SnapshotState& state, std::vector<uint32_t>& items, uint32_t tick, uint32_t item_count) {
+	state.tick = tick;
+	for (uint32_t i = 0; i < 64; i++)
+		state.positions[i] = (float)(tick * 100 + i);
+	items.resize(item_count);
+	for (uint32_t i = 0; i < item_count; i++)
+		items[i] = tick * 1000 + i;
+}
+
+static bool Matches(const SnapshotState& state, const std::vector<uint32_t>& items, uint32_t tick, uint32_t item_count) {
+	SnapshotState expected_state;
+	std::vector<uint32_t> expected_items;
+	Fill(expected_state, expected_items, tick, item_count);
+	return memcmp(&state, &expected_state, sizeof(state)) == 0 && items == expected_items;
+}
+
+TEST(SnapshotRestoresValuesAndVectors) {
+	SnapshotState state;
+	std::vector<uint32_t> items;
+	SnapshotHistory history;
+	history.Init(16, 64 * 1024, 64);
+	history.Register(&state, "state");
+	history.RegisterVector(&items, "items");
+
+	/* The vector grows past a page, shrinks below one and ends up empty. */
+	const uint32_t item_counts[] = { 10, 200, 3, 0, 57 };
+	for (uint32_t tick = 0; tick < 5; tick++) {
+		Fill(state, items, tick, item_counts[tick]);
+		CHECK(history.Capture(tick));
+	}
+	CHECK(history.GetStats().frames == 5);
+
+	for (uint32_t tick = 5; tick-- > 0;) {
+		Fill(state, items, 99, 120);
+		CHECK(history.Restore(tick));
+		CHECK(Matches(state, items, tick, item_counts[tick]));
+	}
+	CHECK(!history.Restore(7));
+	history.Destroy();
+}
+
+TEST(SnapshotSharesUnchangedPages) {
+	SnapshotState state;
+	std::vector<uint32_t> items;
+	SnapshotHistory history;
+	/* The state is 260 bytes, 5 pages of 64, and 32 items are 2 more. */
+	history.Init(16, 64 * 1024, 64);
+	history.Register(&state, "state");
+	history.RegisterVector(&items, "items");
+
+	Fill(state, items, 1, 32);
+	CHECK(history.Capture(1));
+	CHECK(history.GetStats().last_new_pages == 7);
+	CHECK(history.GetStats().last_shared_pages == 0);
+
+	CHECK(history.Capture(2));
+	CHECK(history.GetStats().last_new_pages == 0);
+	CHECK(history.GetStats().last_shared_pages == 7);
+	CHECK(history.GetStats().pages_used == 7);
+
+	/* One float in the last page of the state. */
+	state.positions[63] = -1.0f;
+	CHECK(history.Capture(3));
+	CHECK(history.GetStats().last_new_pages == 1);
+	CHECK(history.GetStats().last_shared_pages == 6);
+	CHECK(history.GetStats().pages_used == 8);
+
+	/* Growing the vector keeps its full pages and copies the partial last page and the new ones. */
+	items.resize(40, 7);
+	CHECK(history.Capture(4));
+	CHECK(history.GetStats().last_new_pages == 1);
+	CHECK(history.GetStats().last_shared_pages == 7);
+
+	CHECK(history.Restore(2));
+	CHECK(Matches(state, items, 1, 32));
+	history.Destroy();
+}
+
+TEST(SnapshotDropsNewerFrames) {
+	SnapshotState state;
+	std::vector<uint32_t> items;
+	SnapshotHistory history;
+	history.Init(16, 64 * 1024, 64);
+	history.Register(&state, "state");
+	history.RegisterVector(&items, "items");
+
+	for (uint32_t tick = 1; tick <= 6; tick++) {
+		Fill(state, items, tick, tick * 4);
+		CHECK(history.Capture(tick));
+	}
+
+	/* Restoring drops everything after the frame. */
+	CHECK(history.Restore(4));
+	CHECK(history.GetLatestFrame() == 4);
+	CHECK(history.HasFrame(3) && !history.HasFrame(5) && !history.HasFrame(6));
+	CHECK(history.GetStats().frames == 4);
+
+	/* Capturing a frame that is already there replaces it and everything after it. */
+	Fill(state, items, 50, 9);
+	CHECK(history.Capture(2));
+	CHECK(history.GetLatestFrame() == 2);
+	CHECK(history.GetOldestFrame() == 1);
+	CHECK(!history.HasFrame(3) && !history.HasFrame(4));
+	CHECK(history.GetStats().frames == 2);
+
+	Fill(state, items, 0, 0);
+	CHECK(history.Restore(2));
+	CHECK(Matches(state, items, 50, 9));
+	CHECK(history.Restore(1));
+	CHECK(Matches(state, items, 1, 4));
+	history.Destroy();
+}
+
+TEST(SnapshotStaysInsideTheBudget) {
+	SnapshotState state;
+	std::vector<uint32_t> items;
+	SnapshotHistory history;
+	/* Every frame changes all 7 pages and the budget holds 24, so only the newest 3 frames fit. */
+	history.Init(16, 24 * 64, 64);
+	history.Register(&state, "state");
+	history.RegisterVector(&items, "items");
+
+	for (uint32_t tick = 1; tick <= 10; tick++) {
+		Fill(state, items, tick, 32);
+		CHECK(history.Capture(tick));
+		CHECK(history.GetStats().pages_used <= history.GetStats().page_capacity);
+	}
+	CHECK(history.GetStats().page_capacity == 24);
+	CHECK(history.GetStats().frames == 3);
+	CHECK(history.GetOldestFrame() == 8);
+	CHECK(history.GetLatestFrame() == 10);
+	CHECK(!history.HasFrame(7));
+	CHECK(history.Restore(8));
+	CHECK(Matches(state, items, 8, 32));
+
+	/* Unchanged frames cost no pages, then the frame count is the limit. */
+	for (uint32_t tick = 9; tick <= 30; tick++)
+		CHECK(history.Capture(tick));
+	CHECK(history.GetStats().frames == 16);
+	CHECK(history.GetOldestFrame() == 15);
+	CHECK(history.GetStats().pages_used == 7);
+
+	/* A frame bigger than the whole budget is refused after evicting everything, without leaking pages. */
+	items.resize(2000);
+	CHECK(!history.Capture(31));
+	CHECK(history.GetStats().frames == 0);
+	CHECK(history.GetStats().pages_used == 0);
+	items.resize(32);
+	CHECK(history.Capture(32));
+	CHECK(history.Restore(32));
+	CHECK(Matches(state, items, 8, 32));
+	history.Destroy();
+}
@@ -0,0 +1,224 @@
+#include "Tests.h"
+#include "Renderer.h"
+#include "RendererCommands.h"
+#include "SoftwareRendererAPI.h"
+#include "GPUResources.h"
+#include "OrthoCamera.h"
+#include "Texture.h"
+
+#include <cmath>
+#include <cstdint>
+
+using namespace Ember;
+
+/*
+* Runs the Renderer on a 64 by 64 SoftwareRendererAPI cleared to opaque black, with a camera of the same size so a
+* world unit is a pixel. Cameras sit at z = 0 like the game's, so the near and far planes keep z = 0.
+*/
+class SoftwareScope {
+public:
+	static constexpr uint32_t SIZE = 64;
+
+	SoftwareScope() : api(SIZE, SIZE), camera(0.0f, (float)SIZE, 0.0f, (float)SIZE) {
+		RendererAPI::Set(&api);
+		RendererCommand::Init();
+		Renderer::Init();
+		RendererCommand::SetViewport(0, 0, SIZE, SIZE);
+		RendererCommand::SetClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		RendererCommand::Clear();
+		camera.SetPosition({ 0.0f, 0.0f, 0.0f });
+	}
+
+	~SoftwareScope() {
+		Renderer::Destroy();
+		GPUResources::Flush();
+		RendererCommand::SetViewport(0, 0, 0, 0);
+		RendererAPI::Set(nullptr);
+	}
+
+	const uint8_t* Pixel(uint32_t x, uint32_t y) const {
+		return api.GetColorBuffer() + ((size_t)y * SIZE + x) * 4;
+	}
+
+	bool IsClear(uint32_t x, uint32_t y) const {
+		const uint8_t* pixel = Pixel(x, y);
+		return pixel[0] == 0 && pixel[1] == 0 && pixel[2] == 0;
+	}
+
+	SoftwareRendererAPI api;
+	OrthoCamera camera;
+};
+
+static bool IsColor(const uint8_t* pixel, uint8_t r, uint8_t g, uint8_t b) {
+	return pixel[0] == r && pixel[1] == g && pixel[2] == b;
+}
+
+/* Edges on pixel centers: left and top edges own those pixels, right and bottom edges do not. */
+TEST(SoftwareQuadFollowsTheFillRule) {
+	SoftwareScope scope;
+
+	Renderer::BeginScene(scope.camera);
+	/* x and y from 8.5 to 12.5, and a neighbour sharing the edge at x = 12.5. */
+	Renderer::DrawQuad({ 10.5f, 10.5f, 0.0f }, { 4.0f, 4.0f }, { 1.0f, 0.0f, 0.0f, 1.0f });
+	Renderer::DrawQuad({ 14.5f, 10.5f, 0.0f }, { 4.0f, 4.0f }, { 0.0f, 1.0f, 0.0f, 1.0f });
+	Renderer::EndScene();
+	Renderer::EndFrame();
+
+	uint32_t red = 0, green = 0, other = 0;
+	for (uint32_t y = 0; y < SoftwareScope::SIZE; y++) {
+		for (uint32_t x = 0; x < SoftwareScope::SIZE; x++) {
+			bool inside_rows = y >= 9 && y <= 12;
+			const uint8_t* pixel = scope.Pixel(x, y);
+			if (inside_rows && x >= 8 && x <= 11)
+				red += IsColor(pixel, 255, 0, 0);
+			else if (inside_rows && x >= 12 && x <= 15)
+				green += IsColor(pixel, 0, 255, 0);
+			else
+				other += !scope.IsClear(x, y);
+		}
+	}
+
+	CHECK(red == 16);
+	CHECK(green == 16);
+	CHECK(other == 0);
+	CHECK(scope.api.GetRasterStats().fragments == 32);
+}
+
+TEST(SoftwareBlendsOverlappingQuads) {
+	SoftwareScope scope;
+
+	/* The second quad is nearer, it would fail the depth test at the same z. */
+	Renderer::BeginScene(scope.camera);
+	Renderer::DrawQuad({ 16.0f, 16.0f, 0.0f }, { 16.0f, 16.0f }, { 1.0f, 0.0f, 0.0f, 1.0f });
+	Renderer::DrawQuad({ 24.0f, 16.0f, 0.5f }, { 16.0f, 16.0f }, { 0.0f, 1.0f, 0.0f, 0.5f });
+	Renderer::EndScene();
+	Renderer::EndFrame();
+
+	/* Only red, both, only green, neither. */
+	CHECK(IsColor(scope.Pixel(10, 16), 255, 0, 0));
+	const uint8_t* both = scope.Pixel(20, 16);
+	CHECK_NEAR(both[0], 128, 1);
+	CHECK_NEAR(both[1], 128, 1);
+	CHECK(both[2] == 0);
+	CHECK_NEAR(both[3], 191, 1);
+	const uint8_t* green = scope.Pixel(28, 16);
+	CHECK_NEAR(green[0], 0, 1);
+	CHECK_NEAR(green[1], 128, 1);
+	CHECK(scope.IsClear(36, 16));
+}
+
+/* Magnified textures sample the nearest texel, minified ones filter linearly. */
+TEST(SoftwareSamplesTexturesNearestAndLinear) {
+	SoftwareScope scope;
+	/* Bottom row first: red, green, then blue, white. */
+	uint8_t corners[2 * 2 * 4] = {
+		255, 0, 0, 255,  0, 255, 0, 255,
+		0, 0, 255, 255,  255, 255, 255, 255
+	};
+	Texture magnified(2, 2);
+	magnified.SetData(corners);
+
+	/* Black and white columns, each pixel of the quad below covers two of them. */
+	uint8_t stripes[8 * 8 * 4];
+	for (uint32_t i = 0; i < 8 * 8; i++) {
+		uint8_t value = (i % 2) ? 255 : 0;
+		stripes[i * 4 + 0] = stripes[i * 4 + 1] = stripes[i * 4 + 2] = value;
+		stripes[i * 4 + 3] = 255;
+	}
+	Texture minified(8, 8);
+	minified.SetData(stripes);
+
+	Renderer::BeginScene(scope.camera);
+	Renderer::DrawQuad({ 24.0f, 24.0f, 0.0f }, { 16.0f, 16.0f }, &magnified);
+	Renderer::DrawQuad({ 48.0f, 8.0f, 0.0f }, { 4.0f, 4.0f }, &minified);
+	Renderer::EndScene();
+	Renderer::EndFrame();
+
+	/* The texel boundary falls between pixels 23 and 24, nearest sampling keeps it sharp. */
+	CHECK(IsColor(scope.Pixel(16, 16), 255, 0, 0));
+	CHECK(IsColor(scope.Pixel(23, 23), 255, 0, 0));
+	CHECK(IsColor(scope.Pixel(24, 23), 0, 255, 0));
+	CHECK(IsColor(scope.Pixel(31, 16), 0, 255, 0));
+	CHECK(IsColor(scope.Pixel(23, 24), 0, 0, 255));
+	CHECK(IsColor(scope.Pixel(24, 24), 255, 255, 255));
+	CHECK(IsColor(scope.Pixel(31, 31), 255, 255, 255));
+	CHECK(scope.IsClear(15, 16) && scope.IsClear(32, 31));
+
+	/* Every pixel center sits between a black and a white column. */
+	for (uint32_t y = 6; y < 10; y++) {
+		for (uint32_t x = 46; x < 50; x++) {
+			const uint8_t* pixel = scope.Pixel(x, y);
+			CHECK_NEAR(pixel[0], 128, 1);
+			CHECK(pixel[0] == pixel[1] && pixel[1] == pixel[2]);
+		}
+	}
+}
+
+/* The edge fades over the pixel centered on it, so coverage follows the distance to the circle. */
+TEST(SoftwareCircleCoverage) {
+	SoftwareScope scope;
+	const float radius = 10.0f;
+
+	Renderer::BeginScene(scope.camera);
+	Renderer::DrawCircle({ 32.0f, 32.0f, 0.0f }, radius, { 1.0f, 1.0f, 1.0f, 1.0f });
+	Renderer::EndScene();
+	Renderer::EndFrame();
+
+	double total = 0.0;
+	uint32_t wrong = 0;
+	for (uint32_t y = 0; y < SoftwareScope::SIZE; y++) {
+		for (uint32_t x = 0; x < SoftwareScope::SIZE; x++) {
+			float distance = std::sqrt((x + 0.5f - 32.0f) * (x + 0.5f - 32.0f) + (y + 0.5f - 32.0f) * (y + 0.5f - 32.0f));
+			float expected = std::fmin(std::fmax(0.5f - (distance - radius), 0.0f), 1.0f) * 255.0f;
+			float value = scope.Pixel(x, y)[0];
+			/* The edge width is a forward difference like fwidth, a little off along the diagonals. */
+			if (std::fabs(value - expected) > 4.0f)
+				wrong++;
+			total += value / 255.0;
+		}
+	}
+
+	CHECK(wrong == 0);
+	CHECK_NEAR(total, 3.14159265 * radius * radius, 1.0);
+	CHECK(scope.Pixel(32, 32)[0] == 255);
+	CHECK(scope.IsClear(32, 43) && scope.IsClear(20, 32));
+}
+
+/* Each view draws only into its own rectangle of the viewport, through its own camera. */
+TEST(SoftwareDrawsEveryViewIntoItsRectangle) {
+	SoftwareScope scope;
+	/* Each half of the buffer shows 64 world units squeezed into 32 pixels, the right one starting at x = 72. */
+	RenderView views[2];
+	views[0].camera = OrthoCamera(0.0f, 64.0f, 0.0f, 64.0f);
+	views[0].viewport = { 0.0f, 0.0f, 0.5f, 1.0f };
+	views[1].camera = OrthoCamera(72.0f, 136.0f, 0.0f, 64.0f);
+	views[1].viewport = { 0.5f, 0.0f, 0.5f, 1.0f };
+	for (RenderView& view : views)
+		view.camera.SetPosition({ 0.0f, 0.0f, 0.0f });
+
+	Renderer::BeginScene(views, 2);
+	/* Red is only in the left view, green runs off its right edge, blue is only in the right view. */
+	Renderer::DrawQuad({ 8.0f, 32.0f, 0.0f }, { 16.0f, 64.0f }, { 1.0f, 0.0f, 0.0f, 1.0f });
+	Renderer::DrawQuad({ 64.0f, 32.0f, 0.0f }, { 16.0f, 64.0f }, { 0.0f, 1.0f, 0.0f, 1.0f });
+	Renderer::DrawQuad({ 104.0f, 32.0f, 0.0f }, { 8.0f, 64.0f }, { 0.0f, 0.0f, 1.0f, 1.0f });
+	Renderer::EndScene();
+	Renderer::EndFrame();
+
+	uint32_t wrong = 0;
+	for (uint32_t y = 0; y < SoftwareScope::SIZE; y++) {
+		for (uint32_t x = 0; x < SoftwareScope::SIZE; x++) {
+			const uint8_t* pixel = scope.Pixel(x, y);
+			bool correct;
+			if (x < 8)
+				correct = IsColor(pixel, 255, 0, 0);
+			else if (x >= 28 && x < 32)
+				correct = IsColor(pixel, 0, 255, 0);
+			else if (x >= 46 && x < 50)
+				correct = IsColor(pixel, 0, 0, 255);
+			else
+				correct = scope.IsClear(x, y);
+			wrong += !correct;
+		}
+	}
+	CHECK(wrong == 0);
+}
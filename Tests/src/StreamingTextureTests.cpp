@@ -0,0 +1,195 @@
+#include "Tests.h"
+#include "StreamingTexture.h"
+#include "GPUResources.h"
+#include "NullRendererAPI.h"
+#include "SoftwareRendererAPI.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using namespace Ember;
+
+/* Sets the backend for the length of a test and deletes what the textures released into GPUResources. */
+class StreamingScope {
+public:
+	StreamingScope(RendererAPI* api) {
+		RendererAPI::Set(api);
+		GPUResources::Flush();
+	}
+
+	~StreamingScope() {
+		GPUResources::Flush();
+		RendererAPI::Set(nullptr);
+	}
+};
+
+static std::vector<uint8_t> MakePixels(uint32_t w, uint32_t h, uint32_t bpp, uint32_t seed) {
+	std::vector<uint8_t> pixels((size_t)w * h * bpp);
+	for (size_t i = 0; i < pixels.size(); i++)
+		pixels[i] = (uint8_t)(i * 31 + seed * 17 + 1);
+	return pixels;
+}
+
+/* Pixels that land outside the texture are dropped, the rest go where they are in the texture. */
+static void ApplyClipped(std::vector<uint8_t>& image, uint32_t width, uint32_t height, uint32_t bpp, int32_t x, int32_t y, uint32_t w, uint32_t h, const std::vector<uint8_t>& pixels) {
+	for (uint32_t row = 0; row < h; row++) {
+		for (uint32_t column = 0; column < w; column++) {
+			int64_t tx = (int64_t)x + column, ty = (int64_t)y + row;
+			if (tx < 0 || ty < 0 || tx >= width || ty >= height)
+				continue;
+			for (uint32_t c = 0; c < bpp; c++)
+				image[((size_t)ty * width + tx) * bpp + c] = pixels[((size_t)row * w + column) * bpp + c];
+		}
+	}
+}
+
+/* Texels of the software backend that differ from the CPU copy, expanded to RGBA8 like the backend does. */
+static uint32_t CountTexelDifferences(const SoftwareRendererAPI& api, const StreamingTexture& texture) {
+	const uint8_t* texels = api.GetTexels(texture.GetTextureId());
+	if (!texels)
+		return texture.GetWidth() * texture.GetHeight();
+
+	TextureFormat format = texture.GetFormat();
+	uint32_t bpp = GetBytesPerPixel(format);
+	uint32_t differences = 0;
+	for (uint32_t i = 0; i < texture.GetWidth() * texture.GetHeight(); i++) {
+		const uint8_t* in = texture.GetPixels() + (size_t)i * bpp;
+		uint8_t expected[4] = { in[0], 0, 0, 255 };
+		if (format != TextureFormat::R8) {
+			expected[1] = in[1];
+			expected[2] = in[2];
+		}
+		if (format == TextureFormat::RGBA8)
+			expected[3] = in[3];
+
+		const uint8_t* out = texels + (size_t)i * 4;
+		differences += (out[0] != expected[0] || out[1] != expected[1] || out[2] != expected[2] || out[3] != expected[3]);
+	}
+	return differences;
+}
+
+TEST(StreamingTextureClippedUpdatesReachTheBackend) {
+	const uint32_t width = 20, height = 12;
+	for (TextureFormat format : { TextureFormat::RGBA8, TextureFormat::RGB8, TextureFormat::R8 }) {
+		SoftwareRendererAPI api(16, 16);
+		StreamingScope scope(&api);
+		StreamingTexture texture(width, height, format);
+		uint32_t bpp = GetBytesPerPixel(format);
+
+		std::vector<uint8_t> reference = MakePixels(width, height, bpp, 0);
+		texture.Update(reference.data());
+		texture.Flush();
+		CHECK(!texture.IsDirty());
+		CHECK(CountTexelDifferences(api, texture) == 0);
+
+		/* Off the top left, off the bottom right, inside, and wider than the texture on both sides. */
+		struct Rect { int32_t x, y; uint32_t w, h; };
+		const Rect rects[] = { { -3, -2, 8, 6 }, { 15, 8, 10, 10 }, { 5, 4, 3, 2 }, { -4, 6, width + 8, 1 } };
+		uint32_t seed = 1;
+		for (const Rect& rect : rects) {
+			std::vector<uint8_t> pixels = MakePixels(rect.w, rect.h, bpp, seed++);
+			texture.Update(rect.x, rect.y, rect.w, rect.h, pixels.data());
+			ApplyClipped(reference, width, height, bpp, rect.x, rect.y, rect.w, rect.h, pixels);
+			CHECK(texture.IsDirty());
+			texture.Flush();
+			CHECK(CountTexelDifferences(api, texture) == 0);
+		}
+		CHECK(std::vector<uint8_t>(texture.GetPixels(), texture.GetPixels() + reference.size()) == reference);
+
+		/* Nothing of these is inside the texture, so nothing is dirty. */
+		std::vector<uint8_t> outside = MakePixels(4, 4, bpp, seed);
+		texture.Update(width, 0, 4, 4, outside.data());
+		texture.Update(-4, -4, 4, 4, outside.data());
+		texture.Update(2, 2, 0, 4, outside.data());
+		CHECK(!texture.IsDirty());
+
+		StreamingTextureStats stats = texture.GetStats();
+		CHECK(stats.uploads == 5);
+		CHECK(stats.stalls == 0);
+	}
+}
+
+TEST(StreamingTextureUploadsTheDirtyUnion) {
+	RecordingRendererAPI api;
+	StreamingScope scope(&api);
+	const uint32_t width = 32, height = 32, bpp = 4;
+	StreamingTexture texture(width, height);
+	api.ClearCalls();
+
+	std::vector<uint8_t> first = MakePixels(4, 4, bpp, 1), second = MakePixels(5, 2, bpp, 2);
+	texture.Update(2, 3, 4, 4, first.data());
+	texture.Update(10, 12, 5, 2, second.data());
+	texture.Flush();
+
+	/* One upload covering both rectangles, from (2, 3) to (15, 14). */
+	CHECK(api.CountCalls(RendererAPICallType::SetTextureSubData) == 1);
+	const RendererAPICall* upload = api.FindLast(RendererAPICallType::SetTextureSubData);
+	CHECK(upload != nullptr);
+	if (upload) {
+		CHECK(upload->args[0] == texture.GetTextureId());
+		CHECK(upload->args[1] == 2 && upload->args[2] == 3);
+		CHECK(upload->args[3] == 13 && upload->args[4] == 11);
+		CHECK(upload->args[5] == (uint32_t)TextureFormat::RGBA8);
+
+		/* The backend cannot map, so the rows come straight from the copy. */
+		uint32_t wrong_rows = 0;
+		CHECK(upload->data.size() == (size_t)13 * 11 * bpp);
+		for (uint32_t row = 0; row < 11 && upload->data.size() == (size_t)13 * 11 * bpp; row++) {
+			const uint8_t* expected = texture.GetPixels() + ((size_t)(3 + row) * width + 2) * bpp;
+			wrong_rows += !std::equal(expected, expected + 13 * bpp, upload->data.begin() + (size_t)row * 13 * bpp);
+		}
+		CHECK(wrong_rows == 0);
+	}
+	CHECK(texture.GetStats().uploads == 1);
+	CHECK(texture.GetStats().bytes == (uint64_t)13 * 11 * bpp);
+
+	/* A clean texture uploads nothing, a clipped update uploads only its part inside the texture. */
+	texture.Flush();
+	CHECK(api.CountCalls(RendererAPICallType::SetTextureSubData) == 1);
+
+	std::vector<uint8_t> corner = MakePixels(10, 10, bpp, 3);
+	texture.Update(-5, 30, 10, 10, corner.data());
+	texture.Flush();
+	CHECK(api.CountCalls(RendererAPICallType::SetTextureSubData) == 2);
+	upload = api.FindLast(RendererAPICallType::SetTextureSubData);
+	if (upload) {
+		CHECK(upload->args[1] == 0 && upload->args[2] == 30);
+		CHECK(upload->args[3] == 5 && upload->args[4] == 2);
+	}
+	CHECK(texture.GetStats().bytes == (uint64_t)(13 * 11 + 5 * 2) * bpp);
+}
+
+/* A slice comes around again after STREAMING_TEXTURE_SLICES uploads, and waits if the GPU has not passed its fence. */
+TEST(StreamingTextureCountsStallsOnReusedSlices) {
+	SoftwareRendererAPI api(16, 16);
+	StreamingScope scope(&api);
+	StreamingTexture texture(8, 8);
+
+	api.HoldFences(true);
+	for (uint32_t frame = 0; frame < STREAMING_TEXTURE_SLICES; frame++) {
+		std::vector<uint8_t> pixels = MakePixels(8, 8, 4, frame);
+		texture.Update(pixels.data());
+		texture.Flush();
+	}
+	CHECK(texture.GetStats().stalls == 0);
+
+	for (uint32_t frame = 0; frame < 2; frame++) {
+		std::vector<uint8_t> pixels = MakePixels(3, 3, 4, 10 + frame);
+		texture.Update(frame, frame, 3, 3, pixels.data());
+		texture.Flush();
+	}
+	CHECK(texture.GetStats().stalls == 2);
+	CHECK(CountTexelDifferences(api, texture) == 0);
+
+	/* Once the GPU catches up the ring runs without waiting. */
+	api.HoldFences(false);
+	for (uint32_t frame = 0; frame < STREAMING_TEXTURE_SLICES * 2; frame++) {
+		std::vector<uint8_t> pixels = MakePixels(2, 2, 4, 20 + frame);
+		texture.Update(4, 4, 2, 2, pixels.data());
+		texture.Flush();
+	}
+	CHECK(texture.GetStats().stalls == 2);
+	CHECK(texture.GetStats().uploads == STREAMING_TEXTURE_SLICES * 3 + 2);
+	CHECK(CountTexelDifferences(api, texture) == 0);
+}
@@ -0,0 +1,69 @@
+#include "Tests.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace Tests {
+	struct TestCase {
+		const char* name;
+		TestFunction function;
+		bool benchmark;
+	};
+
+	/* A function local so registrars in other files can run before this file's statics are initialized. */
+	static std::vector<TestCase>& GetTestCases() {
+		static std::vector<TestCase> test_cases;
+		return test_cases;
+	}
+
+	static uint32_t current_failures = 0;
+
+	TestRegistrar::TestRegistrar(const char* name, TestFunction function, bool benchmark) {
+		GetTestCases().push_back({ name, function, benchmark });
+	}
+
+	void Fail(const char* file, int line, const char* expression) {
+		printf("    %s(%d): CHECK(%s) failed\n", file, line, expression);
+		current_failures++;
+	}
+
+	void FailNear(const char* file, int line, const char* expression, double value, double expected, double tolerance) {
+		printf("    %s(%d): %s is %g, expected %g within %g\n", file, line, expression, value, expected, tolerance);
+		current_failures++;
+	}
+
+	double Seconds() {
+		static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	const char* filter = nullptr;
+	bool benchmarks = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--bench") == 0)
+			benchmarks = true;
+		else
+			filter = argv[i];
+	}
+
+	uint32_t run = 0, failed = 0;
+	for (const Tests::TestCase& test_case : Tests::GetTestCases()) {
+		if (test_case.benchmark != benchmarks || (filter && !strstr(test_case.name, filter)))
+			continue;
+
+		printf("%s\n", test_case.name);
+		Tests::current_failures = 0;
+		test_case.function();
+		run++;
+		if (Tests::current_failures > 0) {
+			printf("  FAILED\n");
+			failed++;
+		}
+	}
+
+	printf("%u %s, %u failed\n", run, benchmarks ? "benchmarks" : "tests", failed);
+	return (int)failed;
+}
@@ -0,0 +1,50 @@
+#ifndef TESTS_H
+#define TESTS_H
+
+#include <cstdint>
+#include <cstdio>
+
+/*
+* A small test runner for Ember. TEST bodies run every time, BENCHMARK bodies only with --bench, and both register
+* themselves from static initializers so a new file only has to be added to the project.
+*
+* Tests [name filter] [--bench]
+*
+* A failed CHECK reports itself and the test carries on; the exit code is the number of failed tests.
+*/
+namespace Tests {
+	using TestFunction = void (*)();
+
+	struct TestRegistrar {
+		TestRegistrar(const char* name, TestFunction function, bool benchmark);
+	};
+
+	void Fail(const char* file, int line, const char* expression);
+	void FailNear(const char* file, int line, const char* expression, double value, double expected, double tolerance);
+
+	/* Seconds since an arbitrary start, for the benchmarks. */
+	double Seconds();
+}
+
+#define TEST(name) \
+	static void name(); \
+	static Tests::TestRegistrar name##_registrar(#name, name, false); \
+	static void name()
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static Tests::TestRegistrar name##_registrar(#name, name, true); \
+	static void name()
+
+#define CHECK(expression) \
+	do { if (!(expression)) Tests::Fail(__FILE__, __LINE__, #expression); } while (0)
+
+/* Checks |value - expected| <= tolerance. */
+#define CHECK_NEAR(value, expected, tolerance) \
+	do { \
+		double check_value = (double)(value), check_expected = (double)(expected); \
+		if (!(check_value - check_expected <= (tolerance) && check_expected - check_value <= (tolerance))) \
+			Tests::FailNear(__FILE__, __LINE__, #value, check_value, check_expected, (double)(tolerance)); \
+	} while (0)
+
+#endif // !TESTS_H
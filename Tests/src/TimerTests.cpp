@@ -0,0 +1,181 @@
+#include "Tests.h"
+#include "TimerWheel.h"
+#include "Timer.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace Ember;
+
+/* Delays on both sides of each level's range, in one nanosecond ticks so the delay is the tick count. */
+TEST(TimerWheelFiresAcrossLevels) {
+	const uint64_t level_ranges[] = { 1ull << 8, 1ull << 16, 1ull << 24 };
+	for (uint64_t start : { 0ull, 100ull }) {
+		TimerWheel wheel(1);
+		/* An offset start leaves the lower levels mid rotation when the timers are placed. */
+		wheel.Advance(start);
+
+		std::vector<uint64_t> delays;
+		for (uint64_t range : level_ranges)
+			for (uint64_t delay : { range - 1, range, range + 1 })
+				delays.push_back(delay);
+
+		std::vector<uint64_t> fired(delays.size(), 0);
+		for (size_t i = 0; i < delays.size(); i++)
+			wheel.Schedule(delays[i], [&wheel, &fired, i]() { fired[i] = wheel.GetTime(); });
+		CHECK(wheel.GetTimerCount() == delays.size());
+
+		/* Uneven steps, so expiries land inside an Advance rather than on its end. */
+		uint64_t last = start + delays.back();
+		while (wheel.GetTime() <= last)
+			wheel.Advance(99991);
+
+		for (size_t i = 0; i < delays.size(); i++)
+			CHECK(fired[i] == start + delays[i]);
+		CHECK(wheel.GetTimerCount() == 0);
+	}
+}
+
+TEST(TimerWheelRepeatsPeriodicTimers) {
+	TimerWheel wheel(1);
+	std::vector<uint64_t> short_fires, long_fires;
+	wheel.Schedule(5, [&]() { short_fires.push_back(wheel.GetTime()); }, 10);
+	/* A period longer than the first level, each repeat goes through a cascade. */
+	TimerHandle long_timer = wheel.Schedule(300, [&]() { long_fires.push_back(wheel.GetTime()); }, 300);
+
+	wheel.Advance(1000);
+	CHECK(short_fires.size() == 100);
+	for (size_t i = 0; i < short_fires.size(); i++)
+		CHECK(short_fires[i] == 5 + 10 * i);
+	CHECK(long_fires.size() == 3);
+	for (size_t i = 0; i < long_fires.size(); i++)
+		CHECK(long_fires[i] == 300 * (i + 1));
+
+	CHECK(wheel.IsPending(long_timer));
+	CHECK(wheel.GetTimerCount() == 2);
+	CHECK(wheel.Cancel(long_timer));
+	CHECK(!long_timer.IsValid());
+	wheel.Advance(1000);
+	CHECK(long_fires.size() == 3);
+	CHECK(wheel.GetTimerCount() == 1);
+}
+
+TEST(TimerWheelCallbacksCancelAndSchedule) {
+	TimerWheel wheel(1);
+	uint32_t later_fired = 0, scheduled_fired = 0, same_slot_fired = 0;
+	uint64_t scheduled_time = 0;
+
+	TimerHandle later = wheel.Schedule(20, [&]() { later_fired++; });
+	wheel.Schedule(10, [&]() {
+		CHECK(wheel.Cancel(later));
+		wheel.Schedule(5, [&]() { scheduled_fired++; scheduled_time = wheel.GetTime(); });
+	});
+
+	/* Two timers in the same slot, whichever fires first cancels the other. */
+	TimerHandle pair[2];
+	for (uint32_t i = 0; i < 2; i++) {
+		pair[i] = wheel.Schedule(12, [&, i]() {
+			same_slot_fired++;
+			CHECK(wheel.Cancel(pair[1 - i]));
+		});
+	}
+
+	/* A periodic timer that cancels itself on its third run. */
+	uint32_t self_runs = 0;
+	TimerHandle self;
+	self = wheel.Schedule(1, [&]() {
+		if (++self_runs == 3) {
+			CHECK(wheel.Cancel(self));
+			CHECK(!wheel.Cancel(self));
+		}
+	}, 1);
+
+	wheel.Advance(100);
+	CHECK(later_fired == 0);
+	CHECK(scheduled_fired == 1 && scheduled_time == 15);
+	CHECK(same_slot_fired == 1);
+	CHECK(self_runs == 3);
+	CHECK(!wheel.IsPending(self));
+	CHECK(wheel.GetTimerCount() == 0);
+
+	/* Freed nodes are reused, handles to their old timers stay invalid. */
+	TimerHandle stale = pair[0].IsValid() ? pair[0] : pair[1];
+	TimerHandle fresh = wheel.Schedule(5, []() {});
+	CHECK(!wheel.IsPending(stale));
+	CHECK(wheel.IsPending(fresh));
+}
+
+TEST(TimerWheelClearInsideACallback) {
+	TimerWheel wheel(1);
+	uint32_t fired = 0, clearing_runs = 0;
+
+	wheel.Schedule(10, [&]() { fired++; });
+	wheel.Schedule(10, [&]() { fired++; });
+	wheel.Schedule(50, [&]() { fired++; });
+	wheel.Schedule(70000, [&]() { fired++; });
+	wheel.Schedule(10, [&]() {
+		clearing_runs++;
+		wheel.Clear();
+	}, 10);
+
+	/* The clearing timer is the last scheduled, so it heads its slot and fires first. */
+	wheel.Advance(100000);
+	CHECK(clearing_runs == 1);
+	CHECK(fired == 0);
+	CHECK(wheel.GetTimerCount() == 0);
+
+	/* The wheel keeps working afterwards. */
+	wheel.Schedule(10, [&]() { fired++; });
+	wheel.Advance(10);
+	CHECK(fired == 1);
+}
+
+TEST(TimerWheelRemainingTime) {
+	TimerWheel wheel(1000);
+	TimerHandle near_timer = wheel.Schedule(5000, []() {});
+	/* Rounded up to whole ticks. */
+	TimerHandle rounded = wheel.Schedule(2500, []() {});
+	TimerHandle far_timer = wheel.Schedule(300000000, []() {});
+	CHECK(wheel.GetRemaining(near_timer) == 5000);
+	CHECK(wheel.GetRemaining(rounded) == 3000);
+	CHECK(wheel.GetRemaining(far_timer) == 300000000);
+
+	/* Time short of a tick still counts. */
+	wheel.Advance(1500);
+	CHECK(wheel.GetRemaining(near_timer) == 3500);
+	CHECK(wheel.GetRemaining(rounded) == 1500);
+	CHECK(wheel.GetRemaining(far_timer) == 300000000 - 1500);
+
+	wheel.Advance(3500);
+	CHECK(!wheel.IsPending(near_timer));
+	CHECK(wheel.GetRemaining(near_timer) == 0);
+	CHECK(wheel.GetRemaining(far_timer) == 300000000 - 5000);
+
+	wheel.Cancel(far_timer);
+	CHECK(wheel.GetRemaining(far_timer) == 0);
+}
+
+/* A long frame that skips past several seconds reports each of them once. */
+TEST(TimerFetchAtAcrossOneUpdate) {
+	Timer timer;
+	timer.Update();
+	CHECK(!timer.FetchAt(1));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+	timer.Update();
+	CHECK(timer.GetSeconds() == 2);
+	CHECK(!timer.FetchAt(0));
+	CHECK(timer.FetchAt(1));
+	CHECK(timer.FetchAt(2));
+	CHECK(!timer.FetchAt(3));
+
+	timer.Update();
+	CHECK(!timer.FetchAt(1));
+	CHECK(!timer.FetchAt(2));
+
+	/* A stopped timer does not move, so nothing is reached. */
+	timer.StopTimer();
+	timer.Update();
+	CHECK(!timer.FetchAt(2) && !timer.FetchAt(3));
+}
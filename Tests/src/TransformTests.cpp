@@ -0,0 +1,101 @@
+#include "Tests.h"
+#include "Transform2D.h"
+
+#include <gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <random>
+
+using Ember::Transform2D;
+
+static const glm::vec4 UNIT_QUAD[4] = {
+	{ -0.5f, -0.5f, 0.0f, 1.0f }, { 0.5f, -0.5f, 0.0f, 1.0f }, { 0.5f, 0.5f, 0.0f, 1.0f }, { -0.5f, 0.5f, 0.0f, 1.0f }
+};
+
+/* Largest coordinate difference between the mat4 and the transform over the unit quad's corners. */
+static float QuadError(const glm::mat4& model, const Transform2D& transform) {
+	float error = 0.0f;
+	for (const glm::vec4& corner : UNIT_QUAD) {
+		glm::vec2 difference = glm::vec2(model * corner) - transform.Apply(glm::vec2(corner));
+		error = std::max(error, std::max(std::fabs(difference.x), std::fabs(difference.y)));
+	}
+	return error;
+}
+
+TEST(Transform2DMatchesMat4) {
+	std::mt19937 random(60);
+	std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+	const glm::vec3 z_axis = { 0.0f, 0.0f, 1.0f };
+	float error = 0.0f;
+	for (uint32_t i = 0; i < 100000; i++) {
+		glm::vec2 translation = { distribution(random), distribution(random) };
+		glm::vec2 scale = { distribution(random), distribution(random) };
+		float radians = glm::radians(distribution(random) * 4.0f);
+		glm::mat4 translate = glm::translate(glm::mat4(1.0f), glm::vec3(translation, 0.0f));
+		glm::mat4 rotate = glm::rotate(glm::mat4(1.0f), radians, z_axis);
+		glm::mat4 scaled = glm::scale(glm::mat4(1.0f), glm::vec3(scale, 1.0f));
+
+		error = std::max(error, QuadError(translate * scaled, Transform2D::TranslateScale(translation, scale)));
+		error = std::max(error, QuadError(translate * rotate * scaled, Transform2D::TranslateRotateScale(translation, radians, scale)));
+		error = std::max(error, QuadError(translate * scaled * rotate, Transform2D::TranslateScaleRotate(translation, scale, radians)));
+
+		Transform2D transform = Transform2D::TranslateRotateScale(translation, radians, scale);
+		error = std::max(error, QuadError(transform.ToMat4(), transform));
+
+		/* What DrawLine used to build: rotate by atan2 and stretch over the length. */
+		glm::vec2 p1 = { distribution(random), distribution(random) };
+		glm::vec2 p2 = { distribution(random), distribution(random) };
+		float width = distribution(random);
+		glm::vec2 direction = p2 - p1;
+		glm::mat4 line = glm::translate(glm::mat4(1.0f), glm::vec3((p1 + p2) * 0.5f, 0.0f)) *
+			glm::rotate(glm::mat4(1.0f), std::atan2(direction.y, direction.x), z_axis) *
+			glm::scale(glm::mat4(1.0f), { glm::length(direction), width, 1.0f });
+		error = std::max(error, QuadError(line, Transform2D::Line(p1, p2, width)));
+	}
+	/* Coordinates reach a few hundred, so this is a few ulps of them. */
+	CHECK_NEAR(error, 0.0, 1.0e-4);
+
+	Transform2D a = Transform2D::TranslateRotateScale({ 3.0f, -2.0f }, 0.7f, { 2.0f, 5.0f });
+	Transform2D b = Transform2D::TranslateScaleRotate({ -1.0f, 4.0f }, { 0.5f, 3.0f }, -1.1f);
+	CHECK_NEAR(QuadError(a.ToMat4() * b.ToMat4(), a * b), 0.0, 1.0e-5);
+}
+
+/* The corners of a sprite's quad the way the Renderer built them from a mat4, and from a Transform2D. */
+BENCHMARK(Transform2DQuadCorners) {
+	const uint32_t count = 1000000;
+	const glm::vec3 z_axis = { 0.0f, 0.0f, 1.0f };
+	glm::vec4 sink(0.0f);
+
+	double start = Tests::Seconds();
+	for (uint32_t i = 0; i < count; i++) {
+		float f = (float)i;
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), { f, f, 0.0f }) * glm::scale(glm::mat4(1.0f), { f, 2.0f, 1.0f });
+		for (const glm::vec4& corner : UNIT_QUAD)
+			sink += model * corner;
+	}
+	double mat4_plain = Tests::Seconds();
+	for (uint32_t i = 0; i < count; i++) {
+		float f = (float)i;
+		Transform2D transform = Transform2D::TranslateScale({ f, f }, { f, 2.0f });
+		for (const glm::vec4& corner : UNIT_QUAD)
+			sink += glm::vec4(transform.Apply(glm::vec2(corner)), 0.0f, 1.0f);
+	}
+	double transform_plain = Tests::Seconds();
+	for (uint32_t i = 0; i < count; i++) {
+		float f = (float)i;
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), { f, f, 0.0f }) * glm::rotate(glm::mat4(1.0f), f * 0.001f, z_axis) *
+			glm::scale(glm::mat4(1.0f), { f, 2.0f, 1.0f });
+		for (const glm::vec4& corner : UNIT_QUAD)
+			sink += model * corner;
+	}
+	double mat4_rotated = Tests::Seconds();
+	for (uint32_t i = 0; i < count; i++) {
+		float f = (float)i;
+		Transform2D transform = Transform2D::TranslateRotateScale({ f, f }, f * 0.001f, { f, 2.0f });
+		for (const glm::vec4& corner : UNIT_QUAD)
+			sink += glm::vec4(transform.Apply(glm::vec2(corner)), 0.0f, 1.0f);
+	}
+	double transform_rotated = Tests::Seconds();
+
+	printf("  quad             mat4 %6.2f ns  Transform2D %6.2f ns\n", (mat4_plain - start) * 1.0e9 / count, (transform_plain - mat4_plain) * 1.0e9 / count);
+	printf("  rotated quad     mat4 %6.2f ns  Transform2D %6.2f ns (%g)\n", (mat4_rotated - transform_plain) * 1.0e9 / count, (transform_rotated - mat4_rotated) * 1.0e9 / count, sink.x);
+}
@@ -23,7 +23,7 @@ project "Asteroids"
 	kind "ConsoleApp"
 	language "C++"
 	staticruntime "on"
-	cppdialect "C++17"
+	cppdialect "C++20"
 
 	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
 	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
@@ -50,7 +50,99 @@ project "Asteroids"
 		systemversion "latest"
 
 	filter "configurations:Debug"
-		defines "EMBER_DEBUG"
+		defines { "EMBER_DEBUG", "EMBER_MEMORY_TRACKING" }
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "EMBER_RELEASE"
+		runtime "Release"
+		optimize "on"
+
+	filter "configurations:Dist"
+		defines "EMBER_DIST"
+		runtime "Release"
+		optimize "on"
+
+project "Replay"
+	location "Replay"
+	kind "ConsoleApp"
+	language "C++"
+	staticruntime "on"
+	cppdialect "C++20"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	files {
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp"
+	}
+
+	includedirs {
+		"Ember/include",
+		"%{IncludeDir.SDL2}",
+		"%{IncludeDir.GLAD}",
+		"%{IncludeDir.glm}",
+		"%{IncludeDir.freetype}"
+	}
+
+	links
+	{
+		"Ember"
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		defines { "EMBER_DEBUG", "EMBER_MEMORY_TRACKING" }
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "EMBER_RELEASE"
+		runtime "Release"
+		optimize "on"
+
+	filter "configurations:Dist"
+		defines "EMBER_DIST"
+		runtime "Release"
+		optimize "on"
+
+project "Tests"
+	location "Tests"
+	kind "ConsoleApp"
+	language "C++"
+	staticruntime "on"
+	cppdialect "C++20"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	files {
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp"
+	}
+
+	includedirs {
+		"Ember/include",
+		"%{IncludeDir.SDL2}",
+		"%{IncludeDir.GLAD}",
+		"%{IncludeDir.glm}",
+		"%{IncludeDir.freetype}"
+	}
+
+	links
+	{
+		"Ember"
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		defines { "EMBER_DEBUG", "EMBER_MEMORY_TRACKING" }
 		runtime "Debug"
 		symbols "on"
 
@@ -69,7 +161,7 @@ project "Ember"
 	kind "StaticLib"
 	language "C++"
 	staticruntime "on"
-	cppdialect "C++17"
+	cppdialect "C++20"
 
 	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
 	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
@@ -111,7 +203,7 @@ project "Ember"
 		systemversion "latest"
 
 	filter "configurations:Debug"
-		defines "EMBER_DEBUG"
+		defines { "EMBER_DEBUG", "EMBER_MEMORY_TRACKING" }
 		runtime "Debug"
 		symbols "on"
 